@@ -0,0 +1,288 @@
+#include "canvas/ownership_grid.h"
+#include "headless/frame_exporter.h"
+#include "headless/headless_runner.h"
+#include "performance/profiler.h"
+#include "replay/canvas_stream.h"
+#include "replay/input_recording.h"
+#include "replay/match_recording.h"
+#include "rendering/null_renderer.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+
+template <typename T>
+bool parseNumber(const std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+void printUsage() {
+    std::cout << "Usage: ddd_headless [--ticks N] [--players N] [--bots N] [--seed N] "
+                 "[--tick-rate HZ] [--threads N] [--script FILE] [--record FILE] [--replay FILE] "
+                 "[--match-out FILE] [--keyframe-interval N] [--trace-frames N] [--trace-out FILE] "
+                 "[--frames-out DIR] [--frame-interval N] [--watercolor INTENSITY] "
+                 "[--arena WIDTHxHEIGHT] [--canvas-out FILE] [--canvas-interval N]\n"
+                 "       ddd_headless --match-in FILE --seek TICK\n";
+}
+
+// Restores one tick of a match recording and reports what it holds
+int seekMatch(const std::string& path, const std::uint32_t tick) {
+    auto reader = MatchRecordingReader::open(path);
+    if (!reader.has_value()) {
+        std::cerr << "Could not open match recording " << path << ": " << reader.error() << "\n";
+        return 1;
+    }
+
+    entt::registry registry;
+    const auto start = std::chrono::steady_clock::now();
+    if (!reader->seek(registry, tick)) {
+        std::cerr << "Could not seek to tick " << tick << " of " << reader->getTickCount() << "\n";
+        return 1;
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Tick: " << tick << " of " << reader->getTickCount() << "\n"
+              << "Seek: " << elapsed.count() << " ms\n";
+    const auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+    for (std::uint8_t palette = 1; palette < CanvasOwnershipGrid::kMaxPaletteEntries; ++palette) {
+        if (grid.cellCount(palette) > 0) {
+            std::cout << "Palette " << static_cast<int>(palette) << " coverage: " << grid.coverage(palette) * 100.0F
+                      << "%\n";
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(const int argc, char** argv) {
+    HeadlessOptions options;
+    std::string scriptPath;
+    std::string recordPath;
+    std::string replayPath;
+    std::string matchOut;
+    std::string matchIn;
+    std::uint32_t keyframeInterval = MatchRecordingWriter::kDefaultKeyframeInterval;
+    std::optional<std::uint32_t> seekTick;
+    bool ticksGiven = false;
+    std::uint32_t traceFrames = 0;
+    std::string traceOut = "trace.json";
+    std::string framesOut;
+    std::uint32_t frameInterval = 1;
+    std::optional<WatercolorSettings> watercolor;
+    std::string canvasOut;
+    std::uint32_t canvasInterval = 0; // 0 for one simulated second
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view flag = argv[i];
+        if (flag == "--help") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        bool parsed = true;
+        if (flag == "--ticks") {
+            parsed = parseNumber(value, options.ticks);
+            ticksGiven = true;
+        } else if (flag == "--players") {
+            parsed = parseNumber(value, options.players);
+        } else if (flag == "--bots") {
+            parsed = parseNumber(value, options.bots);
+        } else if (flag == "--seed") {
+            parsed = parseNumber(value, options.seed);
+        } else if (flag == "--tick-rate") {
+            parsed = parseNumber(value, options.tickRate) && options.tickRate > 0.0F;
+        } else if (flag == "--threads") {
+            parsed = parseNumber(value, options.workerThreads);
+        } else if (flag == "--script") {
+            scriptPath = value;
+        } else if (flag == "--record") {
+            recordPath = value;
+        } else if (flag == "--replay") {
+            replayPath = value;
+        } else if (flag == "--match-out") {
+            matchOut = value;
+        } else if (flag == "--keyframe-interval") {
+            parsed = parseNumber(value, keyframeInterval) && keyframeInterval > 0;
+        } else if (flag == "--match-in") {
+            matchIn = value;
+        } else if (flag == "--seek") {
+            std::uint32_t tick = 0;
+            parsed = parseNumber(value, tick);
+            seekTick = tick;
+        } else if (flag == "--trace-frames") {
+            parsed = parseNumber(value, traceFrames);
+        } else if (flag == "--trace-out") {
+            traceOut = value;
+        } else if (flag == "--frames-out") {
+            framesOut = value;
+        } else if (flag == "--frame-interval") {
+            parsed = parseNumber(value, frameInterval) && frameInterval > 0;
+        } else if (flag == "--arena") {
+            const auto separator = value.find('x');
+            parsed = separator != std::string_view::npos &&
+                     parseNumber(value.substr(0, separator), options.arenaWidth) &&
+                     parseNumber(value.substr(separator + 1), options.arenaHeight) &&
+                     options.arenaWidth > 0.0F && options.arenaHeight > 0.0F;
+        } else if (flag == "--canvas-out") {
+            canvasOut = value;
+        } else if (flag == "--canvas-interval") {
+            parsed = parseNumber(value, canvasInterval) && canvasInterval > 0;
+        } else if (flag == "--watercolor") {
+            parsed = parseNumber(value, watercolor.emplace().intensity) &&
+                     watercolor->intensity >= 0.0F;
+        } else {
+            parsed = false;
+        }
+
+        if (!parsed) {
+            std::cerr << "Invalid argument: " << flag << " " << value << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!matchIn.empty()) {
+        return seekMatch(matchIn, seekTick.value_or(0));
+    }
+
+    // A replay brings its own config, spawns and input, and by default runs to its end
+    std::optional<InputRecording> replay;
+    if (!replayPath.empty()) {
+        std::ifstream file(replayPath, std::ios::binary);
+        auto recording = readInputRecording(file);
+        if (!recording.has_value()) {
+            std::cerr << "Could not load replay " << replayPath << ": " << recording.error() << "\n";
+            return 1;
+        }
+        if (!ticksGiven) {
+            options.ticks = recording->getTickCount();
+        }
+        replay = std::move(*recording);
+    }
+
+    const NullRenderer renderer {};
+    HeadlessRunner runner(renderer, options, std::move(replay));
+    if (!recordPath.empty() && !runner.startRecording()) {
+        std::cerr << "Too many players to record input\n";
+        return 1;
+    }
+
+    if (!scriptPath.empty()) {
+        std::ifstream script(scriptPath);
+        if (!script || !runner.loadScript(script)) {
+            std::cerr << "Could not load input script " << scriptPath << "\n";
+            return 1;
+        }
+    }
+
+    std::ofstream matchFile;
+    std::optional<MatchRecordingWriter> matchWriter;
+    if (!matchOut.empty()) {
+        matchFile.open(matchOut, std::ios::binary);
+        if (!matchFile) {
+            std::cerr << "Could not create match recording " << matchOut << "\n";
+            return 1;
+        }
+        runner.recordMatch(matchWriter.emplace(matchFile, keyframeInterval));
+    }
+
+    // Deltas while the match runs and a snapshot of how it ended, packed as they are written
+    std::ofstream canvasFile;
+    std::optional<CanvasStreamWriter> canvasWriter;
+    if (!canvasOut.empty()) {
+        canvasFile.open(canvasOut, std::ios::binary);
+        if (!canvasFile) {
+            std::cerr << "Could not create canvas stream " << canvasOut << "\n";
+            return 1;
+        }
+        const auto palette = runner.getPalette();
+        if (canvasInterval == 0) {
+            canvasInterval = static_cast<std::uint32_t>(
+                std::max(1.0F, std::round(runner.getConfig().simulationTickRate)));
+        }
+        const auto& grid = runner.getRegistry().ctx().get<CanvasOwnershipGrid>();
+        runner.streamCanvas(canvasWriter.emplace(canvasFile, grid, palette), canvasInterval);
+    }
+
+    // Frames are drawn on the CPU, so this works without a GPU or a display
+    std::optional<FrameExporter> frameExporter;
+    if (!framesOut.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(framesOut, error);
+        if (error) {
+            std::cerr << "Could not create frame directory " << framesOut << ": " << error.message()
+                      << "\n";
+            return 1;
+        }
+        runner.exportFrames(frameExporter.emplace(runner.getRegistry(), runner.getConfig(),
+                                                  renderer.getWindowWidth(),
+                                                  renderer.getWindowHeight(), framesOut,
+                                                  watercolor, runner.getThreadPool()),
+                            frameInterval);
+    }
+
+    // Each tick is a profiler frame
+    if (traceFrames > 0) {
+        ScopeProfiler::getInstance().requestCapture(traceFrames, traceOut);
+    }
+
+    const auto report = runner.run();
+    ScopeProfiler::getInstance().waitForCapture();
+    std::cout << "Ticks: " << report.ticks << "\n"
+              << "Elapsed: " << report.elapsedSeconds << " s\n"
+              << "Ticks/second: " << report.ticksPerSecond << "\n";
+    for (std::size_t player = 0; player < report.coverage.size(); ++player) {
+        std::cout << "Player " << player + 1 << " coverage: " << report.coverage[player] * 100.0F
+                  << "%\n";
+    }
+    ScopeProfiler::getInstance().printResults();
+
+    if (frameExporter.has_value()) {
+        if (frameExporter->hasFailed()) {
+            std::cerr << "Could not write frames to " << framesOut << "\n";
+            return 1;
+        }
+        std::cout << "Frames written: " << frameExporter->getFramesWritten() << "\n";
+    }
+
+    if (canvasWriter.has_value()) {
+        const auto& grid = runner.getRegistry().ctx().get<CanvasOwnershipGrid>();
+        if (!canvasWriter->writeSnapshot(grid, runner.getTick()) || !canvasFile.flush()) {
+            std::cerr << "Could not write canvas stream to " << canvasOut << "\n";
+            return 1;
+        }
+        std::cout << "Canvas frames: " << canvasWriter->getFrameCount() << ", "
+                  << canvasWriter->getBytesWritten() << " bytes\n";
+    }
+
+    if (matchWriter.has_value() && !matchWriter->finish()) {
+        std::cerr << "Could not write match recording to " << matchOut << "\n";
+        return 1;
+    }
+
+    if (!recordPath.empty()) {
+        std::ofstream file(recordPath, std::ios::binary);
+        if (!file || !writeInputRecording(file, runner.getRecording())) {
+            std::cerr << "Could not write input recording to " << recordPath << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
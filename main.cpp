@@ -1,17 +1,100 @@
 #include "humble_engine.h"
+#include "performance/profiler.h"
+#include "replay/input_recording.h"
 #include "rendering/renderer.h"
 #include "src/diddle_doodle_duel.h"
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
 #include <string>
+#include <string_view>
+
+namespace {
+
+template <typename T>
+bool parseNumber(const std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+void printUsage() {
+    std::cout << "Usage: DiddleDoodleDuel [--trace-frames N] [--trace-out FILE] [--record FILE] "
+                 "[--replay FILE] [--arena WIDTHxHEIGHT]\n";
+}
+
+} // namespace
+
+int main(const int argc, char** argv) {
+    // --trace-frames N [--trace-out FILE] captures the first N frames as a Chrome trace;
+    // --record FILE saves the last local match's input, --replay FILE plays one back;
+    // --arena WIDTHxHEIGHT plays on an arena of that size, followed by the camera
+    std::uint32_t traceFrames = 0;
+    std::string traceOut = "trace.json";
+    std::string replayPath;
+    InputLogOptions inputLog;
+    GameConfig config = GameConfig::localMatch();
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view flag = argv[i];
+        if (flag == "--help") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        bool parsed = true;
+        if (flag == "--trace-frames") {
+            parsed = parseNumber(value, traceFrames);
+        } else if (flag == "--trace-out") {
+            traceOut = value;
+        } else if (flag == "--record") {
+            inputLog.recordPath = value;
+        } else if (flag == "--replay") {
+            replayPath = value;
+        } else if (flag == "--arena") {
+            const auto separator = value.find('x');
+            parsed = separator != std::string_view::npos &&
+                     parseNumber(value.substr(0, separator), config.arenaWidth) &&
+                     parseNumber(value.substr(separator + 1), config.arenaHeight) &&
+                     config.arenaWidth > 0.0F && config.arenaHeight > 0.0F;
+        } else {
+            parsed = false;
+        }
+
+        if (!parsed) {
+            std::cerr << "Invalid argument: " << flag << " " << value << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!replayPath.empty()) {
+        std::ifstream file(replayPath, std::ios::binary);
+        auto recording = readInputRecording(file);
+        if (!recording.has_value()) {
+            std::cerr << "Could not load replay " << replayPath << ": " << recording.error() << "\n";
+            return 1;
+        }
+        inputLog.replay = std::move(*recording);
+    }
 
-int main() {
     engine::Renderer renderer {};
     if (const auto init = renderer.initialize(1280, 720, "Diddle Doodle Duel");
         !init.has_value()) {
         return 1;
     }
 
-    DiddleDoodleDuel game(renderer);
+    if (traceFrames > 0) {
+        ScopeProfiler::getInstance().requestCapture(traceFrames, traceOut);
+    }
+
+    DiddleDoodleDuel game(renderer, std::move(inputLog), config);
     game.run();
+    ScopeProfiler::getInstance().waitForCapture();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,140 @@
+#include "performance/profiler.h"
+#include "rendering/null_renderer.h"
+#include "server/match_server.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+template <typename T>
+bool parseNumber(const std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+bool parseSwitch(const std::string_view text, bool& value) {
+    if (text == "on" || text == "off") {
+        value = text == "on";
+        return true;
+    }
+    return false;
+}
+
+void printUsage() {
+    std::cout << "Usage: ddd_server [--ticks N] [--matches N] [--players N] [--bots N] "
+                 "[--snapshot-interval N] [--snapshot-budget BYTES] [--threads N] [--pin on|off] "
+                 "[--pace on|off] [--seed N] [--tick-rate HZ]\n";
+}
+
+double percentile(std::vector<double> values, const double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index),
+                     values.end());
+    return values[index];
+}
+
+} // namespace
+
+int main(const int argc, char** argv) {
+    MatchServerOptions options;
+    std::uint32_t ticks = 600;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view flag = argv[i];
+        if (flag == "--help") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        bool parsed = true;
+        if (flag == "--ticks") {
+            parsed = parseNumber(value, ticks);
+        } else if (flag == "--matches") {
+            parsed = parseNumber(value, options.matches) && options.matches > 0;
+        } else if (flag == "--players") {
+            parsed = parseNumber(value, options.playersPerMatch);
+        } else if (flag == "--bots") {
+            parsed = parseNumber(value, options.botClientsPerMatch);
+        } else if (flag == "--snapshot-interval") {
+            parsed = parseNumber(value, options.snapshotInterval);
+        } else if (flag == "--snapshot-budget") {
+            parsed =
+                parseNumber(value, options.snapshotBudgetBytes) && options.snapshotBudgetBytes > 0;
+        } else if (flag == "--threads") {
+            parsed = parseNumber(value, options.threads);
+        } else if (flag == "--pin") {
+            parsed = parseSwitch(value, options.pinThreads);
+        } else if (flag == "--pace") {
+            parsed = parseSwitch(value, options.paced);
+        } else if (flag == "--seed") {
+            parsed = parseNumber(value, options.seed);
+        } else if (flag == "--tick-rate") {
+            parsed = parseNumber(value, options.tickRate) && options.tickRate > 0.0F;
+        } else {
+            parsed = false;
+        }
+
+        if (!parsed) {
+            std::cerr << "Invalid argument: " << flag << " " << value << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    const NullRenderer renderer {};
+    MatchServer server(renderer, options);
+    const auto report = server.run(ticks);
+
+    std::vector<double> means;
+    double worst = 0.0;
+    double totalMean = 0.0;
+    std::uint64_t snapshotBytes = 0;
+    for (const auto& match : report.matches) {
+        means.push_back(match.meanTickSeconds);
+        worst = std::max(worst, match.maxTickSeconds);
+        totalMean += match.meanTickSeconds;
+        snapshotBytes += match.snapshotBytes;
+    }
+    const double averageMean = totalMean / static_cast<double>(report.matches.size());
+    const double tickSeconds = 1.0 / options.tickRate;
+
+    std::cout << "Matches: " << report.matches.size() << " on " << server.getThreadCount()
+              << " threads\n"
+              << "Ticks: " << report.ticks << "\n"
+              << "Elapsed: " << report.elapsedSeconds << " s\n"
+              << "Late ticks: " << report.lateTicks << "\n"
+              << "Match tick cost: mean " << averageMean * 1e6 << " us, p50 "
+              << percentile(means, 0.5) * 1e6 << " us, p99 " << percentile(means, 0.99) * 1e6
+              << " us, max " << worst * 1e6 << " us\n";
+    if (averageMean > 0.0) {
+        std::cout << "Matches per core at " << options.tickRate
+                  << " Hz: " << tickSeconds / averageMean << "\n";
+    }
+    const auto clients = static_cast<std::uint64_t>(report.matches.size()) *
+                         options.botClientsPerMatch;
+    if (clients > 0 && report.ticks > 0) {
+        const double simulatedSeconds = static_cast<double>(report.ticks) * tickSeconds;
+        std::cout << "Snapshot bytes/s per client: "
+                  << static_cast<double>(snapshotBytes) / static_cast<double>(clients) /
+                         simulatedSeconds
+                  << "\n";
+    }
+    for (std::size_t worker = 0; worker < report.threadBusySeconds.size(); ++worker) {
+        std::cout << "Thread " << worker << " busy: "
+                  << report.threadBusySeconds[worker] / report.elapsedSeconds * 100.0 << "%\n";
+    }
+    ScopeProfiler::getInstance().printResults();
+    return 0;
+}
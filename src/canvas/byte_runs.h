@@ -0,0 +1,83 @@
+#ifndef DIDDLEDOODLEDUEL_BYTE_RUNS_H
+#define DIDDLEDOODLEDUEL_BYTE_RUNS_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// PackBits run-length coding, for packed canvas rows. A control byte c below 128 is followed by
+// c + 1 literal bytes; one above 128 by a single byte repeated 257 - c times. 128 is unused.
+// Flat paint packs to a few bytes per row, and noise grows by at most one byte in 128.
+namespace byte_runs {
+
+inline constexpr std::size_t kMaxRun = 128;
+
+// Appends the runs of bytes to packed
+inline void pack(const std::span<const std::uint8_t> bytes, std::vector<std::uint8_t>& packed) {
+    std::size_t index = 0;
+    std::size_t literalStart = 0;
+    const auto flushLiterals = [&](const std::size_t end) {
+        while (literalStart < end) {
+            const std::size_t length = std::min(kMaxRun, end - literalStart);
+            packed.push_back(static_cast<std::uint8_t>(length - 1));
+            packed.insert(packed.end(), bytes.begin() + static_cast<std::ptrdiff_t>(literalStart),
+                          bytes.begin() + static_cast<std::ptrdiff_t>(literalStart + length));
+            literalStart += length;
+        }
+    };
+
+    while (index < bytes.size()) {
+        std::size_t length = 1;
+        while (index + length < bytes.size() && length < kMaxRun &&
+               bytes[index + length] == bytes[index]) {
+            ++length;
+        }
+        // A pair costs as much either way; repeats only pay from three bytes on
+        if (length < 3) {
+            index += length;
+            continue;
+        }
+        flushLiterals(index);
+        packed.push_back(static_cast<std::uint8_t>(257 - length));
+        packed.push_back(bytes[index]);
+        index += length;
+        literalStart = index;
+    }
+    flushLiterals(bytes.size());
+}
+
+// False unless the runs fill bytes exactly
+inline bool unpack(const std::span<const std::uint8_t> packed,
+                   const std::span<std::uint8_t> bytes) {
+    std::size_t index = 0;
+    std::size_t offset = 0;
+    while (offset < packed.size()) {
+        const std::uint8_t control = packed[offset++];
+        if (control < 128) {
+            const std::size_t length = std::size_t {control} + 1;
+            if (length > packed.size() - offset || length > bytes.size() - index) {
+                return false;
+            }
+            std::copy_n(packed.begin() + static_cast<std::ptrdiff_t>(offset), length,
+                        bytes.begin() + static_cast<std::ptrdiff_t>(index));
+            offset += length;
+            index += length;
+        } else if (control > 128) {
+            const std::size_t length = 257 - std::size_t {control};
+            if (offset == packed.size() || length > bytes.size() - index) {
+                return false;
+            }
+            std::fill_n(bytes.begin() + static_cast<std::ptrdiff_t>(index), length,
+                        packed[offset++]);
+            index += length;
+        } else {
+            return false;
+        }
+    }
+    return index == bytes.size();
+}
+
+} // namespace byte_runs
+
+#endif // DIDDLEDOODLEDUEL_BYTE_RUNS_H
@@ -0,0 +1,113 @@
+#ifndef DIDDLEDOODLEDUEL_DIRTY_TILES_H
+#define DIDDLEDOODLEDUEL_DIRTY_TILES_H
+#include "canvas/paint_stamp.h"
+#include <algorithm>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+// Which kTileSize x kTileSize tiles of the canvas changed: a bitset, plus the set tiles listed
+// in the order they were first marked so consumers never scan the whole canvas. PaintSystem
+// keeps one in the registry context holding the tiles its last stamp pass drew into, for the
+// stages after it (post-processing, frame capture, canvas sync) to touch only those.
+class CanvasDirtyTiles {
+public:
+    static constexpr int kTileSize = 64;
+
+    CanvasDirtyTiles() = default;
+    CanvasDirtyTiles(const int width, const int height)
+        : width(std::max(0, width)), height(std::max(0, height)),
+          columns((this->width + kTileSize - 1) / kTileSize),
+          rows((this->height + kTileSize - 1) / kTileSize), bits((getTileCount() + 63) / 64, 0) {
+    }
+
+    // Bounds in canvas pixels; parts outside the canvas are ignored
+    void markRect(const float minX, const float minY, const float maxX, const float maxY) {
+        if (maxX < 0.0F || maxY < 0.0F || minX >= static_cast<float>(width) ||
+            minY >= static_cast<float>(height) || minX > maxX || minY > maxY) {
+            return;
+        }
+        const int firstColumn = std::max(0, static_cast<int>(minX) / kTileSize);
+        const int lastColumn = std::min(columns - 1, static_cast<int>(maxX) / kTileSize);
+        const int firstRow = std::max(0, static_cast<int>(minY) / kTileSize);
+        const int lastRow = std::min(rows - 1, static_cast<int>(maxY) / kTileSize);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                mark(static_cast<std::uint32_t>((row * columns) + column));
+            }
+        }
+    }
+
+    // The box around the swept circle, a pixel wider for rasterizers that round outwards
+    void markStamp(const PaintStamp& stamp) {
+        const float reach = stamp.radius + 1.0F;
+        markRect(std::min(stamp.from.x, stamp.to.x) - reach,
+                 std::min(stamp.from.y, stamp.to.y) - reach,
+                 std::max(stamp.from.x, stamp.to.x) + reach,
+                 std::max(stamp.from.y, stamp.to.y) + reach);
+    }
+
+    void markAll() {
+        for (std::uint32_t tile = 0; tile < getTileCount(); ++tile) {
+            mark(tile);
+        }
+    }
+
+    // Adds other's tiles; both must cover the same canvas size
+    void merge(const CanvasDirtyTiles& other) {
+        for (const std::uint32_t tile : other.dirtyTiles) {
+            mark(tile);
+        }
+    }
+
+    // Costs the number of dirty tiles, not the size of the canvas
+    void clear() {
+        for (const std::uint32_t tile : dirtyTiles) {
+            bits[tile / 64] = 0;
+        }
+        dirtyTiles.clear();
+    }
+
+    [[nodiscard]] bool any() const { return !dirtyTiles.empty(); }
+    [[nodiscard]] bool isDirty(const int column, const int row) const {
+        const auto tile = static_cast<std::uint32_t>((row * columns) + column);
+        return (bits[tile / 64] & (std::uint64_t {1} << (tile % 64))) != 0;
+    }
+    // Tile indices (row * columns + column), in the order they were marked
+    [[nodiscard]] std::span<const std::uint32_t> getDirtyTiles() const { return dirtyTiles; }
+
+    // Clipped to the canvas
+    [[nodiscard]] Rectangle getTileBounds(const std::uint32_t tile) const {
+        const int left = static_cast<int>(tile % static_cast<std::uint32_t>(columns)) * kTileSize;
+        const int top = static_cast<int>(tile / static_cast<std::uint32_t>(columns)) * kTileSize;
+        return Rectangle{static_cast<float>(left), static_cast<float>(top),
+                         static_cast<float>(std::min(kTileSize, width - left)),
+                         static_cast<float>(std::min(kTileSize, height - top))};
+    }
+
+    [[nodiscard]] int getColumns() const { return columns; }
+    [[nodiscard]] int getRows() const { return rows; }
+    [[nodiscard]] std::uint32_t getTileCount() const {
+        return static_cast<std::uint32_t>(columns) * static_cast<std::uint32_t>(rows);
+    }
+
+private:
+    int width {0};
+    int height {0};
+    int columns {0};
+    int rows {0};
+    std::vector<std::uint64_t> bits;
+    std::vector<std::uint32_t> dirtyTiles;
+
+    void mark(const std::uint32_t tile) {
+        std::uint64_t& word = bits[tile / 64];
+        const std::uint64_t bit = std::uint64_t {1} << (tile % 64);
+        if ((word & bit) == 0) {
+            word |= bit;
+            dirtyTiles.push_back(tile);
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_DIRTY_TILES_H
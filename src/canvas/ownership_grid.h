@@ -0,0 +1,245 @@
+#ifndef DIDDLEDOODLEDUEL_OWNERSHIP_GRID_H
+#define DIDDLEDOODLEDUEL_OWNERSHIP_GRID_H
+#include "canvas/span_rasterizer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+// CPU mirror of the paint canvas: one palette index per cell, 0 meaning unpainted. A cell
+// belongs to a stamp when its centre lies inside it. Per-palette cell counts are maintained
+// while stamps are rasterized, so scores never need a pass over the grid or a GPU readback.
+// Unpainted cells are also counted per block of kBlockCells x kBlockCells cells, for coarse
+// queries such as where unclaimed space is left, and the blocks whose count changed are listed
+// so consumers of those counts only revisit what was painted.
+class CanvasOwnershipGrid {
+public:
+    static constexpr std::uint8_t kUnpainted = 0;
+    static constexpr std::size_t kMaxPaletteEntries = 16;
+    static constexpr int kBlockCells = 8;
+
+    CanvasOwnershipGrid(const float worldWidth, const float worldHeight, const float cellSize)
+        : cellSize(cellSize), inverseCellSize(1.0F / cellSize),
+          width(std::max(1, static_cast<int>(std::ceil(worldWidth / cellSize)))),
+          height(std::max(1, static_cast<int>(std::ceil(worldHeight / cellSize)))),
+          blockColumns((width + kBlockCells - 1) / kBlockCells),
+          blockRows((height + kBlockCells - 1) / kBlockCells) {
+        clear();
+    }
+
+    CanvasOwnershipGrid(const CanvasOwnershipGrid&) = default;
+    CanvasOwnershipGrid(CanvasOwnershipGrid&&) = default;
+    CanvasOwnershipGrid& operator=(CanvasOwnershipGrid&&) = default;
+    ~CanvasOwnershipGrid() = default;
+
+    // Takes on other's cells, e.g. when rolling back, and adds the blocks whose unpainted count
+    // differs to this grid's changed blocks rather than taking other's list
+    CanvasOwnershipGrid& operator=(const CanvasOwnershipGrid& other) {
+        if (this == &other) {
+            return *this;
+        }
+        const bool sameBlocks = blockColumns == other.blockColumns && blockRows == other.blockRows;
+        if (sameBlocks) {
+            for (std::size_t block = 0; block < blockUnpainted.size(); ++block) {
+                if (blockUnpainted[block] != other.blockUnpainted[block]) {
+                    markBlockChanged(block);
+                }
+            }
+        }
+        cellSize = other.cellSize;
+        inverseCellSize = other.inverseCellSize;
+        width = other.width;
+        height = other.height;
+        blockColumns = other.blockColumns;
+        blockRows = other.blockRows;
+        cells = other.cells;
+        cellCounts = other.cellCounts;
+        blockUnpainted = other.blockUnpainted;
+        if (!sameBlocks) {
+            markAllBlocksChanged();
+        }
+        return *this;
+    }
+
+    void clear() {
+        cells.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), kUnpainted);
+        cellCounts.fill(0);
+        cellCounts[kUnpainted] = static_cast<std::uint32_t>(cells.size());
+        blockUnpainted.resize(static_cast<std::size_t>(blockColumns) *
+                              static_cast<std::size_t>(blockRows));
+        for (int blockRow = 0; blockRow < blockRows; ++blockRow) {
+            for (int blockColumn = 0; blockColumn < blockColumns; ++blockColumn) {
+                blockUnpainted[blockIndexOf(blockColumn, blockRow)] =
+                    static_cast<std::uint16_t>(blockCellCount(blockColumn, blockRow));
+            }
+        }
+        markAllBlocksChanged();
+    }
+
+    // Stamps with a palette index of kMaxPaletteEntries or more claim nothing
+    void rasterizeCircle(const Vector2 center, const float radius, const std::uint8_t paletteIndex) {
+        if (paletteIndex >= kMaxPaletteEntries) {
+            return;
+        }
+        span_rasterizer::forEachCircleSpan(
+            center, radius, cellSize, height,
+            [&](const int row, const float startX, const float endX) {
+                fillSpan(row, startX, endX, paletteIndex);
+            });
+    }
+
+    // Everything within radius of the segment from -> to, i.e. a swept circle
+    void rasterizeCapsule(const Vector2 from, const Vector2 to, const float radius,
+                          const std::uint8_t paletteIndex) {
+        if (paletteIndex >= kMaxPaletteEntries) {
+            return;
+        }
+        span_rasterizer::forEachCapsuleSpan(
+            from, to, radius, cellSize, height,
+            [&](const int row, const float startX, const float endX) {
+                fillSpan(row, startX, endX, paletteIndex);
+            });
+    }
+
+    // Replaces every cell, e.g. when restoring a recording. False, leaving the grid untouched,
+    // if the size differs or a cell is not a palette index.
+    bool assignCells(const std::span<const std::uint8_t> source) {
+        if (source.size() != cells.size() ||
+            std::ranges::any_of(source, [](const std::uint8_t cell) { return cell >= kMaxPaletteEntries; })) {
+            return false;
+        }
+        std::ranges::copy(source, cells.begin());
+        cellCounts.fill(0);
+        std::ranges::fill(blockUnpainted, std::uint16_t {0});
+        for (int row = 0; row < height; ++row) {
+            for (int column = 0; column < width; ++column) {
+                const std::uint8_t cell = cells[indexOf(column, row)];
+                ++cellCounts[cell];
+                if (cell == kUnpainted) {
+                    ++blockUnpainted[blockIndexOf(column / kBlockCells, row / kBlockCells)];
+                }
+            }
+        }
+        markAllBlocksChanged();
+        return true;
+    }
+
+    [[nodiscard]] std::uint8_t ownerAt(const float x, const float y) const {
+        const auto column = static_cast<int>(std::floor(x * inverseCellSize));
+        const auto row = static_cast<int>(std::floor(y * inverseCellSize));
+        if (column < 0 || row < 0 || column >= width || row >= height) {
+            return kUnpainted;
+        }
+        return cells[indexOf(column, row)];
+    }
+
+    [[nodiscard]] std::uint32_t cellCount(const std::uint8_t paletteIndex) const {
+        return cellCounts[paletteIndex];
+    }
+
+    [[nodiscard]] float coverage(const std::uint8_t paletteIndex) const {
+        return static_cast<float>(cellCounts[paletteIndex]) / static_cast<float>(cells.size());
+    }
+
+    // Share of the block's cells that are unpainted; blocks on the far edges may be partial
+    [[nodiscard]] float unpaintedBlockFraction(const int blockColumn, const int blockRow) const {
+        return static_cast<float>(blockUnpainted[blockIndexOf(blockColumn, blockRow)]) /
+               static_cast<float>(blockCellCount(blockColumn, blockRow));
+    }
+
+    // Calls visit(blockColumn, blockRow) once for every block whose unpainted count changed
+    // since the last call, and forgets them
+    template <typename Visit>
+    void takeChangedBlocks(Visit&& visit) {
+        for (std::size_t entry = 0; entry < changedCount; ++entry) {
+            const std::uint32_t block = changedBlocks[entry];
+            blockChanged[block] = 0;
+            visit(static_cast<int>(block % static_cast<std::uint32_t>(blockColumns)),
+                  static_cast<int>(block / static_cast<std::uint32_t>(blockColumns)));
+        }
+        changedCount = 0;
+    }
+
+    [[nodiscard]] int getBlockColumns() const { return blockColumns; }
+    [[nodiscard]] int getBlockRows() const { return blockRows; }
+    [[nodiscard]] int getWidth() const { return width; }
+    [[nodiscard]] int getHeight() const { return height; }
+    [[nodiscard]] float getCellSize() const { return cellSize; }
+    [[nodiscard]] std::span<const std::uint8_t> getCells() const { return cells; }
+
+private:
+    float cellSize;
+    float inverseCellSize;
+    int width;
+    int height;
+    int blockColumns;
+    int blockRows;
+    std::vector<std::uint8_t> cells;
+    std::array<std::uint32_t, kMaxPaletteEntries> cellCounts {};
+    std::vector<std::uint16_t> blockUnpainted;
+    // The first changedCount entries of changedBlocks, which has room for every block, so
+    // marking never allocates; blockChanged is 1 for the blocks among them
+    std::vector<std::uint8_t> blockChanged;
+    std::vector<std::uint32_t> changedBlocks;
+    std::size_t changedCount {0};
+
+    [[nodiscard]] std::size_t indexOf(const int column, const int row) const {
+        return (static_cast<std::size_t>(row) * static_cast<std::size_t>(width)) +
+               static_cast<std::size_t>(column);
+    }
+
+    [[nodiscard]] std::size_t blockIndexOf(const int blockColumn, const int blockRow) const {
+        return (static_cast<std::size_t>(blockRow) * static_cast<std::size_t>(blockColumns)) +
+               static_cast<std::size_t>(blockColumn);
+    }
+
+    [[nodiscard]] int blockCellCount(const int blockColumn, const int blockRow) const {
+        return std::min(kBlockCells, width - (blockColumn * kBlockCells)) *
+               std::min(kBlockCells, height - (blockRow * kBlockCells));
+    }
+
+    void markBlockChanged(const std::size_t block) {
+        if (blockChanged[block] == 0) {
+            blockChanged[block] = 1;
+            changedBlocks[changedCount++] = static_cast<std::uint32_t>(block);
+        }
+    }
+
+    void markAllBlocksChanged() {
+        blockChanged.assign(blockUnpainted.size(), 1);
+        changedBlocks.resize(blockUnpainted.size());
+        for (std::size_t block = 0; block < changedBlocks.size(); ++block) {
+            changedBlocks[block] = static_cast<std::uint32_t>(block);
+        }
+        changedCount = changedBlocks.size();
+    }
+
+    void fillSpan(const int row, const float startX, const float endX,
+                  const std::uint8_t paletteIndex) {
+        const auto [firstColumn, lastColumn] =
+            span_rasterizer::columnRange(startX, endX, inverseCellSize, width);
+
+        std::uint8_t* cell = cells.data() + indexOf(0, row);
+        const std::size_t firstBlock = blockIndexOf(0, row / kBlockCells);
+        std::uint16_t* blocks = blockUnpainted.data() + firstBlock;
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            if (const std::uint8_t previous = cell[column]; previous != paletteIndex) {
+                --cellCounts[previous];
+                ++cellCounts[paletteIndex];
+                cell[column] = paletteIndex;
+                if (previous == kUnpainted) {
+                    --blocks[column / kBlockCells];
+                    markBlockChanged(firstBlock + static_cast<std::size_t>(column / kBlockCells));
+                } else if (paletteIndex == kUnpainted) {
+                    ++blocks[column / kBlockCells];
+                    markBlockChanged(firstBlock + static_cast<std::size_t>(column / kBlockCells));
+                }
+            }
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_OWNERSHIP_GRID_H
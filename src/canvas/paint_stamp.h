@@ -0,0 +1,15 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_STAMP_H
+#define DIDDLEDOODLEDUEL_PAINT_STAMP_H
+#include <cstdint>
+#include <raylib.h>
+
+// One brush stroke segment for a frame: a circle swept from -> to
+struct PaintStamp {
+    Vector2 from;
+    Vector2 to;
+    float radius;
+    Color color;
+    std::uint8_t paletteIndex; // 0 when the brush doesn't claim ownership
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_STAMP_H
@@ -0,0 +1,12 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_STAMP_QUEUE_H
+#define DIDDLEDOODLEDUEL_PAINT_STAMP_QUEUE_H
+#include "canvas/paint_stamp.h"
+#include <vector>
+
+// Stamps produced by the simulation and not yet drawn into the canvas. Lives in the registry
+// context; PaintGridSystem appends, whoever owns the canvas drains it.
+struct PaintStampQueue {
+    std::vector<PaintStamp> stamps;
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_STAMP_QUEUE_H
@@ -0,0 +1,63 @@
+#ifndef DIDDLEDOODLEDUEL_PIXEL_RUNS_H
+#define DIDDLEDOODLEDUEL_PIXEL_RUNS_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+// Run-length packing for canvas pixels. Paint lands in flat strokes, so a tile of them packs to
+// a few hundred bytes, and an untouched one to six. Each run is its length minus one as a
+// little-endian u16, then the colour's r, g, b and a.
+namespace pixel_runs {
+
+inline constexpr std::size_t kRunBytes = 6;
+inline constexpr std::size_t kMaxRunLength = 65536;
+
+inline std::vector<std::uint8_t> pack(const std::span<const Color> pixels) {
+    std::vector<std::uint8_t> packed;
+    std::size_t index = 0;
+    while (index < pixels.size()) {
+        const Color color = pixels[index];
+        std::size_t length = 1;
+        while (index + length < pixels.size() && length < kMaxRunLength) {
+            const Color next = pixels[index + length];
+            if (next.r != color.r || next.g != color.g || next.b != color.b || next.a != color.a) {
+                break;
+            }
+            ++length;
+        }
+        const auto stored = static_cast<std::uint16_t>(length - 1);
+        packed.insert(packed.end(), {static_cast<std::uint8_t>(stored & 0xFFU),
+                                     static_cast<std::uint8_t>(stored >> 8U), color.r, color.g,
+                                     color.b, color.a});
+        index += length;
+    }
+    return packed;
+}
+
+// False, leaving pixels partly written, unless the runs cover pixels exactly
+inline bool unpack(const std::span<const std::uint8_t> packed, const std::span<Color> pixels) {
+    if (packed.size() % kRunBytes != 0) {
+        return false;
+    }
+    std::size_t index = 0;
+    for (std::size_t offset = 0; offset < packed.size(); offset += kRunBytes) {
+        const std::size_t length =
+            (static_cast<std::size_t>(packed[offset]) |
+             (static_cast<std::size_t>(packed[offset + 1]) << 8U)) + 1;
+        if (length > pixels.size() - index) {
+            return false;
+        }
+        const Color color = {packed[offset + 2], packed[offset + 3], packed[offset + 4],
+                             packed[offset + 5]};
+        std::fill_n(pixels.begin() + static_cast<std::ptrdiff_t>(index), length, color);
+        index += length;
+    }
+    return index == pixels.size();
+}
+
+} // namespace pixel_runs
+
+#endif // DIDDLEDOODLEDUEL_PIXEL_RUNS_H
@@ -0,0 +1,118 @@
+#ifndef DIDDLEDOODLEDUEL_SPAN_RASTERIZER_H
+#define DIDDLEDOODLEDUEL_SPAN_RASTERIZER_H
+#include <algorithm>
+#include <cmath>
+#include <raylib.h>
+#include <utility>
+
+// Row-by-row coverage of circles and capsules on a grid of square cells, shared by the
+// ownership grid and the software renderer so both agree on which cells a stamp covers. A cell
+// is covered when its centre lies inside the shape. visit(row, startX, endX) gets the covered
+// stretch of each row in world units; the caller turns it into columns with columnRange.
+namespace span_rasterizer {
+
+// Rows whose cell centres fall inside [minY, maxY], clamped to [0, rows)
+inline std::pair<int, int> rowRange(const float minY, const float maxY, const float inverseCellSize,
+                                    const int rows) {
+    const int firstRow = std::max(0, static_cast<int>(std::ceil((minY * inverseCellSize) - 0.5F)));
+    const int lastRow =
+        std::min(rows - 1, static_cast<int>(std::floor((maxY * inverseCellSize) - 0.5F)));
+    return {firstRow, lastRow};
+}
+
+// Columns whose cell centres fall inside [startX, endX], clamped to [0, columns)
+inline std::pair<int, int> columnRange(const float startX, const float endX,
+                                       const float inverseCellSize, const int columns) {
+    return rowRange(startX, endX, inverseCellSize, columns);
+}
+
+// Narrows [start, end] to the x where lower <= offset + slope * x <= upper
+inline void clipLinear(const float offset, const float slope, const float lower, const float upper,
+                       float& start, float& end) {
+    if (std::abs(slope) < 1.0e-6F) {
+        if (offset < lower || offset > upper) {
+            start = INFINITY;
+            end = -INFINITY;
+        }
+        return;
+    }
+    float first = (lower - offset) / slope;
+    float second = (upper - offset) / slope;
+    if (first > second) {
+        std::swap(first, second);
+    }
+    start = std::max(start, first);
+    end = std::min(end, second);
+}
+
+template <typename Visit>
+void forEachCircleSpan(const Vector2 center, const float radius, const float cellSize,
+                       const int rows, const Visit& visit) {
+    const auto [firstRow, lastRow] =
+        rowRange(center.y - radius, center.y + radius, 1.0F / cellSize, rows);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const float dy = ((static_cast<float>(row) + 0.5F) * cellSize) - center.y;
+        const float halfWidthSquared = (radius * radius) - (dy * dy);
+        if (halfWidthSquared < 0.0F) {
+            continue;
+        }
+        const float halfWidth = std::sqrt(halfWidthSquared);
+        visit(row, center.x - halfWidth, center.x + halfWidth);
+    }
+}
+
+// Everything within radius of the segment from -> to, i.e. a swept circle
+template <typename Visit>
+void forEachCapsuleSpan(const Vector2 from, const Vector2 to, const float radius,
+                        const float cellSize, const int rows, const Visit& visit) {
+    const float segmentX = to.x - from.x;
+    const float segmentY = to.y - from.y;
+    const float length = std::sqrt((segmentX * segmentX) + (segmentY * segmentY));
+    if (length <= 1.0e-4F) {
+        forEachCircleSpan(from, radius, cellSize, rows, visit);
+        return;
+    }
+
+    const float dirX = segmentX / length;
+    const float dirY = segmentY / length;
+    const auto [firstRow, lastRow] = rowRange(std::min(from.y, to.y) - radius,
+                                              std::max(from.y, to.y) + radius, 1.0F / cellSize,
+                                              rows);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const float y = (static_cast<float>(row) + 0.5F) * cellSize;
+        // The capsule is convex, so its cross-section with the row is the hull of the
+        // end cap spans and the span of the swept band between them
+        float spanStart = INFINITY;
+        float spanEnd = -INFINITY;
+        for (const Vector2 cap : {from, to}) {
+            const float dy = y - cap.y;
+            if (const float halfWidthSquared = (radius * radius) - (dy * dy);
+                halfWidthSquared >= 0.0F) {
+                const float halfWidth = std::sqrt(halfWidthSquared);
+                spanStart = std::min(spanStart, cap.x - halfWidth);
+                spanEnd = std::max(spanEnd, cap.x + halfWidth);
+            }
+        }
+
+        // Band: |cross(p - from, dir)| <= radius and 0 <= dot(p - from, dir) <= length,
+        // each linear in u = x - from.x along the row
+        const float dy = y - from.y;
+        float bandStart = -INFINITY;
+        float bandEnd = INFINITY;
+        clipLinear(-dy * dirX, dirY, -radius, radius, bandStart, bandEnd);
+        clipLinear(dy * dirY, dirX, 0.0F, length, bandStart, bandEnd);
+        if (bandStart <= bandEnd) {
+            spanStart = std::min(spanStart, bandStart + from.x);
+            spanEnd = std::max(spanEnd, bandEnd + from.x);
+        }
+
+        if (spanStart <= spanEnd) {
+            visit(row, spanStart, spanEnd);
+        }
+    }
+}
+
+} // namespace span_rasterizer
+
+#endif // DIDDLEDOODLEDUEL_SPAN_RASTERIZER_H
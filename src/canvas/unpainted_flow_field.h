@@ -0,0 +1,181 @@
+#ifndef DIDDLEDOODLEDUEL_UNPAINTED_FLOW_FIELD_H
+#define DIDDLEDOODLEDUEL_UNPAINTED_FLOW_FIELD_H
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <raylib.h>
+#include <utility>
+#include <vector>
+
+// Distance from every block of the canvas to the nearest target block, one with unclaimed
+// space, as a dynamic brushfire: each block remembers which target is nearest, so a heading
+// towards it is one lookup. When targets appear or are painted over, only the blocks whose
+// nearest target changes are revisited. Those repairs wait in a priority queue that is worked
+// off a bounded amount per call, so a burst of changes is spread over several ticks.
+class UnpaintedFlowField {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::int32_t kNoTarget = -1;
+    static constexpr std::int32_t kUnreachable = std::numeric_limits<std::int32_t>::max();
+
+    UnpaintedFlowField(const int columns, const int rows, const float blockSize)
+        : columns(std::max(1, columns)), rows(std::max(1, rows)), blockSize(blockSize),
+          inverseBlockSize(1.0F / blockSize), targets(cellCount(), 0),
+          nearest(cellCount(), kNoTarget), distances(cellCount(), kUnreachable),
+          raising(cellCount(), 0) {
+    }
+
+    [[nodiscard]] bool isTarget(const int column, const int row) const {
+        return targets[indexOf(column, row)] != 0;
+    }
+
+    void setTarget(const int column, const int row, const bool target) {
+        const std::int32_t cell = indexOf(column, row);
+        if ((targets[cell] != 0) == target) {
+            return;
+        }
+        targets[cell] = target ? 1 : 0;
+        if (target) {
+            nearest[cell] = cell;
+            distances[cell] = 0;
+            raising[cell] = 0;
+        } else {
+            // Blocks that relied on this target get cleared from here outwards
+            nearest[cell] = kNoTarget;
+            distances[cell] = kUnreachable;
+            raising[cell] = 1;
+        }
+        open.emplace(0, cell);
+    }
+
+    // Works off queued repairs until maxUpdates blocks were processed or deadline passed.
+    // True once the field is settled.
+    bool repair(const std::uint32_t maxUpdates,
+                const std::optional<Clock::time_point> deadline = std::nullopt) {
+        // Checking the clock per block would cost more than most blocks do
+        constexpr std::uint32_t kClockInterval = 64;
+        for (std::uint32_t updates = 0; !open.empty() && updates < maxUpdates; ++updates) {
+            if (deadline.has_value() && updates % kClockInterval == kClockInterval - 1 &&
+                Clock::now() >= *deadline) {
+                break;
+            }
+
+            const std::int32_t cell = open.top().second;
+            open.pop();
+            if (raising[cell] != 0) {
+                raise(cell);
+            } else if (nearest[cell] != kNoTarget && targets[nearest[cell]] != 0) {
+                lower(cell);
+            }
+        }
+        return open.empty();
+    }
+
+    [[nodiscard]] bool isSettled() const { return open.empty(); }
+
+    // Offset from (x, y) to the centre of the nearest target block; nullopt when there is none
+    [[nodiscard]] std::optional<Vector2> offsetToTarget(const float x, const float y) const {
+        const int column = std::clamp(static_cast<int>(std::floor(x * inverseBlockSize)), 0,
+                                      columns - 1);
+        const int row =
+            std::clamp(static_cast<int>(std::floor(y * inverseBlockSize)), 0, rows - 1);
+        const std::int32_t target = nearest[indexOf(column, row)];
+        if (target == kNoTarget) {
+            return std::nullopt;
+        }
+        return Vector2{((static_cast<float>(target % columns) + 0.5F) * blockSize) - x,
+                       ((static_cast<float>(target / columns) + 0.5F) * blockSize) - y};
+    }
+
+    // Squared distance to the nearest target, in blocks; kUnreachable without one
+    [[nodiscard]] std::int32_t distanceSquaredAt(const int column, const int row) const {
+        return distances[indexOf(column, row)];
+    }
+
+    [[nodiscard]] int getColumns() const { return columns; }
+    [[nodiscard]] int getRows() const { return rows; }
+    [[nodiscard]] float getBlockSize() const { return blockSize; }
+
+private:
+    using Entry = std::pair<std::int32_t, std::int32_t>; // Distance, block
+
+    int columns;
+    int rows;
+    float blockSize;
+    float inverseBlockSize;
+    std::vector<std::uint8_t> targets;
+    std::vector<std::int32_t> nearest;
+    std::vector<std::int32_t> distances;
+    std::vector<std::uint8_t> raising; // Cleared, still to clear the blocks that relied on it
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+
+    [[nodiscard]] std::size_t cellCount() const {
+        return static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+    }
+
+    [[nodiscard]] std::int32_t indexOf(const int column, const int row) const {
+        return (row * columns) + column;
+    }
+
+    [[nodiscard]] std::int32_t distanceSquared(const std::int32_t from,
+                                               const std::int32_t to) const {
+        const std::int32_t dx = (from % columns) - (to % columns);
+        const std::int32_t dy = (from / columns) - (to / columns);
+        return (dx * dx) + (dy * dy);
+    }
+
+    template <typename Visit>
+    void forEachNeighbour(const std::int32_t cell, const Visit& visit) const {
+        const int column = cell % columns;
+        const int row = cell / columns;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int neighbourColumn = column + dx;
+                const int neighbourRow = row + dy;
+                if ((dx != 0 || dy != 0) && neighbourColumn >= 0 && neighbourColumn < columns &&
+                    neighbourRow >= 0 && neighbourRow < rows) {
+                    visit(indexOf(neighbourColumn, neighbourRow));
+                }
+            }
+        }
+    }
+
+    // Clears neighbours whose nearest target is gone and queues the rest to refill the hole
+    void raise(const std::int32_t cell) {
+        forEachNeighbour(cell, [&](const std::int32_t neighbour) {
+            if (nearest[neighbour] == kNoTarget || raising[neighbour] != 0) {
+                return;
+            }
+            open.emplace(distances[neighbour], neighbour);
+            if (targets[nearest[neighbour]] == 0) {
+                nearest[neighbour] = kNoTarget;
+                distances[neighbour] = kUnreachable;
+                raising[neighbour] = 1;
+            }
+        });
+        raising[cell] = 0;
+    }
+
+    // Offers this block's nearest target to its neighbours
+    void lower(const std::int32_t cell) {
+        const std::int32_t target = nearest[cell];
+        forEachNeighbour(cell, [&](const std::int32_t neighbour) {
+            if (raising[neighbour] != 0) {
+                return;
+            }
+            if (const std::int32_t distance = distanceSquared(target, neighbour);
+                distance < distances[neighbour]) {
+                distances[neighbour] = distance;
+                nearest[neighbour] = target;
+                open.emplace(distance, neighbour);
+            }
+        });
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_UNPAINTED_FLOW_FIELD_H
@@ -0,0 +1,13 @@
+#ifndef DIDDLEDOODLEDUEL_AI_CONTROLLER_H
+#define DIDDLEDOODLEDUEL_AI_CONTROLLER_H
+#include <cstdint>
+
+// Marks a brush as steered by AiSteeringSystem. Each bot carries its own random state, so it
+// steers the same whichever thread updates it.
+struct AiController {
+    std::uint32_t randomState {1}; // xorshift32, never 0
+    std::int8_t wanderTurn {0};    // -1 left, 0 straight, 1 right
+    std::uint16_t wanderTicks {0}; // Until the next wander turn is picked
+};
+
+#endif // DIDDLEDOODLEDUEL_AI_CONTROLLER_H
@@ -0,0 +1,10 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_OWNER_H
+#define DIDDLEDOODLEDUEL_PAINT_OWNER_H
+#include <cstdint>
+
+// Palette index a brush claims canvas cells with; 0 is reserved for unpainted
+struct PaintOwner {
+    std::uint8_t paletteIndex {0};
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_OWNER_H
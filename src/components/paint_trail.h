@@ -0,0 +1,11 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_TRAIL_H
+#define DIDDLEDOODLEDUEL_PAINT_TRAIL_H
+#include <raylib.h>
+
+// Where a brush last stamped the canvas; the next stamp is swept from here
+struct PaintTrail {
+    Vector2 lastPosition {0.0F, 0.0F};
+    bool hasLastPosition {false};
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_TRAIL_H
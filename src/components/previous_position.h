@@ -0,0 +1,10 @@
+#ifndef DIDDLEDOODLEDUEL_PREVIOUS_POSITION_H
+#define DIDDLEDOODLEDUEL_PREVIOUS_POSITION_H
+#include <raylib.h>
+
+// Position at the start of the current simulation tick
+struct PreviousPosition {
+    Vector2 position{0.0F, 0.0F};
+};
+
+#endif // DIDDLEDOODLEDUEL_PREVIOUS_POSITION_H
@@ -0,0 +1,10 @@
+#ifndef DIDDLEDOODLEDUEL_RENDER_POSITION_H
+#define DIDDLEDOODLEDUEL_RENDER_POSITION_H
+#include <raylib.h>
+
+// Where to draw an entity this frame, interpolated between the last two simulation ticks
+struct RenderPosition {
+    Vector2 position{0.0F, 0.0F};
+};
+
+#endif // DIDDLEDOODLEDUEL_RENDER_POSITION_H
@@ -0,0 +1,40 @@
+#ifndef DIDDLEDOODLEDUEL_ARENA_CAMERA_H
+#define DIDDLEDOODLEDUEL_ARENA_CAMERA_H
+#include <algorithm>
+#include <cmath>
+#include <raylib.h>
+
+// The part of the arena the window shows, as a raylib Camera2D: a world point p lands on screen
+// at offset + zoom * rotate(p - target). CameraSystem keeps the one in the registry context
+// following the local players; the default shows the world as it is.
+struct ArenaCamera {
+    Camera2D camera {
+        .offset = {0.0F, 0.0F}, .target = {0.0F, 0.0F}, .rotation = 0.0F, .zoom = 1.0F};
+    float viewWidth {0.0F};  // Screen pixels
+    float viewHeight {0.0F};
+
+    // The world area on screen, or the box around it when the camera is rotated
+    [[nodiscard]] Rectangle getVisibleRect() const {
+        const float zoom = camera.zoom > 0.0F ? camera.zoom : 1.0F;
+        const float cosine = std::cos(-camera.rotation * DEG2RAD);
+        const float sine = std::sin(-camera.rotation * DEG2RAD);
+        float minX = INFINITY;
+        float maxX = -INFINITY;
+        float minY = INFINITY;
+        float maxY = -INFINITY;
+        for (const Vector2 corner : {Vector2{0.0F, 0.0F}, Vector2{viewWidth, 0.0F},
+                                     Vector2{0.0F, viewHeight}, Vector2{viewWidth, viewHeight}}) {
+            const float offsetX = (corner.x - camera.offset.x) / zoom;
+            const float offsetY = (corner.y - camera.offset.y) / zoom;
+            const float x = camera.target.x + (offsetX * cosine) - (offsetY * sine);
+            const float y = camera.target.y + (offsetX * sine) + (offsetY * cosine);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        return Rectangle{minX, minY, maxX - minX, maxY - minY};
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_ARENA_CAMERA_H
@@ -4,7 +4,14 @@
 #include <string>
 
 struct MenuEvent {
-    enum class Type : uint8_t { StartLocalGame, StartOnlineGame, ExitGame, BackToMenu } type;
+    enum class Type : uint8_t {
+        StartLocalGame,
+        StartOnlineGame,
+        ConnectOnlineGame, // Starts the match configured on the online screen
+        StartStressTest,
+        ExitGame,
+        BackToMenu
+    } type;
 };
 
 
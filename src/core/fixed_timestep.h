@@ -0,0 +1,56 @@
+#ifndef DIDDLEDOODLEDUEL_FIXED_TIMESTEP_H
+#define DIDDLEDOODLEDUEL_FIXED_TIMESTEP_H
+#include <algorithm>
+
+// Accumulator for running the simulation at a fixed rate independent of the frame rate. Each
+// frame adds its duration and takes back a whole number of ticks; the remainder carries over
+// and becomes the interpolation factor for rendering.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(const float tickRate, const int maxStepsPerFrame)
+        : stepDuration(1.0F / tickRate), maxStepsPerFrame(maxStepsPerFrame) {
+    }
+
+    // Returns how many ticks to simulate this frame. When the simulation falls more than
+    // maxStepsPerFrame behind, the backlog is dropped instead of chased, so one slow frame
+    // cannot snowball into ever longer frames.
+    [[nodiscard]] int advance(const float frameTime) {
+        accumulator += std::max(frameTime, 0.0F);
+
+        int steps = 0;
+        while (accumulator >= stepDuration && steps < maxStepsPerFrame) {
+            accumulator -= stepDuration;
+            ++steps;
+        }
+
+        if (steps == maxStepsPerFrame) {
+            accumulator = std::min(accumulator, stepDuration);
+        }
+        return steps;
+    }
+
+    void setTickRate(const float tickRate) {
+        const float newStepDuration = 1.0F / tickRate;
+        // Keep the same fraction of a tick pending so interpolation does not jump
+        accumulator *= newStepDuration / stepDuration;
+        stepDuration = newStepDuration;
+    }
+
+    void setMaxStepsPerFrame(const int maxSteps) { maxStepsPerFrame = std::max(1, maxSteps); }
+
+    void reset() { accumulator = 0.0F; }
+
+    [[nodiscard]] float getStepDuration() const { return stepDuration; }
+
+    // How far between the last two ticks the current frame is, in [0, 1]
+    [[nodiscard]] float getAlpha() const {
+        return std::clamp(accumulator / stepDuration, 0.0F, 1.0F);
+    }
+
+private:
+    float stepDuration;
+    int maxStepsPerFrame;
+    float accumulator {0.0F};
+};
+
+#endif // DIDDLEDOODLEDUEL_FIXED_TIMESTEP_H
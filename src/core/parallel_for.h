@@ -0,0 +1,78 @@
+#ifndef DIDDLEDOODLEDUEL_PARALLEL_FOR_H
+#define DIDDLEDOODLEDUEL_PARALLEL_FOR_H
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+// Calls body(begin, end) over [0, count) in grain-sized chunks. The caller and up to one helper
+// task per worker claim chunks from a shared counter, so whoever is free takes the next one and
+// uneven chunks balance out. Runs inline without a pool or when everything fits in one chunk.
+template <typename Body>
+void parallelFor(ThreadPool* pool, const std::size_t count, const std::size_t grain, const Body& body) {
+    const std::size_t chunkSize = std::max<std::size_t>(grain, 1);
+    const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    if (pool == nullptr || pool->getWorkerCount() == 0 || chunks <= 1) {
+        body(std::size_t {0}, count);
+        return;
+    }
+
+    std::atomic<std::size_t> nextChunk {0};
+    std::atomic<std::size_t> finishedHelpers {0};
+    const auto runChunks = [&] {
+        for (std::size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunks;
+             chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            const std::size_t begin = chunk * chunkSize;
+            body(begin, std::min(begin + chunkSize, count));
+        }
+    };
+
+    const std::size_t helpers = std::min(pool->getWorkerCount(), chunks - 1);
+    for (std::size_t helper = 0; helper < helpers; ++helper) {
+        pool->submit([&] {
+            runChunks();
+            finishedHelpers.fetch_add(1, std::memory_order_release);
+        });
+    }
+    runChunks();
+
+    // Helpers still queued would find no chunks left, but they reference this frame, so run
+    // pool work (possibly them) until they have all finished
+    while (finishedHelpers.load(std::memory_order_acquire) < helpers) {
+        if (!pool->tryRunPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Calls func(entity) for every entity in an EnTT view. Chunks index the view's leading storage
+// directly and skip entities the view does not contain, so nothing is copied up front. Only
+// worth it once the storage holds at least threshold entities; below that it loops inline.
+// func must only touch its own entity's components.
+template <typename View, typename Func>
+void parallelForEach(ThreadPool* pool, const View& view, const std::size_t threshold,
+                     const std::size_t grain, const Func& func) {
+    const auto* leading = view.handle();
+    if (leading == nullptr) {
+        return;
+    }
+
+    if (pool == nullptr || leading->size() < threshold) {
+        for (const auto entity : view) {
+            func(entity);
+        }
+        return;
+    }
+
+    const auto* entities = leading->data();
+    parallelFor(pool, leading->size(), grain, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            if (view.contains(entities[index])) {
+                func(entities[index]);
+            }
+        }
+    });
+}
+
+#endif // DIDDLEDOODLEDUEL_PARALLEL_FOR_H
@@ -0,0 +1,120 @@
+#ifndef DIDDLEDOODLEDUEL_PLAYER_FACTORY_H
+#define DIDDLEDOODLEDUEL_PLAYER_FACTORY_H
+#include "canvas/ownership_grid.h"
+#include "components/ai_controller.h"
+#include "components/collision_state.h"
+#include "components/input_action.h"
+#include "components/input_mapping.h"
+#include "components/paint_owner.h"
+#include "components/position.h"
+#include "components/previous_position.h"
+#include "components/render_position.h"
+#include "components/renderable.h"
+#include "components/velocity.h"
+#include "game_config.h"
+#include "systems/entity_lifecycle_system.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <random>
+#include <raylib.h>
+#include <vector>
+
+struct PlayerSpawn {
+    Vector2 startPosition;
+    float initialRotation;
+    KeyboardKey rotateLeftKey;
+    KeyboardKey rotateRightKey;
+    Color brushColor;
+    std::uint8_t paletteIndex;
+};
+
+struct PlayerFactory {
+    static entt::entity createPlayer(entt::registry& registry, const GameConfig& gameConfig,
+                                     const PlayerSpawn& spawn) {
+        const auto player = createBrush(registry, gameConfig, spawn);
+        registry.emplace<InputMapping>(player, InputMapping{.rotateLeftKey = spawn.rotateLeftKey,
+                                                            .rotateRightKey = spawn.rotateRightKey});
+        return player;
+    }
+
+    // A brush steered by AiSteeringSystem; the spawn's keys are ignored. Bots with different
+    // seeds wander differently.
+    static entt::entity createBot(entt::registry& registry, const GameConfig& gameConfig,
+                                  const PlayerSpawn& spawn, const std::uint32_t seed) {
+        const auto bot = createBrush(registry, gameConfig, spawn);
+        registry.emplace<AiController>(bot, AiController{.randomState = seed == 0 ? 1U : seed});
+        return bot;
+    }
+
+    // The four starts of a local match, on the corners of a 1080 x 520 box in the middle of the
+    // arena: 100 units in from the corners of the default one, and all on screen in larger ones
+    static constexpr std::array<PlayerSpawn, 4> localGameSpawns(const float arenaWidth = 1280.0F,
+                                                                const float arenaHeight = 720.0F) {
+        const float left = (arenaWidth * 0.5F) - 540.0F;
+        const float right = (arenaWidth * 0.5F) + 540.0F;
+        const float top = (arenaHeight * 0.5F) - 260.0F;
+        const float bottom = (arenaHeight * 0.5F) + 260.0F;
+        return {{
+            {{left, top}, 0, KEY_A, KEY_D, RED, 1},
+            {{right, top}, 90, KEY_LEFT, KEY_RIGHT, BLUE, 2},
+            {{right, bottom}, 180, KEY_J, KEY_L, GREEN, 3},
+            {{left, bottom}, 270, KEY_F, KEY_H, YELLOW, 4},
+        }};
+    }
+
+    // count starts scattered over the arena with random headings, cycling through every
+    // palette entry. The same seed gives the same spawns.
+    static std::vector<PlayerSpawn> scatteredSpawns(const std::uint32_t count,
+                                                    const float worldWidth, const float worldHeight,
+                                                    const std::uint32_t seed) {
+        constexpr std::array<Color, CanvasOwnershipGrid::kMaxPaletteEntries - 1> colors = {
+            RED,  BLUE,  GREEN, YELLOW, ORANGE, PURPLE, SKYBLUE, LIME,
+            PINK, BROWN, GOLD,  MAROON, VIOLET, BEIGE,  DARKBLUE};
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> x(50.0F, std::max(50.0F, worldWidth - 50.0F));
+        std::uniform_real_distribution<float> y(50.0F, std::max(50.0F, worldHeight - 50.0F));
+        std::uniform_real_distribution<float> rotation(0.0F, 360.0F);
+
+        std::vector<PlayerSpawn> spawns;
+        spawns.reserve(count);
+        for (std::uint32_t index = 0; index < count; ++index) {
+            const std::size_t palette = index % colors.size();
+            spawns.push_back(PlayerSpawn{.startPosition = {x(random), y(random)},
+                                         .initialRotation = rotation(random),
+                                         .rotateLeftKey = KEY_NULL,
+                                         .rotateRightKey = KEY_NULL,
+                                         .brushColor = colors[palette],
+                                         .paletteIndex = static_cast<std::uint8_t>(palette + 1)});
+        }
+        return spawns;
+    }
+
+private:
+    static entt::entity createBrush(entt::registry& registry, const GameConfig& gameConfig,
+                                    const PlayerSpawn& spawn) {
+        const auto player = registry.create();
+        registry.emplace<Position>(player, Position{.position = spawn.startPosition});
+        registry.emplace<PreviousPosition>(player, PreviousPosition{.position = spawn.startPosition});
+        registry.emplace<RenderPosition>(player, RenderPosition{.position = spawn.startPosition});
+
+        registry.emplace<Velocity>(player, Velocity{.velocity = {0, 0},
+                                                    .rotation = spawn.initialRotation,
+                                                    .speed = gameConfig.brushMovementSpeed,
+                                                    .rotationSpeed = 120.0F});
+
+        registry.emplace<Renderable>(
+            player, Renderable{.radius = gameConfig.brushSize, .color = spawn.brushColor});
+        registry.emplace<PaintOwner>(player, PaintOwner{.paletteIndex = spawn.paletteIndex});
+        registry.emplace<InputAction>(player, InputAction{.rotateLeft = false, .rotateRight = false});
+        registry.emplace<CollisionState>(player, CollisionState{.isInCollision = false,
+                                                                .bounceTimer = 0.0F,
+                                                                .bounceVelocity = Vector2{0, 0}});
+
+        EntityLifecycleSystem::tagEntityWithScene(registry, player, SceneType::Game);
+        return player;
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_PLAYER_FACTORY_H
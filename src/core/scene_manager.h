@@ -1,11 +1,9 @@
 #ifndef DIDDLEDOODLEDUEL_SCENE_MANAGER_H
 #define DIDDLEDOODLEDUEL_SCENE_MANAGER_H
 
-#include "scene_state.h"
 #include "scene_type.h"
+#include "system_registry.h"
 #include <entt/entity/registry.hpp>
-#include <string>
-#include <unordered_set>
 
 struct Scene {
     SceneType type;
@@ -13,7 +11,7 @@ struct Scene {
 
 struct SceneConfig {
     SceneType type;
-    std::unordered_set<std::string> activeSystems;
+    SystemMask activeSystems {0};
     bool isTransitioning = false;
     float transitionDuration = 0.5f;
     float currentTransitionTime = 0.0f;
@@ -29,7 +27,7 @@ public:
 
         auto& config = registry.ctx().emplace_or_replace<SceneConfig>();
         config.type = type;
-        config.activeSystems = getSystemsForScene(type);
+        config.activeSystems = kSceneSystemMasks[static_cast<std::size_t>(type)];
         config.isTransitioning = false;
         
         return sceneEntity;
@@ -56,16 +54,10 @@ public:
         createScene(registry, newScene);
     }
 
-    static bool isSystemActive(entt::registry& registry, const std::string& systemName) {
+    template <typename System>
+    static bool isSystemActive(entt::registry& registry) {
         const auto& config = registry.ctx().get<SceneConfig>();
-        return config.activeSystems.contains(systemName);
-    }
-
-private:
-    static std::unordered_set<std::string> getSystemsForScene(const SceneType scene) {
-        const auto& map = SceneState::getSceneSystemMap();
-        const auto it = map.find(scene);
-        return (it != map.end()) ? it->second : std::unordered_set<std::string>{};
+        return (config.activeSystems & systemBit<System>) != 0;
     }
 };
 
@@ -2,9 +2,8 @@
 #define DIDDLEDOODLEDUEL_SCENE_STATE_H
 
 #include "scene_type.h"
-#include <string>
-#include <unordered_set>
-#include <unordered_map>
+#include "system_registry.h"
+#include <cstddef>
 
 struct SceneState {
 
@@ -12,40 +11,10 @@ struct SceneState {
     SceneType previousScene = SceneType::MainMenu;
     bool isTransitioning = false;
     float transitionTime = 0.0F;
-    std::unordered_set<std::string> activeSystems;
-
-    [[nodiscard]] static const std::unordered_map<SceneType, std::unordered_set<std::string>>& getSceneSystemMap() {
-        static const std::unordered_map<SceneType, std::unordered_set<std::string>> map = {
-            {
-                SceneType::MainMenu,
-                {"ImGuiSystem"}
-            },
-            {
-                SceneType::Game,
-                {"PaintSystem",
-                    "PhysicsMovementSystem",
-                    "InputSystem",
-                    "UISystem",
-
-                    "PhysicsCollisionSystem",
-                    "DebugRenderSystem",
-                    "ArrowRenderSystem",
-                    "ImGuiSystem"}
-            },
-            {
-                SceneType::NetworkingDemo, {"ImGuiSystem"}
-            },
-        };
-        return map;
-    }
+    SystemMask activeSystems {0};
 
     void updateActiveSystems() {
-        const auto& systemMap = getSceneSystemMap();
-        if (const auto it = systemMap.find(currentScene); it != systemMap.end()) {
-            activeSystems = it->second;
-        } else {
-            activeSystems.clear();
-        }
+        activeSystems = kSceneSystemMasks[static_cast<std::size_t>(currentScene)];
     }
 };
 
@@ -9,7 +9,8 @@ enum class SceneType {
     GameOver,
     NetworkingDemo,
     Lobby,
-    NetworkedGame
+    NetworkedGame,
+    StressTest
 };
 
 inline const char* to_string(const SceneType type) {
@@ -22,6 +23,7 @@ inline const char* to_string(const SceneType type) {
         case SceneType::NetworkingDemo: return "NetworkingDemo";
         case SceneType::Lobby: return "Lobby";
         case SceneType::NetworkedGame: return "NetworkedGame";
+        case SceneType::StressTest: return "StressTest";
         default: return "unknown";
     }
 }
@@ -0,0 +1,82 @@
+#ifndef DIDDLEDOODLEDUEL_SYSTEM_REGISTRY_H
+#define DIDDLEDOODLEDUEL_SYSTEM_REGISTRY_H
+#include "scene_type.h"
+#include "type_list.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct AiSteeringSystem;
+struct FlowFieldSystem;
+struct InputSystem;
+struct InputRecorderSystem;
+struct InputReplaySystem;
+struct InterpolationSystem;
+struct PhysicsMovementSystem;
+struct PhysicsCollisionSystem;
+struct PaintGridSystem;
+struct PaintSystem;
+struct ArrowRenderSystem;
+struct BrushRenderSystem;
+struct CameraSystem;
+struct UISystem;
+struct DebugRenderSystem;
+class ImGuiSystem;
+
+using SystemMask = std::uint32_t;
+
+// Schedulable systems; a system's id is its position in the list. Adding a system: append it
+// here and to the scenes that run it below.
+using GameSystems = TypeList<InputSystem, InterpolationSystem, PhysicsMovementSystem,
+                             PhysicsCollisionSystem, PaintGridSystem, PaintSystem,
+                             ArrowRenderSystem, UISystem, DebugRenderSystem, ImGuiSystem,
+                             InputRecorderSystem, InputReplaySystem, AiSteeringSystem,
+                             FlowFieldSystem, BrushRenderSystem, CameraSystem>;
+static_assert(GameSystems::size <= sizeof(SystemMask) * 8, "Too many systems for SystemMask");
+
+template <typename System>
+inline constexpr SystemMask systemBit = SystemMask{1} << GameSystems::idOf<System>();
+
+template <typename... Systems>
+inline constexpr SystemMask systemMask = (SystemMask{0} | ... | systemBit<Systems>);
+
+inline constexpr std::size_t kSceneTypeCount = static_cast<std::size_t>(SceneType::StressTest) + 1;
+
+constexpr SystemMask systemsForScene(const SceneType scene) {
+    switch (scene) {
+        case SceneType::MainMenu:
+        case SceneType::NetworkingDemo:
+            return systemMask<ImGuiSystem>;
+        case SceneType::Game:
+            return systemMask<PaintSystem, PaintGridSystem, InterpolationSystem,
+                              PhysicsMovementSystem, InputSystem, UISystem, PhysicsCollisionSystem,
+                              DebugRenderSystem, ArrowRenderSystem, ImGuiSystem,
+                              InputRecorderSystem, InputReplaySystem, AiSteeringSystem,
+                              FlowFieldSystem, BrushRenderSystem, CameraSystem>;
+        // Input comes from the rollback session, so nothing records or replays it
+        case SceneType::NetworkedGame:
+            return systemMask<PaintSystem, PaintGridSystem, InterpolationSystem,
+                              PhysicsMovementSystem, InputSystem, UISystem, PhysicsCollisionSystem,
+                              DebugRenderSystem, ArrowRenderSystem, ImGuiSystem,
+                              BrushRenderSystem, CameraSystem>;
+        // Every brush is a bot
+        case SceneType::StressTest:
+            return systemMask<PaintSystem, PaintGridSystem, InterpolationSystem,
+                              PhysicsMovementSystem, UISystem, PhysicsCollisionSystem,
+                              DebugRenderSystem, ArrowRenderSystem, ImGuiSystem, AiSteeringSystem,
+                              FlowFieldSystem, BrushRenderSystem, CameraSystem>;
+        default:
+            return 0;
+    }
+}
+
+// Active systems per scene, indexed by SceneType
+inline constexpr std::array<SystemMask, kSceneTypeCount> kSceneSystemMasks = [] {
+    std::array<SystemMask, kSceneTypeCount> masks {};
+    for (std::size_t scene = 0; scene < kSceneTypeCount; ++scene) {
+        masks[scene] = systemsForScene(static_cast<SceneType>(scene));
+    }
+    return masks;
+}();
+
+#endif // DIDDLEDOODLEDUEL_SYSTEM_REGISTRY_H
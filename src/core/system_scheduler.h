@@ -0,0 +1,235 @@
+#ifndef DIDDLEDOODLEDUEL_SYSTEM_SCHEDULER_H
+#define DIDDLEDOODLEDUEL_SYSTEM_SCHEDULER_H
+#include "core/system_registry.h"
+#include "core/thread_pool.h"
+#include "core/type_list.h"
+#include "performance/profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <entt/core/type_info.hpp>
+#include <entt/entity/registry.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Runs one phase of systems (a tick, a frame) as a dependency graph. Each system declares
+//
+//     using Reads = TypeList<...>;   // components and context resources it only reads
+//     using Writes = TypeList<...>;  // ... and the ones it modifies
+//     static constexpr bool kMainThreadOnly = true;  // optional, e.g. for raylib calls
+//
+// A system depends on every earlier-added system it conflicts with (one writes what the other
+// touches), so conflicting systems keep the order they were added in and see the same data
+// as a sequential run; only systems with disjoint access overlap. Without a pool everything
+// runs in insertion order on the calling thread.
+class SystemScheduler {
+public:
+    template <typename System>
+    void add(const char* name, std::function<void()> run) {
+        Node node;
+        node.profileId = ScopeProfiler::getInstance().intern(name);
+        node.run = std::move(run);
+        node.activationBit = activationBitOf<System>();
+        node.mainThreadOnly = mainThreadOnly<System>();
+        AccessOf<typename System::Reads>::collect(node.reads);
+        AccessOf<typename System::Writes>::collect(node.writes);
+        // Views must not create storage while other systems run, so create it up front
+        // (an unused pool for context resources is harmless)
+        node.prepareStorage = [](entt::registry& registry) {
+            AccessOf<typename System::Reads>::prepare(registry);
+            AccessOf<typename System::Writes>::prepare(registry);
+        };
+
+        nodes.push_back(std::move(node));
+        plans.clear();
+    }
+
+    // Runs the systems whose bit is set in active; systems outside GameSystems always run
+    void run(entt::registry& registry, const SystemMask active, ThreadPool* pool) {
+        Plan& plan = planFor(registry, active);
+        if (pool == nullptr || pool->getWorkerCount() == 0) {
+            for (const std::size_t node : plan.order) {
+                execute(node);
+            }
+            return;
+        }
+        runParallel(plan, *pool);
+    }
+
+private:
+    struct Node {
+        ProfileScopeId profileId {0};
+        std::function<void()> run;
+        std::function<void(entt::registry&)> prepareStorage;
+        SystemMask activationBit {0};
+        bool mainThreadOnly {false};
+        std::vector<entt::id_type> reads;
+        std::vector<entt::id_type> writes;
+    };
+
+    // The graph for one set of active systems, positions referring into order
+    struct Plan {
+        SystemMask mask {0};
+        std::vector<std::size_t> order;
+        std::vector<std::vector<std::size_t>> successors;
+        std::vector<std::uint32_t> dependencyCount;
+        std::unique_ptr<std::atomic<std::uint32_t>[]> remaining;
+    };
+
+    struct RunState {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::size_t> mainThreadReady;
+        std::size_t completed {0};
+    };
+
+    template <typename List>
+    struct AccessOf;
+
+    template <typename... Types>
+    struct AccessOf<TypeList<Types...>> {
+        static void collect(std::vector<entt::id_type>& ids) {
+            (ids.push_back(entt::type_hash<Types>::value()), ...);
+        }
+
+        static void prepare(entt::registry& registry) {
+            (static_cast<void>(registry.storage<Types>()), ...);
+        }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::unique_ptr<Plan>> plans;
+
+    template <typename System>
+    static constexpr SystemMask activationBitOf() {
+        if constexpr (GameSystems::contains<System>) {
+            return systemBit<System>;
+        } else {
+            return 0;
+        }
+    }
+
+    template <typename System>
+    static constexpr bool mainThreadOnly() {
+        if constexpr (requires { System::kMainThreadOnly; }) {
+            return System::kMainThreadOnly;
+        } else {
+            return false;
+        }
+    }
+
+    static bool overlaps(const std::vector<entt::id_type>& lhs, const std::vector<entt::id_type>& rhs) {
+        return std::ranges::any_of(lhs, [&](const entt::id_type id) {
+            return std::ranges::find(rhs, id) != rhs.end();
+        });
+    }
+
+    static bool conflicts(const Node& earlier, const Node& later) {
+        return overlaps(earlier.writes, later.reads) || overlaps(earlier.writes, later.writes) ||
+               overlaps(earlier.reads, later.writes);
+    }
+
+    Plan& planFor(entt::registry& registry, const SystemMask active) {
+        if (const auto cached = std::ranges::find(plans, active, [](const auto& plan) { return plan->mask; });
+            cached != plans.end()) {
+            return **cached;
+        }
+
+        auto plan = std::make_unique<Plan>();
+        plan->mask = active;
+        for (std::size_t node = 0; node < nodes.size(); ++node) {
+            if (nodes[node].activationBit == 0 || (nodes[node].activationBit & active) != 0) {
+                plan->order.push_back(node);
+                nodes[node].prepareStorage(registry);
+            }
+        }
+
+        const std::size_t count = plan->order.size();
+        plan->successors.resize(count);
+        plan->dependencyCount.assign(count, 0);
+        plan->remaining = std::make_unique<std::atomic<std::uint32_t>[]>(count);
+        for (std::size_t later = 0; later < count; ++later) {
+            for (std::size_t earlier = 0; earlier < later; ++earlier) {
+                if (conflicts(nodes[plan->order[earlier]], nodes[plan->order[later]])) {
+                    plan->successors[earlier].push_back(later);
+                    ++plan->dependencyCount[later];
+                }
+            }
+        }
+
+        plans.push_back(std::move(plan));
+        return *plans.back();
+    }
+
+    void execute(const std::size_t node) const {
+        const ProfileScope scope(nodes[node].profileId);
+        nodes[node].run();
+    }
+
+    void runParallel(Plan& plan, ThreadPool& pool) const {
+        const std::size_t count = plan.order.size();
+        for (std::size_t position = 0; position < count; ++position) {
+            plan.remaining[position].store(plan.dependencyCount[position], std::memory_order_relaxed);
+        }
+
+        RunState state;
+        state.mainThreadReady.reserve(count);
+        for (std::size_t position = 0; position < count; ++position) {
+            if (plan.dependencyCount[position] == 0) {
+                dispatch(plan, state, pool, position);
+            }
+        }
+
+        // Run main-thread systems as they become ready and help the pool in between
+        std::unique_lock lock(state.mutex);
+        while (state.completed < count) {
+            if (!state.mainThreadReady.empty()) {
+                const std::size_t position = state.mainThreadReady.back();
+                state.mainThreadReady.pop_back();
+                lock.unlock();
+                complete(plan, state, pool, position);
+                lock.lock();
+                continue;
+            }
+
+            lock.unlock();
+            const bool helped = pool.tryRunPendingTask();
+            lock.lock();
+            if (!helped) {
+                state.changed.wait(lock, [&] {
+                    return state.completed == count || !state.mainThreadReady.empty();
+                });
+            }
+        }
+    }
+
+    void dispatch(Plan& plan, RunState& state, ThreadPool& pool, const std::size_t position) const {
+        if (nodes[plan.order[position]].mainThreadOnly) {
+            const std::scoped_lock lock(state.mutex);
+            state.mainThreadReady.push_back(position);
+            state.changed.notify_all();
+            return;
+        }
+        pool.submit([this, &plan, &state, &pool, position] { complete(plan, state, pool, position); });
+    }
+
+    void complete(Plan& plan, RunState& state, ThreadPool& pool, const std::size_t position) const {
+        execute(plan.order[position]);
+        for (const std::size_t successor : plan.successors[position]) {
+            if (plan.remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                dispatch(plan, state, pool, successor);
+            }
+        }
+
+        // Notify under the lock: once completed reaches the total the caller may return and
+        // destroy state
+        const std::scoped_lock lock(state.mutex);
+        ++state.completed;
+        state.changed.notify_all();
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_SYSTEM_SCHEDULER_H
@@ -0,0 +1,136 @@
+#ifndef DIDDLEDOODLEDUEL_THREAD_POOL_H
+#define DIDDLEDOODLEDUEL_THREAD_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a deque: it pushes and pops its own work at the
+// back, and when it runs dry it steals from the front of the others'. Tasks submitted from
+// outside the pool are spread round-robin. A thread waiting on pool work can run tasks itself
+// with tryRunPendingTask() instead of blocking.
+class ThreadPool {
+public:
+    explicit ThreadPool(const std::size_t workerCount) {
+        queues.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        workers.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this, i](const std::stop_token& stop) { workerLoop(i, stop); });
+        }
+    }
+
+    ~ThreadPool() {
+        // Stopping wakes sleeping workers; join them before the queues and wake-up go away
+        for (auto& worker : workers) {
+            worker.request_stop();
+        }
+        workers.clear();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers used when the config asks for 0: every hardware thread but the caller's
+    static std::size_t defaultWorkerCount() {
+        const unsigned hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    void submit(std::function<void()> task) {
+        const std::size_t queue = workerIndex.has_value() && owner == this
+                                      ? *workerIndex
+                                      : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        // Counted before it is visible, so takers can never drive the count below zero
+        pendingTasks.fetch_add(1, std::memory_order_release);
+        {
+            const std::scoped_lock lock(queues[queue]->mutex);
+            queues[queue]->tasks.push_back(std::move(task));
+        }
+        {
+            // Pairs with the predicate check in workerLoop so the wake-up cannot be missed
+            const std::scoped_lock lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+    // Runs one queued task on the calling thread, if any
+    bool tryRunPendingTask() {
+        const std::size_t start = workerIndex.has_value() && owner == this ? *workerIndex : 0;
+        if (auto task = takeTask(start)) {
+            (*task)();
+            return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] std::size_t getWorkerCount() const { return workers.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::jthread> workers;
+    std::atomic<std::size_t> pendingTasks {0};
+    std::atomic<std::size_t> nextQueue {0};
+    std::mutex sleepMutex;
+    std::condition_variable_any wake;
+
+    static inline thread_local std::optional<std::size_t> workerIndex;
+    static inline thread_local const ThreadPool* owner = nullptr;
+
+    // Own queue from the back (most recent, still warm in cache), others from the front
+    std::optional<std::function<void()>> takeTask(const std::size_t self) {
+        if (pendingTasks.load(std::memory_order_acquire) == 0) {
+            return std::nullopt;
+        }
+
+        for (std::size_t offset = 0; offset < queues.size(); ++offset) {
+            auto& queue = *queues[(self + offset) % queues.size()];
+            const std::scoped_lock lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            std::function<void()> task;
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void workerLoop(const std::size_t index, const std::stop_token& stop) {
+        workerIndex = index;
+        owner = this;
+
+        while (!stop.stop_requested()) {
+            if (auto task = takeTask(index)) {
+                (*task)();
+                continue;
+            }
+
+            std::unique_lock lock(sleepMutex);
+            wake.wait(lock, stop, [this] { return pendingTasks.load(std::memory_order_acquire) > 0; });
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_THREAD_POOL_H
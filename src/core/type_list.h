@@ -0,0 +1,27 @@
+#ifndef DIDDLEDOODLEDUEL_TYPE_LIST_H
+#define DIDDLEDOODLEDUEL_TYPE_LIST_H
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+// Ordered list of types; a type's id is its position in the list
+template <typename... Types>
+struct TypeList {
+    static constexpr std::size_t size = sizeof...(Types);
+
+    template <typename Type>
+    static constexpr bool contains = (std::is_same_v<Type, Types> || ...);
+
+    template <typename Type>
+    static consteval std::size_t idOf() {
+        constexpr std::array<bool, size> matches = {std::is_same_v<Type, Types>...};
+        for (std::size_t id = 0; id < size; ++id) {
+            if (matches[id]) {
+                return id;
+            }
+        }
+        throw "Type is not in the list";
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_TYPE_LIST_H
@@ -1,67 +1,149 @@
 #include "diddle_doodle_duel.h"
-#include "components/collision_state.h"
-#include "components/input_action.h"
-#include "components/input_mapping.h"
-#include "components/position.h"
-#include "components/renderable.h"
-#include "components/velocity.h"
+#include "canvas/ownership_grid.h"
+#include "canvas/paint_stamp_queue.h"
+#include "components/paint_owner.h"
+#include "core/player_factory.h"
 #include "logging/logger.h"
 #include "systems/debug_render.h"
 #include "performance/profiler.h"
+#include <algorithm>
+#include <array>
 #include <entt/entity/registry.hpp>
+#include <fstream>
+#include <iostream>
+#include <span>
+
+namespace {
+// Frames recorded by an F9 trace capture
+constexpr std::uint32_t kTraceCaptureFrames = 300;
+// Players each peer of an online match drives
+constexpr std::size_t kOnlineLocalPlayers = 2;
+// Stress tests always scatter their bots the same way, so runs compare
+constexpr std::uint32_t kStressTestSeed = 1;
+}
 
 void DiddleDoodleDuel::onMenuEvent(const MenuEvent& evt) {
     switch (evt.type) {
         case MenuEvent::Type::StartLocalGame:
+            stopOnlineGame();
             startLocalGame();
             break;
         case MenuEvent::Type::StartOnlineGame:
             SceneTransitionSystem::requestTransition(registry, SceneType::NetworkingDemo);
             break;
+        case MenuEvent::Type::ConnectOnlineGame:
+            startOnlineGame();
+            break;
+        case MenuEvent::Type::StartStressTest:
+            stopOnlineGame();
+            startStressTest();
+            break;
         case MenuEvent::Type::ExitGame:
             LOG_INFO_MSG("User requested game exit (event)");
             CloseWindow();
             break;
         case MenuEvent::Type::BackToMenu:
+            stopOnlineGame();
             SceneTransitionSystem::requestTransition(registry, SceneType::MainMenu);
             break;
     }
 }
 
-DiddleDoodleDuel::DiddleDoodleDuel(engine::IRenderer& renderer) : Game(renderer) {
-    SetTargetFPS(60);
-
-    gameConfig = GameConfig{.brushSize = 25.0F,
-                            .brushMovementSpeed = 200.0F,
-                            .collisionForceMultiplier = 3.0F,
-                            .bounceDuration = 0.6F,
-                            .controlDuringBounceFactor = 0.2F,
-                            .debugCollisionRadius = 25.0F,
-                            .restitution = 0.6F,
-                            .collisionDamping = 0.8F,
-                            .separationForce = 150.0F};
+DiddleDoodleDuel::DiddleDoodleDuel(engine::IRenderer& renderer, InputLogOptions inputLog,
+                                   const GameConfig& config)
+    : Game(renderer), gameConfig(config),
+      fixedTimestep(gameConfig.simulationTickRate, gameConfig.maxSimulationStepsPerFrame),
+      appliedTargetFps(gameConfig.targetFps), inputRecordPath(std::move(inputLog.recordPath)) {
+    SetTargetFPS(gameConfig.targetFps);
+    // The canvas and ownership grid are sized once, so a replay's arena has to be known now
+    if (inputLog.replay.has_value()) {
+        gameConfig.arenaWidth = inputLog.replay->config.arenaWidth;
+        gameConfig.arenaHeight = inputLog.replay->config.arenaHeight;
+    }
 
     eventBus = std::make_unique<EventBus>();
     SceneTransitionSystem::initializeSceneState(registry);
+    threadPool = std::make_unique<ThreadPool>(
+        gameConfig.workerThreads > 0 ? static_cast<std::size_t>(gameConfig.workerThreads)
+                                     : ThreadPool::defaultWorkerCount());
 
     imguiSystem = std::make_unique<ImGuiSystem>(ImGuiSystem(registry, gameConfig));
-    paintSystem =
-        std::make_unique<PaintSystem>(PaintSystem(this->getRenderer(), gameConfig, registry));
+    paintGridSystem = std::make_unique<PaintGridSystem>(registry, gameConfig, gameConfig.arenaWidth,
+                                                        gameConfig.arenaHeight);
+    paintSystem = std::make_unique<PaintSystem>(this->getRenderer(), registry, gameConfig);
     physicsMovementSystem =
-        std::make_unique<PhysicsMovementSystem>(PhysicsMovementSystem(registry, gameConfig));
+        std::make_unique<PhysicsMovementSystem>(registry, gameConfig, threadPool.get());
+    flowFieldSystem = std::make_unique<FlowFieldSystem>(registry, gameConfig);
+    aiSteeringSystem = std::make_unique<AiSteeringSystem>(registry, gameConfig, threadPool.get());
     inputSystem = std::make_unique<InputSystem>(InputSystem(registry));
+    if (!inputRecordPath.empty()) {
+        inputRecorderSystem = std::make_unique<InputRecorderSystem>(registry);
+    }
+    if (inputLog.replay.has_value()) {
+        inputReplaySystem = std::make_unique<InputReplaySystem>(registry, std::move(*inputLog.replay));
+    }
+    interpolationSystem = std::make_unique<InterpolationSystem>(registry);
+    cameraSystem = std::make_unique<CameraSystem>(
+        registry, gameConfig, static_cast<float>(this->getRenderer().getWindowWidth()),
+        static_cast<float>(this->getRenderer().getWindowHeight()));
     uiSystem = std::make_unique<UISystem>(this->getRenderer());
     physicsCollisionSystem =
-        std::make_unique<PhysicsCollisionSystem>(PhysicsCollisionSystem(registry, gameConfig));
+        std::make_unique<PhysicsCollisionSystem>(registry, gameConfig, threadPool.get());
     debugRenderSystem = std::make_unique<DebugRenderSystem>(registry, gameConfig);
+    brushRenderSystem =
+        std::make_unique<BrushRenderSystem>(registry, this->getRenderer(), gameConfig);
     arrowRenderSystem = std::make_unique<ArrowRenderSystem>(registry, this->getRenderer());
+
+    scheduleSystems();
+}
+
+// Systems are added in the order they ran in sequentially; the schedulers only overlap the ones
+// whose declared component access does not conflict
+void DiddleDoodleDuel::scheduleSystems() {
+    // Bots decide their input first, so the recorder sees it like anyone else's
+    tickScheduler.add<AiSteeringSystem>("AiSteering", [this] { aiSteeringSystem->update(); });
+    // Recorded input stands in for the keyboard, so it has to land before anything reads it
+    if (inputReplaySystem) {
+        tickScheduler.add<InputReplaySystem>("InputReplay", [this] {
+            inputReplaySystem->update(players);
+        });
+    }
+    if (inputRecorderSystem) {
+        tickScheduler.add<InputRecorderSystem>("InputRecorder", [this] {
+            inputRecorderSystem->update(players);
+        });
+    }
+    tickScheduler.add<InterpolationSystem>("StorePreviousPositions", [this] {
+        interpolationSystem->storePreviousPositions();
+    });
+    tickScheduler.add<PhysicsMovementSystem>("PhysicsMovement", [this] {
+        physicsMovementSystem->update(fixedTimestep.getStepDuration());
+    });
+    tickScheduler.add<PhysicsCollisionSystem>("PhysicsCollision", [this] {
+        physicsCollisionSystem->update(fixedTimestep.getStepDuration());
+    });
+    tickScheduler.add<PaintGridSystem>("PaintGridSystem", [this] { paintGridSystem->update(); });
+    // Bots steer by the field as of last tick
+    tickScheduler.add<FlowFieldSystem>("FlowField", [this] { flowFieldSystem->update(); });
+
+    frameScheduler.add<InterpolationSystem>("Interpolation", [this] {
+        interpolationSystem->interpolate(fixedTimestep.getAlpha());
+    });
+    frameScheduler.add<CameraSystem>("Camera", [this] { cameraSystem->update(); });
+    frameScheduler.add<PaintSystem>("PaintSystem", [this] { paintSystem->update(); });
+}
+
+ThreadPool* DiddleDoodleDuel::activeThreadPool() const {
+    return gameConfig.parallelSystems ? threadPool.get() : nullptr;
 }
 
 DiddleDoodleDuel::~DiddleDoodleDuel() {
     LOG_DEBUG_MSG("Cleaning up game resources...");
     
+    saveInputRecording();
+
     // Print final performance report
-    SimpleProfiler::getInstance().printResults();
+    ScopeProfiler::getInstance().printResults();
     
     EntityLifecycleSystem::cleanupAllEntities(registry);
     
@@ -112,49 +194,29 @@ void DiddleDoodleDuel::onUpdate(const float deltaTime) {
     static float timeSinceLastProfile = 0.0f;
     timeSinceLastProfile += deltaTime;
     if (timeSinceLastProfile >= 5.0f) {
-        SimpleProfiler::getInstance().printResults();
-        SimpleProfiler::getInstance().reset();
+        ScopeProfiler::getInstance().printResults();
         timeSinceLastProfile = 0.0f;
     }
 }
 
 void DiddleDoodleDuel::onRender() {
-    SimpleProfiler::getInstance().startTimer("FullFrame");
-    SimpleProfiler::getInstance().startTimer("Rendering");
-    
-    ClearBackground({30, 30, 40, 255});
-    
-    const SceneType currentScene = SceneTransitionSystem::getCurrentScene(registry);
-    
-    executeRenderOnWorldSystems();
-    renderUISystems(currentScene);
-    renderDebugInfo(currentScene);
-    
-    SimpleProfiler::getInstance().endTimer("Rendering");
-    SimpleProfiler::getInstance().endTimer("FullFrame");
-}
+    {
+        PROFILE_SCOPE("Rendering");
+
+        // Run without a window, e.g. through a NullRenderer in tests, there is nothing to clear
+        if (IsWindowReady()) {
+            ClearBackground({30, 30, 40, 255});
+        }
+
+        const SceneType currentScene = SceneTransitionSystem::getCurrentScene(registry);
 
-void DiddleDoodleDuel::createPlayer(const Vector2 startPosition, const float initialRotation,
-                                    const KeyboardKey rotateLeftKey,
-                                    const KeyboardKey rotateRightKey, const Color brushColor) {
-    const auto player = registry.create();
-    registry.emplace<Position>(player, Position{.position = startPosition});
-
-    registry.emplace<Velocity>(player, Velocity{.velocity = {0, 0},
-                                                .rotation = initialRotation,
-                                                .speed = gameConfig.brushMovementSpeed,
-                                                .rotationSpeed = 120.0F});
-
-    registry.emplace<Renderable>(player,
-                                 Renderable{.radius = gameConfig.brushSize, .color = brushColor});
-    registry.emplace<InputAction>(player, InputAction{.rotateLeft = false, .rotateRight = false});
-    registry.emplace<InputMapping>(
-        player, InputMapping{.rotateLeftKey = rotateLeftKey, .rotateRightKey = rotateRightKey});
-    registry.emplace<CollisionState>(player, CollisionState{.isInCollision = false,
-                                                            .bounceTimer = 0.0F,
-                                                            .bounceVelocity = Vector2{0, 0}});
-
-    EntityLifecycleSystem::tagEntityWithScene(registry, player, SceneType::Game);
+        executeRenderOnWorldSystems();
+        renderUISystems(currentScene);
+        renderDebugInfo(currentScene);
+    }
+
+    // Update and render make up one frame
+    ScopeProfiler::getInstance().endFrame();
 }
 
 void DiddleDoodleDuel::startLocalGame() {
@@ -163,10 +225,123 @@ void DiddleDoodleDuel::startLocalGame() {
 
     SceneTransitionSystem::requestTransition(registry, SceneType::Game);
 
-    createPlayer({100, 100}, 0, KEY_A, KEY_D, RED);
-    createPlayer({1180, 100}, 90, KEY_LEFT, KEY_RIGHT, BLUE);
-    createPlayer({1180, 620}, 180, KEY_J, KEY_L, GREEN);
-    createPlayer({100, 620}, 270, KEY_F, KEY_H, YELLOW);
+    // A replayed match runs with the tuning and spawns it was recorded with
+    const auto localSpawns =
+        PlayerFactory::localGameSpawns(gameConfig.arenaWidth, gameConfig.arenaHeight);
+    std::span<const PlayerSpawn> spawns = localSpawns;
+    if (inputReplaySystem) {
+        gameConfig = inputReplaySystem->getRecording().config;
+        spawns = inputReplaySystem->getRecording().spawns;
+        inputReplaySystem->restart();
+    }
+    fixedTimestep.reset();
+
+    // Nothing from the last match carries over: not its cells, nor stamps it left queued
+    registry.ctx().get<CanvasOwnershipGrid>().clear();
+    registry.ctx().get<PaintStampQueue>().stamps.clear();
+
+    // Seats past the human players are filled with bots; a replay plays every seat back
+    players.clear();
+    for (std::size_t seat = 0; seat < spawns.size(); ++seat) {
+        const bool isBot =
+            !inputReplaySystem && seat >= static_cast<std::size_t>(gameConfig.localHumanPlayers);
+        players.push_back(
+            isBot ? PlayerFactory::createBot(registry, gameConfig, spawns[seat],
+                                             static_cast<std::uint32_t>(seat) + 1)
+                  : PlayerFactory::createPlayer(registry, gameConfig, spawns[seat]));
+    }
+
+    if (inputRecorderSystem && !inputRecorderSystem->start(gameConfig, spawns)) {
+        std::cerr << "Too many players to record input\n";
+    }
+}
+
+void DiddleDoodleDuel::startOnlineGame() {
+    stopOnlineGame();
+    // Peers don't exchange arenas and the canvas can't be resized here, so online matches only
+    // run on the default arena, which is then the same on both sides
+    constexpr GameConfig kDefaultConfig {};
+    if (gameConfig.arenaWidth != kDefaultConfig.arenaWidth ||
+        gameConfig.arenaHeight != kDefaultConfig.arenaHeight) {
+        onlineSetup.error = "Online matches need the default arena, restart without --arena";
+        return;
+    }
+    UdpTransportOptions options;
+    options.port = static_cast<std::uint16_t>(onlineSetup.port);
+    auto opened = UdpTransport::open(options);
+    if (!opened) {
+        onlineSetup.error = opened.error();
+        return;
+    }
+    onlineSetup.error.clear();
+    transport = std::move(*opened);
+    transport->addPeer(static_cast<std::uint16_t>(onlineSetup.peerPort));
+
+    EntityLifecycleSystem::cleanupSceneEntities(registry,
+                                                SceneTransitionSystem::getCurrentScene(registry));
+    SceneTransitionSystem::requestTransition(registry, SceneType::NetworkedGame);
+    fixedTimestep.reset();
+
+    // Both peers have to start from the same state: default tuning and arena, a clean canvas
+    // and the same players in the same order
+    gameConfig = GameConfig::localMatch();
+    registry.ctx().get<CanvasOwnershipGrid>().clear();
+    registry.ctx().get<PaintStampQueue>().stamps.clear();
+    players.clear();
+    for (const auto& spawn :
+         PlayerFactory::localGameSpawns(gameConfig.arenaWidth, gameConfig.arenaHeight)) {
+        const auto player = PlayerFactory::createPlayer(registry, gameConfig, spawn);
+        EntityLifecycleSystem::tagEntityWithScene(registry, player, SceneType::NetworkedGame);
+        players.push_back(player);
+    }
+
+    const auto first = static_cast<std::size_t>(onlineSetup.firstLocalPlayer);
+    const std::array<std::size_t, kOnlineLocalPlayers> localPlayers = {first, first + 1};
+    rollbackSession = std::make_unique<RollbackSession>(
+        registry, players, localPlayers, *transport, [this] {
+            executeFixedUpdateOnActiveSystems(
+                kSceneSystemMasks[static_cast<std::size_t>(SceneType::NetworkedGame)]);
+        });
+}
+
+void DiddleDoodleDuel::startStressTest() {
+    EntityLifecycleSystem::cleanupSceneEntities(registry,
+                                                SceneTransitionSystem::getCurrentScene(registry));
+    SceneTransitionSystem::requestTransition(registry, SceneType::StressTest);
+    fixedTimestep.reset();
+
+    registry.ctx().get<CanvasOwnershipGrid>().clear();
+    registry.ctx().get<PaintStampQueue>().stamps.clear();
+    players.clear();
+    const auto spawns = PlayerFactory::scatteredSpawns(
+        static_cast<std::uint32_t>(std::max(gameConfig.stressBotCount, 0)), gameConfig.arenaWidth,
+        gameConfig.arenaHeight, kStressTestSeed);
+    for (std::size_t index = 0; index < spawns.size(); ++index) {
+        const auto bot = PlayerFactory::createBot(registry, gameConfig, spawns[index],
+                                                  static_cast<std::uint32_t>(index) + 1);
+        EntityLifecycleSystem::tagEntityWithScene(registry, bot, SceneType::StressTest);
+    }
+}
+
+void DiddleDoodleDuel::stopOnlineGame() {
+    if (!transport) {
+        return;
+    }
+    rollbackSession.reset();
+    transport.reset();
+    EntityLifecycleSystem::cleanupSceneEntities(registry, SceneType::NetworkedGame);
+    players.clear();
+}
+
+void DiddleDoodleDuel::saveInputRecording() const {
+    if (!inputRecorderSystem || inputRecorderSystem->getRecording().runs.empty()) {
+        return;
+    }
+
+    std::ofstream file(inputRecordPath, std::ios::binary);
+    if (!file || !writeInputRecording(file, inputRecorderSystem->getRecording())) {
+        std::cerr << "Could not write input recording to " << inputRecordPath << "\n";
+    }
 }
 
 void DiddleDoodleDuel::renderMainMenuUI() const {
@@ -186,7 +361,7 @@ void DiddleDoodleDuel::renderMainMenuUI() const {
     ImGui::SetNextWindowPos(ImVec2(viewport->Pos.x + viewport->Size.x * 0.5f,
                                    viewport->Pos.y + viewport->Size.y * 0.5f),
                             ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-    ImGui::SetNextWindowSize(ImVec2(420, 340), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(420, 390), ImGuiCond_FirstUseEver);
 
     ImGui::Begin("Diddle Doodle Duel", nullptr,
                  ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize);
@@ -236,7 +411,17 @@ void DiddleDoodleDuel::renderMainMenuUI() const {
             eventBus->dispatcher.trigger<MenuEvent>(MenuEvent{MenuEvent::Type::StartOnlineGame});
     }
     if (ImGui::IsItemHovered()) {
-        ImGui::SetTooltip("Online multiplayer (WIP)");
+        ImGui::SetTooltip("Play against a peer over UDP");
+    }
+
+    ImGui::Spacing();
+    ImGui::SetCursorPosX(buttonX);
+    if (ImGui::Button("Stress Test", buttonSize)) {
+        if (eventBus)
+            eventBus->dispatcher.trigger<MenuEvent>(MenuEvent{MenuEvent::Type::StartStressTest});
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Fill the arena with AI brushes");
     }
 
     ImGui::Spacing();
@@ -252,12 +437,12 @@ void DiddleDoodleDuel::renderMainMenuUI() const {
     ImGui::End();
 }
 
-void DiddleDoodleDuel::renderOnlineUI() const {
+void DiddleDoodleDuel::renderOnlineUI() {
     const ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::SetNextWindowPos(ImVec2(viewport->Pos.x + viewport->Size.x * 0.5f,
                                    viewport->Pos.y + viewport->Size.y * 0.5f),
                             ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-    ImGui::SetNextWindowSize(ImVec2(350, 200), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(350, 260), ImGuiCond_FirstUseEver);
 
     ImGui::Begin("Online Game", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize);
 
@@ -265,17 +450,30 @@ void DiddleDoodleDuel::renderOnlineUI() const {
     ImGui::Separator();
     ImGui::Spacing();
 
-    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Work in Progress");
+    ImGui::TextWrapped("Plays against a second copy of the game on this machine. Start it with "
+                       "the ports swapped and the other players.");
     ImGui::Spacing();
-    ImGui::Text("Online multiplayer functionality");
-    ImGui::Text("is currently under development.");
-    ImGui::Spacing();
-    ImGui::Text("Stay tuned for updates!");
+    ImGui::InputInt("Port", &onlineSetup.port);
+    ImGui::InputInt("Peer port", &onlineSetup.peerPort);
+    onlineSetup.port = std::clamp(onlineSetup.port, 1, 65535);
+    onlineSetup.peerPort = std::clamp(onlineSetup.peerPort, 1, 65535);
+    ImGui::RadioButton("Players 1 and 2", &onlineSetup.firstLocalPlayer, 0);
+    ImGui::SameLine();
+    ImGui::RadioButton("Players 3 and 4", &onlineSetup.firstLocalPlayer, 2);
+
+    if (!onlineSetup.error.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", onlineSetup.error.c_str());
+    }
 
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Spacing();
 
+    if (ImGui::Button("Start", ImVec2(200, 30))) {
+        if (eventBus) {
+            eventBus->dispatcher.trigger<MenuEvent>(MenuEvent{MenuEvent::Type::ConnectOnlineGame});
+        }
+    }
     if (ImGui::Button("Back to Main Menu", ImVec2(200, 30))) {
         if (eventBus) {
             eventBus->dispatcher.trigger<MenuEvent>(MenuEvent{MenuEvent::Type::BackToMenu});
@@ -285,46 +483,111 @@ void DiddleDoodleDuel::renderOnlineUI() const {
     ImGui::End();
 }
 
-void DiddleDoodleDuel::executeUpdateOnActiveSystems(const float deltaTime) const {
-    SimpleProfiler::getInstance().startTimer("SystemUpdate");
-    
+void DiddleDoodleDuel::renderNetworkStats() const {
+    if (!rollbackSession) {
+        return;
+    }
 
-    if ((SystemsActivationSystem::shouldSystemRun(registry, "InputSystem"))) {
-        SimpleProfiler::getInstance().startTimer("InputSystem");
+    ImGui::Begin("Network");
+    const auto& [rollbacks, resimulatedTicks, stalls] = rollbackSession->getStats();
+    ImGui::Text("Tick %u (confirmed %u)", rollbackSession->getTick(),
+                rollbackSession->getConfirmedTick());
+    ImGui::Text("Rollbacks: %u, re-simulated ticks: %u", rollbacks, resimulatedTicks);
+    ImGui::Text("Stalls: %u", stalls);
+
+    const double seconds = std::max(
+        1.0, static_cast<double>(rollbackSession->getTick()) / gameConfig.simulationTickRate);
+    for (std::size_t peer = 0; peer < transport->getPeerCount(); ++peer) {
+        const auto& stats = transport->getPeerStats(peer);
+        ImGui::Separator();
+        ImGui::Text("RTT %.1f ms, jitter %.1f ms", stats.rttSeconds * 1000.0,
+                    stats.jitterSeconds * 1000.0);
+        ImGui::Text("Lost %llu of %llu datagrams",
+                    static_cast<unsigned long long>(stats.datagramsLost),
+                    static_cast<unsigned long long>(stats.datagramsSent));
+        ImGui::Text("Sent %.0f B/s, received %.0f B/s",
+                    static_cast<double>(stats.bytesSent) / seconds,
+                    static_cast<double>(stats.bytesReceived) / seconds);
+    }
+    ImGui::End();
+}
+
+void DiddleDoodleDuel::executeUpdateOnActiveSystems(const float deltaTime) {
+    PROFILE_SCOPE("SystemUpdate");
+    const SystemMask active = SystemsActivationSystem::activeSystems(registry);
+
+    if (!inputReplaySystem && SystemsActivationSystem::isActive<InputSystem>(active)) {
+        PROFILE_SCOPE("InputSystem");
         inputSystem->update();
-        SimpleProfiler::getInstance().endTimer("InputSystem");
     }
 
-    if ((SystemsActivationSystem::shouldSystemRun(registry, "PhysicsMovementSystem"))) {
-        SimpleProfiler::getInstance().startTimer("PhysicsMovement");
-        physicsMovementSystem->update(deltaTime);
-        SimpleProfiler::getInstance().endTimer("PhysicsMovement");
+    // The simulation only ever sees the fixed step, so its results do not depend on frame rate
+    applyFramePacingSettings();
+    const int steps = fixedTimestep.advance(deltaTime);
+    if (rollbackSession &&
+        SceneTransitionSystem::getCurrentScene(registry) == SceneType::NetworkedGame) {
+        // The session simulates the ticks, with the keyboard's input for the local players
+        std::array<InputAction, kOnlineLocalPlayers> localInputs {};
+        for (std::size_t index = 0; index < localInputs.size(); ++index) {
+            const auto player = static_cast<std::size_t>(onlineSetup.firstLocalPlayer) + index;
+            localInputs[index] = registry.get<const InputAction>(players[player]);
+        }
+        for (int step = 0; step < steps; ++step) {
+            // Too far ahead of the peer: wait for its input
+            if (!rollbackSession->advance(localInputs)) {
+                break;
+            }
+        }
+        transport->update(UdpTransport::Clock::now());
+    } else {
+        for (int step = 0; step < steps; ++step) {
+            executeFixedUpdateOnActiveSystems(active);
+        }
     }
 
-    if ((SystemsActivationSystem::shouldSystemRun(registry, "PhysicsCollisionSystem"))) {
-        SimpleProfiler::getInstance().startTimer("PhysicsCollision");
-        physicsCollisionSystem->update(deltaTime);
-        SimpleProfiler::getInstance().endTimer("PhysicsCollision");
+    frameScheduler.run(registry, active, activeThreadPool());
+}
+
+void DiddleDoodleDuel::executeFixedUpdateOnActiveSystems(const SystemMask active) {
+    PROFILE_SCOPE("SimulationTick");
+    tickScheduler.run(registry, active, activeThreadPool());
+}
+
+// Picks up tick rate and frame cap changes made from the ImGui controls
+void DiddleDoodleDuel::applyFramePacingSettings() {
+    if (1.0F / gameConfig.simulationTickRate != fixedTimestep.getStepDuration()) {
+        fixedTimestep.setTickRate(gameConfig.simulationTickRate);
     }
+    fixedTimestep.setMaxStepsPerFrame(gameConfig.maxSimulationStepsPerFrame);
 
-    if ((SystemsActivationSystem::shouldSystemRun(registry, "PaintSystem"))) {
-        SimpleProfiler::getInstance().startTimer("PaintSystem");
-        paintSystem->update();
-        SimpleProfiler::getInstance().endTimer("PaintSystem");
+    if (appliedTargetFps != gameConfig.targetFps) {
+        SetTargetFPS(gameConfig.targetFps);
+        appliedTargetFps = gameConfig.targetFps;
     }
-    
-    SimpleProfiler::getInstance().endTimer("SystemUpdate");
 }
 
 void DiddleDoodleDuel::executeRenderOnWorldSystems() const {
-
-    if (SystemsActivationSystem::shouldSystemRun(registry, "PaintSystem")) {
+    const SystemMask active = SystemsActivationSystem::activeSystems(registry);
+    if (SystemsActivationSystem::isActive<PaintSystem>(active)) {
         paintSystem->render();
     }
 
-    if (SystemsActivationSystem::shouldSystemRun(registry, "ArrowRenderSystem")) {
+    // The canvas applies the camera itself; everything else in the world is drawn through it.
+    // Without a window rlgl has no batch to apply a camera to, so the commands go out unmoved.
+    const bool cameraPass = IsWindowReady();
+    if (cameraPass) {
+        BeginMode2D(registry.ctx().get<ArenaCamera>().camera);
+    }
+    if (SystemsActivationSystem::isActive<BrushRenderSystem>(active)) {
+        brushRenderSystem->render();
+    }
+
+    if (SystemsActivationSystem::isActive<ArrowRenderSystem>(active)) {
         arrowRenderSystem->render();
     }
+    if (cameraPass) {
+        EndMode2D();
+    }
 }
 
 void DiddleDoodleDuel::handleInputEvents() const {
@@ -341,13 +604,18 @@ void DiddleDoodleDuel::handleInputEvents() const {
     if (IsKeyPressed(KEY_O)) {
         eventBus->dispatcher.trigger<MenuEvent>(MenuEvent{MenuEvent::Type::StartOnlineGame});
     }
+    if (IsKeyPressed(KEY_F9)) {
+        ScopeProfiler::getInstance().requestCapture(kTraceCaptureFrames, "trace.json");
+    }
 }
 
-void DiddleDoodleDuel::renderUISystems(const SceneType currentScene) const {
+void DiddleDoodleDuel::renderUISystems(const SceneType currentScene) {
+    const SystemMask active = SystemsActivationSystem::activeSystems(registry);
 
-    uiSystem->render(title);
+    uiSystem->render(title, GetFPS());
 
-    if (SystemsActivationSystem::shouldSystemRun(registry, "ImGuiSystem")) {
+    // Without a window ImGui never gets a context, and the scene panels have nothing to draw on
+    if (SystemsActivationSystem::isActive<ImGuiSystem>(active) && imguiSystem->isInitialized()) {
         imguiSystem->beginFrame();
 
         switch (currentScene) {
@@ -358,6 +626,14 @@ void DiddleDoodleDuel::renderUISystems(const SceneType currentScene) const {
                 imguiSystem->renderGameUI(title, GetFPS());
                 imguiSystem->renderEcsDebug();
                 break;
+            case SceneType::NetworkedGame:
+                imguiSystem->renderGameUI(title, GetFPS());
+                renderNetworkStats();
+                break;
+            // Too many brushes for the ECS table
+            case SceneType::StressTest:
+                imguiSystem->renderGameUI(title, GetFPS());
+                break;
             case SceneType::NetworkingDemo:
                 renderOnlineUI();
                 break;
@@ -370,10 +646,14 @@ void DiddleDoodleDuel::renderUISystems(const SceneType currentScene) const {
 }
 
 void DiddleDoodleDuel::renderDebugInfo(const SceneType currentScene) const {
+    const SystemMask active = SystemsActivationSystem::activeSystems(registry);
 
-    if (imguiSystem->isDebugWindowVisible() &&
-        SystemsActivationSystem::shouldSystemRun(registry, "DebugRenderSystem")) {
+    // The debug shapes are drawn with raylib directly, which needs a window
+    if (IsWindowReady() && imguiSystem->isDebugWindowVisible() &&
+        SystemsActivationSystem::isActive<DebugRenderSystem>(active)) {
+        BeginMode2D(registry.ctx().get<ArenaCamera>().camera);
         debugRenderSystem->render();
+        EndMode2D();
     }
 
     const std::string sceneText = "Current Scene: " + std::string(to_string(currentScene));
@@ -381,7 +661,6 @@ void DiddleDoodleDuel::renderDebugInfo(const SceneType currentScene) const {
 
     const std::string systemText =
         "ImGui System: " +
-        std::string(SystemsActivationSystem::shouldSystemRun(registry, "ImGuiSystem") ? "Active"
-                                                                                      : "Inactive");
+        std::string(SystemsActivationSystem::isActive<ImGuiSystem>(active) ? "Active" : "Inactive");
     DrawText(systemText.c_str(), 10, 35, 20, WHITE);
 }
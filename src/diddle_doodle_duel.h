@@ -2,27 +2,60 @@
 #define DIDDLEDOODLEDUEL_DIDDLEDOODLEDUEL_H
 #include "core/event_bus.h"
 #include "core/event_definitions.h"
+#include "core/fixed_timestep.h"
+#include "core/system_scheduler.h"
+#include "core/thread_pool.h"
 #include "game/game.h"
 #include "game_config.h"
+#include "netcode/rollback_session.h"
+#include "netcode/udp_transport.h"
+#include "replay/input_recording.h"
+#include "systems/ai_steering.h"
 #include "systems/arrow_render.h"
+#include "systems/brush_render.h"
+#include "systems/camera.h"
 #include "systems/collision.h"
 #include "systems/debug_render.h"
 #include "systems/entity_lifecycle_system.h"
+#include "systems/flow_field.h"
 #include "systems/imgui_system.h"
 #include "systems/input.h"
+#include "systems/input_recorder.h"
+#include "systems/input_replay.h"
+#include "systems/interpolation.h"
 #include "systems/paint.h"
+#include "systems/paint_grid.h"
 #include "systems/physics_collision.h"
 #include "systems/physics_movement.h"
 #include "systems/scene_transition_system.h"
 #include "systems/system_activation_system.h"
 #include "systems/ui.h"
 #include <entt/entity/registry.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Where local match input is recorded to or replayed from
+struct InputLogOptions {
+    std::string recordPath;               // The last local match is written here on exit
+    std::optional<InputRecording> replay; // Replaces the keyboard in local matches
+};
+
+// What the online screen connects to; both peers run on this machine
+struct OnlineMatchSetup {
+    int port {7777};
+    int peerPort {7778};
+    int firstLocalPlayer {0}; // This peer drives this player and the one after it
+    std::string error;
+};
 
 class DiddleDoodleDuel : public engine::Game {
     void onMenuEvent(const MenuEvent& evt);
 
 public:
-    explicit DiddleDoodleDuel(engine::IRenderer& renderer);
+    // config is the tuning local matches start with; its arena is fixed from here on
+    explicit DiddleDoodleDuel(engine::IRenderer& renderer, InputLogOptions inputLog = {},
+                              const GameConfig& config = GameConfig::localMatch());
     ~DiddleDoodleDuel() override;
     void onInitialize() override;
     void onUpdate(float deltaTime) override;
@@ -32,33 +65,57 @@ private:
     entt::registry registry;
     std::string title;
     GameConfig gameConfig;
+    FixedTimestep fixedTimestep;
+    int appliedTargetFps;
+    std::string inputRecordPath;
+    std::vector<entt::entity> players;
+
+    // Simulation systems run once per tick, the rest once per frame
+    std::unique_ptr<ThreadPool> threadPool;
+    SystemScheduler tickScheduler;
+    SystemScheduler frameScheduler;
 
     std::unique_ptr<EventBus> eventBus;
+    std::unique_ptr<PaintGridSystem> paintGridSystem;
     std::unique_ptr<PaintSystem> paintSystem;
     std::unique_ptr<PhysicsMovementSystem> physicsMovementSystem;
+    std::unique_ptr<FlowFieldSystem> flowFieldSystem;
+    std::unique_ptr<AiSteeringSystem> aiSteeringSystem;
     std::unique_ptr<InputSystem> inputSystem;
+    std::unique_ptr<InputRecorderSystem> inputRecorderSystem;
+    std::unique_ptr<InputReplaySystem> inputReplaySystem;
+    std::unique_ptr<InterpolationSystem> interpolationSystem;
+    std::unique_ptr<CameraSystem> cameraSystem;
     std::unique_ptr<UISystem> uiSystem;
     std::unique_ptr<PhysicsCollisionSystem> physicsCollisionSystem;
     std::unique_ptr<DebugRenderSystem> debugRenderSystem;
+    std::unique_ptr<BrushRenderSystem> brushRenderSystem;
     std::unique_ptr<ArrowRenderSystem> arrowRenderSystem;
     std::unique_ptr<ImGuiSystem> imguiSystem;
 
-    void createPlayer(
-        Vector2 startPosition,
-        float initialRotation,
-        KeyboardKey rotateLeftKey,
-        KeyboardKey rotateRightKey,
-        Color brushColor);
+    // Set while a networked match runs; the session simulates its ticks instead of the timestep
+    OnlineMatchSetup onlineSetup;
+    std::unique_ptr<UdpTransport> transport;
+    std::unique_ptr<RollbackSession> rollbackSession;
 
     void startLocalGame();
+    void startOnlineGame();
+    void startStressTest();
+    void stopOnlineGame();
+    void saveInputRecording() const;
     void renderMainMenuUI() const;
-    void renderOnlineUI() const;
+    void renderOnlineUI();
+    void renderNetworkStats() const;
 
-    void executeUpdateOnActiveSystems(float deltaTime) const;
+    void executeUpdateOnActiveSystems(float deltaTime);
+    void executeFixedUpdateOnActiveSystems(SystemMask active);
+    void scheduleSystems();
+    [[nodiscard]] ThreadPool* activeThreadPool() const;
+    void applyFramePacingSettings();
     void executeRenderOnWorldSystems() const;
 
     void handleInputEvents() const;
-    void renderUISystems(SceneType currentScene) const;
+    void renderUISystems(SceneType currentScene);
     void renderDebugInfo(SceneType currentScene) const;
 };
 
@@ -1,5 +1,6 @@
 #ifndef DIDDLEDOODLEDUEL_GAME_CONFIG_H
 #define DIDDLEDOODLEDUEL_GAME_CONFIG_H
+#include "physics/narrowphase_backend.h"
 
 struct GameConfig {
     float brushSize {25.0F};
@@ -8,11 +9,49 @@ struct GameConfig {
     float bounceDuration {0.6F};
     float controlDuringBounceFactor {0.3F};
     float debugCollisionRadius {25.0F};
-    
+    float ownershipCellSize {4.0F};        // World units per paint ownership cell
+
+    // Arena, fixed once the match's canvas exists
+    float arenaWidth {1280.0F};            // World units; brushes are kept inside
+    float arenaHeight {720.0F};
+    int canvasResidentTiles {64};          // Tiled canvas tiles kept live before old ones pack
+
     // Collision physics
     float restitution {0.8F};              // Bounce factor (0-1)
     float collisionDamping {0.7F};         // Velocity reduction on collision
     float separationForce {100.0F};        // Force to separate overlapping objects
+    bool useSpatialHash {true};            // Grid broadphase instead of testing every pair
+    NarrowphaseBackend narrowphaseBackend {NarrowphaseBackend::Simd}; // Batched SIMD contact tests
+
+    // Frame pacing
+    float simulationTickRate {60.0F};      // Fixed simulation ticks per second
+    int maxSimulationStepsPerFrame {5};    // Ticks dropped beyond this to avoid a spiral of death
+    int targetFps {0};                     // Render frame cap, 0 for uncapped
+
+    // Threading
+    bool parallelSystems {true};           // Run independent systems on the worker pool
+    int workerThreads {0};                 // Pool size, 0 for one per spare hardware thread
+    int parallelEntityThreshold {512};     // Per-entity loops go parallel from this many entities
+    int parallelGrainSize {128};           // Entities per parallel chunk
+
+    // Bots
+    int localHumanPlayers {4};             // Local match seats past this are played by bots
+    int stressBotCount {5000};             // Bots spawned by the stress test scene
+    int flowFieldUpdatesPerTick {2048};    // Flow field blocks repaired per tick
+    float flowFieldBudgetMicros {0.0F};    // Wall-clock cap on that, 0 keeps bots repeatable
+
+    // Tuning used by local matches, shared by the game and the headless runner
+    static GameConfig localMatch() {
+        return GameConfig{.brushSize = 25.0F,
+                          .brushMovementSpeed = 200.0F,
+                          .collisionForceMultiplier = 3.0F,
+                          .bounceDuration = 0.6F,
+                          .controlDuringBounceFactor = 0.2F,
+                          .debugCollisionRadius = 25.0F,
+                          .restitution = 0.6F,
+                          .collisionDamping = 0.8F,
+                          .separationForce = 150.0F};
+    }
 };
 
 #endif // DIDDLEDOODLEDUEL_GAME_CONFIG_H
@@ -0,0 +1,104 @@
+#include "headless/frame_exporter.h"
+#include "performance/profiler.h"
+#include "rendering/software_canvas_tile_store.h"
+#include "rendering/software_paint_canvas.h"
+#include "rendering/tiled_paint_canvas.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+constexpr int kGeneratedTextureSize = 64;
+
+Texture2D loadOr(SoftwareRenderer& renderer, const char* path, SoftwareImage fallback) {
+    const Texture2D loaded = renderer.loadTexture(path);
+    return loaded.id != 0 ? loaded : renderer.addTexture(std::move(fallback));
+}
+
+SoftwareImage disc(const float radius, const Color color) {
+    SoftwareImage image(kGeneratedTextureSize, kGeneratedTextureSize);
+    constexpr float kCenter = kGeneratedTextureSize * 0.5F;
+    image.fillCircle({kCenter, kCenter}, radius, color);
+    return image;
+}
+
+// Points up, like arrowFacingUp.png
+SoftwareImage arrow() {
+    SoftwareImage image(kGeneratedTextureSize, kGeneratedTextureSize);
+    constexpr float kSize = kGeneratedTextureSize;
+    for (int row = 0; row < kGeneratedTextureSize; ++row) {
+        const float halfWidth = (static_cast<float>(row) + 0.5F) * 0.4F;
+        image.fillCapsule({(kSize * 0.5F) - halfWidth, static_cast<float>(row) + 0.5F},
+                          {(kSize * 0.5F) + halfWidth, static_cast<float>(row) + 0.5F}, 0.5F,
+                          WHITE);
+    }
+    return image;
+}
+
+} // namespace
+
+FrameExporter::FrameExporter(entt::registry& registry, const GameConfig& config, const int width,
+                             const int height, std::filesystem::path directory,
+                             const std::optional<WatercolorSettings> watercolor, ThreadPool* pool)
+    : renderer(width, height), directory(std::move(directory)) {
+    constexpr float kHalf = kGeneratedTextureSize * 0.5F;
+    const Texture2D brushBase = loadOr(renderer, "resources/textures/brush_base.png",
+                                       disc(kHalf, Color{60, 60, 60, 255}));
+    const Texture2D brushMask =
+        loadOr(renderer, "resources/textures/brush_mask.png", disc(kHalf - 4.0F, WHITE));
+    const Texture2D arrowTexture =
+        loadOr(renderer, "resources/textures/arrowFacingUp.png", arrow());
+
+    interpolationSystem = std::make_unique<InterpolationSystem>(registry);
+    cameraSystem = std::make_unique<CameraSystem>(registry, config, static_cast<float>(width),
+                                                  static_cast<float>(height));
+
+    const auto arenaWidth = static_cast<int>(std::ceil(config.arenaWidth));
+    const auto arenaHeight = static_cast<int>(std::ceil(config.arenaHeight));
+    std::unique_ptr<PaintCanvas> canvas;
+    if (arenaWidth <= width && arenaHeight <= height) {
+        canvas = std::make_unique<SoftwarePaintCanvas>(renderer, arenaWidth, arenaHeight,
+                                                       watercolor, pool);
+    } else {
+        canvas = std::make_unique<TiledPaintCanvas>(
+            std::make_unique<SoftwareCanvasTileStore>(renderer), arenaWidth, arenaHeight,
+            static_cast<std::size_t>(std::max(config.canvasResidentTiles, 1)));
+    }
+    paintSystem = std::make_unique<PaintSystem>(registry, std::move(canvas));
+    brushRenderSystem =
+        std::make_unique<BrushRenderSystem>(registry, renderer, config, brushBase, brushMask);
+    arrowRenderSystem = std::make_unique<ArrowRenderSystem>(registry, renderer, arrowTexture);
+}
+
+void FrameExporter::paint() {
+    PROFILE_SCOPE("FramePaint");
+    paintSystem->update();
+}
+
+bool FrameExporter::capture(const std::uint32_t tick) {
+    PROFILE_SCOPE("FrameCapture");
+    // There is no frame between ticks to interpolate to, so draw brushes where they are
+    interpolationSystem->interpolate(1.0F);
+    cameraSystem->update();
+
+    renderer.beginFrame();
+    paintSystem->render();
+    renderer.beginCamera(cameraSystem->getCamera().camera);
+    brushRenderSystem->render();
+    arrowRenderSystem->render();
+    renderer.endCamera();
+    renderer.endFrame();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06u.ppm", tick);
+    std::ofstream file(directory / name, std::ios::binary);
+    if (!file || !renderer.getFramebuffer().writePpm(file)) {
+        failed = true;
+        return false;
+    }
+    ++framesWritten;
+    return true;
+}
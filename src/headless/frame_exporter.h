@@ -0,0 +1,58 @@
+#ifndef DIDDLEDOODLEDUEL_FRAME_EXPORTER_H
+#define DIDDLEDOODLEDUEL_FRAME_EXPORTER_H
+#include "core/thread_pool.h"
+#include "game_config.h"
+#include "headless/frame_sink.h"
+#include "rendering/software_renderer.h"
+#include "rendering/watercolor_filter.h"
+#include "systems/arrow_render.h"
+#include "systems/brush_render.h"
+#include "systems/camera.h"
+#include "systems/interpolation.h"
+#include "systems/paint.h"
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+// Renders a headless match with the software renderer and writes frames as numbered PPM
+// images, e.g. to encode a recorded match to video on machines without a GPU. Brush and arrow
+// textures come from resources/ when they decode, or are simple generated shapes otherwise.
+// With watercolor settings the canvas gets the game's watercolor look, shaded on the CPU.
+// Arenas larger than the frame are painted into tiles and framed by a CameraSystem, as in the
+// game; those are drawn without the watercolor look.
+class FrameExporter final : public FrameSink {
+public:
+    // The registry's PaintGridSystem has to exist already. The pool, if any, shades the
+    // watercolor between ticks and must outlive the exporter.
+    FrameExporter(entt::registry& registry, const GameConfig& config, int width, int height,
+                  std::filesystem::path directory,
+                  std::optional<WatercolorSettings> watercolor = std::nullopt,
+                  ThreadPool* pool = nullptr);
+
+    // Draws the stamps queued this tick into the canvas; call every tick, before they are dropped
+    void paint() override;
+
+    // Renders the current state and writes it as frame_NNNNNN.ppm, numbered by tick. False,
+    // and hasFailed() from then on, if the file can't be written.
+    bool capture(std::uint32_t tick) override;
+
+    [[nodiscard]] std::uint32_t getFramesWritten() const { return framesWritten; }
+    [[nodiscard]] bool hasFailed() const { return failed; }
+    [[nodiscard]] const SoftwareImage& getFramebuffer() const { return renderer.getFramebuffer(); }
+
+private:
+    SoftwareRenderer renderer;
+    std::filesystem::path directory;
+    std::uint32_t framesWritten {0};
+    bool failed {false};
+
+    std::unique_ptr<InterpolationSystem> interpolationSystem;
+    std::unique_ptr<CameraSystem> cameraSystem;
+    std::unique_ptr<PaintSystem> paintSystem;
+    std::unique_ptr<BrushRenderSystem> brushRenderSystem;
+    std::unique_ptr<ArrowRenderSystem> arrowRenderSystem;
+};
+
+#endif // DIDDLEDOODLEDUEL_FRAME_EXPORTER_H
@@ -0,0 +1,17 @@
+#ifndef DIDDLEDOODLEDUEL_FRAME_SINK_H
+#define DIDDLEDOODLEDUEL_FRAME_SINK_H
+#include <cstdint>
+
+// What HeadlessRunner hands its ticks to when frames are exported, e.g. a FrameExporter. Kept
+// apart so runners that never draw, like the server's, don't carry the software renderer.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    // Called every tick while the tick's paint stamps are still queued
+    virtual void paint() = 0;
+    // Called every interval-th tick; false if the frame couldn't be written
+    virtual bool capture(std::uint32_t tick) = 0;
+};
+
+#endif // DIDDLEDOODLEDUEL_FRAME_SINK_H
@@ -0,0 +1,212 @@
+#include "headless/headless_runner.h"
+#include "canvas/ownership_grid.h"
+#include "canvas/paint_stamp_queue.h"
+#include "components/paint_owner.h"
+#include "core/player_factory.h"
+#include "performance/profiler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <raylib.h>
+#include <span>
+#include <utility>
+
+namespace {
+// A replay runs with the tuning and arena it was recorded with
+GameConfig matchConfig(const engine::IRenderer& renderer, const HeadlessOptions& options,
+                       const std::optional<InputRecording>& replay) {
+    if (replay.has_value()) {
+        return replay->config;
+    }
+    GameConfig config = GameConfig::localMatch();
+    config.simulationTickRate = options.tickRate;
+    config.arenaWidth = options.arenaWidth > 0.0F ? options.arenaWidth
+                                                  : static_cast<float>(renderer.getWindowWidth());
+    config.arenaHeight = options.arenaHeight > 0.0F
+                             ? options.arenaHeight
+                             : static_cast<float>(renderer.getWindowHeight());
+    return config;
+}
+} // namespace
+
+HeadlessRunner::HeadlessRunner(const engine::IRenderer& renderer, const HeadlessOptions& options,
+                               std::optional<InputRecording> replay)
+    : gameConfig(matchConfig(renderer, options, replay)), options(options),
+      tickDuration(1.0F / gameConfig.simulationTickRate) {
+    const float worldWidth = gameConfig.arenaWidth;
+    const float worldHeight = gameConfig.arenaHeight;
+
+    if (options.workerThreads > 0) {
+        threadPool = std::make_unique<ThreadPool>(options.workerThreads);
+    }
+
+    scriptedInputSystem = std::make_unique<ScriptedInputSystem>(registry, options.seed);
+    inputRecorderSystem = std::make_unique<InputRecorderSystem>(registry);
+    aiSteeringSystem = std::make_unique<AiSteeringSystem>(registry, gameConfig, threadPool.get());
+    physicsMovementSystem =
+        std::make_unique<PhysicsMovementSystem>(registry, gameConfig, threadPool.get());
+    physicsCollisionSystem =
+        std::make_unique<PhysicsCollisionSystem>(registry, gameConfig, threadPool.get());
+    paintGridSystem = std::make_unique<PaintGridSystem>(registry, gameConfig, worldWidth, worldHeight);
+    flowFieldSystem = std::make_unique<FlowFieldSystem>(registry, gameConfig);
+
+    if (replay.has_value()) {
+        spawns = replay->spawns;
+        inputReplaySystem = std::make_unique<InputReplaySystem>(registry, std::move(*replay));
+        tickScheduler.add<InputReplaySystem>("InputReplay", [this] {
+            inputReplaySystem->update(players);
+        });
+    } else {
+        tickScheduler.add<ScriptedInputSystem>("ScriptedInput", [this] {
+            scriptedInputSystem->update(currentTick, std::span(players).first(scriptedPlayers));
+        });
+        if (options.bots > 0) {
+            tickScheduler.add<AiSteeringSystem>("AiSteering",
+                                                [this] { aiSteeringSystem->update(); });
+        }
+    }
+    tickScheduler.add<InputRecorderSystem>("InputRecorder", [this] {
+        inputRecorderSystem->update(players);
+    });
+    tickScheduler.add<PhysicsMovementSystem>("PhysicsMovement", [this] {
+        physicsMovementSystem->update(tickDuration);
+    });
+    tickScheduler.add<PhysicsCollisionSystem>("PhysicsCollision", [this] {
+        physicsCollisionSystem->update(tickDuration);
+    });
+    tickScheduler.add<PaintGridSystem>("PaintGridSystem", [this] { paintGridSystem->update(); });
+    if (options.bots > 0 && !inputReplaySystem) {
+        tickScheduler.add<FlowFieldSystem>("FlowField", [this] { flowFieldSystem->update(); });
+    }
+
+    // Replays already carry their spawns, and play every one of them back
+    if (spawns.empty()) {
+        planSpawns(worldWidth, worldHeight);
+        scriptedPlayers = options.players;
+    } else {
+        scriptedPlayers = spawns.size();
+    }
+    for (std::size_t index = 0; index < spawns.size(); ++index) {
+        const auto seed = (options.seed * 65537U) + static_cast<std::uint32_t>(index) + 1;
+        const auto& spawn = spawns[index];
+        players.push_back(index < scriptedPlayers
+                              ? PlayerFactory::createPlayer(registry, gameConfig, spawn)
+                              : PlayerFactory::createBot(registry, gameConfig, spawn, seed));
+    }
+}
+
+bool HeadlessRunner::loadScript(std::istream& script) {
+    return scriptedInputSystem->loadScript(script);
+}
+
+bool HeadlessRunner::startRecording() {
+    return inputRecorderSystem->start(gameConfig, spawns);
+}
+
+HeadlessReport HeadlessRunner::run() {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint32_t step = 0; step < options.ticks; ++step) {
+        tick();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    HeadlessReport report;
+    report.ticks = options.ticks;
+    report.elapsedSeconds = elapsed.count();
+    report.ticksPerSecond =
+        report.elapsedSeconds > 0.0 ? static_cast<double>(report.ticks) / report.elapsedSeconds : 0.0;
+
+    const auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+    for (const auto player : std::span(players).first(scriptedPlayers)) {
+        report.coverage.push_back(grid.coverage(registry.get<PaintOwner>(player).paletteIndex));
+    }
+    return report;
+}
+
+void HeadlessRunner::tick() {
+    {
+        PROFILE_SCOPE("SimulationTick");
+        // No scene filtering here, every scheduled system runs
+        tickScheduler.run(registry, ~SystemMask{0}, threadPool.get());
+
+        // Unless frames are exported nothing draws the stamps, so drop them once the grid has
+        // claimed their cells
+        if (frameSink != nullptr) {
+            frameSink->paint();
+        }
+        registry.ctx().get<PaintStampQueue>().stamps.clear();
+    }
+
+    if (frameSink != nullptr && currentTick % frameInterval == 0) {
+        frameSink->capture(currentTick);
+    }
+
+    if (canvasStream != nullptr && currentTick % canvasInterval == 0) {
+        PROFILE_SCOPE("CanvasStream");
+        canvasStream->writeDelta(registry.ctx().get<CanvasOwnershipGrid>(), currentTick);
+    }
+
+    if (matchRecording != nullptr) {
+        PROFILE_SCOPE("MatchRecording");
+        matchRecording->record(registry);
+    }
+
+    // Each tick is a profiler frame
+    if (options.endProfilerFrames) {
+        ScopeProfiler::getInstance().endFrame();
+    }
+    ++currentTick;
+}
+
+std::vector<Color> HeadlessRunner::getPalette() const {
+    // Brushes may share an entry; the first one's colour is kept
+    std::vector<Color> palette(1, WHITE);
+    std::array<bool, CanvasOwnershipGrid::kMaxPaletteEntries> assigned {};
+    for (const auto& spawn : spawns) {
+        if (spawn.paletteIndex >= assigned.size()) {
+            continue;
+        }
+        if (spawn.paletteIndex >= palette.size()) {
+            palette.resize(spawn.paletteIndex + std::size_t {1}, WHITE);
+        }
+        if (!std::exchange(assigned[spawn.paletteIndex], true)) {
+            palette[spawn.paletteIndex] = spawn.brushColor;
+        }
+    }
+    return palette;
+}
+
+void HeadlessRunner::planSpawns(const float worldWidth, const float worldHeight) {
+    const auto localSpawns = PlayerFactory::localGameSpawns(worldWidth, worldHeight);
+    constexpr std::array<Color, 8> extraColors = {ORANGE, PURPLE, SKYBLUE, LIME,
+                                                  PINK,   BROWN,  GOLD,    MAROON};
+    constexpr auto paletteSize = static_cast<std::uint32_t>(CanvasOwnershipGrid::kMaxPaletteEntries);
+
+    // Players past the local four are spread on a ring facing the centre, and share palette
+    // entries once the palette runs out
+    const Vector2 center = {worldWidth * 0.5F, worldHeight * 0.5F};
+    const float ringRadius = std::min(worldWidth, worldHeight) * 0.35F;
+
+    for (std::uint32_t index = 0; index < options.players; ++index) {
+        PlayerSpawn spawn{};
+        if (index < localSpawns.size()) {
+            spawn = localSpawns[index];
+        } else {
+            const float angle = (static_cast<float>(index) / static_cast<float>(options.players)) * 2.0F * PI;
+            spawn = PlayerSpawn{
+                .startPosition = {center.x + (std::cos(angle) * ringRadius),
+                                  center.y + (std::sin(angle) * ringRadius)},
+                .initialRotation = (angle * RAD2DEG) + 180.0F,
+                .rotateLeftKey = KEY_NULL,
+                .rotateRightKey = KEY_NULL,
+                .brushColor = extraColors[index % extraColors.size()],
+                .paletteIndex = static_cast<std::uint8_t>((index % (paletteSize - 1)) + 1)};
+        }
+        spawns.push_back(spawn);
+    }
+
+    const auto bots =
+        PlayerFactory::scatteredSpawns(options.bots, worldWidth, worldHeight, options.seed);
+    spawns.insert(spawns.end(), bots.begin(), bots.end());
+}
@@ -0,0 +1,126 @@
+#ifndef DIDDLEDOODLEDUEL_HEADLESS_RUNNER_H
+#define DIDDLEDOODLEDUEL_HEADLESS_RUNNER_H
+#include "core/system_scheduler.h"
+#include "core/thread_pool.h"
+#include "core/player_factory.h"
+#include "game_config.h"
+#include "headless/frame_sink.h"
+#include "replay/canvas_stream.h"
+#include "replay/input_recording.h"
+#include "replay/match_recording.h"
+#include "rendering/irenderer.h"
+#include "systems/ai_steering.h"
+#include "systems/flow_field.h"
+#include "systems/input_recorder.h"
+#include "systems/input_replay.h"
+#include "systems/paint_grid.h"
+#include "systems/physics_collision.h"
+#include "systems/physics_movement.h"
+#include "systems/scripted_input.h"
+#include <algorithm>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct HeadlessOptions {
+    std::uint32_t ticks {3600};
+    std::uint32_t players {4};
+    std::uint32_t bots {0}; // Scattered over the arena after the players, steered by AI
+    std::uint32_t seed {1};
+    float tickRate {60.0F};
+    std::uint32_t workerThreads {0}; // 0 runs every system on the calling thread
+    float arenaWidth {0.0F};         // 0 for the renderer's window size
+    float arenaHeight {0.0F};
+    // Each tick ends a profiler frame. Turn off when runners tick on several threads at once;
+    // frames are then the caller's to end.
+    bool endProfilerFrames {true};
+};
+
+struct HeadlessReport {
+    std::uint32_t ticks {0};
+    double elapsedSeconds {0.0};
+    double ticksPerSecond {0.0};
+    std::vector<float> coverage; // Per player, in spawn order; bots are left out
+};
+
+// Steps a local match with no window or GPU: scripted input, physics and the paint ownership
+// grid run at a fixed tick rate as fast as the machine allows. The renderer is only asked for
+// the arena size when the options don't give one, so a NullRenderer is enough. Given a replay,
+// the match is rebuilt from the recording's config and spawns and its input is played back
+// instead, bots included.
+class HeadlessRunner {
+public:
+    explicit HeadlessRunner(const engine::IRenderer& renderer, const HeadlessOptions& options,
+                            std::optional<InputRecording> replay = std::nullopt);
+
+    // See ScriptedInputSystem::loadScript; without a script input is random
+    bool loadScript(std::istream& script);
+
+    // Records the input of every following tick; false if there are too many players
+    bool startRecording();
+    [[nodiscard]] const InputRecording& getRecording() const {
+        return inputRecorderSystem->getRecording();
+    }
+
+    // Writes the state after every following tick to writer, which must outlive the runner
+    void recordMatch(MatchRecordingWriter& writer) { matchRecording = &writer; }
+
+    // Appends a canvas delta every interval-th tick from the next one on. The writer must
+    // outlive the runner.
+    void streamCanvas(CanvasStreamWriter& writer, const std::uint32_t interval) {
+        canvasStream = &writer;
+        canvasInterval = std::max<std::uint32_t>(interval, 1);
+    }
+
+    // Paints every following tick into sink, e.g. a FrameExporter, and captures every
+    // interval-th one. The sink must outlive the runner.
+    void exportFrames(FrameSink& sink, const std::uint32_t interval) {
+        frameSink = &sink;
+        frameInterval = std::max<std::uint32_t>(interval, 1);
+    }
+
+    HeadlessReport run();
+    void tick();
+
+    [[nodiscard]] entt::registry& getRegistry() { return registry; }
+    [[nodiscard]] const GameConfig& getConfig() const { return gameConfig; }
+    // Idle between ticks; nullptr when running on one thread
+    [[nodiscard]] ThreadPool* getThreadPool() const { return threadPool.get(); }
+    [[nodiscard]] std::uint32_t getTick() const { return currentTick; }
+    // Canvas colour per palette index: white where unpainted, then the brushes' colours
+    [[nodiscard]] std::vector<Color> getPalette() const;
+
+private:
+    entt::registry registry;
+    GameConfig gameConfig;
+    HeadlessOptions options;
+    float tickDuration;
+    std::uint32_t currentTick {0};
+    std::vector<PlayerSpawn> spawns;
+    std::vector<entt::entity> players; // Scripted or replayed players first, then the bots
+    std::size_t scriptedPlayers {0};
+    MatchRecordingWriter* matchRecording {nullptr};
+    FrameSink* frameSink {nullptr};
+    std::uint32_t frameInterval {1};
+    CanvasStreamWriter* canvasStream {nullptr};
+    std::uint32_t canvasInterval {1};
+
+    std::unique_ptr<ScriptedInputSystem> scriptedInputSystem;
+    std::unique_ptr<InputReplaySystem> inputReplaySystem;
+    std::unique_ptr<InputRecorderSystem> inputRecorderSystem;
+    std::unique_ptr<AiSteeringSystem> aiSteeringSystem;
+    std::unique_ptr<PhysicsMovementSystem> physicsMovementSystem;
+    std::unique_ptr<PhysicsCollisionSystem> physicsCollisionSystem;
+    std::unique_ptr<PaintGridSystem> paintGridSystem;
+    std::unique_ptr<FlowFieldSystem> flowFieldSystem;
+
+    std::unique_ptr<ThreadPool> threadPool;
+    SystemScheduler tickScheduler;
+
+    void planSpawns(float worldWidth, float worldHeight);
+};
+
+#endif // DIDDLEDOODLEDUEL_HEADLESS_RUNNER_H
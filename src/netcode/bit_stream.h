@@ -0,0 +1,86 @@
+#ifndef DIDDLEDOODLEDUEL_BIT_STREAM_H
+#define DIDDLEDOODLEDUEL_BIT_STREAM_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Packs values of arbitrary bit widths back to back, least significant bit first
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& output) : output(output) {
+    }
+
+    // bits <= 64; bits of value above that are ignored
+    void write(std::uint64_t value, unsigned bits) {
+        while (bits > 0) {
+            const auto offset = static_cast<unsigned>(bitCount % 8);
+            if (offset == 0) {
+                output.push_back(0);
+            }
+            const unsigned take = std::min(bits, 8 - offset);
+            output.back() |= static_cast<std::uint8_t>((value & ((1U << take) - 1)) << offset);
+            value >>= take;
+            bits -= take;
+            bitCount += take;
+        }
+    }
+
+    void writeBool(const bool value) { write(value ? 1U : 0U, 1); }
+
+    // Zigzag, so small negative and positive numbers both take few bits
+    void writeSigned(const std::int64_t value, const unsigned bits) {
+        const auto sign = static_cast<std::uint64_t>(value >> 63);
+        write((static_cast<std::uint64_t>(value) << 1U) ^ sign, bits);
+    }
+
+    [[nodiscard]] std::size_t getBitCount() const { return bitCount; }
+
+private:
+    std::vector<std::uint8_t>& output;
+    std::size_t bitCount {0};
+};
+
+// Reads what BitWriter wrote. Reading past the end yields zeros and marks the stream overflowed,
+// so callers can decode a whole message and check once at the end.
+class BitReader {
+public:
+    explicit BitReader(const std::span<const std::uint8_t> input) : input(input) {
+    }
+
+    std::uint64_t read(const unsigned bits) {
+        if (bits > remainingBits()) {
+            overflowed = true;
+            position = input.size() * 8;
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (unsigned done = 0; done < bits;) {
+            const auto offset = static_cast<unsigned>(position % 8);
+            const unsigned take = std::min(bits - done, 8 - offset);
+            const unsigned chunk = (input[position / 8] >> offset) & ((1U << take) - 1);
+            value |= std::uint64_t {chunk} << done;
+            done += take;
+            position += take;
+        }
+        return value;
+    }
+
+    bool readBool() { return read(1) != 0; }
+
+    std::int64_t readSigned(const unsigned bits) {
+        const std::uint64_t value = read(bits);
+        return static_cast<std::int64_t>(value >> 1U) ^ -static_cast<std::int64_t>(value & 1U);
+    }
+
+    [[nodiscard]] std::size_t remainingBits() const { return (input.size() * 8) - position; }
+    [[nodiscard]] bool hasOverflowed() const { return overflowed; }
+
+private:
+    std::span<const std::uint8_t> input;
+    std::size_t position {0};
+    bool overflowed {false};
+};
+
+#endif // DIDDLEDOODLEDUEL_BIT_STREAM_H
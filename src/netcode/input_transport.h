@@ -0,0 +1,97 @@
+#ifndef DIDDLEDOODLEDUEL_INPUT_TRANSPORT_H
+#define DIDDLEDOODLEDUEL_INPUT_TRANSPORT_H
+#include "components/input_action.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// One player's input for a run of consecutive ticks. Senders repeat every tick the receiver has
+// not acknowledged yet, so a lost or late packet is covered by the next one.
+struct InputPacket {
+    static constexpr std::size_t kMaxTicks = 8;
+
+    std::uint32_t firstTick {0};
+    std::uint32_t ackTick {0}; // The sender has every player's input for the ticks before this
+    std::uint8_t player {0};
+    std::uint8_t tickCount {0};
+    std::array<InputAction, kMaxTicks> inputs {};
+};
+
+// Unreliable, unordered delivery of input packets to every other peer in a match
+class IInputTransport {
+public:
+    virtual ~IInputTransport() = default;
+
+    virtual void send(const InputPacket& packet) = 0;
+    // Pops the next packet that has arrived; false once there is none
+    virtual bool receive(InputPacket& packet) = 0;
+};
+
+// Two in-process peers joined by a simulated connection. A packet arrives latencyTicks calls
+// to tick() after it was sent, plus a random extra of up to jitterTicks, so packets can also
+// overtake each other. Deterministic for a given seed.
+class LoopbackLink {
+public:
+    explicit LoopbackLink(const std::uint32_t latencyTicks, const std::uint32_t jitterTicks = 0,
+                          const std::uint32_t seed = 1)
+        : latencyTicks(latencyTicks), jitterTicks(jitterTicks), random(seed),
+          endpoints{Endpoint(*this, 0), Endpoint(*this, 1)} {
+    }
+
+    LoopbackLink(const LoopbackLink&) = delete;
+    LoopbackLink& operator=(const LoopbackLink&) = delete;
+
+    [[nodiscard]] IInputTransport& endpoint(const std::size_t side) { return endpoints[side]; }
+
+    void tick() { ++now; }
+
+private:
+    struct InFlight {
+        std::uint64_t arrival;
+        InputPacket packet;
+    };
+
+    class Endpoint final : public IInputTransport {
+    public:
+        Endpoint(LoopbackLink& link, const std::size_t side) : link(link), side(side) {
+        }
+
+        void send(const InputPacket& packet) override {
+            std::uint64_t delay = link.latencyTicks;
+            if (link.jitterTicks > 0) {
+                std::uniform_int_distribution<std::uint32_t> jitter(0, link.jitterTicks);
+                delay += jitter(link.random);
+            }
+            link.inFlight[1 - side].push_back(
+                InFlight{.arrival = link.now + delay, .packet = packet});
+        }
+
+        bool receive(InputPacket& packet) override {
+            auto& queue = link.inFlight[side];
+            const auto arrived = std::ranges::find_if(
+                queue, [&](const InFlight& entry) { return entry.arrival <= link.now; });
+            if (arrived == queue.end()) {
+                return false;
+            }
+            packet = arrived->packet;
+            queue.erase(arrived);
+            return true;
+        }
+
+    private:
+        LoopbackLink& link;
+        std::size_t side;
+    };
+
+    std::uint32_t latencyTicks;
+    std::uint32_t jitterTicks;
+    std::minstd_rand random;
+    std::uint64_t now {0};
+    std::array<std::vector<InFlight>, 2> inFlight;
+    std::array<Endpoint, 2> endpoints;
+};
+
+#endif // DIDDLEDOODLEDUEL_INPUT_TRANSPORT_H
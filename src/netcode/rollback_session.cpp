@@ -0,0 +1,197 @@
+#include "netcode/rollback_session.h"
+#include "canvas/paint_stamp_queue.h"
+#include "components/paint_trail.h"
+#include "performance/profiler.h"
+#include <algorithm>
+#include <optional>
+
+namespace {
+
+bool sameInput(const InputAction& lhs, const InputAction& rhs) {
+    return lhs.rotateLeft == rhs.rotateLeft && lhs.rotateRight == rhs.rotateRight;
+}
+
+// PaintGridSystem only adds PaintTrail on a brush's first tick, but the state ring needs it from
+// the start
+const entt::registry& withRollbackComponents(entt::registry& registry,
+                                             const std::span<const entt::entity> players) {
+    for (const auto player : players) {
+        registry.get_or_emplace<PaintTrail>(player);
+    }
+    return registry;
+}
+
+} // namespace
+
+RollbackSession::RollbackSession(entt::registry& registry,
+                                 const std::span<const entt::entity> players,
+                                 const std::span<const std::size_t> localPlayers,
+                                 IInputTransport& transport, std::function<void()> simulateTick,
+                                 const std::size_t maxRollbackTicks)
+    : registry(registry), players(players.begin(), players.end()),
+      localPlayers(localPlayers.begin(), localPlayers.end()), isLocal(players.size(), false),
+      transport(transport), simulateTick(std::move(simulateTick)),
+      states(withRollbackComponents(registry, players), players,
+             std::max<std::size_t>(maxRollbackTicks, 1)),
+      maxRollbackTicks(states.getCapacity()), confirmedTicks(players.size(), 0),
+      lastConfirmed(players.size()), remoteAcks(players.size(), 0),
+      inputs(players.size() * states.getCapacity() * 2), historyLength(states.getCapacity() * 2),
+      heldStamps(historyLength) {
+    for (const auto player : localPlayers) {
+        isLocal[player] = true;
+    }
+}
+
+bool RollbackSession::advance(const std::span<const InputAction> localInputs) {
+    receiveInputs();
+    if (currentTick - getConfirmedTick() >= maxRollbackTicks) {
+        ++stats.stalls;
+        sendLocalInputs();
+        return false;
+    }
+
+    const std::size_t localCount = std::min(localPlayers.size(), localInputs.size());
+    for (std::size_t local = 0; local < localCount; ++local) {
+        confirm(localPlayers[local], currentTick, localInputs[local]);
+    }
+    sendLocalInputs();
+    runTick(currentTick);
+    ++currentTick;
+    releaseConfirmedStamps();
+    return true;
+}
+
+void RollbackSession::poll() {
+    receiveInputs();
+    sendLocalInputs();
+}
+
+void RollbackSession::receiveInputs() {
+    std::optional<std::uint32_t> rollbackFrom;
+    InputPacket packet;
+    while (transport.receive(packet)) {
+        if (packet.player >= players.size() || isLocal[packet.player]) {
+            continue;
+        }
+        remoteAcks[packet.player] = std::max(remoteAcks[packet.player], packet.ackTick);
+        const std::uint32_t tickCount = std::min<std::uint32_t>(packet.tickCount, InputPacket::kMaxTicks);
+        for (std::uint32_t offset = 0; offset < tickCount; ++offset) {
+            const std::uint32_t tick = packet.firstTick + offset;
+            if (confirm(packet.player, tick, packet.inputs[offset])) {
+                rollbackFrom = std::min(rollbackFrom.value_or(tick), tick);
+            }
+        }
+    }
+
+    // Mispredicted ticks are never older than the confirmed tick, whose state is still saved
+    if (rollbackFrom.has_value() && states.load(registry, *rollbackFrom)) {
+        PROFILE_SCOPE("Rollback");
+        ++stats.rollbacks;
+        for (std::uint32_t tick = *rollbackFrom; tick < currentTick; ++tick) {
+            runTick(tick);
+            ++stats.resimulatedTicks;
+        }
+    }
+    releaseConfirmedStamps();
+}
+
+std::uint32_t RollbackSession::getConfirmedTick() const {
+    return confirmedTicks.empty() ? currentTick : std::ranges::min(confirmedTicks);
+}
+
+std::size_t RollbackSession::slotIndex(const std::uint32_t tick, const std::size_t player) const {
+    return ((tick % historyLength) * players.size()) + player;
+}
+
+RollbackSession::InputSlot& RollbackSession::slotFor(const std::uint32_t tick,
+                                                     const std::size_t player) {
+    InputSlot& slot = inputs[slotIndex(tick, player)];
+    if (slot.tick != tick) {
+        slot = InputSlot{.tick = tick};
+    }
+    return slot;
+}
+
+bool RollbackSession::confirm(const std::size_t player, const std::uint32_t tick,
+                              const InputAction input) {
+    // Older ticks are settled; input further ahead than the other peer may predict is resent later
+    if (tick < confirmedTicks[player] || tick >= currentTick + maxRollbackTicks) {
+        return false;
+    }
+    InputSlot& slot = slotFor(tick, player);
+    if (slot.confirmed) {
+        return false;
+    }
+    slot.confirmed = true;
+    slot.input = input;
+
+    for (;;) {
+        const InputSlot& next = inputs[slotIndex(confirmedTicks[player], player)];
+        if (next.tick != confirmedTicks[player] || !next.confirmed) {
+            break;
+        }
+        lastConfirmed[player] = next.input;
+        ++confirmedTicks[player];
+    }
+    return tick < currentTick && !sameInput(slot.used, input);
+}
+
+void RollbackSession::runTick(const std::uint32_t tick) {
+    states.save(registry, tick);
+    for (std::size_t player = 0; player < players.size(); ++player) {
+        InputSlot& slot = slotFor(tick, player);
+        slot.used = slot.confirmed ? slot.input : lastConfirmed[player];
+        registry.get<InputAction>(players[player]) = slot.used;
+    }
+
+    // The tick's stamps replace whatever its last simulation held; the queue keeps only what
+    // was already released
+    auto* queue = registry.ctx().find<PaintStampQueue>();
+    const std::size_t released = queue != nullptr ? queue->stamps.size() : 0;
+    simulateTick();
+    if (queue != nullptr) {
+        const auto first = queue->stamps.begin() + static_cast<std::ptrdiff_t>(released);
+        heldStamps[tick % historyLength].assign(first, queue->stamps.end());
+        queue->stamps.erase(first, queue->stamps.end());
+    }
+}
+
+void RollbackSession::releaseConfirmedStamps() {
+    auto* queue = registry.ctx().find<PaintStampQueue>();
+    const std::uint32_t confirmed = std::min(getConfirmedTick(), currentTick);
+    for (; releasedTick < confirmed; ++releasedTick) {
+        auto& held = heldStamps[releasedTick % historyLength];
+        if (queue != nullptr) {
+            queue->stamps.insert(queue->stamps.end(), held.begin(), held.end());
+        }
+        held.clear();
+    }
+}
+
+void RollbackSession::sendLocalInputs() {
+    const std::uint32_t ackTick = getConfirmedTick();
+    std::uint32_t from = currentTick;
+    for (std::size_t player = 0; player < players.size(); ++player) {
+        if (!isLocal[player]) {
+            from = std::min(from, remoteAcks[player]);
+        }
+    }
+
+    for (const auto player : localPlayers) {
+        const std::uint32_t end = confirmedTicks[player];
+        const auto history = static_cast<std::uint32_t>(historyLength);
+        const std::uint32_t oldestKept = end - std::min(end, history);
+        for (std::uint32_t first = std::max(from, oldestKept); first < end;
+             first += InputPacket::kMaxTicks) {
+            const auto count = std::min<std::uint32_t>(InputPacket::kMaxTicks, end - first);
+            InputPacket packet{.firstTick = first,
+                               .ackTick = ackTick,
+                               .player = static_cast<std::uint8_t>(player),
+                               .tickCount = static_cast<std::uint8_t>(count)};
+            for (std::uint32_t offset = 0; offset < packet.tickCount; ++offset) {
+                packet.inputs[offset] = inputs[slotIndex(first + offset, player)].input;
+            }
+            transport.send(packet);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef DIDDLEDOODLEDUEL_ROLLBACK_SESSION_H
+#define DIDDLEDOODLEDUEL_ROLLBACK_SESSION_H
+#include "canvas/paint_stamp.h"
+#include "components/input_action.h"
+#include "netcode/input_transport.h"
+#include "netcode/rollback_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <functional>
+#include <span>
+#include <vector>
+
+struct RollbackStats {
+    std::uint32_t rollbacks {0};
+    std::uint32_t resimulatedTicks {0};
+    std::uint32_t stalls {0}; // advance() calls that waited for remote input
+};
+
+// GGPO-style rollback over an IInputTransport. Each peer simulates every tick as soon as its own
+// players' input is known, predicting that remote players still hold what they last sent. When
+// a remote input arrives that differs from the prediction, the state saved before that tick is
+// restored and the ticks since are simulated again with the corrected input.
+//
+// All peers must start from the same state with the same players in the same order, and
+// simulateTick must be deterministic and only depend on the registry and InputAction.
+//
+// Stamps a tick adds to the PaintStampQueue are held back until the tick is confirmed, so the
+// canvas, which can't be rolled back, only ever draws what the ownership grid settles on. The
+// canvas trails the simulation by the wait for remote input.
+class RollbackSession {
+public:
+    static constexpr std::size_t kDefaultMaxRollbackTicks = 8;
+
+    // localPlayers indexes players; every other player's input comes from the transport
+    RollbackSession(entt::registry& registry, std::span<const entt::entity> players,
+                    std::span<const std::size_t> localPlayers, IInputTransport& transport,
+                    std::function<void()> simulateTick,
+                    std::size_t maxRollbackTicks = kDefaultMaxRollbackTicks);
+
+    // Simulates the next tick with localInputs, one per local player in localPlayers order. False,
+    // with nothing simulated, while predicting further would exceed maxRollbackTicks; call
+    // again next frame.
+    bool advance(std::span<const InputAction> localInputs);
+
+    // Takes in whatever input has arrived, rolling back if it contradicts a prediction, and
+    // resends local input the other peers have not acknowledged. Only needed while not
+    // advancing, e.g. to settle the last ticks of a match.
+    void poll();
+
+    [[nodiscard]] std::uint32_t getTick() const { return currentTick; }
+    // Ticks before this have every player's real input, so they will never roll back
+    [[nodiscard]] std::uint32_t getConfirmedTick() const;
+    [[nodiscard]] const RollbackStats& getStats() const { return stats; }
+
+private:
+    struct InputSlot {
+        std::uint32_t tick {0};
+        bool confirmed {false};
+        InputAction input {};
+        InputAction used {}; // What the last simulation of this tick applied
+    };
+
+    entt::registry& registry;
+    std::vector<entt::entity> players;
+    std::vector<std::size_t> localPlayers;
+    std::vector<bool> isLocal;
+    IInputTransport& transport;
+    std::function<void()> simulateTick;
+    RollbackStateRing states;
+    std::size_t maxRollbackTicks;
+
+    std::uint32_t currentTick {0};
+    // Per player: ticks below this all have confirmed input, and the last of those inputs,
+    // which is also the prediction for the ticks after it
+    std::vector<std::uint32_t> confirmedTicks;
+    std::vector<InputAction> lastConfirmed;
+    // Per remote player, the ackTick its peer last reported; local input is resent from there
+    std::vector<std::uint32_t> remoteAcks;
+    // historyLength ticks of every player's input, indexed by (tick % historyLength, player)
+    std::vector<InputSlot> inputs;
+    std::size_t historyLength;
+    // Stamps of simulated but unconfirmed ticks, indexed by tick % historyLength; ticks below
+    // releasedTick have been handed to the PaintStampQueue
+    std::vector<std::vector<PaintStamp>> heldStamps;
+    std::uint32_t releasedTick {0};
+    RollbackStats stats;
+
+    [[nodiscard]] std::size_t slotIndex(std::uint32_t tick, std::size_t player) const;
+    InputSlot& slotFor(std::uint32_t tick, std::size_t player);
+    // True if tick was already simulated with a different input
+    bool confirm(std::size_t player, std::uint32_t tick, InputAction input);
+    void receiveInputs();
+    void runTick(std::uint32_t tick);
+    void releaseConfirmedStamps();
+    void sendLocalInputs();
+};
+
+#endif // DIDDLEDOODLEDUEL_ROLLBACK_SESSION_H
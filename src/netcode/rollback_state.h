@@ -0,0 +1,104 @@
+#ifndef DIDDLEDOODLEDUEL_ROLLBACK_STATE_H
+#define DIDDLEDOODLEDUEL_ROLLBACK_STATE_H
+#include "canvas/ownership_grid.h"
+#include "components/collision_state.h"
+#include "components/paint_trail.h"
+#include "components/position.h"
+#include "components/previous_position.h"
+#include "components/velocity.h"
+#include "core/type_list.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <entt/entity/registry.hpp>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Everything a simulation tick changes on a player. Input is not saved; it is applied again
+// before each re-simulated tick.
+using RollbackComponents =
+    TypeList<Position, PreviousPosition, Velocity, CollisionState, PaintTrail>;
+
+// Ring of the last capacity simulation states of a fixed set of players plus the ownership grid.
+// Every slot is allocated up front and saving is a flat copy into it, so saving and restoring
+// never allocate. Players must already have every RollbackComponents component.
+class RollbackStateRing {
+public:
+    RollbackStateRing(const entt::registry& registry, const std::span<const entt::entity> players,
+                      const std::size_t capacity)
+        : players(players.begin(), players.end()),
+          playerBytes(componentBytes(RollbackComponents {})) {
+        const auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+        slots.reserve(capacity);
+        for (std::size_t slot = 0; slot < capacity; ++slot) {
+            slots.push_back(Slot{.tick = std::nullopt,
+                                 .components = std::vector<std::byte>(playerBytes * players.size()),
+                                 .grid = grid});
+        }
+    }
+
+    [[nodiscard]] std::size_t getCapacity() const { return slots.size(); }
+
+    // State at the start of tick, before its input is applied
+    void save(const entt::registry& registry, const std::uint32_t tick) {
+        Slot& slot = slots[tick % slots.size()];
+        slot.tick = tick;
+        std::byte* cursor = slot.components.data();
+        for (const auto player : players) {
+            copyOut(registry, player, cursor, RollbackComponents {});
+        }
+        slot.grid = registry.ctx().get<CanvasOwnershipGrid>();
+    }
+
+    // False if tick was never saved or has since been overwritten
+    bool load(entt::registry& registry, const std::uint32_t tick) const {
+        const Slot& slot = slots[tick % slots.size()];
+        if (slot.tick != tick) {
+            return false;
+        }
+        const std::byte* cursor = slot.components.data();
+        for (const auto player : players) {
+            copyIn(registry, player, cursor, RollbackComponents {});
+        }
+        registry.ctx().get<CanvasOwnershipGrid>() = slot.grid;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::optional<std::uint32_t> tick;
+        std::vector<std::byte> components;
+        CanvasOwnershipGrid grid; // Same shape in every slot, so assigning reuses its storage
+    };
+
+    std::vector<entt::entity> players;
+    std::size_t playerBytes;
+    std::vector<Slot> slots;
+
+    template <typename... Components>
+    static constexpr std::size_t componentBytes(TypeList<Components...> /*components*/) {
+        static_assert((std::is_trivially_copyable_v<Components> && ...),
+                      "Rollback state is copied as raw bytes");
+        return (sizeof(Components) + ...);
+    }
+
+    template <typename... Components>
+    static void copyOut(const entt::registry& registry, const entt::entity player,
+                        std::byte*& cursor, TypeList<Components...> /*components*/) {
+        ((std::memcpy(cursor, &registry.get<const Components>(player), sizeof(Components)),
+          cursor += sizeof(Components)),
+         ...);
+    }
+
+    template <typename... Components>
+    static void copyIn(entt::registry& registry, const entt::entity player,
+                       const std::byte*& cursor, TypeList<Components...> /*components*/) {
+        ((std::memcpy(&registry.get<Components>(player), cursor, sizeof(Components)),
+          cursor += sizeof(Components)),
+         ...);
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_ROLLBACK_STATE_H
@@ -0,0 +1,476 @@
+#include "netcode/snapshot_codec.h"
+#include "components/collision_state.h"
+#include "components/position.h"
+#include "components/velocity.h"
+#include "netcode/bit_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Snapshot layout, bit-packed with BitWriter:
+//   u32 sequence, bool has baseline, then u8 baseline age (sequence - baseline sequence)
+//   var removed count, then the removed ids as var gaps from the one before
+//   var changed count, then per entity: var id gap, u3 field mask and the changed fields:
+//     position: var signed x and y deltas; rotation: var signed delta, wrapped to a half turn;
+//     collision: bool in collision, var signed timer, bounce x and bounce y deltas
+// Deltas are against the baseline's entity, or against zero for entities it does not have.
+// Removals and changes that don't fit the client's budget are left out; the client keeps the
+// baseline's copy of those entities.
+// Var values are a 2-bit width class followed by 4, 9, 16 or 32 bits.
+
+namespace {
+
+constexpr float kPositionScale = 16.0F;
+constexpr std::uint32_t kRotationSteps = 4096;
+// Nine bits cover a brush's movement over a few ticks, sixteen any position in the arena
+constexpr std::array<unsigned, 4> kVarBits = {4, 9, 16, 32};
+
+enum FieldMask : std::uint32_t {
+    kPositionChanged = 1U << 0U,
+    kRotationChanged = 1U << 1U,
+    kCollisionChanged = 1U << 2U,
+};
+constexpr unsigned kFieldMaskBits = 3;
+
+unsigned varWidthClass(const std::uint32_t value) {
+    unsigned widthClass = 0;
+    while (widthClass < kVarBits.size() - 1 &&
+           value >= (std::uint64_t {1} << kVarBits[widthClass])) {
+        ++widthClass;
+    }
+    return widthClass;
+}
+
+void writeVar(BitWriter& writer, const std::uint32_t value) {
+    const unsigned widthClass = varWidthClass(value);
+    writer.write(widthClass, 2);
+    writer.write(value, kVarBits[widthClass]);
+}
+
+std::size_t varBits(const std::size_t value) {
+    return 2 + kVarBits[varWidthClass(static_cast<std::uint32_t>(value))];
+}
+
+std::uint32_t readVar(BitReader& reader) {
+    return static_cast<std::uint32_t>(reader.read(kVarBits[reader.read(2)]));
+}
+
+// Differences wrap instead of overflowing, so any two values round-trip
+std::uint32_t zigzagDelta(const std::int32_t value, const std::int32_t base) {
+    const auto delta = static_cast<std::int32_t>(static_cast<std::uint32_t>(value) -
+                                                 static_cast<std::uint32_t>(base));
+    return (static_cast<std::uint32_t>(delta) << 1U) ^ static_cast<std::uint32_t>(delta >> 31);
+}
+
+void writeDelta(BitWriter& writer, const std::int32_t value, const std::int32_t base) {
+    writeVar(writer, zigzagDelta(value, base));
+}
+
+std::size_t deltaBits(const std::int32_t value, const std::int32_t base) {
+    return varBits(zigzagDelta(value, base));
+}
+
+std::int32_t readDelta(BitReader& reader, const std::int32_t base) {
+    const std::uint32_t zigzag = readVar(reader);
+    const std::uint32_t delta = (zigzag >> 1U) ^ (0U - (zigzag & 1U));
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(base) + delta);
+}
+
+std::int32_t quantizePosition(const float value) {
+    return static_cast<std::int32_t>(std::lround(value * kPositionScale));
+}
+
+float dequantizePosition(const std::int32_t value) {
+    return static_cast<float>(value) / kPositionScale;
+}
+
+std::uint16_t quantizeRotation(const float degrees) {
+    const float turns = degrees / 360.0F;
+    const auto steps =
+        std::lround((turns - std::floor(turns)) * static_cast<float>(kRotationSteps));
+    return static_cast<std::uint16_t>(static_cast<std::uint32_t>(steps) % kRotationSteps);
+}
+
+std::uint32_t fieldMask(const QuantizedEntity& entity, const QuantizedEntity& base) {
+    std::uint32_t mask = 0;
+    if (entity.x != base.x || entity.y != base.y) {
+        mask |= kPositionChanged;
+    }
+    if (entity.rotation != base.rotation) {
+        mask |= kRotationChanged;
+    }
+    if (entity.inCollision != base.inCollision ||
+        entity.bounceMilliseconds != base.bounceMilliseconds || entity.bounceX != base.bounceX ||
+        entity.bounceY != base.bounceY) {
+        mask |= kCollisionChanged;
+    }
+    return mask;
+}
+
+// The short way round
+std::int32_t rotationDelta(const QuantizedEntity& entity, const QuantizedEntity& base) {
+    auto delta = static_cast<std::int32_t>((entity.rotation - base.rotation + kRotationSteps) %
+                                           kRotationSteps);
+    if (delta >= static_cast<std::int32_t>(kRotationSteps / 2)) {
+        delta -= static_cast<std::int32_t>(kRotationSteps);
+    }
+    return delta;
+}
+
+void writeEntity(BitWriter& writer, const QuantizedEntity& entity, const QuantizedEntity& base) {
+    const std::uint32_t mask = fieldMask(entity, base);
+    writer.write(mask, kFieldMaskBits);
+    if ((mask & kPositionChanged) != 0) {
+        writeDelta(writer, entity.x, base.x);
+        writeDelta(writer, entity.y, base.y);
+    }
+    if ((mask & kRotationChanged) != 0) {
+        writeDelta(writer, rotationDelta(entity, base), 0);
+    }
+    if ((mask & kCollisionChanged) != 0) {
+        writer.writeBool(entity.inCollision);
+        writeDelta(writer, entity.bounceMilliseconds, base.bounceMilliseconds);
+        writeDelta(writer, entity.bounceX, base.bounceX);
+        writeDelta(writer, entity.bounceY, base.bounceY);
+    }
+}
+
+// What writeEntity writes, in bits
+std::size_t entityBits(const QuantizedEntity& entity, const QuantizedEntity& base) {
+    const std::uint32_t mask = fieldMask(entity, base);
+    std::size_t bits = kFieldMaskBits;
+    if ((mask & kPositionChanged) != 0) {
+        bits += deltaBits(entity.x, base.x) + deltaBits(entity.y, base.y);
+    }
+    if ((mask & kRotationChanged) != 0) {
+        bits += deltaBits(rotationDelta(entity, base), 0);
+    }
+    if ((mask & kCollisionChanged) != 0) {
+        bits += 1 + deltaBits(entity.bounceMilliseconds, base.bounceMilliseconds) +
+                deltaBits(entity.bounceX, base.bounceX) + deltaBits(entity.bounceY, base.bounceY);
+    }
+    return bits;
+}
+
+// A snapshot's worth of staleness, plus one per 16 units the client's copy is off by
+float priorityGain(const QuantizedEntity& entity, const QuantizedEntity& base) {
+    const std::int64_t error = std::max(std::abs(std::int64_t {entity.x} - base.x),
+                                        std::abs(std::int64_t {entity.y} - base.y));
+    return 1.0F + static_cast<float>(error) / (kPositionScale * 16.0F);
+}
+
+void readEntity(BitReader& reader, QuantizedEntity& entity) {
+    const auto mask = static_cast<std::uint32_t>(reader.read(kFieldMaskBits));
+    if ((mask & kPositionChanged) != 0) {
+        entity.x = readDelta(reader, entity.x);
+        entity.y = readDelta(reader, entity.y);
+    }
+    if ((mask & kRotationChanged) != 0) {
+        const auto rotation = static_cast<std::uint32_t>(readDelta(reader, entity.rotation));
+        entity.rotation = static_cast<std::uint16_t>(rotation % kRotationSteps);
+    }
+    if ((mask & kCollisionChanged) != 0) {
+        entity.inCollision = reader.readBool();
+        entity.bounceMilliseconds =
+            static_cast<std::uint16_t>(readDelta(reader, entity.bounceMilliseconds));
+        entity.bounceX = readDelta(reader, entity.bounceX);
+        entity.bounceY = readDelta(reader, entity.bounceY);
+    }
+}
+
+void writeComponents(entt::registry& registry, const QuantizedEntity& state) {
+    auto entity = static_cast<entt::entity>(state.id);
+    if (!registry.valid(entity)) {
+        entity = registry.create(entity);
+    }
+    registry.emplace_or_replace<Position>(
+        entity, Position{.position = {dequantizePosition(state.x), dequantizePosition(state.y)}});
+    registry.get_or_emplace<Velocity>(entity).rotation =
+        static_cast<float>(state.rotation) * 360.0F / static_cast<float>(kRotationSteps);
+    registry.emplace_or_replace<CollisionState>(
+        entity,
+        CollisionState{.isInCollision = state.inCollision,
+                       .bounceTimer = static_cast<float>(state.bounceMilliseconds) / 1000.0F,
+                       .bounceVelocity = {dequantizePosition(state.bounceX),
+                                          dequantizePosition(state.bounceY)}});
+}
+
+void destroyEntity(entt::registry& registry, const std::uint32_t id) {
+    if (const auto entity = static_cast<entt::entity>(id); registry.valid(entity)) {
+        registry.destroy(entity);
+    }
+}
+
+// Brings registry from the previous snapshot to the next one, touching only what differs
+void applyDifferences(const std::vector<QuantizedEntity>& previous,
+                      const std::vector<QuantizedEntity>& next, entt::registry& registry) {
+    auto before = previous.begin();
+    for (const auto& entity : next) {
+        for (; before != previous.end() && before->id < entity.id; ++before) {
+            destroyEntity(registry, before->id);
+        }
+        if (before != previous.end() && before->id == entity.id) {
+            if (*before != entity) {
+                writeComponents(registry, entity);
+            }
+            ++before;
+        } else {
+            writeComponents(registry, entity);
+        }
+    }
+    for (; before != previous.end(); ++before) {
+        destroyEntity(registry, before->id);
+    }
+}
+
+} // namespace
+
+std::uint32_t SnapshotEncoder::capture(const entt::registry& registry) {
+    const std::uint32_t sequence = nextSequence++;
+    auto& [latestSequence, entities] = latest;
+    latestSequence = sequence;
+    entities.clear();
+
+    for (const auto view = registry.view<const Position, const Velocity, const CollisionState>();
+         const auto entity : view) {
+        const auto& [position] = view.get<const Position>(entity);
+        const auto& [isInCollision, bounceTimer, bounceVelocity] =
+            view.get<const CollisionState>(entity);
+        const long bounceMilliseconds = std::lround(bounceTimer * 1000.0F);
+        entities.push_back(QuantizedEntity{
+            .id = entt::to_integral(entity),
+            .x = quantizePosition(position.x),
+            .y = quantizePosition(position.y),
+            .rotation = quantizeRotation(view.get<const Velocity>(entity).rotation),
+            .inCollision = isInCollision,
+            .bounceMilliseconds =
+                static_cast<std::uint16_t>(std::clamp(bounceMilliseconds, 0L, 65535L)),
+            .bounceX = quantizePosition(bounceVelocity.x),
+            .bounceY = quantizePosition(bounceVelocity.y)});
+    }
+    std::ranges::sort(entities, {}, &QuantizedEntity::id);
+    return sequence;
+}
+
+void SnapshotEncoder::encode(SnapshotClientState& client,
+                             const std::optional<std::uint32_t> ackedSequence,
+                             std::vector<std::uint8_t>& output) {
+    if (nextSequence == 0) {
+        return;
+    }
+    const std::uint32_t sequence = nextSequence - 1;
+    const auto& current = latest.entities;
+
+    const WorldSnapshot* baseline = nullptr;
+    if (ackedSequence && *ackedSequence < sequence &&
+        sequence - *ackedSequence < kSnapshotHistoryLength &&
+        client.sent[*ackedSequence % kSnapshotHistoryLength].sequence == ackedSequence) {
+        baseline = &client.sent[*ackedSequence % kSnapshotHistoryLength];
+    }
+    std::span<const QuantizedEntity> base;
+    if (baseline != nullptr) {
+        base = baseline->entities;
+    }
+
+    // Both lists are sorted by id, so one walk finds everything added, removed or changed. The
+    // client's priorities are sorted by id too; entities it has up to date owe nothing.
+    changed.clear();
+    removed.clear();
+    priorities.clear();
+    auto owed = client.priorities.begin();
+    const auto accumulate = [&](const QuantizedEntity& entity, const QuantizedEntity& from) {
+        for (; owed != client.priorities.end() && owed->id < entity.id; ++owed) {
+        }
+        const float carried =
+            owed != client.priorities.end() && owed->id == entity.id ? owed->priority : 0.0F;
+        priorities.push_back({.id = entity.id, .priority = carried + priorityGain(entity, from)});
+    };
+    for (std::size_t index = 0, baseIndex = 0; index < current.size() || baseIndex < base.size();) {
+        if (baseIndex == base.size() ||
+            (index < current.size() && current[index].id < base[baseIndex].id)) {
+            accumulate(current[index], QuantizedEntity{.id = current[index].id});
+            changed.emplace_back(index++, std::nullopt);
+        } else if (index == current.size() || base[baseIndex].id < current[index].id) {
+            removed.push_back(base[baseIndex++].id);
+        } else {
+            if (current[index] != base[baseIndex]) {
+                accumulate(current[index], base[baseIndex]);
+                changed.emplace_back(index, baseIndex);
+            } else {
+                priorities.push_back({.id = current[index].id});
+            }
+            ++index;
+            ++baseIndex;
+        }
+    }
+
+    // Removals first, then the most overdue changes that fit. Ids are costed as if written
+    // whole, an upper bound on the gap to the one before, so the budget holds once sorted.
+    const std::size_t budgetBits = budgetBytes * 8;
+    std::size_t bits = 32 + 1 + (baseline != nullptr ? 8 : 0) + varBits(removed.size()) +
+                       varBits(changed.size());
+    std::size_t removedSent = 0;
+    for (std::uint32_t previousId = 0; removedSent < removed.size(); ++removedSent) {
+        const std::size_t cost = varBits(removed[removedSent] - previousId);
+        if (bits + cost > budgetBits) {
+            break;
+        }
+        bits += cost;
+        previousId = removed[removedSent];
+    }
+
+    std::ranges::sort(changed, [this](const auto& left, const auto& right) {
+        return priorities[left.first].priority > priorities[right.first].priority ||
+               (priorities[left.first].priority == priorities[right.first].priority &&
+                left.first < right.first);
+    });
+    sending.clear();
+    for (const auto& [index, baseIndex] : changed) {
+        const QuantizedEntity& entity = current[index];
+        const std::size_t cost =
+            varBits(entity.id) +
+            entityBits(entity, baseIndex ? base[*baseIndex] : QuantizedEntity{.id = entity.id});
+        if (bits + cost > budgetBits) {
+            continue;
+        }
+        bits += cost;
+        priorities[index].priority = 0.0F;
+        sending.emplace_back(index, baseIndex);
+    }
+    std::ranges::sort(sending);
+
+    BitWriter writer(output);
+    writer.write(sequence, 32);
+    writer.writeBool(baseline != nullptr);
+    if (baseline != nullptr) {
+        writer.write(sequence - *ackedSequence, 8);
+    }
+
+    writeVar(writer, static_cast<std::uint32_t>(removedSent));
+    std::uint32_t previousId = 0;
+    for (std::size_t entry = 0; entry < removedSent; ++entry) {
+        writeVar(writer, removed[entry] - previousId);
+        previousId = removed[entry];
+    }
+
+    writeVar(writer, static_cast<std::uint32_t>(sending.size()));
+    previousId = 0;
+    for (const auto& [index, baseIndex] : sending) {
+        const QuantizedEntity& entity = current[index];
+        writeVar(writer, entity.id - previousId);
+        previousId = entity.id;
+        writeEntity(writer, entity,
+                    baseIndex ? base[*baseIndex] : QuantizedEntity{.id = entity.id});
+    }
+
+    // What the client holds once it decodes this: the baseline without what was removed, with
+    // what was sent
+    auto& [sentSequence, held] = client.sent[sequence % kSnapshotHistoryLength];
+    sentSequence = sequence;
+    held.clear();
+    auto send = sending.begin();
+    const auto removedEnd = removed.begin() + static_cast<std::ptrdiff_t>(removedSent);
+    auto removal = removed.begin();
+    for (const auto& entity : base) {
+        for (; send != sending.end() && current[send->first].id < entity.id; ++send) {
+            held.push_back(current[send->first]);
+        }
+        for (; removal != removedEnd && *removal < entity.id; ++removal) {
+        }
+        if (removal != removedEnd && *removal == entity.id) {
+            continue;
+        }
+        if (send != sending.end() && current[send->first].id == entity.id) {
+            held.push_back(current[(send++)->first]);
+        } else {
+            held.push_back(entity);
+        }
+    }
+    for (; send != sending.end(); ++send) {
+        held.push_back(current[send->first]);
+    }
+    std::swap(client.priorities, priorities);
+}
+
+bool SnapshotDecoder::decode(const std::span<const std::uint8_t> input, entt::registry& registry) {
+    BitReader reader(input);
+    const auto sequence = static_cast<std::uint32_t>(reader.read(32));
+    const bool hasBaseline = reader.readBool();
+    const auto age = hasBaseline ? static_cast<std::uint32_t>(reader.read(8)) : 0;
+    if (reader.hasOverflowed()) {
+        return false;
+    }
+    if (latest && sequence <= *latest) {
+        return true;
+    }
+
+    std::span<const QuantizedEntity> base;
+    if (hasBaseline) {
+        const std::uint32_t baseSequence = sequence - age;
+        const auto& baseline = history[baseSequence % kSnapshotHistoryLength];
+        if (age == 0 || age >= kSnapshotHistoryLength || baseline.sequence != baseSequence) {
+            return false;
+        }
+        base = baseline.entities;
+    }
+
+    // Every count is checked against what is left, so corrupt data cannot allocate much
+    const std::uint32_t removedCount = readVar(reader);
+    if (removedCount > reader.remainingBits()) {
+        return false;
+    }
+    removed.clear();
+    std::uint32_t id = 0;
+    for (std::uint32_t entry = 0; entry < removedCount; ++entry) {
+        id += readVar(reader);
+        removed.push_back(id);
+    }
+
+    const std::uint32_t changedCount = readVar(reader);
+    if (changedCount > reader.remainingBits()) {
+        return false;
+    }
+    changed.clear();
+    id = 0;
+    for (std::uint32_t entry = 0; entry < changedCount; ++entry) {
+        id += readVar(reader);
+        const auto found = std::ranges::lower_bound(base, id, {}, &QuantizedEntity::id);
+        QuantizedEntity entity =
+            found != base.end() && found->id == id ? *found : QuantizedEntity{.id = id};
+        readEntity(reader, entity);
+        changed.push_back(entity);
+    }
+    if (reader.hasOverflowed() ||
+        std::ranges::adjacent_find(changed, {}, &QuantizedEntity::id) != changed.end()) {
+        return false;
+    }
+
+    // The baseline without what was removed, with what changed
+    decoded.sequence = sequence;
+    decoded.entities.clear();
+    auto change = changed.begin();
+    auto removal = removed.begin();
+    for (const auto& entity : base) {
+        for (; change != changed.end() && change->id < entity.id; ++change) {
+            decoded.entities.push_back(*change);
+        }
+        for (; removal != removed.end() && *removal < entity.id; ++removal) {
+        }
+        if (removal != removed.end() && *removal == entity.id) {
+            continue;
+        }
+        if (change != changed.end() && change->id == entity.id) {
+            decoded.entities.push_back(*change++);
+        } else {
+            decoded.entities.push_back(entity);
+        }
+    }
+    decoded.entities.insert(decoded.entities.end(), change, changed.end());
+
+    static const std::vector<QuantizedEntity> kNoEntities;
+    applyDifferences(latest ? history[*latest % kSnapshotHistoryLength].entities : kNoEntities,
+                     decoded.entities, registry);
+    std::swap(history[sequence % kSnapshotHistoryLength], decoded);
+    latest = sequence;
+    return true;
+}
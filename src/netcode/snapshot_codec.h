@@ -0,0 +1,106 @@
+#ifndef DIDDLEDOODLEDUEL_SNAPSHOT_CODEC_H
+#define DIDDLEDOODLEDUEL_SNAPSHOT_CODEC_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Replicated state of one entity, quantized: positions and bounce velocities in 1/16 units,
+// rotation in 1/4096 turns, the bounce timer in milliseconds
+struct QuantizedEntity {
+    std::uint32_t id {0}; // entt::to_integral of the server's entity
+    std::int32_t x {0};
+    std::int32_t y {0};
+    std::uint16_t rotation {0};
+    bool inCollision {false};
+    std::uint16_t bounceMilliseconds {0};
+    std::int32_t bounceX {0};
+    std::int32_t bounceY {0};
+
+    bool operator==(const QuantizedEntity&) const = default;
+};
+
+// Every entity with Position, Velocity and CollisionState, sorted by id
+struct WorldSnapshot {
+    std::optional<std::uint32_t> sequence;
+    std::vector<QuantizedEntity> entities;
+};
+
+inline constexpr std::uint32_t kSnapshotHistoryLength = 64;
+// Fits one datagram under a typical MTU
+inline constexpr std::size_t kDefaultSnapshotBudgetBytes = 1200;
+
+// How overdue an entity's update is for one client
+struct EntityPriority {
+    std::uint32_t id {0};
+    float priority {0.0F};
+};
+
+// Server-side record of one client, kept next to its acknowledgements. Snapshots leave out what
+// doesn't fit the budget, so the baseline for a delta is what each snapshot left the client with
+// rather than the world it was captured from.
+class SnapshotClientState {
+private:
+    friend class SnapshotEncoder;
+    std::array<WorldSnapshot, kSnapshotHistoryLength> sent;
+    std::vector<EntityPriority> priorities; // Sorted by id
+};
+
+// Server side. Captures one snapshot per send and encodes it for each client as a delta against
+// the newest snapshot that client acknowledged: only entities that were added, removed or
+// changed are written, each with a mask of which fields changed and bit-packed deltas of those.
+// Each client gets at most a fixed number of bytes per snapshot, so its bandwidth stays flat
+// however many entities move. Changed entities go in by priority: every snapshot an entity is
+// left out adds to its priority, more the further the client's copy is off, and sending it
+// resets it, so what doesn't fit this time comes first next time.
+class SnapshotEncoder {
+public:
+    explicit SnapshotEncoder(std::size_t budgetBytes = kDefaultSnapshotBudgetBytes)
+        : budgetBytes(budgetBytes) {
+    }
+
+    // Quantizes registry into the next snapshot and returns its sequence
+    std::uint32_t capture(const entt::registry& registry);
+
+    // Appends the newest snapshot to output, for a client that last acknowledged ackedSequence.
+    // Without an acknowledged snapshot still in the client's history it is encoded against an
+    // empty world.
+    void encode(SnapshotClientState& client, std::optional<std::uint32_t> ackedSequence,
+                std::vector<std::uint8_t>& output);
+
+private:
+    std::size_t budgetBytes;
+    WorldSnapshot latest;
+    std::uint32_t nextSequence {0};
+    // Per changed entity: index into the newest snapshot and into the baseline, if it has one
+    std::vector<std::pair<std::size_t, std::optional<std::size_t>>> changed;
+    std::vector<std::uint32_t> removed;
+    std::vector<EntityPriority> priorities; // Aligned with the newest snapshot
+    std::vector<std::pair<std::size_t, std::optional<std::size_t>>> sending;
+};
+
+// Client side. Rebuilds each snapshot from the baseline it was encoded against and applies it
+// to a registry that mirrors the server's entities, with the same ids. Keep client-only
+// entities in another registry.
+class SnapshotDecoder {
+public:
+    // Applies the encoded snapshot to registry. Snapshots older than the last one applied are
+    // skipped. False if the data is corrupt or its baseline is no longer known.
+    bool decode(std::span<const std::uint8_t> input, entt::registry& registry);
+
+    // What to acknowledge to the server
+    [[nodiscard]] std::optional<std::uint32_t> getLatestSequence() const { return latest; }
+
+private:
+    std::array<WorldSnapshot, kSnapshotHistoryLength> history;
+    std::optional<std::uint32_t> latest;
+    // Scratch space reused by every decode
+    WorldSnapshot decoded;
+    std::vector<QuantizedEntity> changed;
+    std::vector<std::uint32_t> removed;
+};
+
+#endif // DIDDLEDOODLEDUEL_SNAPSHOT_CODEC_H
@@ -0,0 +1,458 @@
+#include "netcode/udp_transport.h"
+#include "netcode/bit_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Datagram layout, bit-packed with BitWriter:
+//   u8 protocol id, u16 sequence, bool has ack, u16 ack, u16 ack bits (ack - 1 .. ack - 16)
+//   u32 base tick, compact zigzag (sender's confirmed tick - base tick)
+//   u6 range count, per range: u5 player, compact (first tick - base tick), u6 tick count,
+//   then 2 bits per tick (rotate left, rotate right)
+// Compact values are a flag bit and then either a few bits or the full 32.
+
+namespace {
+
+constexpr std::uint8_t kProtocolId = 0xDD;
+constexpr std::size_t kMaxPlayers = 32;
+constexpr std::size_t kMaxRangeTicks = 63;
+constexpr std::size_t kMaxDatagramSize = 512;
+constexpr std::size_t kBatchSize = 32;
+constexpr std::uint32_t kAckBits = 16;
+// Datagrams sent since one that still has no ack, before it counts as lost
+constexpr std::uint16_t kLossAge = 2 * (kAckBits + 1);
+
+void writeCompact(BitWriter& writer, const std::uint32_t value, const unsigned smallBits) {
+    const bool small = value < (1U << smallBits);
+    writer.writeBool(small);
+    writer.write(value, small ? smallBits : 32);
+}
+
+std::uint32_t readCompact(BitReader& reader, const unsigned smallBits) {
+    return static_cast<std::uint32_t>(reader.read(reader.readBool() ? smallBits : 32));
+}
+
+std::uint32_t zigzag(const std::int32_t value) {
+    return (static_cast<std::uint32_t>(value) << 1U) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+std::int32_t unzigzag(const std::uint32_t value) {
+    return static_cast<std::int32_t>(value >> 1U) ^ -static_cast<std::int32_t>(value & 1U);
+}
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle kInvalidSocket = INVALID_SOCKET;
+
+void closeSocket(const SocketHandle socketHandle) {
+    closesocket(socketHandle);
+}
+
+bool startSockets() {
+    static const bool started = [] {
+        WSADATA data {};
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+
+bool makeNonBlocking(const SocketHandle socketHandle) {
+    u_long enabled = 1;
+    return ioctlsocket(socketHandle, FIONBIO, &enabled) == 0;
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle kInvalidSocket = -1;
+
+void closeSocket(const SocketHandle socketHandle) {
+    ::close(socketHandle);
+}
+
+bool startSockets() {
+    return true;
+}
+
+bool makeNonBlocking(const SocketHandle socketHandle) {
+    const int flags = ::fcntl(socketHandle, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(socketHandle, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+#endif
+
+sockaddr_in loopbackAddress(const std::uint16_t port) {
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    return address;
+}
+
+SocketHandle toSocket(const std::intptr_t handle) {
+    return static_cast<SocketHandle>(handle);
+}
+
+} // namespace
+
+std::expected<std::unique_ptr<UdpTransport>, std::string>
+UdpTransport::open(const UdpTransportOptions& options) {
+    if (!startSockets()) {
+        return std::unexpected("could not start the socket library");
+    }
+
+    const SocketHandle socketHandle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socketHandle == kInvalidSocket) {
+        return std::unexpected("could not create a UDP socket");
+    }
+
+    sockaddr_in address = loopbackAddress(options.port);
+    socklen_t length = sizeof(address);
+    if (!makeNonBlocking(socketHandle) ||
+        ::bind(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::getsockname(socketHandle, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        closeSocket(socketHandle);
+        return std::unexpected("could not bind 127.0.0.1:" + std::to_string(options.port));
+    }
+
+    return std::unique_ptr<UdpTransport>(new UdpTransport(
+        static_cast<std::intptr_t>(socketHandle), ntohs(address.sin_port), options));
+}
+
+UdpTransport::UdpTransport(const std::intptr_t socketHandle, const std::uint16_t port,
+                           const UdpTransportOptions& options)
+    : socketHandle(socketHandle), port(port), options(options), pending(kMaxPlayers),
+      random(options.conditions.seed) {
+}
+
+UdpTransport::~UdpTransport() {
+    closeSocket(toSocket(socketHandle));
+}
+
+std::size_t UdpTransport::addPeer(const std::uint16_t peerPort) {
+    Peer peer;
+    peer.address = INADDR_LOOPBACK;
+    peer.port = peerPort;
+    peers.push_back(peer);
+    return peers.size() - 1;
+}
+
+void UdpTransport::send(const InputPacket& packet) {
+    if (packet.player >= kMaxPlayers || packet.tickCount == 0) {
+        return;
+    }
+    ackTick = packet.ackTick;
+
+    // Merge with what is already waiting for the player when the ranges touch; otherwise the
+    // newer range wins and the session resends the rest
+    auto& [valid, firstTick, inputs] = pending[packet.player];
+    const std::uint32_t count = std::min<std::uint32_t>(packet.tickCount, InputPacket::kMaxTicks);
+    const std::uint32_t end = packet.firstTick + count;
+    const std::uint32_t pendingEnd = firstTick + static_cast<std::uint32_t>(inputs.size());
+    if (!valid || packet.firstTick > pendingEnd || end < firstTick) {
+        valid = true;
+        firstTick = packet.firstTick;
+        inputs.clear();
+    }
+    if (packet.firstTick < firstTick) {
+        inputs.insert(inputs.begin(), firstTick - packet.firstTick, InputAction {});
+        firstTick = packet.firstTick;
+    }
+    for (std::uint32_t offset = 0; offset < count; ++offset) {
+        const std::size_t index = packet.firstTick + offset - firstTick;
+        if (index < inputs.size()) {
+            inputs[index] = packet.inputs[offset];
+        } else {
+            inputs.push_back(packet.inputs[offset]);
+        }
+    }
+}
+
+bool UdpTransport::receive(InputPacket& packet) {
+    if (received.empty()) {
+        return false;
+    }
+    packet = received.front();
+    received.pop_front();
+    return true;
+}
+
+void UdpTransport::update(const Clock::time_point now) {
+    receiveDatagrams(now);
+
+    const bool hasInput = std::ranges::any_of(pending, &PendingInput::valid);
+    const bool ackDue = std::ranges::any_of(peers, &Peer::ackDue);
+    const std::chrono::duration<double> sinceLastSend = now - lastSend;
+    if ((hasInput || ackDue) && sinceLastSend.count() >= options.sendIntervalSeconds) {
+        queueDatagrams(now);
+        lastSend = now;
+    }
+    sendDueDatagrams(now);
+}
+
+void UdpTransport::receiveDatagrams(const Clock::time_point now) {
+    std::array<std::array<std::uint8_t, kMaxDatagramSize>, kBatchSize> buffers {};
+    std::array<sockaddr_in, kBatchSize> senders {};
+
+#ifdef __linux__
+    std::array<iovec, kBatchSize> vectors {};
+    std::array<mmsghdr, kBatchSize> messages {};
+    for (std::size_t index = 0; index < kBatchSize; ++index) {
+        vectors[index] = iovec{.iov_base = buffers[index].data(), .iov_len = kMaxDatagramSize};
+        messages[index].msg_hdr.msg_iov = &vectors[index];
+        messages[index].msg_hdr.msg_iovlen = 1;
+        messages[index].msg_hdr.msg_name = &senders[index];
+    }
+
+    for (;;) {
+        for (std::size_t index = 0; index < kBatchSize; ++index) {
+            messages[index].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        const int count = ::recvmmsg(toSocket(socketHandle), messages.data(), kBatchSize,
+                                     MSG_DONTWAIT, nullptr);
+        if (count <= 0) {
+            return;
+        }
+        for (std::size_t index = 0; index < static_cast<std::size_t>(count); ++index) {
+            readDatagram(ntohl(senders[index].sin_addr.s_addr), ntohs(senders[index].sin_port),
+                         buffers[index].data(), messages[index].msg_len, now);
+        }
+        if (static_cast<std::size_t>(count) < kBatchSize) {
+            return;
+        }
+    }
+#else
+    for (;;) {
+        socklen_t senderLength = sizeof(sockaddr_in);
+        const auto size = ::recvfrom(toSocket(socketHandle),
+                                     reinterpret_cast<char*>(buffers[0].data()),
+                                     static_cast<int>(kMaxDatagramSize), 0,
+                                     reinterpret_cast<sockaddr*>(&senders[0]), &senderLength);
+        if (size <= 0) {
+            return;
+        }
+        readDatagram(ntohl(senders[0].sin_addr.s_addr), ntohs(senders[0].sin_port),
+                     buffers[0].data(), static_cast<std::size_t>(size), now);
+    }
+#endif
+}
+
+void UdpTransport::readDatagram(const std::uint32_t address, const std::uint16_t fromPort,
+                                const std::uint8_t* data, const std::size_t size,
+                                const Clock::time_point now) {
+    const auto peer = std::ranges::find_if(peers, [&](const Peer& candidate) {
+        return candidate.address == address && candidate.port == fromPort;
+    });
+    if (peer == peers.end()) {
+        return;
+    }
+
+    BitReader reader({data, size});
+    if (reader.read(8) != kProtocolId) {
+        return;
+    }
+    const auto sequence = static_cast<std::uint16_t>(reader.read(16));
+    const bool hasAck = reader.readBool();
+    const auto ack = static_cast<std::uint16_t>(reader.read(16));
+    const auto ackBits = static_cast<std::uint32_t>(reader.read(kAckBits));
+    const auto baseTick = static_cast<std::uint32_t>(reader.read(32));
+    const auto peerAckTick =
+        static_cast<std::uint32_t>(baseTick + unzigzag(readCompact(reader, 8)));
+
+    // Decode fully before handing anything out, so a truncated datagram delivers nothing
+    const std::size_t firstPacket = received.size();
+    const auto rangeCount = static_cast<std::size_t>(reader.read(6));
+    for (std::size_t range = 0; range < rangeCount && !reader.hasOverflowed(); ++range) {
+        const auto player = static_cast<std::uint8_t>(reader.read(5));
+        const std::uint32_t firstTick = baseTick + readCompact(reader, 4);
+        const auto tickCount = static_cast<std::uint32_t>(reader.read(6));
+        for (std::uint32_t offset = 0; offset < tickCount; ++offset) {
+            if (offset % InputPacket::kMaxTicks == 0) {
+                received.push_back(InputPacket{
+                    .firstTick = firstTick + offset, .ackTick = peerAckTick, .player = player});
+            }
+            auto& packet = received.back();
+            packet.inputs[packet.tickCount++] =
+                InputAction{.rotateLeft = reader.readBool(), .rotateRight = reader.readBool()};
+        }
+    }
+    if (reader.hasOverflowed()) {
+        received.erase(received.begin() + static_cast<std::ptrdiff_t>(firstPacket), received.end());
+        return;
+    }
+
+    peer->stats.datagramsReceived++;
+    peer->stats.bytesReceived += size;
+    peer->ackDue = true;
+
+    // Remember what arrived, for the ack bits sent back
+    const auto newer = static_cast<std::int16_t>(sequence - peer->remoteSequence);
+    if (!peer->hasReceived) {
+        peer->hasReceived = true;
+        peer->remoteSequence = sequence;
+        peer->receivedBits = 0;
+    } else if (newer > 0) {
+        peer->receivedBits = newer >= 32 ? 0 : (peer->receivedBits << newer) | (1U << (newer - 1));
+        peer->remoteSequence = sequence;
+    } else if (newer < 0 && newer >= -32) {
+        peer->receivedBits |= 1U << (-newer - 1);
+    }
+
+    if (!hasAck) {
+        return;
+    }
+    const auto acknowledge = [&](const std::uint16_t acked, const bool sampleRtt) {
+        auto& record = peer->sent[acked % peer->sent.size()];
+        if (!record.pending || record.sequence != acked) {
+            return;
+        }
+        record.pending = false;
+        if (!sampleRtt) {
+            return;
+        }
+        // Smoothed as in TCP (RFC 6298)
+        const double sample = std::chrono::duration<double>(now - record.time).count();
+        auto& stats = peer->stats;
+        if (!peer->hasRtt) {
+            stats.rttSeconds = sample;
+            stats.jitterSeconds = sample * 0.5;
+            peer->hasRtt = true;
+        } else {
+            stats.jitterSeconds =
+                (0.75 * stats.jitterSeconds) + (0.25 * std::abs(stats.rttSeconds - sample));
+            stats.rttSeconds = (0.875 * stats.rttSeconds) + (0.125 * sample);
+        }
+    };
+    acknowledge(ack, true);
+    for (std::uint32_t bit = 0; bit < kAckBits; ++bit) {
+        if ((ackBits & (1U << bit)) != 0) {
+            acknowledge(static_cast<std::uint16_t>(ack - 1 - bit), false);
+        }
+    }
+}
+
+void UdpTransport::queueDatagrams(const Clock::time_point now) {
+    std::uint32_t baseTick = ackTick;
+    std::size_t rangeCount = 0;
+    for (const auto& [valid, firstTick, inputs] : pending) {
+        if (valid) {
+            baseTick = rangeCount == 0 ? firstTick : std::min(baseTick, firstTick);
+            ++rangeCount;
+        }
+    }
+
+    // Everything but the header is the same for every peer
+    std::vector<std::uint8_t> body;
+    BitWriter bodyWriter(body);
+    bodyWriter.write(baseTick, 32);
+    writeCompact(bodyWriter, zigzag(static_cast<std::int32_t>(ackTick - baseTick)), 8);
+    bodyWriter.write(rangeCount, 6);
+    for (std::size_t player = 0; player < pending.size(); ++player) {
+        auto& [valid, firstTick, inputs] = pending[player];
+        if (!valid) {
+            continue;
+        }
+        // Oldest ticks first: those are what the peer is waiting for
+        const std::size_t tickCount = std::min(inputs.size(), kMaxRangeTicks);
+        bodyWriter.write(player, 5);
+        writeCompact(bodyWriter, firstTick - baseTick, 4);
+        bodyWriter.write(tickCount, 6);
+        for (std::size_t tick = 0; tick < tickCount; ++tick) {
+            bodyWriter.writeBool(inputs[tick].rotateLeft);
+            bodyWriter.writeBool(inputs[tick].rotateRight);
+        }
+        valid = false;
+        inputs.clear();
+    }
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto& conditions = options.conditions;
+    for (std::size_t index = 0; index < peers.size(); ++index) {
+        Peer& peer = peers[index];
+        const std::uint16_t sequence = peer.nextSequence++;
+        // Acks only reach kAckBits back, so anything this old that is still pending was lost
+        const auto expiredSequence = static_cast<std::uint16_t>(sequence - kLossAge);
+        auto& expired = peer.sent[expiredSequence % peer.sent.size()];
+        if (expired.pending) {
+            expired.pending = false;
+            ++peer.stats.datagramsLost;
+        }
+        peer.sent[sequence % peer.sent.size()] =
+            SentDatagram{.sequence = sequence, .time = now, .pending = true};
+        peer.ackDue = false;
+
+        std::vector<std::uint8_t> bytes;
+        BitWriter writer(bytes);
+        writer.write(kProtocolId, 8);
+        writer.write(sequence, 16);
+        writer.writeBool(peer.hasReceived);
+        writer.write(peer.remoteSequence, 16);
+        writer.write(peer.receivedBits, kAckBits);
+        const std::size_t bodyBits = bodyWriter.getBitCount();
+        for (std::size_t bit = 0; bit < bodyBits; bit += 8) {
+            const auto bits = static_cast<unsigned>(std::min<std::size_t>(8, bodyBits - bit));
+            writer.write(body[bit / 8], bits);
+        }
+
+        peer.stats.datagramsSent++;
+        peer.stats.bytesSent += bytes.size();
+        if (unit(random) < conditions.lossRate) {
+            continue;
+        }
+        const double delay = conditions.latencySeconds + (unit(random) * conditions.jitterSeconds);
+        outgoing.push_back(QueuedDatagram{
+            .sendAt = now + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(delay)),
+            .peer = index,
+            .bytes = std::move(bytes)});
+    }
+}
+
+void UdpTransport::sendDueDatagrams(const Clock::time_point now) {
+    const auto firstLater = std::ranges::stable_partition(
+        outgoing, [&](const QueuedDatagram& datagram) { return datagram.sendAt <= now; });
+    const std::span<QueuedDatagram> due(outgoing.begin(), firstLater.begin());
+
+    for (std::size_t start = 0; start < due.size(); start += kBatchSize) {
+        const std::size_t count = std::min(kBatchSize, due.size() - start);
+        std::array<sockaddr_in, kBatchSize> addresses {};
+        for (std::size_t index = 0; index < count; ++index) {
+            addresses[index] = loopbackAddress(peers[due[start + index].peer].port);
+        }
+
+#ifdef __linux__
+        std::array<iovec, kBatchSize> vectors {};
+        std::array<mmsghdr, kBatchSize> messages {};
+        for (std::size_t index = 0; index < count; ++index) {
+            auto& bytes = due[start + index].bytes;
+            vectors[index] = iovec{.iov_base = bytes.data(), .iov_len = bytes.size()};
+            messages[index].msg_hdr.msg_iov = &vectors[index];
+            messages[index].msg_hdr.msg_iovlen = 1;
+            messages[index].msg_hdr.msg_name = &addresses[index];
+            messages[index].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        // A full socket buffer drops datagrams, like the network would
+        ::sendmmsg(toSocket(socketHandle), messages.data(), static_cast<unsigned>(count),
+                   MSG_DONTWAIT);
+#else
+        for (std::size_t index = 0; index < count; ++index) {
+            const auto& bytes = due[start + index].bytes;
+            ::sendto(toSocket(socketHandle), reinterpret_cast<const char*>(bytes.data()),
+                     static_cast<int>(bytes.size()), 0,
+                     reinterpret_cast<const sockaddr*>(&addresses[index]), sizeof(sockaddr_in));
+        }
+#endif
+    }
+    outgoing.erase(outgoing.begin(), firstLater.begin());
+}
@@ -0,0 +1,125 @@
+#ifndef DIDDLEDOODLEDUEL_UDP_TRANSPORT_H
+#define DIDDLEDOODLEDUEL_UDP_TRANSPORT_H
+#include "netcode/input_transport.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Conditions simulated on outgoing datagrams, so loss and latency can be tested on loopback
+struct NetworkConditions {
+    float lossRate {0.0F};       // Fraction of datagrams dropped
+    double latencySeconds {0.0}; // Added one-way delay
+    double jitterSeconds {0.0};  // Random extra delay of up to this much
+    std::uint32_t seed {1};
+};
+
+struct UdpTransportOptions {
+    std::uint16_t port {0};            // 0 picks a free port
+    double sendIntervalSeconds {0.05}; // Input is batched into one datagram per peer per interval
+    NetworkConditions conditions;
+};
+
+struct PeerStats {
+    double rttSeconds {0.0};    // Smoothed, including up to one send interval of ack delay
+    double jitterSeconds {0.0}; // Smoothed mean deviation of the round trip time
+    std::uint64_t datagramsSent {0};
+    std::uint64_t datagramsReceived {0};
+    std::uint64_t datagramsLost {0}; // Sent datagrams the peer never acknowledged
+    std::uint64_t bytesSent {0};     // UDP payload bytes
+    std::uint64_t bytesReceived {0};
+};
+
+// Non-blocking UDP transport on 127.0.0.1. Input handed to send() is merged per player and
+// bit-packed into one datagram per peer every send interval; the session repeats every tick a
+// peer has not acknowledged, so each datagram carries that redundant history and a lost one
+// costs nothing but latency. Datagram headers carry sequence numbers and an ack bitfield, which
+// give each peer's round trip time, jitter and loss. Sends and receives are batched with
+// sendmmsg/recvmmsg where available.
+class UdpTransport final : public IInputTransport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static std::expected<std::unique_ptr<UdpTransport>, std::string>
+    open(const UdpTransportOptions& options);
+    ~UdpTransport() override;
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    // Adds the peer listening on port of 127.0.0.1 and returns its index
+    std::size_t addPeer(std::uint16_t port);
+
+    [[nodiscard]] std::uint16_t getPort() const { return port; }
+    [[nodiscard]] std::size_t getPeerCount() const { return peers.size(); }
+    [[nodiscard]] const PeerStats& getPeerStats(const std::size_t peer) const {
+        return peers[peer].stats;
+    }
+
+    void send(const InputPacket& packet) override;
+    bool receive(InputPacket& packet) override;
+
+    // Takes in every datagram that arrived and sends the batched input once the send interval
+    // has passed. Call once per frame, after the session advanced.
+    void update(Clock::time_point now);
+
+private:
+    struct SentDatagram {
+        std::uint16_t sequence {0};
+        Clock::time_point time;
+        bool pending {false};
+    };
+
+    struct Peer {
+        std::uint32_t address {0}; // IPv4, host byte order
+        std::uint16_t port {0};
+        std::uint16_t nextSequence {0};
+        std::array<SentDatagram, 256> sent {};
+        bool hasReceived {false};
+        std::uint16_t remoteSequence {0}; // Newest sequence received from the peer
+        std::uint32_t receivedBits {0};   // Bit i: remoteSequence - 1 - i was received too
+        bool ackDue {false};
+        bool hasRtt {false};
+        PeerStats stats;
+    };
+
+    // One player's input for consecutive ticks, merged from every send() since the last datagram
+    struct PendingInput {
+        bool valid {false};
+        std::uint32_t firstTick {0};
+        std::vector<InputAction> inputs;
+    };
+
+    struct QueuedDatagram {
+        Clock::time_point sendAt;
+        std::size_t peer;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    std::intptr_t socketHandle;
+    std::uint16_t port;
+    UdpTransportOptions options;
+    std::vector<Peer> peers;
+    std::vector<PendingInput> pending;
+    std::uint32_t ackTick {0};
+    std::deque<InputPacket> received;
+    std::vector<QueuedDatagram> outgoing;
+    std::minstd_rand random;
+    Clock::time_point lastSend;
+
+    UdpTransport(std::intptr_t socketHandle, std::uint16_t port, const UdpTransportOptions& options);
+
+    void receiveDatagrams(Clock::time_point now);
+    void readDatagram(std::uint32_t address, std::uint16_t fromPort, const std::uint8_t* data,
+                      std::size_t size, Clock::time_point now);
+    void queueDatagrams(Clock::time_point now);
+    void sendDueDatagrams(Clock::time_point now);
+};
+
+#endif // DIDDLEDOODLEDUEL_UDP_TRANSPORT_H
@@ -1,59 +1,544 @@
 #ifndef DIDDLEDOODLEDUEL_PROFILER_H
 #define DIDDLEDOODLEDUEL_PROFILER_H
 
+#include "logging/logger.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <string>
-#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ProfileScopeId = std::uint16_t;
+
+struct ProfileStats {
+    std::uint32_t frames {0}; // Frames in the history window in which the scope ran
+    double callsPerFrame {0.0};
+    double minMicros {0.0};
+    double avgMicros {0.0};
+    double p50Micros {0.0};
+    double p95Micros {0.0};
+    double p99Micros {0.0};
+    double maxMicros {0.0};
+};
+
+// One timed scope in a trace capture
+struct TraceEvent {
+    std::uint64_t startNanoseconds;
+    std::uint32_t durationNanoseconds;
+    ProfileScopeId id;
+};
 
-class SimpleProfiler {
+// Samples recorded by one thread. The owning thread accumulates scope times for the current
+// frame without locking; when it notices the frame has moved on it commits the totals to a
+// fixed-size ring per scope under a mutex that only reports ever contend for.
+class ThreadProfile {
 public:
-    static SimpleProfiler& getInstance() {
-        static SimpleProfiler instance;
+    static constexpr std::size_t kMaxScopes = 128;
+    static constexpr std::size_t kFrameHistory = 256;
+    static constexpr std::size_t kMaxDepth = 32;
+    static constexpr std::size_t kTraceCapacity = 1 << 16;
+    static constexpr ProfileScopeId kNoParent = 0xFFFF;
+
+    explicit ThreadProfile(const std::uint32_t threadIndex) : threadIndex(threadIndex) {
+        for (auto& parent : parentOf) {
+            parent.store(kNoParent, std::memory_order_relaxed);
+        }
+        seenParent.fill(false);
+    }
+
+    void enter(const ProfileScopeId id) {
+        if (depth < kMaxDepth) {
+            const ProfileScopeId parent = depth > 0 ? stack[depth - 1] : kNoParent;
+            if (!seenParent[id]) {
+                parentOf[id].store(parent, std::memory_order_relaxed);
+                seenParent[id] = true;
+            }
+            stack[depth] = id;
+        }
+        ++depth;
+    }
+
+    void exit(const ProfileScopeId id, const std::uint64_t nanoseconds, const std::uint64_t frame) {
+        --depth;
+        recordSample(id, nanoseconds, frame);
+    }
+
+    // Adds time to a scope without touching the nesting stack
+    void recordSample(const ProfileScopeId id, const std::uint64_t nanoseconds, const std::uint64_t frame) {
+        if (frame != currentFrame) {
+            commit(frame);
+        }
+
+        auto& [totalNanoseconds, calls] = pending[id];
+        if (calls == 0) {
+            touched[touchedCount++] = id;
+        }
+        totalNanoseconds += nanoseconds;
+        ++calls;
+    }
+
+    // Appends to this thread's trace buffer. A new capture generation restarts the buffer, which
+    // is allocated the first time this thread takes part in a capture.
+    void recordTraceEvent(const TraceEvent& event, const std::uint32_t generation) {
+        if (generation != traceGeneration.load(std::memory_order_relaxed)) {
+            if (!traceEvents) {
+                traceEvents = std::make_unique<TraceEvent[]>(kTraceCapacity);
+            }
+            traceCount.store(0, std::memory_order_relaxed);
+            traceGeneration.store(generation, std::memory_order_release);
+        }
+
+        if (const std::size_t count = traceCount.load(std::memory_order_relaxed); count < kTraceCapacity) {
+            traceEvents[count] = event;
+            traceCount.store(count + 1, std::memory_order_release);
+        }
+    }
+
+    // Events recorded so far in the given capture; safe to call from any thread
+    [[nodiscard]] std::span<const TraceEvent> getTraceEvents(const std::uint32_t generation) const {
+        if (traceGeneration.load(std::memory_order_acquire) != generation) {
+            return {};
+        }
+        return {traceEvents.get(), traceCount.load(std::memory_order_acquire)};
+    }
+
+    // Moves this frame's totals into the history rings; only called by the owning thread
+    void commit(const std::uint64_t nextFrame) {
+        {
+            const std::scoped_lock lock(historyMutex);
+            for (std::size_t i = 0; i < touchedCount; ++i) {
+                const ProfileScopeId id = touched[i];
+                auto& ring = history[id];
+                ring.nanoseconds[ring.head] = static_cast<std::uint32_t>(
+                    std::min<std::uint64_t>(pending[id].totalNanoseconds, UINT32_MAX));
+                ring.calls[ring.head] = pending[id].calls;
+                ring.head = (ring.head + 1) % kFrameHistory;
+                ring.count = std::min(ring.count + 1, kFrameHistory);
+                pending[id] = {};
+            }
+        }
+        touchedCount = 0;
+        currentFrame = nextFrame;
+    }
+
+    void clearHistory() {
+        const std::scoped_lock lock(historyMutex);
+        for (auto& ring : history) {
+            ring.head = 0;
+            ring.count = 0;
+        }
+    }
+
+    [[nodiscard]] ProfileStats getStats(const ProfileScopeId id) const {
+        std::array<std::uint32_t, kFrameHistory> sorted {};
+        ProfileStats stats;
+        std::uint64_t totalCalls = 0;
+        {
+            const std::scoped_lock lock(historyMutex);
+            const auto& ring = history[id];
+            stats.frames = static_cast<std::uint32_t>(ring.count);
+            for (std::size_t i = 0; i < ring.count; ++i) {
+                sorted[i] = ring.nanoseconds[i];
+                totalCalls += ring.calls[i];
+            }
+        }
+        if (stats.frames == 0) {
+            return stats;
+        }
+
+        const auto samples = std::span(sorted).first(stats.frames);
+        std::ranges::sort(samples);
+        std::uint64_t totalNanoseconds = 0;
+        for (const auto sample : samples) {
+            totalNanoseconds += sample;
+        }
+
+        // Nearest-rank percentiles
+        const auto percentile = [&](const double fraction) {
+            const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+            return static_cast<double>(samples[std::max<std::size_t>(rank, 1) - 1]) / 1000.0;
+        };
+
+        stats.callsPerFrame = static_cast<double>(totalCalls) / stats.frames;
+        stats.minMicros = static_cast<double>(samples.front()) / 1000.0;
+        stats.avgMicros = static_cast<double>(totalNanoseconds) / stats.frames / 1000.0;
+        stats.p50Micros = percentile(0.50);
+        stats.p95Micros = percentile(0.95);
+        stats.p99Micros = percentile(0.99);
+        stats.maxMicros = static_cast<double>(samples.back()) / 1000.0;
+        return stats;
+    }
+
+    // Safe to call from any thread while the owner is profiling
+    [[nodiscard]] ProfileScopeId getParent(const ProfileScopeId id) const {
+        return parentOf[id].load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::uint32_t getThreadIndex() const { return threadIndex; }
+
+private:
+    struct PendingFrame {
+        std::uint64_t totalNanoseconds {0};
+        std::uint32_t calls {0};
+    };
+
+    struct FrameRing {
+        std::array<std::uint32_t, kFrameHistory> nanoseconds {};
+        std::array<std::uint32_t, kFrameHistory> calls {};
+        std::size_t head {0};
+        std::size_t count {0};
+    };
+
+    std::uint32_t threadIndex;
+    std::uint64_t currentFrame {0};
+
+    // Owner-only state
+    std::array<ProfileScopeId, kMaxDepth> stack {};
+    std::size_t depth {0};
+    std::array<bool, kMaxScopes> seenParent {};
+    std::array<PendingFrame, kMaxScopes> pending {};
+    std::array<ProfileScopeId, kMaxScopes> touched {};
+    std::size_t touchedCount {0};
+
+    // Written once per scope by the owner, read by reports; each link stands alone, so relaxed
+    std::array<std::atomic<ProfileScopeId>, kMaxScopes> parentOf {};
+
+    mutable std::mutex historyMutex;
+    std::array<FrameRing, kMaxScopes> history {};
+
+    std::unique_ptr<TraceEvent[]> traceEvents;
+    std::atomic<std::size_t> traceCount {0};
+    std::atomic<std::uint32_t> traceGeneration {0};
+};
+
+// Process-wide scope registry and frame clock. Scope names are interned once per call site, so
+// recording a scope is two clock reads and a few array writes into thread-local storage: no
+// strings, hashing, allocation or locks.
+class ScopeProfiler {
+public:
+    static ScopeProfiler& getInstance() {
+        static ScopeProfiler instance;
         return instance;
     }
 
-    void startTimer(const std::string& name) {
-        timers[name] = std::chrono::high_resolution_clock::now();
+    // Same name, same id. Names must outlive the profiler; PROFILE_SCOPE passes literals.
+    ProfileScopeId intern(const char* name) {
+        const std::scoped_lock lock(registryMutex);
+        for (std::size_t id = 0; id < scopeCount; ++id) {
+            if (std::strcmp(names[id], name) == 0) {
+                return static_cast<ProfileScopeId>(id);
+            }
+        }
+        if (scopeCount == ThreadProfile::kMaxScopes) {
+            // Out of ids: fold the rest into the last slot rather than fail
+            names[scopeCount - 1] = "<other>";
+            return static_cast<ProfileScopeId>(scopeCount - 1);
+        }
+        names[scopeCount] = name;
+        return static_cast<ProfileScopeId>(scopeCount++);
     }
 
-    void endTimer(const std::string& name) {
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto it = timers.find(name);
-        if (it != timers.end()) {
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - it->second);
-            totalTimes[name] += duration.count();
-            callCounts[name]++;
+    // Closes the current frame and records it as a FullFrame scope. Call once per frame from
+    // the thread that drives the frame.
+    void endFrame() {
+        const std::uint64_t currentFrame = frame.load(std::memory_order_relaxed);
+        const std::uint64_t now = nowNanoseconds();
+        ThreadProfile& profile = threadProfile();
+
+        if (lastFrameEnd != 0) {
+            const std::uint64_t duration = now - lastFrameEnd;
+            profile.recordSample(fullFrameId, duration, currentFrame);
+            if (isCapturing(currentFrame)) {
+                profile.recordTraceEvent(
+                    TraceEvent{.startNanoseconds = lastFrameEnd,
+                               .durationNanoseconds = clampDuration(duration),
+                               .id = fullFrameId},
+                    captureGeneration.load(std::memory_order_relaxed));
+            }
+        }
+        lastFrameEnd = now;
+
+        profile.commit(currentFrame + 1);
+        frame.store(currentFrame + 1, std::memory_order_relaxed);
+
+        if (currentFrame + 1 == captureEndFrame.load(std::memory_order_relaxed)) {
+            finishCapture();
         }
     }
 
-    void printResults() const {
-        std::cout << "\n=== Performance Profile ===\n";
-        for (const auto& [name, totalTime] : totalTimes) {
-            auto avgTime = totalTime / static_cast<double>(callCounts.at(name));
-            std::cout << name << ": " << avgTime << "μs avg (" 
-                     << callCounts.at(name) << " calls)\n";
+    [[nodiscard]] std::uint64_t getFrame() const { return frame.load(std::memory_order_relaxed); }
+
+    // Records every scope on every thread for the next frameCount frames, then writes them to
+    // path as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev) on a background thread.
+    // Restarts a capture already in progress.
+    void requestCapture(const std::uint32_t frameCount, std::string path) {
+        // The next capture reuses the trace buffers the last one may still be writing out
+        waitForCapture();
+        const std::scoped_lock lock(registryMutex);
+        capturePath = std::move(path);
+        captureGeneration.fetch_add(1, std::memory_order_relaxed);
+        const std::uint64_t firstFrame = frame.load(std::memory_order_relaxed) + 1;
+        captureFirstFrame.store(firstFrame, std::memory_order_relaxed);
+        captureEndFrame.store(firstFrame + frameCount, std::memory_order_relaxed);
+        LOG_INFO_MSG("Capturing a trace of " + std::to_string(frameCount) + " frames to " +
+                     capturePath);
+    }
+
+    // Blocks until a finished capture is on disk. Call before exit so the trace is complete.
+    void waitForCapture() {
+        const std::scoped_lock lock(writerMutex);
+        if (traceWriter.joinable()) {
+            traceWriter.join();
+        }
+    }
+
+    [[nodiscard]] bool isCapturing(const std::uint64_t atFrame) const {
+        return atFrame >= captureFirstFrame.load(std::memory_order_relaxed) &&
+               atFrame < captureEndFrame.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint32_t getCaptureGeneration() const {
+        return captureGeneration.load(std::memory_order_relaxed);
+    }
+
+    // Writes the events of the current capture recorded so far
+    void writeChromeTrace(std::ostream& out) const {
+        writeChromeTrace(out, captureGeneration.load(std::memory_order_relaxed));
+    }
+
+    // The calling thread's sample storage, registered on first use
+    ThreadProfile& threadProfile() {
+        thread_local ThreadProfile* profile = registerThread();
+        return *profile;
+    }
+
+    [[nodiscard]] ProfileStats getStats(const ProfileScopeId id, const std::uint32_t threadIndex = 0) const {
+        const std::scoped_lock lock(registryMutex);
+        return threadIndex < threads.size() ? threads[threadIndex]->getStats(id) : ProfileStats{};
+    }
+
+    void printResults(std::ostream& out = std::cout) const {
+        const std::scoped_lock lock(registryMutex);
+        out << "\n=== Performance Profile (last " << ThreadProfile::kFrameHistory
+            << " frames, microseconds) ===\n";
+        out << std::fixed << std::setprecision(1);
+        for (const auto& thread : threads) {
+            std::array<ProfileStats, ThreadProfile::kMaxScopes> stats {};
+            bool anySamples = false;
+            for (std::size_t id = 0; id < scopeCount; ++id) {
+                stats[id] = thread->getStats(static_cast<ProfileScopeId>(id));
+                anySamples = anySamples || stats[id].frames > 0;
+            }
+            if (!anySamples) {
+                continue;
+            }
+
+            out << "Thread " << thread->getThreadIndex() << "\n";
+            std::array<bool, ThreadProfile::kMaxScopes> printed {};
+            for (std::size_t id = 0; id < scopeCount; ++id) {
+                if (thread->getParent(static_cast<ProfileScopeId>(id)) == ThreadProfile::kNoParent) {
+                    printTree(out, *thread, stats, printed, static_cast<ProfileScopeId>(id), 1);
+                }
+            }
+            // Scopes only ever seen below the depth limit or in a cycle
+            for (std::size_t id = 0; id < scopeCount; ++id) {
+                printTree(out, *thread, stats, printed, static_cast<ProfileScopeId>(id), 1);
+            }
         }
-        std::cout << "===========================\n\n";
+        out << std::defaultfloat << "===========================\n\n";
+    }
+
+    static std::uint64_t nowNanoseconds() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    static std::uint32_t clampDuration(const std::uint64_t nanoseconds) {
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(nanoseconds, UINT32_MAX));
     }
 
     void reset() {
-        totalTimes.clear();
-        callCounts.clear();
-        timers.clear();
+        const std::scoped_lock lock(registryMutex);
+        for (const auto& thread : threads) {
+            thread->clearHistory();
+        }
+    }
+
+private:
+    mutable std::mutex registryMutex;
+    std::array<const char*, ThreadProfile::kMaxScopes> names {};
+    std::size_t scopeCount {0};
+    std::vector<std::unique_ptr<ThreadProfile>> threads;
+    std::atomic<std::uint64_t> frame {0};
+    ProfileScopeId fullFrameId;
+    std::uint64_t lastFrameEnd {0};
+
+    std::string capturePath;
+    std::atomic<std::uint32_t> captureGeneration {0};
+    std::atomic<std::uint64_t> captureFirstFrame {0};
+    std::atomic<std::uint64_t> captureEndFrame {0};
+
+    std::mutex writerMutex;
+    std::thread traceWriter; // Writes out the last finished capture
+
+    ScopeProfiler() : fullFrameId(intern("FullFrame")) {}
+
+    ~ScopeProfiler() { waitForCapture(); }
+
+    // Hands the capture to the writer thread, so the frame that ends it isn't held up by the file.
+    // Its events stay put until the next requestCapture, which waits for the writer first.
+    void finishCapture() {
+        std::string path;
+        {
+            const std::scoped_lock lock(registryMutex);
+            path = capturePath;
+        }
+
+        const std::uint32_t generation = captureGeneration.load(std::memory_order_relaxed);
+        const std::scoped_lock lock(writerMutex);
+        if (traceWriter.joinable()) {
+            traceWriter.join();
+        }
+        traceWriter = std::thread([this, generation, path = std::move(path)] {
+            if (std::ofstream file(path); file) {
+                writeChromeTrace(file, generation);
+                LOG_INFO_MSG("Wrote trace to " + path);
+            } else {
+                LOG_ERROR_MSG("Could not write trace to " + path);
+            }
+        });
+    }
+
+    // Scope names and thread storage are only ever appended, so the lock is held just long
+    // enough to list them and writing doesn't stall threads registering or interning meanwhile
+    void writeChromeTrace(std::ostream& out, const std::uint32_t generation) const {
+        std::vector<const ThreadProfile*> traced;
+        std::array<const char*, ThreadProfile::kMaxScopes> scopeNames {};
+        {
+            const std::scoped_lock lock(registryMutex);
+            for (const auto& thread : threads) {
+                traced.push_back(thread.get());
+            }
+            scopeNames = names;
+        }
+
+        std::uint64_t origin = UINT64_MAX;
+        for (const ThreadProfile* thread : traced) {
+            for (const auto& event : thread->getTraceEvents(generation)) {
+                origin = std::min(origin, event.startNanoseconds);
+            }
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        const auto separator = [&] {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+
+        out << std::fixed << std::setprecision(3);
+        for (const ThreadProfile* thread : traced) {
+            const auto events = thread->getTraceEvents(generation);
+            if (events.empty()) {
+                continue;
+            }
+
+            const std::uint32_t tid = thread->getThreadIndex();
+            separator();
+            out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+                << R"(,"args":{"name":"Thread )" << tid << "\"}}";
+            for (const auto& [start, duration, id] : events) {
+                separator();
+                out << R"({"name":")" << scopeNames[id] << R"(","cat":"scope","ph":"X","ts":)"
+                    << static_cast<double>(start - origin) / 1000.0
+                    << ",\"dur\":" << static_cast<double>(duration) / 1000.0
+                    << ",\"pid\":1,\"tid\":" << tid << "}";
+            }
+        }
+        out << std::defaultfloat << "\n]}\n";
+    }
+
+    ThreadProfile* registerThread() {
+        const std::scoped_lock lock(registryMutex);
+        threads.push_back(std::make_unique<ThreadProfile>(static_cast<std::uint32_t>(threads.size())));
+        return threads.back().get();
+    }
+
+    void printTree(std::ostream& out, const ThreadProfile& thread,
+                   const std::array<ProfileStats, ThreadProfile::kMaxScopes>& stats,
+                   std::array<bool, ThreadProfile::kMaxScopes>& printed, const ProfileScopeId id,
+                   const int indent) const {
+        if (printed[id]) {
+            return;
+        }
+        printed[id] = true;
+
+        if (const auto& scope = stats[id]; scope.frames > 0) {
+            out << std::string(static_cast<std::size_t>(indent) * 2, ' ') << names[id] << ": min "
+                << scope.minMicros << " avg " << scope.avgMicros << " p50 " << scope.p50Micros
+                << " p95 " << scope.p95Micros << " p99 " << scope.p99Micros << " ("
+                << scope.callsPerFrame << " calls/frame)\n";
+        }
+        for (std::size_t child = 0; child < scopeCount; ++child) {
+            if (child != id && thread.getParent(static_cast<ProfileScopeId>(child)) == id) {
+                printTree(out, thread, stats, printed, static_cast<ProfileScopeId>(child), indent + 1);
+            }
+        }
     }
+};
+
+// Times the enclosing scope and records it under the scope that was open when it started
+class ProfileScope {
+public:
+    explicit ProfileScope(const ProfileScopeId id)
+        : profile(ScopeProfiler::getInstance().threadProfile()), id(id) {
+        profile.enter(id);
+        start = ScopeProfiler::nowNanoseconds();
+    }
+
+    ~ProfileScope() {
+        const std::uint64_t duration = ScopeProfiler::nowNanoseconds() - start;
+        const auto& profiler = ScopeProfiler::getInstance();
+        const std::uint64_t frame = profiler.getFrame();
+
+        profile.exit(id, duration, frame);
+        if (profiler.isCapturing(frame)) {
+            profile.recordTraceEvent(TraceEvent{.startNanoseconds = start,
+                                                .durationNanoseconds = ScopeProfiler::clampDuration(duration),
+                                                .id = id},
+                                     profiler.getCaptureGeneration());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
 
 private:
-    std::unordered_map<std::string, std::chrono::high_resolution_clock::time_point> timers;
-    std::unordered_map<std::string, long long> totalTimes;
-    std::unordered_map<std::string, int> callCounts;
+    ThreadProfile& profile;
+    ProfileScopeId id;
+    std::uint64_t start {0};
 };
 
-#define PROFILE_SCOPE(name) \
-    SimpleProfiler::getInstance().startTimer(name); \
-    auto scope_guard_##__LINE__ = [&]() { SimpleProfiler::getInstance().endTimer(name); }; \
-    (void)scope_guard_##__LINE__
+#define DDD_PROFILE_CONCAT_INNER(a, b) a##b
+#define DDD_PROFILE_CONCAT(a, b) DDD_PROFILE_CONCAT_INNER(a, b)
 
-#define PROFILE_END(name) SimpleProfiler::getInstance().endTimer(name)
+// Profiles from here to the end of the enclosing block. The name is interned on first use.
+#define PROFILE_SCOPE(name)                                                                        \
+    static const ProfileScopeId DDD_PROFILE_CONCAT(profileScopeId_, __LINE__) =                   \
+        ScopeProfiler::getInstance().intern(name);                                                 \
+    const ProfileScope DDD_PROFILE_CONCAT(profileScope_, __LINE__) {                               \
+        DDD_PROFILE_CONCAT(profileScopeId_, __LINE__)                                              \
+    }
 
-#endif // DIDDLEDOODLEDUEL_PROFILER_H
\ No newline at end of file
+#endif // DIDDLEDOODLEDUEL_PROFILER_H
@@ -0,0 +1,175 @@
+#ifndef DIDDLEDOODLEDUEL_CIRCLE_NARROWPHASE_H
+#define DIDDLEDOODLEDUEL_CIRCLE_NARROWPHASE_H
+#include "physics/narrowphase_backend.h"
+#include "physics/spatial_hash.h"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define DDD_NARROWPHASE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define DDD_NARROWPHASE_SSE2 1
+#endif
+
+// Structure-of-arrays copy of the brushes taking part in a collision pass
+struct CircleBodies {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> radius;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        radius.clear();
+    }
+
+    void push(const Vector2 position, const float bodyRadius) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+        radius.push_back(bodyRadius);
+    }
+
+    [[nodiscard]] std::size_t size() const { return x.size(); }
+};
+
+struct CircleContact {
+    std::uint32_t a;
+    std::uint32_t b;
+    Vector2 normal;    // From B towards A
+    float penetration; // How much the circles overlap
+};
+
+namespace narrowphase {
+
+// Squared-distance prefilter slack. It has to be conservative so the exact test below, which
+// mirrors PhysicsCollisionSystem::checkCollision, sees every pair the per-pair path would.
+inline constexpr float kSquaredRadiusSlack = 1.0F + 1.0e-5F;
+
+// Confirms a prefiltered pair with the same arithmetic as the per-pair path; this is the only
+// place a square root is taken.
+inline void confirmContact(const CircleBodies& bodies, const CandidatePair pair,
+                           std::vector<CircleContact>& contacts) {
+    const Vector2 delta = {bodies.x[pair.a] - bodies.x[pair.b], bodies.y[pair.a] - bodies.y[pair.b]};
+    const float distance = std::sqrt((delta.x * delta.x) + (delta.y * delta.y));
+    const float radiusSum = bodies.radius[pair.a] + bodies.radius[pair.b];
+
+    if (distance < radiusSum && distance > 0.0F) {
+        const float inverseDistance = 1.0F / distance;
+        contacts.push_back(CircleContact{.a = pair.a,
+                                         .b = pair.b,
+                                         .normal = {delta.x * inverseDistance, delta.y * inverseDistance},
+                                         .penetration = radiusSum - distance});
+    }
+}
+
+inline void testPairScalar(const CircleBodies& bodies, const CandidatePair pair,
+                           std::vector<CircleContact>& contacts) {
+    const float dx = bodies.x[pair.a] - bodies.x[pair.b];
+    const float dy = bodies.y[pair.a] - bodies.y[pair.b];
+    const float radiusSum = bodies.radius[pair.a] + bodies.radius[pair.b];
+    const float distanceSquared = (dx * dx) + (dy * dy);
+
+    if (distanceSquared < radiusSum * radiusSum * kSquaredRadiusSlack && distanceSquared > 0.0F) {
+        confirmContact(bodies, pair, contacts);
+    }
+}
+
+inline std::size_t findContactsSimd(const CircleBodies& bodies,
+                                    const std::span<const CandidatePair> pairs,
+                                    std::vector<CircleContact>& contacts) {
+    static_assert(sizeof(CandidatePair) == 2 * sizeof(std::uint32_t));
+    std::size_t first = 0;
+
+#if defined(DDD_NARROWPHASE_AVX2)
+    // 8 pairs per iteration: deinterleave (a, b) indices and gather both bodies
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256 slack = _mm256_set1_ps(kSquaredRadiusSlack);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; first + 8 <= pairs.size(); first += 8) {
+        const auto* pairData = reinterpret_cast<const __m256i*>(pairs.data() + first);
+        const __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(pairData), deinterleave);
+        const __m256i high =
+            _mm256_permutevar8x32_epi32(_mm256_loadu_si256(pairData + 1), deinterleave);
+        const __m256i indexA = _mm256_permute2x128_si256(low, high, 0x20);
+        const __m256i indexB = _mm256_permute2x128_si256(low, high, 0x31);
+
+        const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(bodies.x.data(), indexA, 4),
+                                        _mm256_i32gather_ps(bodies.x.data(), indexB, 4));
+        const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(bodies.y.data(), indexA, 4),
+                                        _mm256_i32gather_ps(bodies.y.data(), indexB, 4));
+        const __m256 radiusSum = _mm256_add_ps(_mm256_i32gather_ps(bodies.radius.data(), indexA, 4),
+                                               _mm256_i32gather_ps(bodies.radius.data(), indexB, 4));
+
+        const __m256 distanceSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const __m256 limit = _mm256_mul_ps(_mm256_mul_ps(radiusSum, radiusSum), slack);
+        const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(distanceSquared, limit, _CMP_LT_OQ),
+                                         _mm256_cmp_ps(distanceSquared, zero, _CMP_GT_OQ));
+
+        for (auto lanes = static_cast<unsigned>(_mm256_movemask_ps(hit)); lanes != 0;
+             lanes &= lanes - 1) {
+            confirmContact(bodies, pairs[first + static_cast<std::size_t>(std::countr_zero(lanes))],
+                           contacts);
+        }
+    }
+#elif defined(DDD_NARROWPHASE_SSE2)
+    // 4 pairs per iteration; SSE2 has no gather so lanes are loaded individually
+    const __m128 slack = _mm_set1_ps(kSquaredRadiusSlack);
+    const __m128 zero = _mm_setzero_ps();
+    const float* xs = bodies.x.data();
+    const float* ys = bodies.y.data();
+    const float* radii = bodies.radius.data();
+
+    for (; first + 4 <= pairs.size(); first += 4) {
+        const CandidatePair* p = pairs.data() + first;
+
+        const __m128 dx = _mm_sub_ps(_mm_setr_ps(xs[p[0].a], xs[p[1].a], xs[p[2].a], xs[p[3].a]),
+                                     _mm_setr_ps(xs[p[0].b], xs[p[1].b], xs[p[2].b], xs[p[3].b]));
+        const __m128 dy = _mm_sub_ps(_mm_setr_ps(ys[p[0].a], ys[p[1].a], ys[p[2].a], ys[p[3].a]),
+                                     _mm_setr_ps(ys[p[0].b], ys[p[1].b], ys[p[2].b], ys[p[3].b]));
+        const __m128 radiusSum =
+            _mm_add_ps(_mm_setr_ps(radii[p[0].a], radii[p[1].a], radii[p[2].a], radii[p[3].a]),
+                       _mm_setr_ps(radii[p[0].b], radii[p[1].b], radii[p[2].b], radii[p[3].b]));
+
+        const __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const __m128 limit = _mm_mul_ps(_mm_mul_ps(radiusSum, radiusSum), slack);
+        const __m128 hit =
+            _mm_and_ps(_mm_cmplt_ps(distanceSquared, limit), _mm_cmpgt_ps(distanceSquared, zero));
+
+        for (auto lanes = static_cast<unsigned>(_mm_movemask_ps(hit)); lanes != 0;
+             lanes &= lanes - 1) {
+            confirmContact(bodies, p[std::countr_zero(lanes)], contacts);
+        }
+    }
+#endif
+
+    return first;
+}
+
+} // namespace narrowphase
+
+// Tests every candidate pair and writes the overlapping ones, in candidate order, to contacts.
+// Both backends produce identical contact lists; Simd falls back to scalar on targets without
+// SSE2/AVX2 and for the tail of the batch.
+inline void findCircleContacts(const CircleBodies& bodies, const std::span<const CandidatePair> pairs,
+                               std::vector<CircleContact>& contacts,
+                               const NarrowphaseBackend backend) {
+    contacts.clear();
+
+    std::size_t first = 0;
+    if (backend == NarrowphaseBackend::Simd) {
+        first = narrowphase::findContactsSimd(bodies, pairs, contacts);
+    }
+
+    for (; first < pairs.size(); ++first) {
+        narrowphase::testPairScalar(bodies, pairs[first], contacts);
+    }
+}
+
+#endif // DIDDLEDOODLEDUEL_CIRCLE_NARROWPHASE_H
@@ -0,0 +1,10 @@
+#ifndef DIDDLEDOODLEDUEL_NARROWPHASE_BACKEND_H
+#define DIDDLEDOODLEDUEL_NARROWPHASE_BACKEND_H
+#include <cstdint>
+
+enum class NarrowphaseBackend : std::uint8_t {
+    Scalar, // One pair at a time through PhysicsCollisionSystem::checkCollision
+    Simd    // Batched squared-distance kernel, AVX2/SSE2 when available
+};
+
+#endif // DIDDLEDOODLEDUEL_NARROWPHASE_BACKEND_H
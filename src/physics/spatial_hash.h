@@ -0,0 +1,125 @@
+#ifndef DIDDLEDOODLEDUEL_SPATIAL_HASH_H
+#define DIDDLEDOODLEDUEL_SPATIAL_HASH_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct CandidatePair {
+    std::uint32_t a;
+    std::uint32_t b;
+};
+
+// Uniform grid broadphase. Items are bucketed by cell with a counting sort into a hashed
+// table, so building and querying are both linear in the item count. With a cell size of at
+// least the largest collision diameter, every overlapping pair lands in neighbouring cells.
+class SpatialHashGrid {
+public:
+    void build(const std::span<const float> xs, const std::span<const float> ys,
+               const float newCellSize) {
+        cellSize = newCellSize;
+        inverseCellSize = 1.0F / newCellSize;
+
+        const auto itemCount = static_cast<std::uint32_t>(xs.size());
+        const std::uint32_t tableSize = std::bit_ceil(std::max<std::uint32_t>(itemCount * 2, 16));
+        tableMask = tableSize - 1;
+
+        cellX.resize(itemCount);
+        cellY.resize(itemCount);
+        bucketStart.assign(tableSize + 1, 0);
+        sortedItems.resize(itemCount);
+
+        for (std::uint32_t i = 0; i < itemCount; ++i) {
+            cellX[i] = static_cast<std::int32_t>(std::floor(xs[i] * inverseCellSize));
+            cellY[i] = static_cast<std::int32_t>(std::floor(ys[i] * inverseCellSize));
+            ++bucketStart[bucketOf(cellX[i], cellY[i]) + 1];
+        }
+
+        for (std::uint32_t bucket = 0; bucket < tableSize; ++bucket) {
+            bucketStart[bucket + 1] += bucketStart[bucket];
+        }
+
+        // Reuse cursor storage between frames to keep the broadphase allocation free
+        bucketCursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::uint32_t i = 0; i < itemCount; ++i) {
+            sortedItems[bucketCursor[bucketOf(cellX[i], cellY[i])]++] = i;
+        }
+    }
+
+    // Emits every pair of items in the same or adjacent cells exactly once, with a < b,
+    // ordered by (a, b) so pair processing order matches a nested loop over the same items.
+    void collectPairs(std::vector<CandidatePair>& pairs) const {
+        pairs.clear();
+
+        const auto itemCount = static_cast<std::uint32_t>(cellX.size());
+        for (std::uint32_t a = 0; a < itemCount; ++a) {
+            const auto firstPairOfA = pairs.size();
+
+            for (std::int32_t dy = -1; dy <= 1; ++dy) {
+                for (std::int32_t dx = -1; dx <= 1; ++dx) {
+                    const std::int32_t neighbourX = cellX[a] + dx;
+                    const std::int32_t neighbourY = cellY[a] + dy;
+                    const std::uint32_t bucket = bucketOf(neighbourX, neighbourY);
+
+                    for (std::uint32_t slot = bucketStart[bucket]; slot < bucketStart[bucket + 1];
+                         ++slot) {
+                        const std::uint32_t b = sortedItems[slot];
+                        // Several cells can share a bucket, so only accept b from the cell
+                        // being visited; this is also what keeps each pair unique.
+                        if (b <= a || cellX[b] != neighbourX || cellY[b] != neighbourY) {
+                            continue;
+                        }
+                        pairs.push_back(CandidatePair{.a = a, .b = b});
+                    }
+                }
+            }
+
+            std::sort(pairs.begin() + static_cast<std::ptrdiff_t>(firstPairOfA), pairs.end(),
+                      [](const CandidatePair& lhs, const CandidatePair& rhs) { return lhs.b < rhs.b; });
+        }
+    }
+
+    // Calls visit(item) for every item in the cell holding (x, y) and the eight around it,
+    // i.e. at least every item within one cell size of the point, until visit returns false
+    template <typename Visit>
+    void forEachNear(const float x, const float y, const Visit& visit) const {
+        const auto centerX = static_cast<std::int32_t>(std::floor(x * inverseCellSize));
+        const auto centerY = static_cast<std::int32_t>(std::floor(y * inverseCellSize));
+        for (std::int32_t dy = -1; dy <= 1; ++dy) {
+            for (std::int32_t dx = -1; dx <= 1; ++dx) {
+                const std::uint32_t bucket = bucketOf(centerX + dx, centerY + dy);
+                for (std::uint32_t slot = bucketStart[bucket]; slot < bucketStart[bucket + 1];
+                     ++slot) {
+                    const std::uint32_t item = sortedItems[slot];
+                    if (cellX[item] == centerX + dx && cellY[item] == centerY + dy &&
+                        !visit(item)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] float getCellSize() const { return cellSize; }
+
+private:
+    float cellSize {1.0F};
+    float inverseCellSize {1.0F};
+    std::uint32_t tableMask {0};
+
+    std::vector<std::int32_t> cellX;
+    std::vector<std::int32_t> cellY;
+    std::vector<std::uint32_t> bucketStart;
+    std::vector<std::uint32_t> bucketCursor;
+    std::vector<std::uint32_t> sortedItems;
+
+    [[nodiscard]] std::uint32_t bucketOf(const std::int32_t x, const std::int32_t y) const {
+        const auto hash = (static_cast<std::uint32_t>(x) * 73856093U) ^
+                          (static_cast<std::uint32_t>(y) * 19349663U);
+        return hash & tableMask;
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_SPATIAL_HASH_H
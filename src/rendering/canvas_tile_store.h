@@ -0,0 +1,37 @@
+#ifndef DIDDLEDOODLEDUEL_CANVAS_TILE_STORE_H
+#define DIDDLEDOODLEDUEL_CANVAS_TILE_STORE_H
+#include "canvas/paint_stamp.h"
+#include "core/arena_camera.h"
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+
+// Where TiledPaintCanvas keeps the pixels of its live tiles: GPU render textures in the game,
+// images in memory under the software renderer. Tiles are square, with pixels in rows from the
+// top, and are only ever drawn into or read between beginView/endView pairs, never during one.
+class CanvasTileStore {
+public:
+    using TileId = std::uint32_t;
+
+    virtual ~CanvasTileStore() = default;
+
+    // A size x size tile filled with color
+    virtual TileId create(int size, Color color) = 0;
+    virtual void destroy(TileId tile) = 0;
+
+    // Stamps in the tile's own pixel coordinates
+    virtual void drawStamps(TileId tile, std::span<const PaintStamp> stamps) = 0;
+    virtual void read(TileId tile, std::span<Color> pixels) = 0;
+    virtual void write(TileId tile, std::span<const Color> pixels) = 0;
+
+    // Draws the arena as camera sees it, from the tiles and the gaps drawn in between
+    virtual void beginView(const ArenaCamera& camera) = 0;
+    // The source part of tile, with its top left corner at position in the world
+    virtual void drawTile(TileId tile, Rectangle source, Vector2 position) = 0;
+    // Unpainted arena. Tiles aren't drawn over it: their pixels may be translucent, and must
+    // show what is behind the canvas as a single canvas's would.
+    virtual void drawEmpty(Rectangle area, Color color) = 0;
+    virtual void endView() = 0;
+};
+
+#endif // DIDDLEDOODLEDUEL_CANVAS_TILE_STORE_H
@@ -0,0 +1,136 @@
+#ifndef DIDDLEDOODLEDUEL_GPU_CANVAS_TILE_STORE_H
+#define DIDDLEDOODLEDUEL_GPU_CANVAS_TILE_STORE_H
+#include "rendering/canvas_tile_store.h"
+#include "rendering/gpu_paint_canvas.h"
+#include <algorithm>
+#include <cstddef>
+#include <raylib.h>
+#include <vector>
+
+// Tiles as render textures. The view is composed into one window-sized render texture that
+// then goes through the watercolor shader, so the shader's noise stays in screen space as it is
+// with GpuPaintCanvas, and its bleed runs across tile seams.
+class GpuCanvasTileStore final : public CanvasTileStore {
+public:
+    GpuCanvasTileStore() : shader(LoadShader(nullptr, "resources/shaders/watercolor.fs")) {
+    }
+
+    ~GpuCanvasTileStore() override {
+        for (const RenderTexture2D& texture : textures) {
+            if (texture.id != 0) {
+                UnloadRenderTexture(texture);
+            }
+        }
+        if (composite.id != 0) {
+            UnloadRenderTexture(composite);
+        }
+        UnloadShader(shader);
+    }
+
+    GpuCanvasTileStore(const GpuCanvasTileStore&) = delete;
+    GpuCanvasTileStore& operator=(const GpuCanvasTileStore&) = delete;
+
+    TileId create(const int size, const Color color) override {
+        const RenderTexture2D texture = LoadRenderTexture(size, size);
+        BeginTextureMode(texture);
+        ClearBackground(color);
+        EndTextureMode();
+
+        if (freeTiles.empty()) {
+            textures.push_back(texture);
+            return static_cast<TileId>(textures.size() - 1);
+        }
+        const TileId tile = freeTiles.back();
+        freeTiles.pop_back();
+        textures[tile] = texture;
+        return tile;
+    }
+
+    void destroy(const TileId tile) override {
+        UnloadRenderTexture(textures[tile]);
+        textures[tile] = RenderTexture2D{};
+        freeTiles.push_back(tile);
+    }
+
+    void drawStamps(const TileId tile, const std::span<const PaintStamp> stamps) override {
+        BeginTextureMode(textures[tile]);
+        GpuPaintCanvas::drawStampShapes(stamps);
+        EndTextureMode();
+    }
+
+    // Render textures are stored bottom-up, so rows are flipped both ways
+    void read(const TileId tile, const std::span<Color> pixels) override {
+        Image image = LoadImageFromTexture(textures[tile].texture);
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        const auto rowLength = static_cast<std::size_t>(image.width);
+        const std::span<const Color> stored(static_cast<const Color*>(image.data),
+                                            rowLength * static_cast<std::size_t>(image.height));
+        for (std::size_t row = 0; row < static_cast<std::size_t>(image.height); ++row) {
+            const auto storedRow = static_cast<std::size_t>(image.height) - 1 - row;
+            std::ranges::copy(stored.subspan(storedRow * rowLength, rowLength),
+                              pixels.begin() + static_cast<std::ptrdiff_t>(row * rowLength));
+        }
+        UnloadImage(image);
+    }
+
+    void write(const TileId tile, const std::span<const Color> pixels) override {
+        const Texture2D& texture = textures[tile].texture;
+        const auto rowLength = static_cast<std::size_t>(texture.width);
+        const auto rowCount = static_cast<std::size_t>(texture.height);
+        flipped.resize(rowLength * rowCount);
+        for (std::size_t row = 0; row < rowCount; ++row) {
+            std::ranges::copy(pixels.subspan((rowCount - 1 - row) * rowLength, rowLength),
+                              flipped.begin() + static_cast<std::ptrdiff_t>(row * rowLength));
+        }
+        UpdateTexture(texture, flipped.data());
+    }
+
+    void beginView(const ArenaCamera& camera) override {
+        const auto width = static_cast<int>(camera.viewWidth);
+        const auto height = static_cast<int>(camera.viewHeight);
+        if (composite.texture.width != width || composite.texture.height != height) {
+            if (composite.id != 0) {
+                UnloadRenderTexture(composite);
+            }
+            composite = LoadRenderTexture(width, height);
+        }
+
+        BeginTextureMode(composite);
+        ClearBackground(BLANK);
+        BeginMode2D(camera.camera);
+    }
+
+    // A tile's top rows are the last stored, so a partial source comes from the end
+    void drawTile(const TileId tile, const Rectangle source, const Vector2 position) override {
+        const Texture2D& texture = textures[tile].texture;
+        DrawTextureRec(texture,
+                       Rectangle{source.x,
+                                 static_cast<float>(texture.height) - source.y - source.height,
+                                 source.width, -source.height},
+                       position, WHITE);
+    }
+
+    void drawEmpty(const Rectangle area, const Color color) override {
+        DrawRectangleRec(area, color);
+    }
+
+    void endView() override {
+        EndMode2D();
+        EndTextureMode();
+        BeginShaderMode(shader);
+        DrawTextureRec(composite.texture,
+                       Rectangle{0, 0, static_cast<float>(composite.texture.width),
+                                 static_cast<float>(-composite.texture.height)},
+                       Vector2{0.0F, 0.0F}, WHITE);
+        EndShaderMode();
+    }
+
+private:
+    Shader shader;
+    std::vector<RenderTexture2D> textures; // By tile id; id 0 while free
+    std::vector<TileId> freeTiles;
+    RenderTexture2D composite {};
+    std::vector<Color> flipped;
+};
+
+#endif // DIDDLEDOODLEDUEL_GPU_CANVAS_TILE_STORE_H
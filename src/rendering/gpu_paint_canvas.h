@@ -0,0 +1,66 @@
+#ifndef DIDDLEDOODLEDUEL_GPU_PAINT_CANVAS_H
+#define DIDDLEDOODLEDUEL_GPU_PAINT_CANVAS_H
+#include "rendering/paint_canvas.h"
+#include <memory>
+#include <raylib.h>
+#include <span>
+
+// Render texture canvas, drawn through the watercolor shader
+class GpuPaintCanvas final : public PaintCanvas {
+public:
+    GpuPaintCanvas(const int width, const int height)
+        : renderTexture(std::make_unique<RenderTexture2D>(LoadRenderTexture(width, height))),
+          shader(std::make_unique<Shader>(LoadShader(nullptr, "resources/shaders/watercolor.fs"))) {
+        clear(WHITE);
+    }
+
+    void clear(const Color color) override {
+        BeginTextureMode(*renderTexture);
+        ClearBackground(color);
+        EndTextureMode();
+    }
+
+    // Every stamp in a single texture-mode pass
+    void drawStamps(const std::span<const PaintStamp> stamps,
+                    [[maybe_unused]] const CanvasDirtyTiles& dirtyTiles) override {
+        if (stamps.empty()) {
+            return;
+        }
+
+        BeginTextureMode(*renderTexture);
+        drawStampShapes(stamps);
+        EndTextureMode();
+    }
+
+    void draw(const ArenaCamera& camera) override {
+        BeginShaderMode(*shader);
+        BeginMode2D(camera.camera);
+        // Render textures are stored bottom-up, hence the negative height
+        DrawTextureRec(renderTexture->texture,
+                       Rectangle{0, 0, static_cast<float>(renderTexture->texture.width),
+                                 static_cast<float>(-renderTexture->texture.height)},
+                       Vector2{0.0F, 0.0F}, WHITE);
+        EndMode2D();
+        EndShaderMode();
+    }
+
+    // Each stamp as two circles joined by a line, into whatever is being drawn to
+    static void drawStampShapes(const std::span<const PaintStamp> stamps) {
+        for (const auto& [from, to, radius, color, paletteIndex] : stamps) {
+            DrawCircleV(from, radius, color);
+            if (from.x != to.x || from.y != to.y) {
+                DrawLineEx(from, to, radius * 2.0F, color);
+                DrawCircleV(to, radius, color);
+            }
+        }
+    }
+
+    [[nodiscard]] int getWidth() const override { return renderTexture->texture.width; }
+    [[nodiscard]] int getHeight() const override { return renderTexture->texture.height; }
+
+private:
+    std::unique_ptr<RenderTexture2D> renderTexture;
+    std::unique_ptr<Shader> shader;
+};
+
+#endif // DIDDLEDOODLEDUEL_GPU_PAINT_CANVAS_H
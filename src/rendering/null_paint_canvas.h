@@ -0,0 +1,25 @@
+#ifndef DIDDLEDOODLEDUEL_NULL_PAINT_CANVAS_H
+#define DIDDLEDOODLEDUEL_NULL_PAINT_CANVAS_H
+#include "rendering/paint_canvas.h"
+
+// Canvas for when there is no window, and so no GPU to paint on, e.g. the game driven through a
+// NullRenderer in tests. It keeps its size so the dirty tiles still work, and drops every stamp.
+class NullPaintCanvas final : public PaintCanvas {
+public:
+    NullPaintCanvas(const int width, const int height) : width(width), height(height) {
+    }
+
+    void clear([[maybe_unused]] Color color) override {}
+    void drawStamps([[maybe_unused]] std::span<const PaintStamp> stamps,
+                    [[maybe_unused]] const CanvasDirtyTiles& dirtyTiles) override {}
+    void draw([[maybe_unused]] const ArenaCamera& camera) override {}
+
+    [[nodiscard]] int getWidth() const override { return width; }
+    [[nodiscard]] int getHeight() const override { return height; }
+
+private:
+    int width;
+    int height;
+};
+
+#endif // DIDDLEDOODLEDUEL_NULL_PAINT_CANVAS_H
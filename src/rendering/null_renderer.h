@@ -0,0 +1,45 @@
+#ifndef DIDDLEDOODLEDUEL_NULL_RENDERER_H
+#define DIDDLEDOODLEDUEL_NULL_RENDERER_H
+#include "rendering/irenderer.h"
+#include <raylib.h>
+#include <string>
+
+// Renderer that never opens a window. It reports a fixed virtual window size so systems that
+// size themselves from the renderer still work, and drops every draw call.
+class NullRenderer final : public engine::IRenderer {
+public:
+    explicit NullRenderer(const int width = 1280, const int height = 720)
+        : width(width), height(height) {
+    }
+
+    std::expected<void, std::string> initialize(const int newWidth, const int newHeight,
+                                                [[maybe_unused]] const std::string& title) override {
+        width = newWidth;
+        height = newHeight;
+        return {};
+    }
+
+    void shutdown() override {}
+    void beginFrame() override {}
+    void endFrame() override {}
+
+    [[nodiscard]] int getWindowWidth() const override { return width; }
+    [[nodiscard]] int getWindowHeight() const override { return height; }
+    [[nodiscard]] Vector2 getScreenCenter() const override {
+        return Vector2{static_cast<float>(width) * 0.5F, static_cast<float>(height) * 0.5F};
+    }
+
+    void drawCircle([[maybe_unused]] Vector2 center, [[maybe_unused]] float radius,
+                    [[maybe_unused]] Color color) override {}
+    void drawText([[maybe_unused]] const std::string& text, [[maybe_unused]] Vector2 position,
+                  [[maybe_unused]] int fontSize, [[maybe_unused]] Color color) override {}
+    void drawTexture([[maybe_unused]] const Texture2D& texture, [[maybe_unused]] Rectangle source,
+                     [[maybe_unused]] Rectangle dest, [[maybe_unused]] Vector2 origin,
+                     [[maybe_unused]] float rotation, [[maybe_unused]] Color tint) override {}
+
+private:
+    int width;
+    int height;
+};
+
+#endif // DIDDLEDOODLEDUEL_NULL_RENDERER_H
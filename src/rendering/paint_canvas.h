@@ -0,0 +1,27 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_CANVAS_H
+#define DIDDLEDOODLEDUEL_PAINT_CANVAS_H
+#include "canvas/dirty_tiles.h"
+#include "canvas/paint_stamp.h"
+#include "core/arena_camera.h"
+#include <raylib.h>
+#include <span>
+
+// The image PaintSystem accumulates stamps in and draws each frame: a GPU render texture in
+// the game, an image in memory under the software renderer, or tiles of either for arenas
+// larger than the window
+class PaintCanvas {
+public:
+    virtual ~PaintCanvas() = default;
+
+    virtual void clear(Color color) = 0;
+    // dirtyTiles are the tiles the stamps touch, for canvases that track changes
+    virtual void drawStamps(std::span<const PaintStamp> stamps,
+                            const CanvasDirtyTiles& dirtyTiles) = 0;
+    // The canvas covers the arena from (0, 0), and is drawn as camera sees it
+    virtual void draw(const ArenaCamera& camera) = 0;
+
+    [[nodiscard]] virtual int getWidth() const = 0;
+    [[nodiscard]] virtual int getHeight() const = 0;
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_CANVAS_H
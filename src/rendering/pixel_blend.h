@@ -0,0 +1,147 @@
+#ifndef DIDDLEDOODLEDUEL_PIXEL_BLEND_H
+#define DIDDLEDOODLEDUEL_PIXEL_BLEND_H
+#include <cstddef>
+#include <cstdint>
+#include <raylib.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define DDD_PIXEL_BLEND_SSE2 1
+#endif
+
+// Span kernels of the software renderer, on RGBA8 Colors. Blending is the GPU's default alpha
+// blend, every channel alpha included: out = src * srcAlpha + dst * (1 - srcAlpha). All maths
+// is exact integer arithmetic, so the SSE2 kernels give the same bytes as the scalar ones.
+namespace pixel_blend {
+
+static_assert(sizeof(Color) == 4);
+
+// round(value / 255) for value <= 255 * 255
+inline std::uint32_t divide255(const std::uint32_t value) {
+    const std::uint32_t rounded = value + 128;
+    return (rounded + (rounded >> 8)) >> 8;
+}
+
+inline std::uint8_t mix(const std::uint8_t src, const std::uint8_t dst, const std::uint8_t alpha) {
+    return static_cast<std::uint8_t>(divide255((src * alpha) + (dst * (255U - alpha))));
+}
+
+inline void blendPixelScalar(Color& dst, const Color src) {
+    dst = Color{mix(src.r, dst.r, src.a), mix(src.g, dst.g, src.a), mix(src.b, dst.b, src.a),
+                mix(src.a, dst.a, src.a)};
+}
+
+inline Color tintPixelScalar(const Color pixel, const Color tint) {
+    return Color{static_cast<std::uint8_t>(divide255(pixel.r * tint.r)),
+                 static_cast<std::uint8_t>(divide255(pixel.g * tint.g)),
+                 static_cast<std::uint8_t>(divide255(pixel.b * tint.b)),
+                 static_cast<std::uint8_t>(divide255(pixel.a * tint.a))};
+}
+
+#if defined(DDD_PIXEL_BLEND_SSE2)
+// divide255 on eight 16-bit lanes
+inline __m128i divide255(const __m128i value) {
+    const __m128i rounded = _mm_add_epi16(value, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(rounded, _mm_srli_epi16(rounded, 8)), 8);
+}
+
+// Two pixels widened to 16 bits per channel, each pixel's alpha copied to its four lanes
+inline __m128i broadcastAlpha(const __m128i pixels) {
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xFF), 0xFF);
+}
+
+inline __m128i blendWide(const __m128i src, const __m128i dst) {
+    const __m128i alpha = broadcastAlpha(src);
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return divide255(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inverse)));
+}
+
+// Four pixels per call
+inline __m128i blend4(const __m128i src, const __m128i dst) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(
+        blendWide(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero)),
+        blendWide(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero)));
+}
+
+inline __m128i tint4(const __m128i pixels, const __m128i wideTint) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(
+        divide255(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), wideTint)),
+        divide255(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), wideTint)));
+}
+
+inline __m128i load4(const Color* pixels) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+inline void store4(Color* pixels, const __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+}
+
+inline __m128i splat(const Color color) {
+    return _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(color.r) |
+                                           (static_cast<std::uint32_t>(color.g) << 8U) |
+                                           (static_cast<std::uint32_t>(color.b) << 16U) |
+                                           (static_cast<std::uint32_t>(color.a) << 24U)));
+}
+#endif
+
+// Blends src[i] over dst[i]
+inline void blendSpan(Color* dst, const Color* src, const std::size_t count) {
+    std::size_t index = 0;
+#if defined(DDD_PIXEL_BLEND_SSE2)
+    for (; index + 4 <= count; index += 4) {
+        store4(dst + index, blend4(load4(src + index), load4(dst + index)));
+    }
+#endif
+    for (; index < count; ++index) {
+        blendPixelScalar(dst[index], src[index]);
+    }
+}
+
+// Blends one colour over every pixel; opaque colours are plain stores
+inline void fillSpan(Color* dst, const Color color, const std::size_t count) {
+    if (color.a == 255) {
+        for (std::size_t index = 0; index < count; ++index) {
+            dst[index] = color;
+        }
+        return;
+    }
+    if (color.a == 0) {
+        return;
+    }
+
+    std::size_t index = 0;
+#if defined(DDD_PIXEL_BLEND_SSE2)
+    const __m128i src = splat(color);
+    for (; index + 4 <= count; index += 4) {
+        store4(dst + index, blend4(src, load4(dst + index)));
+    }
+#endif
+    for (; index < count; ++index) {
+        blendPixelScalar(dst[index], color);
+    }
+}
+
+// Multiplies every pixel by tint, channel by channel
+inline void tintSpan(Color* pixels, const Color tint, const std::size_t count) {
+    if (tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255) {
+        return;
+    }
+
+    std::size_t index = 0;
+#if defined(DDD_PIXEL_BLEND_SSE2)
+    const __m128i wideTint = _mm_unpacklo_epi8(splat(tint), _mm_setzero_si128());
+    for (; index + 4 <= count; index += 4) {
+        store4(pixels + index, tint4(load4(pixels + index), wideTint));
+    }
+#endif
+    for (; index < count; ++index) {
+        pixels[index] = tintPixelScalar(pixels[index], tint);
+    }
+}
+
+} // namespace pixel_blend
+
+#endif // DIDDLEDOODLEDUEL_PIXEL_BLEND_H
@@ -0,0 +1,116 @@
+#ifndef DIDDLEDOODLEDUEL_RECORDING_RENDERER_H
+#define DIDDLEDOODLEDUEL_RECORDING_RENDERER_H
+#include "rendering/irenderer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One recorded draw call. Only the fields of its kind are set.
+struct DrawCommand {
+    enum class Kind : std::uint8_t { Circle, Text, Texture };
+
+    Kind kind {Kind::Circle};
+    Color color {};          // Circle and text colour, texture tint
+    Vector2 position {};     // Circle centre, text position
+    float radius {0.0F};
+    int fontSize {0};
+    std::uint32_t textOffset {0}; // Into RecordingRenderer's text buffer
+    std::uint32_t textLength {0};
+    unsigned int textureId {0};
+    Rectangle source {};
+    Rectangle dest {};
+    Vector2 origin {};
+    float rotation {0.0F};
+};
+
+// Renderer that never opens a window and appends every draw call of the current frame to a flat
+// command buffer, so tests can assert what a system submitted and benchmarks can time the
+// submission without a GPU. Text is copied into one shared buffer. Both buffers are reserved
+// up front and cleared by beginFrame, so frames within the reserved sizes never allocate.
+class RecordingRenderer final : public engine::IRenderer {
+public:
+    explicit RecordingRenderer(const int width = 1280, const int height = 720,
+                               const std::size_t commandCapacity = 4096,
+                               const std::size_t textCapacity = 16384)
+        : width(width), height(height) {
+        commands.reserve(commandCapacity);
+        text.reserve(textCapacity);
+    }
+
+    std::expected<void, std::string> initialize(const int newWidth, const int newHeight,
+                                                [[maybe_unused]] const std::string& title) override {
+        width = newWidth;
+        height = newHeight;
+        return {};
+    }
+
+    void shutdown() override {}
+
+    void beginFrame() override {
+        commands.clear();
+        text.clear();
+        ++frames;
+    }
+
+    void endFrame() override {}
+
+    [[nodiscard]] int getWindowWidth() const override { return width; }
+    [[nodiscard]] int getWindowHeight() const override { return height; }
+    [[nodiscard]] Vector2 getScreenCenter() const override {
+        return Vector2{static_cast<float>(width) * 0.5F, static_cast<float>(height) * 0.5F};
+    }
+
+    void drawCircle(const Vector2 center, const float radius, const Color color) override {
+        commands.push_back(DrawCommand{
+            .kind = DrawCommand::Kind::Circle, .color = color, .position = center, .radius = radius});
+    }
+
+    void drawText(const std::string& string, const Vector2 position, const int fontSize,
+                  const Color color) override {
+        commands.push_back(DrawCommand{.kind = DrawCommand::Kind::Text,
+                                       .color = color,
+                                       .position = position,
+                                       .fontSize = fontSize,
+                                       .textOffset = static_cast<std::uint32_t>(text.size()),
+                                       .textLength = static_cast<std::uint32_t>(string.size())});
+        text.append(string);
+    }
+
+    void drawTexture(const Texture2D& texture, const Rectangle source, const Rectangle dest,
+                     const Vector2 origin, const float rotation, const Color tint) override {
+        commands.push_back(DrawCommand{.kind = DrawCommand::Kind::Texture,
+                                       .color = tint,
+                                       .textureId = texture.id,
+                                       .source = source,
+                                       .dest = dest,
+                                       .origin = origin,
+                                       .rotation = rotation});
+    }
+
+    // Draw calls since the last beginFrame, in submission order
+    [[nodiscard]] std::span<const DrawCommand> getCommands() const { return commands; }
+
+    [[nodiscard]] std::size_t count(const DrawCommand::Kind kind) const {
+        return static_cast<std::size_t>(std::ranges::count(commands, kind, &DrawCommand::kind));
+    }
+
+    [[nodiscard]] std::string_view textOf(const DrawCommand& command) const {
+        return std::string_view(text).substr(command.textOffset, command.textLength);
+    }
+
+    [[nodiscard]] std::uint64_t getFrameCount() const { return frames; }
+
+private:
+    int width;
+    int height;
+    std::uint64_t frames {0};
+    std::vector<DrawCommand> commands;
+    std::string text;
+};
+
+#endif // DIDDLEDOODLEDUEL_RECORDING_RENDERER_H
@@ -0,0 +1,68 @@
+#ifndef DIDDLEDOODLEDUEL_SOFTWARE_CANVAS_TILE_STORE_H
+#define DIDDLEDOODLEDUEL_SOFTWARE_CANVAS_TILE_STORE_H
+#include "rendering/canvas_tile_store.h"
+#include "rendering/software_image.h"
+#include "rendering/software_renderer.h"
+#include <algorithm>
+#include <vector>
+
+// Tiles as images in memory, drawn by a SoftwareRenderer. Stamps are filled as single capsules,
+// as SoftwarePaintCanvas does.
+class SoftwareCanvasTileStore final : public CanvasTileStore {
+public:
+    explicit SoftwareCanvasTileStore(SoftwareRenderer& renderer) : renderer(renderer) {
+    }
+
+    TileId create(const int size, const Color color) override {
+        if (freeTiles.empty()) {
+            images.emplace_back(size, size, color);
+            return static_cast<TileId>(images.size() - 1);
+        }
+        const TileId tile = freeTiles.back();
+        freeTiles.pop_back();
+        images[tile] = SoftwareImage(size, size, color);
+        return tile;
+    }
+
+    void destroy(const TileId tile) override {
+        images[tile] = SoftwareImage();
+        freeTiles.push_back(tile);
+    }
+
+    void drawStamps(const TileId tile, const std::span<const PaintStamp> stamps) override {
+        for (const auto& [from, to, radius, color, paletteIndex] : stamps) {
+            images[tile].fillCapsule(from, to, radius, color);
+        }
+    }
+
+    void read(const TileId tile, const std::span<Color> pixels) override {
+        std::ranges::copy(images[tile].getPixels(), pixels.begin());
+    }
+
+    void write(const TileId tile, const std::span<const Color> pixels) override {
+        std::ranges::copy(pixels, images[tile].getPixels().begin());
+    }
+
+    void beginView(const ArenaCamera& camera) override { renderer.beginCamera(camera.camera); }
+
+    void drawTile(const TileId tile, const Rectangle source, const Vector2 position) override {
+        renderer.drawImage(images[tile], source,
+                           Rectangle{position.x, position.y, source.width, source.height},
+                           Vector2{0.0F, 0.0F}, 0.0F, WHITE);
+    }
+
+    // A single pixel stretched over the area
+    void drawEmpty(const Rectangle area, const Color color) override {
+        renderer.drawImage(SoftwareImage(1, 1, color), Rectangle{0.0F, 0.0F, 1.0F, 1.0F}, area,
+                           Vector2{0.0F, 0.0F}, 0.0F, WHITE);
+    }
+
+    void endView() override { renderer.endCamera(); }
+
+private:
+    SoftwareRenderer& renderer;
+    std::vector<SoftwareImage> images; // By tile id; empty while free
+    std::vector<TileId> freeTiles;
+};
+
+#endif // DIDDLEDOODLEDUEL_SOFTWARE_CANVAS_TILE_STORE_H
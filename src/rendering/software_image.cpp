@@ -0,0 +1,224 @@
+#include "rendering/software_image.h"
+#include "canvas/span_rasterizer.h"
+#include "rendering/bitmap_font.h"
+#include "rendering/pixel_blend.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+SoftwareImage::SoftwareImage(const int width, const int height, const Color fill)
+    : width(std::max(0, width)), height(std::max(0, height)),
+      pixels(static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->height), fill) {
+}
+
+void SoftwareImage::clear(const Color color) {
+    std::ranges::fill(pixels, color);
+}
+
+void SoftwareImage::fillCircle(const Vector2 center, const float radius, const Color color) {
+    span_rasterizer::forEachCircleSpan(center, radius, 1.0F, height,
+                                       [&](const int row, const float startX, const float endX) {
+                                           fillRowSpan(row, startX, endX, color);
+                                       });
+}
+
+void SoftwareImage::fillCapsule(const Vector2 from, const Vector2 to, const float radius,
+                                const Color color) {
+    span_rasterizer::forEachCapsuleSpan(from, to, radius, 1.0F, height,
+                                        [&](const int row, const float startX, const float endX) {
+                                            fillRowSpan(row, startX, endX, color);
+                                        });
+}
+
+void SoftwareImage::drawImage(const SoftwareImage& image, Rectangle source, const Rectangle dest,
+                              const Vector2 origin, const float rotation, const Color tint) {
+    if (image.pixels.empty() || dest.width <= 0.0F || dest.height <= 0.0F) {
+        return;
+    }
+    const bool flipX = source.width < 0.0F;
+    const bool flipY = source.height < 0.0F;
+    source.width = std::abs(source.width);
+    source.height = std::abs(source.height);
+
+    const float cosine = std::cos(rotation * DEG2RAD);
+    const float sine = std::sin(rotation * DEG2RAD);
+
+    // Bounds of the rotated destination quad
+    float minX = INFINITY;
+    float maxX = -INFINITY;
+    float minY = INFINITY;
+    float maxY = -INFINITY;
+    for (const Vector2 corner : {Vector2{0.0F, 0.0F}, Vector2{dest.width, 0.0F},
+                                 Vector2{0.0F, dest.height}, Vector2{dest.width, dest.height}}) {
+        const float offsetX = corner.x - origin.x;
+        const float offsetY = corner.y - origin.y;
+        const float x = dest.x + (offsetX * cosine) - (offsetY * sine);
+        const float y = dest.y + (offsetX * sine) + (offsetY * cosine);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    // Texel bounds of the source rectangle
+    const int firstTexelX = std::max(0, static_cast<int>(std::floor(source.x)));
+    const int lastTexelX =
+        std::min(image.width - 1, static_cast<int>(std::ceil(source.x + source.width)) - 1);
+    const int firstTexelY = std::max(0, static_cast<int>(std::floor(source.y)));
+    const int lastTexelY =
+        std::min(image.height - 1, static_cast<int>(std::ceil(source.y + source.height)) - 1);
+    if (firstTexelX > lastTexelX || firstTexelY > lastTexelY) {
+        return;
+    }
+
+    const auto [firstRow, lastRow] = span_rasterizer::rowRange(minY, maxY, 1.0F, height);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        // A pixel centre p maps into dest as rotate(p - dest.xy, -rotation) + origin, which
+        // along a row is linear in x
+        const float dy = (static_cast<float>(row) + 0.5F) - dest.y;
+        const float localXOffset = (sine * dy) + origin.x - (cosine * dest.x);
+        const float localYOffset = (cosine * dy) + origin.y + (sine * dest.x);
+
+        float start = minX;
+        float end = maxX;
+        span_rasterizer::clipLinear(localXOffset, cosine, 0.0F, dest.width, start, end);
+        span_rasterizer::clipLinear(localYOffset, -sine, 0.0F, dest.height, start, end);
+        if (start > end) {
+            continue;
+        }
+        const auto [firstColumn, lastColumn] =
+            span_rasterizer::columnRange(start, end, 1.0F, width);
+        if (firstColumn > lastColumn) {
+            continue;
+        }
+
+        const auto count = static_cast<std::size_t>(lastColumn - firstColumn + 1);
+        rowTexels.resize(count);
+        for (std::size_t index = 0; index < count; ++index) {
+            const float x = static_cast<float>(firstColumn) + static_cast<float>(index) + 0.5F;
+            float u = std::clamp((localXOffset + (cosine * x)) / dest.width, 0.0F, 1.0F);
+            float v = std::clamp((localYOffset - (sine * x)) / dest.height, 0.0F, 1.0F);
+            u = flipX ? 1.0F - u : u;
+            v = flipY ? 1.0F - v : v;
+            const int texelX =
+                std::clamp(static_cast<int>(std::floor(source.x + (u * source.width))),
+                           firstTexelX, lastTexelX);
+            const int texelY =
+                std::clamp(static_cast<int>(std::floor(source.y + (v * source.height))),
+                           firstTexelY, lastTexelY);
+            rowTexels[index] = image.at(texelX, texelY);
+        }
+
+        pixel_blend::tintSpan(rowTexels.data(), tint, count);
+        pixel_blend::blendSpan(pixels.data() + indexOf(firstColumn, row), rowTexels.data(), count);
+    }
+}
+
+void SoftwareImage::drawText(const std::string_view text, const Vector2 position,
+                             const int fontSize, const Color color) {
+    // raylib's default font is 10 pixels high, with glyphs scaled by whole pixels
+    constexpr int kLineHeight = 10;
+    const int scale = std::max(1, fontSize / kLineHeight);
+    const int left = static_cast<int>(std::lround(position.x));
+    int penX = left;
+    int penY = static_cast<int>(std::lround(position.y));
+
+    for (const char character : text) {
+        if (character == '\n') {
+            penX = left;
+            penY += kLineHeight * scale;
+            continue;
+        }
+
+        const auto& glyph = bitmap_font::glyphOf(character);
+        for (int glyphRow = 0; glyphRow < bitmap_font::kGlyphHeight; ++glyphRow) {
+            // Each run of set bits is one rectangle
+            const unsigned bits = glyph[static_cast<std::size_t>(glyphRow)];
+            const auto isSet = [bits](const int column) {
+                const auto shift = static_cast<unsigned>(bitmap_font::kGlyphWidth - 1 - column);
+                return ((bits >> shift) & 1U) != 0;
+            };
+            int column = 0;
+            while (column < bitmap_font::kGlyphWidth) {
+                if (!isSet(column)) {
+                    ++column;
+                    continue;
+                }
+                const int runStart = column;
+                while (column < bitmap_font::kGlyphWidth && isSet(column)) {
+                    ++column;
+                }
+                fillRect(penX + (runStart * scale), penY + ((glyphRow + 1) * scale),
+                         (column - runStart) * scale, scale, color);
+            }
+        }
+        penX += (bitmap_font::kGlyphWidth + 1) * scale;
+    }
+}
+
+bool SoftwareImage::writePpm(std::ostream& output) const {
+    output << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<char> row(static_cast<std::size_t>(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Color pixel = at(x, y);
+            const auto offset = static_cast<std::size_t>(x) * 3;
+            row[offset] = static_cast<char>(pixel.r);
+            row[offset + 1] = static_cast<char>(pixel.g);
+            row[offset + 2] = static_cast<char>(pixel.b);
+        }
+        output.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(output);
+}
+
+std::optional<SoftwareImage> SoftwareImage::readPpm(std::istream& input) {
+    std::string magic;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int maxValue = 0;
+    input >> magic >> imageWidth >> imageHeight >> maxValue;
+    if (!input || magic != "P6" || imageWidth <= 0 || imageHeight <= 0 || maxValue != 255) {
+        return std::nullopt;
+    }
+    // Exactly one whitespace character separates the header from the pixels
+    input.get();
+
+    SoftwareImage image(imageWidth, imageHeight);
+    std::vector<char> row(static_cast<std::size_t>(imageWidth) * 3);
+    for (int y = 0; y < imageHeight; ++y) {
+        if (!input.read(row.data(), static_cast<std::streamsize>(row.size()))) {
+            return std::nullopt;
+        }
+        for (int x = 0; x < imageWidth; ++x) {
+            const auto offset = static_cast<std::size_t>(x) * 3;
+            image.pixels[image.indexOf(x, y)] = Color{static_cast<unsigned char>(row[offset]),
+                                                      static_cast<unsigned char>(row[offset + 1]),
+                                                      static_cast<unsigned char>(row[offset + 2]),
+                                                      255};
+        }
+    }
+    return image;
+}
+
+void SoftwareImage::fillRowSpan(const int row, const float startX, const float endX,
+                                const Color color) {
+    const auto [firstColumn, lastColumn] = span_rasterizer::columnRange(startX, endX, 1.0F, width);
+    if (firstColumn <= lastColumn) {
+        pixel_blend::fillSpan(pixels.data() + indexOf(firstColumn, row), color,
+                              static_cast<std::size_t>(lastColumn - firstColumn + 1));
+    }
+}
+
+void SoftwareImage::fillRect(const int x, const int y, const int rectWidth, const int rectHeight,
+                             const Color color) {
+    const int firstColumn = std::max(0, x);
+    const int lastColumn = std::min(width, x + rectWidth);
+    if (firstColumn >= lastColumn) {
+        return;
+    }
+    for (int row = std::max(0, y); row < std::min(height, y + rectHeight); ++row) {
+        pixel_blend::fillSpan(pixels.data() + indexOf(firstColumn, row), color,
+                              static_cast<std::size_t>(lastColumn - firstColumn));
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef DIDDLEDOODLEDUEL_SOFTWARE_IMAGE_H
+#define DIDDLEDOODLEDUEL_SOFTWARE_IMAGE_H
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <raylib.h>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// An RGBA8 image in memory plus the drawing the software renderer does into it. The renderer's
+// framebuffer, its textures and canvases standing in for render textures are all images.
+// Shapes cover the pixels whose centres they contain, like the ownership grid's cells, and
+// every draw blends with the same exact integer kernels, so output is reproducible bit for bit.
+class SoftwareImage {
+public:
+    SoftwareImage() = default;
+    SoftwareImage(int width, int height, Color fill = BLANK);
+
+    void clear(Color color);
+    void fillCircle(Vector2 center, float radius, Color color);
+    void fillCapsule(Vector2 from, Vector2 to, float radius, Color color);
+
+    // Takes the same arguments as DrawTexturePro: negative source sizes flip, dest is rotated
+    // by rotation degrees around its x/y, with origin relative to dest. Texels are sampled
+    // nearest, as with raylib's default point filter.
+    void drawImage(const SoftwareImage& image, Rectangle source, Rectangle dest, Vector2 origin,
+                   float rotation, Color tint);
+
+    // In the built-in 5x7 font, scaled like raylib's 10 pixel high default font
+    void drawText(std::string_view text, Vector2 position, int fontSize, Color color);
+
+    [[nodiscard]] int getWidth() const { return width; }
+    [[nodiscard]] int getHeight() const { return height; }
+    [[nodiscard]] std::span<Color> getPixels() { return pixels; }
+    [[nodiscard]] std::span<const Color> getPixels() const { return pixels; }
+    [[nodiscard]] Color at(const int x, const int y) const { return pixels[indexOf(x, y)]; }
+
+    // Binary PPM (P6), which drops alpha. False if the stream fails.
+    bool writePpm(std::ostream& output) const;
+    // Reads what writePpm writes, with alpha set opaque; nullopt if it isn't a PPM
+    static std::optional<SoftwareImage> readPpm(std::istream& input);
+
+private:
+    int width {0};
+    int height {0};
+    std::vector<Color> pixels;
+    std::vector<Color> rowTexels; // Gathered source texels of one row, reused across draws
+
+    [[nodiscard]] std::size_t indexOf(const int x, const int y) const {
+        return (static_cast<std::size_t>(y) * static_cast<std::size_t>(width)) +
+               static_cast<std::size_t>(x);
+    }
+
+    void fillRowSpan(int row, float startX, float endX, Color color);
+    void fillRect(int x, int y, int rectWidth, int rectHeight, Color color);
+};
+
+#endif // DIDDLEDOODLEDUEL_SOFTWARE_IMAGE_H
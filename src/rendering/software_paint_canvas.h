@@ -0,0 +1,83 @@
+#ifndef DIDDLEDOODLEDUEL_SOFTWARE_PAINT_CANVAS_H
+#define DIDDLEDOODLEDUEL_SOFTWARE_PAINT_CANVAS_H
+#include "canvas/dirty_tiles.h"
+#include "core/thread_pool.h"
+#include "rendering/paint_canvas.h"
+#include "rendering/software_renderer.h"
+#include "rendering/watercolor_filter.h"
+#include <memory>
+#include <optional>
+#include <raylib.h>
+
+// Canvas kept as one of the software renderer's textures. Each stamp is filled as a single
+// capsule, where the GPU canvas draws two circles and a line, so translucent stamps don't
+// darken where those overlap. Given watercolor settings, it is drawn through WatercolorFilter,
+// the CPU version of the game's shader, which re-shades only the tiles painted since the last
+// draw and nothing at all while brushes are idle; otherwise as it is.
+class SoftwarePaintCanvas final : public PaintCanvas {
+public:
+    // The size of the renderer's window. The pool, if any, shades the watercolor and must
+    // outlive the canvas.
+    explicit SoftwarePaintCanvas(SoftwareRenderer& renderer,
+                                 const std::optional<WatercolorSettings> watercolor = std::nullopt,
+                                 ThreadPool* pool = nullptr)
+        : SoftwarePaintCanvas(renderer, renderer.getWindowWidth(), renderer.getWindowHeight(),
+                              watercolor, pool) {
+    }
+
+    SoftwarePaintCanvas(SoftwareRenderer& renderer, const int width, const int height,
+                        const std::optional<WatercolorSettings> watercolor = std::nullopt,
+                        ThreadPool* pool = nullptr)
+        : renderer(renderer), texture(renderer.addTexture(SoftwareImage(width, height, WHITE))),
+          unshadedTiles(texture.width, texture.height) {
+        unshadedTiles.markAll();
+        if (watercolor.has_value()) {
+            filter = std::make_unique<WatercolorFilter>(texture.width, texture.height, *watercolor,
+                                                        pool);
+        }
+    }
+
+    void clear(const Color color) override {
+        image().clear(color);
+        unshadedTiles.markAll();
+    }
+
+    void drawStamps(const std::span<const PaintStamp> stamps,
+                    const CanvasDirtyTiles& dirtyTiles) override {
+        SoftwareImage& canvas = image();
+        for (const auto& [from, to, radius, color, paletteIndex] : stamps) {
+            canvas.fillCapsule(from, to, radius, color);
+        }
+        unshadedTiles.merge(dirtyTiles);
+    }
+
+    void draw(const ArenaCamera& camera) override {
+        const Rectangle bounds = {0.0F, 0.0F, static_cast<float>(texture.width),
+                                  static_cast<float>(texture.height)};
+        renderer.beginCamera(camera.camera);
+        if (filter == nullptr) {
+            renderer.drawTexture(texture, bounds, bounds, Vector2{0.0F, 0.0F}, 0.0F, WHITE);
+        } else {
+            if (unshadedTiles.any()) {
+                filter->apply(image(), unshadedTiles.getDirtyTiles());
+                unshadedTiles.clear();
+            }
+            renderer.drawImage(filter->getOutput(), bounds, bounds, Vector2{0.0F, 0.0F}, 0.0F,
+                               WHITE);
+        }
+        renderer.endCamera();
+    }
+
+    [[nodiscard]] int getWidth() const override { return texture.width; }
+    [[nodiscard]] int getHeight() const override { return texture.height; }
+
+private:
+    SoftwareRenderer& renderer;
+    Texture2D texture;
+    std::unique_ptr<WatercolorFilter> filter;
+    CanvasDirtyTiles unshadedTiles; // Painted since the filter last ran
+
+    [[nodiscard]] SoftwareImage& image() const { return *renderer.getTextureImage(texture); }
+};
+
+#endif // DIDDLEDOODLEDUEL_SOFTWARE_PAINT_CANVAS_H
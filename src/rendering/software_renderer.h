@@ -0,0 +1,141 @@
+#ifndef DIDDLEDOODLEDUEL_SOFTWARE_RENDERER_H
+#define DIDDLEDOODLEDUEL_SOFTWARE_RENDERER_H
+#include "rendering/irenderer.h"
+#include "rendering/software_image.h"
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <raylib.h>
+#include <string>
+#include <utility>
+
+// Renderer that draws into an in-memory framebuffer instead of a window, for golden-image
+// tests and for writing frames where there is no GPU. Textures it draws are images it holds:
+// added directly, or decoded from files with raylib's CPU image loader. The Texture2D handles
+// it gives out only mean something to this renderer.
+class SoftwareRenderer final : public engine::IRenderer {
+public:
+    explicit SoftwareRenderer(const int width = 1280, const int height = 720,
+                              const Color clearColor = RAYWHITE)
+        : framebuffer(width, height, clearColor), clearColor(clearColor) {
+    }
+
+    std::expected<void, std::string> initialize(const int newWidth, const int newHeight,
+                                                [[maybe_unused]] const std::string& title) override {
+        framebuffer = SoftwareImage(newWidth, newHeight, clearColor);
+        return {};
+    }
+
+    void shutdown() override {}
+    void beginFrame() override { framebuffer.clear(clearColor); }
+    void endFrame() override {}
+
+    [[nodiscard]] int getWindowWidth() const override { return framebuffer.getWidth(); }
+    [[nodiscard]] int getWindowHeight() const override { return framebuffer.getHeight(); }
+    [[nodiscard]] Vector2 getScreenCenter() const override {
+        return Vector2{static_cast<float>(framebuffer.getWidth()) * 0.5F,
+                       static_cast<float>(framebuffer.getHeight()) * 0.5F};
+    }
+
+    // Like raylib's BeginMode2D: until endCamera, positions and sizes are in world units and
+    // drawn through camera
+    void beginCamera(const Camera2D& newCamera) { camera = newCamera; }
+    void endCamera() { camera.reset(); }
+
+    void drawCircle(const Vector2 center, const float radius, const Color color) override {
+        framebuffer.fillCircle(toScreen(center), radius * zoom(), color);
+    }
+
+    // Under a camera the glyphs scale, but stay upright
+    void drawText(const std::string& text, const Vector2 position, const int fontSize,
+                  const Color color) override {
+        framebuffer.drawText(text, toScreen(position),
+                             static_cast<int>(std::lround(static_cast<float>(fontSize) * zoom())),
+                             color);
+    }
+
+    // Textures this renderer didn't hand out are skipped
+    void drawTexture(const Texture2D& texture, const Rectangle source, const Rectangle dest,
+                     const Vector2 origin, const float rotation, const Color tint) override {
+        if (const SoftwareImage* image = getTextureImage(texture); image != nullptr) {
+            drawImage(*image, source, dest, origin, rotation, tint);
+        }
+    }
+
+    // drawTexture for an image that isn't one of the renderer's textures
+    void drawImage(const SoftwareImage& image, const Rectangle source, const Rectangle dest,
+                   const Vector2 origin, const float rotation, const Color tint) {
+        if (!camera.has_value()) {
+            framebuffer.drawImage(image, source, dest, origin, rotation, tint);
+            return;
+        }
+        // dest's corner is the pivot, so it moves like any point and the rest scales about it
+        const Vector2 pivot = toScreen(Vector2{dest.x, dest.y});
+        const float scale = zoom();
+        framebuffer.drawImage(image, source,
+                              Rectangle{pivot.x, pivot.y, dest.width * scale, dest.height * scale},
+                              Vector2{origin.x * scale, origin.y * scale},
+                              rotation + camera->rotation, tint);
+    }
+
+    Texture2D addTexture(SoftwareImage image) {
+        textures.push_back(std::move(image));
+        const SoftwareImage& added = textures.back();
+        return Texture2D{.id = static_cast<unsigned int>(textures.size()),
+                         .width = added.getWidth(),
+                         .height = added.getHeight(),
+                         .mipmaps = 1,
+                         .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    }
+
+    // Texture2D{} when the file can't be decoded or converted to 8-bit RGBA
+    Texture2D loadTexture(const std::string& path) {
+        Image decoded = LoadImage(path.c_str());
+        if (decoded.data == nullptr) {
+            return Texture2D{};
+        }
+        // ImageFormat leaves e.g. compressed images as they were, which the copy can't read
+        ImageFormat(&decoded, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (decoded.data == nullptr || decoded.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            UnloadImage(decoded);
+            return Texture2D{};
+        }
+        SoftwareImage image(decoded.width, decoded.height);
+        std::memcpy(image.getPixels().data(), decoded.data, image.getPixels().size_bytes());
+        UnloadImage(decoded);
+        return addTexture(std::move(image));
+    }
+
+    // The pixels behind one of this renderer's textures, e.g. to draw into it like a render
+    // texture; nullptr for any other texture
+    [[nodiscard]] SoftwareImage* getTextureImage(const Texture2D& texture) {
+        return texture.id > 0 && texture.id <= textures.size() ? &textures[texture.id - 1]
+                                                               : nullptr;
+    }
+
+    [[nodiscard]] const SoftwareImage& getFramebuffer() const { return framebuffer; }
+
+private:
+    SoftwareImage framebuffer;
+    Color clearColor;
+    std::deque<SoftwareImage> textures; // Id is index + 1; a deque so images never move
+    std::optional<Camera2D> camera;
+
+    [[nodiscard]] float zoom() const { return camera.has_value() ? camera->zoom : 1.0F; }
+
+    // offset + zoom * rotate(point - target), as raylib's camera matrix does it
+    [[nodiscard]] Vector2 toScreen(const Vector2 point) const {
+        if (!camera.has_value()) {
+            return point;
+        }
+        const float cosine = std::cos(camera->rotation * DEG2RAD);
+        const float sine = std::sin(camera->rotation * DEG2RAD);
+        const float x = point.x - camera->target.x;
+        const float y = point.y - camera->target.y;
+        return Vector2{camera->offset.x + (((x * cosine) - (y * sine)) * camera->zoom),
+                       camera->offset.y + (((x * sine) + (y * cosine)) * camera->zoom)};
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_SOFTWARE_RENDERER_H
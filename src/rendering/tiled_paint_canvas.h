@@ -0,0 +1,274 @@
+#ifndef DIDDLEDOODLEDUEL_TILED_PAINT_CANVAS_H
+#define DIDDLEDOODLEDUEL_TILED_PAINT_CANVAS_H
+#include "canvas/pixel_runs.h"
+#include "performance/profiler.h"
+#include "rendering/canvas_tile_store.h"
+#include "rendering/paint_canvas.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Canvas for arenas larger than the window, in kTileSize tiles that only exist once something
+// is painted on them, so memory follows the painted area rather than the arena. Up to a budget
+// of tiles stay live in the store. Past it, the ones used longest ago (never those in view) are
+// read back and packed with pixel_runs, a few hundred bytes for a typical tile, and unpacked
+// the next time they are painted or seen. Only tiles the camera sees are drawn.
+class TiledPaintCanvas final : public PaintCanvas {
+public:
+    static constexpr int kTileSize = 256;
+
+    TiledPaintCanvas(std::unique_ptr<CanvasTileStore> store, const int width, const int height,
+                     const std::size_t residentBudget, const Color background = WHITE)
+        : store(std::move(store)), width(std::max(0, width)), height(std::max(0, height)),
+          columns((this->width + kTileSize - 1) / kTileSize),
+          rows((this->height + kTileSize - 1) / kTileSize),
+          residentBudget(std::max<std::size_t>(residentBudget, 1)), background(background) {
+    }
+
+    // Drops every tile, so the canvas costs nothing again
+    void clear(const Color color) override {
+        for (auto& [key, tile] : tiles) {
+            if (tile.resident.has_value()) {
+                store->destroy(*tile.resident);
+            }
+        }
+        tiles.clear();
+        residentCount = 0;
+        packedBytes = 0;
+        background = color;
+    }
+
+    // Each tile the stamps touch gets the ones touching it in one batch
+    void drawStamps(const std::span<const PaintStamp> stamps,
+                    [[maybe_unused]] const CanvasDirtyTiles& dirtyTiles) override {
+        if (stamps.empty()) {
+            return;
+        }
+        PROFILE_SCOPE("TiledCanvasStamps");
+        ++clock;
+
+        pending.clear();
+        for (const auto& stamp : stamps) {
+            const float reach = stamp.radius + 1.0F;
+            forEachTileIn(std::min(stamp.from.x, stamp.to.x) - reach,
+                          std::min(stamp.from.y, stamp.to.y) - reach,
+                          std::max(stamp.from.x, stamp.to.x) + reach,
+                          std::max(stamp.from.y, stamp.to.y) + reach,
+                          [&](const int column, const int row) {
+                              const Vector2 origin = tileOrigin(column, row);
+                              PaintStamp local = stamp;
+                              local.from = {stamp.from.x - origin.x, stamp.from.y - origin.y};
+                              local.to = {stamp.to.x - origin.x, stamp.to.y - origin.y};
+                              pending.push_back(PendingStamp{keyOf(column, row), local});
+                          });
+        }
+        // Stable, so overlapping stamps keep their order within a tile
+        std::ranges::stable_sort(pending, {}, &PendingStamp::key);
+
+        for (std::size_t begin = 0; begin < pending.size();) {
+            std::size_t end = begin;
+            batch.clear();
+            while (end < pending.size() && pending[end].key == pending[begin].key) {
+                batch.push_back(pending[end].stamp);
+                ++end;
+            }
+            store->drawStamps(use(pending[begin].key), batch);
+            begin = end;
+        }
+        packOverBudget();
+    }
+
+    void draw(const ArenaCamera& camera) override {
+        PROFILE_SCOPE("TiledCanvasDraw");
+        ++clock;
+
+        // Unpacking draws into the store, which it can't do mid-view, so that goes first. Runs of
+        // unpainted cells along a row become one gap.
+        visible.clear();
+        const Rectangle view = camera.getVisibleRect();
+        forEachTileIn(view.x, view.y, view.x + view.width, view.y + view.height,
+                      [&](const int column, const int row) {
+                          const Rectangle area = cellArea(column, row);
+                          const TileKey key = keyOf(column, row);
+                          if (tiles.contains(key)) {
+                              visible.push_back(VisibleCell{area, use(key)});
+                          } else if (!visible.empty() && !visible.back().tile.has_value() &&
+                                     visible.back().area.y == area.y &&
+                                     visible.back().area.x + visible.back().area.width ==
+                                         area.x) {
+                              visible.back().area.width += area.width;
+                          } else {
+                              visible.push_back(VisibleCell{area, std::nullopt});
+                          }
+                      });
+
+        store->beginView(camera);
+        for (const auto& [area, tile] : visible) {
+            if (tile.has_value()) {
+                store->drawTile(*tile, Rectangle{0.0F, 0.0F, area.width, area.height},
+                                Vector2{area.x, area.y});
+            } else {
+                store->drawEmpty(area, background);
+            }
+        }
+        store->endView();
+        packOverBudget();
+    }
+
+    [[nodiscard]] int getWidth() const override { return width; }
+    [[nodiscard]] int getHeight() const override { return height; }
+
+    // Tiles painted so far, live or packed
+    [[nodiscard]] std::size_t getTileCount() const { return tiles.size(); }
+    [[nodiscard]] std::size_t getResidentTileCount() const { return residentCount; }
+    [[nodiscard]] std::size_t getPackedBytes() const { return packedBytes; }
+
+    // The colour at an arena pixel, wherever its tile is. Slow; for tests.
+    [[nodiscard]] Color readPixel(const int x, const int y) {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return background;
+        }
+        const auto found = tiles.find(keyOf(x / kTileSize, y / kTileSize));
+        if (found == tiles.end()) {
+            return background;
+        }
+        scratch.resize(kTilePixels);
+        if (found->second.resident.has_value()) {
+            store->read(*found->second.resident, scratch);
+        } else {
+            pixel_runs::unpack(found->second.packed, scratch);
+        }
+        return scratch[static_cast<std::size_t>(((y % kTileSize) * kTileSize) + (x % kTileSize))];
+    }
+
+private:
+    using TileKey = std::uint64_t; // row * columns + column
+
+    static constexpr std::size_t kTilePixels = static_cast<std::size_t>(kTileSize) * kTileSize;
+
+    struct Tile {
+        std::optional<CanvasTileStore::TileId> resident;
+        std::vector<std::uint8_t> packed; // Its pixels while not resident
+        std::uint64_t lastUsed {0};
+    };
+
+    struct VisibleCell {
+        Rectangle area; // In the world, stopping at the arena's edge
+        std::optional<CanvasTileStore::TileId> tile;
+    };
+
+    struct PendingStamp {
+        TileKey key;
+        PaintStamp stamp;
+    };
+
+    std::unique_ptr<CanvasTileStore> store;
+    int width;
+    int height;
+    int columns;
+    int rows;
+    std::size_t residentBudget;
+    Color background;
+
+    std::unordered_map<TileKey, Tile> tiles;
+    std::size_t residentCount {0};
+    std::size_t packedBytes {0};
+    std::uint64_t clock {0}; // Counts stamp passes and draws
+
+    // Reused between calls
+    std::vector<PendingStamp> pending;
+    std::vector<PaintStamp> batch;
+    std::vector<VisibleCell> visible;
+    std::vector<std::pair<std::uint64_t, TileKey>> packable;
+    std::vector<Color> scratch;
+
+    [[nodiscard]] TileKey keyOf(const int column, const int row) const {
+        return (static_cast<TileKey>(row) * static_cast<TileKey>(columns)) +
+               static_cast<TileKey>(column);
+    }
+    [[nodiscard]] static Vector2 tileOrigin(const int column, const int row) {
+        return Vector2{static_cast<float>(column * kTileSize), static_cast<float>(row * kTileSize)};
+    }
+    // Edge cells stop at the arena's edge
+    [[nodiscard]] Rectangle cellArea(const int column, const int row) const {
+        constexpr auto kSize = static_cast<float>(kTileSize);
+        const Vector2 origin = tileOrigin(column, row);
+        return Rectangle{origin.x, origin.y, std::min(kSize, static_cast<float>(width) - origin.x),
+                         std::min(kSize, static_cast<float>(height) - origin.y)};
+    }
+
+    // Calls func(column, row) for the tiles overlapping a box in arena pixels
+    template <typename Func>
+    void forEachTileIn(const float minX, const float minY, const float maxX, const float maxY,
+                       const Func& func) const {
+        if (maxX < 0.0F || maxY < 0.0F || minX >= static_cast<float>(width) ||
+            minY >= static_cast<float>(height) || minX > maxX || minY > maxY) {
+            return;
+        }
+        const int firstColumn = std::max(0, static_cast<int>(minX) / kTileSize);
+        const int lastColumn = std::min(columns - 1, static_cast<int>(maxX) / kTileSize);
+        const int firstRow = std::max(0, static_cast<int>(minY) / kTileSize);
+        const int lastRow = std::min(rows - 1, static_cast<int>(maxY) / kTileSize);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                func(column, row);
+            }
+        }
+    }
+
+    // The tile's store id, creating or unpacking it as needed
+    CanvasTileStore::TileId use(const TileKey key) {
+        Tile& tile = tiles[key];
+        tile.lastUsed = clock;
+        if (tile.resident.has_value()) {
+            return *tile.resident;
+        }
+
+        const CanvasTileStore::TileId id = store->create(kTileSize, background);
+        if (!tile.packed.empty()) {
+            scratch.resize(kTilePixels);
+            pixel_runs::unpack(tile.packed, scratch);
+            store->write(id, scratch);
+            packedBytes -= tile.packed.size();
+            tile.packed = {};
+        }
+        tile.resident = id;
+        ++residentCount;
+        return id;
+    }
+
+    // Packs the tiles used longest ago down to three quarters of the budget, so a moving view
+    // doesn't read a tile back every frame
+    void packOverBudget() {
+        if (residentCount <= residentBudget) {
+            return;
+        }
+        packable.clear();
+        for (const auto& [key, tile] : tiles) {
+            if (tile.resident.has_value() && tile.lastUsed < clock) {
+                packable.emplace_back(tile.lastUsed, key);
+            }
+        }
+        const std::size_t target = residentBudget - (residentBudget / 4);
+        const std::size_t count = std::min(packable.size(), residentCount - target);
+        std::ranges::nth_element(packable, packable.begin() + static_cast<std::ptrdiff_t>(count));
+
+        scratch.resize(kTilePixels);
+        for (std::size_t index = 0; index < count; ++index) {
+            Tile& tile = tiles[packable[index].second];
+            store->read(*tile.resident, scratch);
+            tile.packed = pixel_runs::pack(scratch);
+            packedBytes += tile.packed.size();
+            store->destroy(*tile.resident);
+            tile.resident.reset();
+            --residentCount;
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_TILED_PAINT_CANVAS_H
@@ -0,0 +1,558 @@
+#include "rendering/watercolor_filter.h"
+#include "core/parallel_for.h"
+#include "performance/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define DDD_WATERCOLOR_SSE2 1
+#endif
+
+namespace {
+
+constexpr int kPowSteps = 4096;
+constexpr float kByteToFloat = 1.0F / 255.0F;
+
+// --- The shader's functions, in float as on the GPU ---
+
+float fract(const float value) {
+    return value - std::floor(value);
+}
+
+float mix(const float from, const float to, const float amount) {
+    return (from * (1.0F - amount)) + (to * amount);
+}
+
+float smoothstep(const float edge0, const float edge1, const float value) {
+    const float t = std::clamp((value - edge0) / (edge1 - edge0), 0.0F, 1.0F);
+    return t * t * (3.0F - (2.0F * t));
+}
+
+float hashNoise(const float x, const float y) {
+    return fract(std::sin((x * 12.9898F) + (y * 78.233F)) * 43758.5453F);
+}
+
+float smoothNoise(const float x, const float y) {
+    const float cellX = std::floor(x);
+    const float cellY = std::floor(y);
+    const float fx = smoothstep(0.0F, 1.0F, x - cellX);
+    const float fy = smoothstep(0.0F, 1.0F, y - cellY);
+    const float a = hashNoise(cellX, cellY);
+    const float b = hashNoise(cellX + 1.0F, cellY);
+    const float c = hashNoise(cellX, cellY + 1.0F);
+    const float d = hashNoise(cellX + 1.0F, cellY + 1.0F);
+    return mix(mix(a, b, fx), mix(c, d, fx), fy);
+}
+
+float fractalNoise(const float x, const float y) {
+    float value = 0.0F;
+    value += 0.5F * smoothNoise(x, y);
+    value += 0.25F * smoothNoise(x * 2.0F, y * 2.0F);
+    value += 0.125F * smoothNoise(x * 4.0F, y * 4.0F);
+    value += 0.0625F * smoothNoise(x * 8.0F, y * 8.0F);
+    return value;
+}
+
+// Noise sampled at uv * scale + phase, the shader's usual pattern
+float fractalNoiseAt(const float u, const float v, const float scale, const float phase) {
+    return fractalNoise((u * scale) + phase, (v * scale) + phase);
+}
+
+float paperTexture(const float u, const float v) {
+    const float paperX = u * 120.0F;
+    const float paperY = v * 120.0F;
+    float paper = fractalNoise(paperX, paperY) * 0.3F;
+    paper += std::sin(paperX * 0.4F) * std::sin(paperY * 0.6F) * 0.05F;
+    paper += std::cos((paperX * 0.7F) + (paperY * 0.3F)) * 0.03F;
+    return std::clamp(paper + 0.75F, 0.0F, 1.0F);
+}
+
+float settlementDarkening(const float u, const float v, const WatercolorSettings settings) {
+    const float settlement = fractalNoiseAt(u, v, 8.0F, settings.time * 0.01F);
+    return smoothstep(0.6F, 0.9F, settlement) * settings.intensity * 0.15F;
+}
+
+float colorNoiseOffset(const float u, const float v, const WatercolorSettings settings) {
+    const float noise = (fractalNoiseAt(u, v, 12.0F, settings.time * 0.02F) * 0.08F) - 0.04F;
+    return noise * settings.intensity * 0.5F;
+}
+
+float edgeNoiseFactor(const float u, const float v, const WatercolorSettings settings) {
+    const float noise = (fractalNoiseAt(u, v, 25.0F, settings.time * 0.03F) * 0.5F) + 0.5F;
+    return mix(0.6F, 1.0F, noise);
+}
+
+float wetBleedAmount(const float u, const float v, const WatercolorSettings settings) {
+    return fractalNoiseAt(u, v, 20.0F, settings.time * 0.05F) * 0.1F * settings.intensity * 0.3F;
+}
+
+// One of the eight colour bleeding taps
+struct Tap {
+    float offsetX;
+    float offsetY;
+    float phase;
+    float weight;
+};
+
+std::array<Tap, WatercolorFilter::kTapCount> tapLayout(const WatercolorSettings settings) {
+    std::array<Tap, WatercolorFilter::kTapCount> layout {};
+    for (int index = 0; index < WatercolorFilter::kTapCount; ++index) {
+        const float angle = static_cast<float>(index) * 0.78539816F;
+        const float phase = (settings.time * 0.1F) + (static_cast<float>(index) * 0.5F);
+        const float radius = 0.003F * settings.intensity * (1.0F + (std::sin(phase) * 0.3F));
+        const float offsetX = std::cos(angle) * radius;
+        const float offsetY = std::sin(angle) * radius;
+        const float length = std::sqrt((offsetX * offsetX) + (offsetY * offsetY));
+        layout[static_cast<std::size_t>(index)] =
+            Tap{offsetX, offsetY, phase, 1.0F / (1.0F + (length * 200.0F))};
+    }
+    return layout;
+}
+
+// The texel a tap from uv samples with nearest filtering, or false if it lands outside
+bool tapTexel(const Tap& tap, const float u, const float v, const WatercolorSettings settings,
+              const int width, const int height, int& texelX, int& texelY) {
+    const float noiseScale = 0.002F * settings.intensity;
+    const float sampleU = u + tap.offsetX + (fractalNoiseAt(u, v, 15.0F, tap.phase) * noiseScale);
+    const float sampleV =
+        v + tap.offsetY + (fractalNoiseAt(u, v, 15.0F, tap.phase + 100.0F) * noiseScale);
+    if (sampleU < 0.0F || sampleU > 1.0F || sampleV < 0.0F || sampleV > 1.0F) {
+        return false;
+    }
+    texelX = std::min(static_cast<int>(sampleU * static_cast<float>(width)), width - 1);
+    // Texture rows run bottom-up in the shader, the canvas image top-down
+    const int textureRow =
+        std::min(static_cast<int>(sampleV * static_cast<float>(height)), height - 1);
+    texelY = height - 1 - textureRow;
+    return true;
+}
+
+// The shader's uv at a pixel's centre
+float pixelU(const int x, const int width) {
+    return (static_cast<float>(x) + 0.5F) / static_cast<float>(width);
+}
+
+float pixelV(const int y, const int height) {
+    return 1.0F - ((static_cast<float>(y) + 0.5F) / static_cast<float>(height));
+}
+
+// The unorm conversion of the render target
+std::uint8_t toByte(const float value) {
+    return static_cast<std::uint8_t>((std::clamp(value, 0.0F, 1.0F) * 255.0F) + 0.5F);
+}
+
+// Whether the shader shades the pixel at all rather than passing it through
+bool hasContent(const Color texel) {
+    const float red = static_cast<float>(texel.r) * kByteToFloat;
+    const float green = static_cast<float>(texel.g) * kByteToFloat;
+    const float blue = static_cast<float>(texel.b) * kByteToFloat;
+    return static_cast<float>(texel.a) * kByteToFloat > 0.01F &&
+           std::sqrt((red * red) + (green * green) + (blue * blue)) > 0.01F;
+}
+
+// Per-pixel inputs of the last shading stage, one row of a tile
+struct FinishRow {
+    const float* red;
+    const float* green;
+    const float* blue;
+    const float* alpha;
+    const float* paperScale;
+    const float* settleScale;
+    const float* colorNoise;
+    const float* edgeFactor;
+    const float* wetBleed;
+};
+
+// Warm tint, colour noise, settlement, paper, edge softening and wet bleed for one pixel
+Color finishPixel(const FinishRow& row, const int column, const float softenScale) {
+    const float alpha = row.alpha[column];
+    const float settle = alpha >= 0.1F ? row.settleScale[column] : 1.0F;
+    const float scale = settle * row.paperScale[column];
+    const float noise = row.colorNoise[column];
+    float red = ((row.red[column] * 1.03F) + noise) * scale;
+    float green = ((row.green[column] * 1.01F) + noise) * scale;
+    float blue = ((row.blue[column] * 0.98F) + noise) * scale;
+
+    const float keep = 1.0F - ((1.0F - alpha) * softenScale);
+    const float softened = (alpha * row.edgeFactor[column] * (1.0F - keep)) + (alpha * keep);
+    if (softened > 0.5F && softened < 0.9F) {
+        const float wet = row.wetBleed[column];
+        red += wet * 0.1F;
+        green += wet * 0.05F;
+        blue += wet * 0.15F;
+    }
+    return Color{toByte(red), toByte(green), toByte(blue), toByte(softened)};
+}
+
+#if defined(DDD_WATERCOLOR_SSE2)
+__m128 select(const __m128 mask, const __m128 ifSet, const __m128 ifClear) {
+    return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, ifClear));
+}
+
+__m128i toBytes(const __m128 value) {
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0F));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0F)),
+                                       _mm_set1_ps(0.5F)));
+}
+
+// finishPixel for four pixels, with the same operations in the same order
+__m128i finish4(const FinishRow& row, const int column, const __m128 softenScale) {
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 alpha = _mm_loadu_ps(row.alpha + column);
+    const __m128 settle = select(_mm_cmpge_ps(alpha, _mm_set1_ps(0.1F)),
+                                 _mm_loadu_ps(row.settleScale + column), one);
+    const __m128 scale = _mm_mul_ps(settle, _mm_loadu_ps(row.paperScale + column));
+    const __m128 noise = _mm_loadu_ps(row.colorNoise + column);
+    __m128 red = _mm_mul_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row.red + column), _mm_set1_ps(1.03F)), noise), scale);
+    __m128 green = _mm_mul_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row.green + column), _mm_set1_ps(1.01F)), noise),
+        scale);
+    __m128 blue = _mm_mul_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row.blue + column), _mm_set1_ps(0.98F)), noise),
+        scale);
+
+    const __m128 keep = _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(one, alpha), softenScale));
+    const __m128 softened = _mm_add_ps(
+        _mm_mul_ps(_mm_mul_ps(alpha, _mm_loadu_ps(row.edgeFactor + column)), _mm_sub_ps(one, keep)),
+        _mm_mul_ps(alpha, keep));
+    // Adding zero where the shader skips the wet bleed leaves those lanes as they are
+    const __m128 wetLanes = _mm_and_ps(_mm_cmpgt_ps(softened, _mm_set1_ps(0.5F)),
+                                       _mm_cmplt_ps(softened, _mm_set1_ps(0.9F)));
+    const __m128 wet = _mm_and_ps(wetLanes, _mm_loadu_ps(row.wetBleed + column));
+    red = _mm_add_ps(red, _mm_mul_ps(wet, _mm_set1_ps(0.1F)));
+    green = _mm_add_ps(green, _mm_mul_ps(wet, _mm_set1_ps(0.05F)));
+    blue = _mm_add_ps(blue, _mm_mul_ps(wet, _mm_set1_ps(0.15F)));
+
+    return _mm_or_si128(_mm_or_si128(toBytes(red), _mm_slli_epi32(toBytes(green), 8)),
+                        _mm_or_si128(_mm_slli_epi32(toBytes(blue), 16),
+                                     _mm_slli_epi32(toBytes(softened), 24)));
+}
+#endif
+
+void finishRow(const FinishRow& row, const int count, const float softenScale, Color* out) {
+    int column = 0;
+#if defined(DDD_WATERCOLOR_SSE2)
+    const __m128 wideSoftenScale = _mm_set1_ps(softenScale);
+    for (; column + 4 <= count; column += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + column),
+                         finish4(row, column, wideSoftenScale));
+    }
+#endif
+    for (; column < count; ++column) {
+        out[column] = finishPixel(row, column, softenScale);
+    }
+}
+
+} // namespace
+
+WatercolorFilter::WatercolorFilter(const int width, const int height,
+                                   const WatercolorSettings settings, ThreadPool* pool)
+    : width(std::max(0, width)), height(std::max(0, height)),
+      tilesX((this->width + kTileSize - 1) / kTileSize),
+      tilesY((this->height + kTileSize - 1) / kTileSize), settings(settings), pool(pool),
+      previous(this->width, this->height), output(this->width, this->height),
+      changedTiles(getTileCount()) {
+    const auto layout = tapLayout(settings);
+    for (std::size_t tap = 0; tap < layout.size(); ++tap) {
+        tapWeights[tap] = layout[tap].weight;
+    }
+    for (std::size_t mask = 0; mask < inverseWeightSums.size(); ++mask) {
+        float sum = 0.0F;
+        for (std::size_t tap = 0; tap < layout.size(); ++tap) {
+            sum += ((mask >> tap) & 1U) != 0 ? tapWeights[tap] : 0.0F;
+        }
+        inverseWeightSums[mask] = sum > 0.0F ? 1.0F / sum : 0.0F;
+    }
+    powTable.resize(kPowSteps + 1);
+    for (int step = 0; step <= kPowSteps; ++step) {
+        powTable[static_cast<std::size_t>(step)] =
+            std::pow(static_cast<float>(step) / static_cast<float>(kPowSteps), 0.95F);
+    }
+
+    const std::size_t pixelCount =
+        static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->height);
+    paperScale.resize(pixelCount);
+    settleScale.resize(pixelCount);
+    colorNoise.resize(pixelCount);
+    edgeFactor.resize(pixelCount);
+    wetBleed.resize(pixelCount);
+    taps.resize(pixelCount * kTapCount);
+    tapMasks.resize(pixelCount);
+
+    // Hundreds of noise evaluations per pixel, so spread over the pool too
+    std::vector<int> rowReach(static_cast<std::size_t>(this->height), 0);
+    parallelFor(pool, rowReach.size(), 8, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t row = begin; row < end; ++row) {
+            rowReach[row] = buildRowTables(static_cast<int>(row));
+        }
+    });
+    reach = rowReach.empty() ? 0 : std::ranges::max(rowReach);
+}
+
+std::size_t WatercolorFilter::apply(const SoftwareImage& source) {
+    parallelFor(pool, changedTiles.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t tile = begin; tile < end; ++tile) {
+            changedTiles[tile] = static_cast<std::uint8_t>(copyIfChanged(source, tile));
+        }
+    });
+    return shadeChanged(source);
+}
+
+std::size_t WatercolorFilter::apply(const SoftwareImage& source,
+                                    const std::span<const std::uint32_t> changed) {
+    std::ranges::fill(changedTiles, std::uint8_t {0});
+    for (const std::uint32_t tile : changed) {
+        if (tile < changedTiles.size()) {
+            changedTiles[tile] = 1;
+        }
+    }
+    return shadeChanged(source);
+}
+
+std::size_t WatercolorFilter::shadeChanged(const SoftwareImage& source) {
+    PROFILE_SCOPE("Watercolor");
+    if (!shadedOnce) {
+        std::ranges::fill(changedTiles, std::uint8_t {1});
+        shadedOnce = true;
+    }
+
+    // A changed pixel reaches every tile that has a pixel tapping it
+    const int reachTiles = (reach + kTileSize - 1) / kTileSize;
+    dirtyTiles.clear();
+    for (int tileY = 0; tileY < tilesY; ++tileY) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            bool dirty = false;
+            for (int nearY = std::max(0, tileY - reachTiles);
+                 !dirty && nearY <= std::min(tilesY - 1, tileY + reachTiles); ++nearY) {
+                for (int nearX = std::max(0, tileX - reachTiles);
+                     !dirty && nearX <= std::min(tilesX - 1, tileX + reachTiles); ++nearX) {
+                    dirty = changedTiles[static_cast<std::size_t>((nearY * tilesX) + nearX)] != 0;
+                }
+            }
+            if (dirty) {
+                dirtyTiles.push_back(static_cast<std::size_t>((tileY * tilesX) + tileX));
+            }
+        }
+    }
+
+    parallelFor(pool, dirtyTiles.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            shadeTile(source, dirtyTiles[index]);
+        }
+    });
+    return dirtyTiles.size();
+}
+
+Color WatercolorFilter::shadeReference(const SoftwareImage& source, const int x, const int y,
+                                       const WatercolorSettings settings) {
+    const int width = source.getWidth();
+    const int height = source.getHeight();
+    const float u = pixelU(x, width);
+    const float v = pixelV(y, height);
+    const Color texel = source.at(x, y);
+    float red = static_cast<float>(texel.r) / 255.0F;
+    float green = static_cast<float>(texel.g) / 255.0F;
+    float blue = static_cast<float>(texel.b) / 255.0F;
+    float alpha = static_cast<float>(texel.a) / 255.0F;
+
+    if (alpha > 0.01F && std::sqrt((red * red) + (green * green) + (blue * blue)) > 0.01F) {
+        // colorBleeding
+        float bleedRed = 0.0F;
+        float bleedGreen = 0.0F;
+        float bleedBlue = 0.0F;
+        float totalWeight = 0.0F;
+        for (const Tap& tap : tapLayout(settings)) {
+            int texelX = 0;
+            int texelY = 0;
+            if (tapTexel(tap, u, v, settings, width, height, texelX, texelY)) {
+                const Color sample = source.at(texelX, texelY);
+                bleedRed += static_cast<float>(sample.r) / 255.0F * tap.weight;
+                bleedGreen += static_cast<float>(sample.g) / 255.0F * tap.weight;
+                bleedBlue += static_cast<float>(sample.b) / 255.0F * tap.weight;
+                totalWeight += tap.weight;
+            }
+        }
+        if (totalWeight > 0.0F) {
+            const float bleedAmount = settings.intensity * 0.25F;
+            red = mix(red, bleedRed / totalWeight, bleedAmount);
+            green = mix(green, bleedGreen / totalWeight, bleedAmount);
+            blue = mix(blue, bleedBlue / totalWeight, bleedAmount);
+        }
+
+        // watercolorColorAdjust
+        const float luminance = (red * 0.299F) + (green * 0.587F) + (blue * 0.114F);
+        red = std::pow(mix(luminance, red, 0.82F), 0.95F) * 1.03F;
+        green = std::pow(mix(luminance, green, 0.82F), 0.95F) * 1.01F;
+        blue = std::pow(mix(luminance, blue, 0.82F), 0.95F) * 0.98F;
+        const float noise = colorNoiseOffset(u, v, settings);
+        red += noise;
+        green += noise;
+        blue += noise;
+
+        // pigmentSettling
+        if (alpha >= 0.1F) {
+            const float darken = settlementDarkening(u, v, settings);
+            red *= 1.0F - darken;
+            green *= 1.0F - darken;
+            blue *= 1.0F - darken;
+        }
+
+        const float paper = paperTexture(u, v);
+        red = mix(red * 0.9F, red * paper, settings.intensity);
+        green = mix(green * 0.9F, green * paper, settings.intensity);
+        blue = mix(blue * 0.9F, blue * paper, settings.intensity);
+
+        // edgeSoftening
+        const float softening = (1.0F - alpha) * settings.intensity * 0.4F;
+        alpha = mix(alpha * edgeNoiseFactor(u, v, settings), alpha, 1.0F - softening);
+
+        if (alpha > 0.5F && alpha < 0.9F) {
+            const float wet = wetBleedAmount(u, v, settings);
+            red += wet * 0.1F;
+            green += wet * 0.05F;
+            blue += wet * 0.15F;
+        }
+    }
+    return Color{toByte(red), toByte(green), toByte(blue), toByte(alpha)};
+}
+
+int WatercolorFilter::buildRowTables(const int y) {
+    const auto layout = tapLayout(settings);
+    const float v = pixelV(y, height);
+    int rowReach = 0;
+    for (int x = 0; x < width; ++x) {
+        const float u = pixelU(x, width);
+        const std::size_t index = (static_cast<std::size_t>(y) * static_cast<std::size_t>(width)) +
+                                  static_cast<std::size_t>(x);
+        paperScale[index] = mix(0.9F, paperTexture(u, v), settings.intensity);
+        settleScale[index] = 1.0F - settlementDarkening(u, v, settings);
+        colorNoise[index] = colorNoiseOffset(u, v, settings);
+        edgeFactor[index] = edgeNoiseFactor(u, v, settings);
+        wetBleed[index] = wetBleedAmount(u, v, settings);
+
+        std::uint8_t mask = 0;
+        for (std::size_t tap = 0; tap < layout.size(); ++tap) {
+            int texelX = 0;
+            int texelY = 0;
+            TapOffset& offset = taps[(index * kTapCount) + tap];
+            offset = TapOffset{0, 0};
+            if (!tapTexel(layout[tap], u, v, settings, width, height, texelX, texelY)) {
+                continue;
+            }
+            // Only an intensity far past the shader's range reaches further than this
+            const int dx = std::clamp(texelX - x, -127, 127);
+            const int dy = std::clamp(texelY - y, -127, 127);
+            offset = TapOffset{static_cast<std::int8_t>(dx), static_cast<std::int8_t>(dy)};
+            mask = static_cast<std::uint8_t>(mask | (1U << tap));
+            rowReach = std::max({rowReach, std::abs(dx), std::abs(dy)});
+        }
+        tapMasks[index] = mask;
+    }
+    return rowReach;
+}
+
+bool WatercolorFilter::copyIfChanged(const SoftwareImage& source, const std::size_t tile) {
+    const int left = static_cast<int>(tile % static_cast<std::size_t>(tilesX)) * kTileSize;
+    const int top = static_cast<int>(tile / static_cast<std::size_t>(tilesX)) * kTileSize;
+    const std::size_t rowBytes =
+        static_cast<std::size_t>(std::min(kTileSize, width - left)) * sizeof(Color);
+    bool changed = false;
+    for (int y = top; y < std::min(top + kTileSize, height); ++y) {
+        const std::size_t start = (static_cast<std::size_t>(y) * static_cast<std::size_t>(width)) +
+                                  static_cast<std::size_t>(left);
+        const Color* current = source.getPixels().data() + start;
+        Color* last = previous.getPixels().data() + start;
+        if (std::memcmp(current, last, rowBytes) != 0) {
+            std::memcpy(last, current, rowBytes);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void WatercolorFilter::shadeTile(const SoftwareImage& source, const std::size_t tile) {
+    const int left = static_cast<int>(tile % static_cast<std::size_t>(tilesX)) * kTileSize;
+    const int top = static_cast<int>(tile / static_cast<std::size_t>(tilesX)) * kTileSize;
+    const int columns = std::min(kTileSize, width - left);
+    const float bleedAmount = settings.intensity * 0.25F;
+    const float softenScale = settings.intensity * 0.4F;
+    const Color* pixels = source.getPixels().data();
+
+    std::array<float, kTileSize> red {};
+    std::array<float, kTileSize> green {};
+    std::array<float, kTileSize> blue {};
+    std::array<float, kTileSize> alpha {};
+    std::array<bool, kTileSize> content {};
+    for (int y = top; y < std::min(top + kTileSize, height); ++y) {
+        const std::size_t rowStart =
+            (static_cast<std::size_t>(y) * static_cast<std::size_t>(width)) +
+            static_cast<std::size_t>(left);
+
+        // Colour bleeding, desaturation and the contrast curve: gathers and table lookups
+        for (int column = 0; column < columns; ++column) {
+            const std::size_t index = rowStart + static_cast<std::size_t>(column);
+            const auto slot = static_cast<std::size_t>(column);
+            const Color texel = pixels[index];
+            content[slot] = hasContent(texel);
+            alpha[slot] = static_cast<float>(texel.a) * kByteToFloat;
+            float r = static_cast<float>(texel.r) * kByteToFloat;
+            float g = static_cast<float>(texel.g) * kByteToFloat;
+            float b = static_cast<float>(texel.b) * kByteToFloat;
+
+            if (const std::uint8_t mask = tapMasks[index]; content[slot] && mask != 0) {
+                float bleedRed = 0.0F;
+                float bleedGreen = 0.0F;
+                float bleedBlue = 0.0F;
+                const TapOffset* pixelTaps = &taps[index * kTapCount];
+                for (std::size_t tap = 0; tap < kTapCount; ++tap) {
+                    if (((mask >> tap) & 1U) == 0) {
+                        continue;
+                    }
+                    const Color sample =
+                        pixels[static_cast<std::ptrdiff_t>(index) +
+                               (static_cast<std::ptrdiff_t>(pixelTaps[tap].dy) * width) +
+                               pixelTaps[tap].dx];
+                    bleedRed += static_cast<float>(sample.r) * tapWeights[tap];
+                    bleedGreen += static_cast<float>(sample.g) * tapWeights[tap];
+                    bleedBlue += static_cast<float>(sample.b) * tapWeights[tap];
+                }
+                const float normalize = inverseWeightSums[mask] * kByteToFloat;
+                r = mix(r, bleedRed * normalize, bleedAmount);
+                g = mix(g, bleedGreen * normalize, bleedAmount);
+                b = mix(b, bleedBlue * normalize, bleedAmount);
+            }
+
+            const float luminance = (r * 0.299F) + (g * 0.587F) + (b * 0.114F);
+            const auto curve = [&](const float value) {
+                const float step = std::clamp(value, 0.0F, 1.0F) * static_cast<float>(kPowSteps);
+                return powTable[static_cast<std::size_t>(step + 0.5F)];
+            };
+            red[slot] = curve(mix(luminance, r, 0.82F));
+            green[slot] = curve(mix(luminance, g, 0.82F));
+            blue[slot] = curve(mix(luminance, b, 0.82F));
+        }
+
+        const FinishRow row {red.data(),
+                             green.data(),
+                             blue.data(),
+                             alpha.data(),
+                             paperScale.data() + rowStart,
+                             settleScale.data() + rowStart,
+                             colorNoise.data() + rowStart,
+                             edgeFactor.data() + rowStart,
+                             wetBleed.data() + rowStart};
+        Color* out = output.getPixels().data() + rowStart;
+        finishRow(row, columns, softenScale, out);
+
+        // The shader passes empty pixels through untouched
+        for (int column = 0; column < columns; ++column) {
+            if (!content[static_cast<std::size_t>(column)]) {
+                out[column] = pixels[rowStart + static_cast<std::size_t>(column)];
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef DIDDLEDOODLEDUEL_WATERCOLOR_FILTER_H
+#define DIDDLEDOODLEDUEL_WATERCOLOR_FILTER_H
+#include "canvas/dirty_tiles.h"
+#include "core/thread_pool.h"
+#include "rendering/software_image.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+// The watercolor shader's uniforms
+struct WatercolorSettings {
+    float intensity {1.0F};
+    float time {0.0F}; // The noise is baked for this moment, so it doesn't animate
+};
+
+// CPU version of resources/shaders/watercolor.fs, for the software canvas and as a reference
+// when tuning the shader. Everything the shader works out from the pixel's position alone (paper
+// texture, pigment settlement, edge and colour noise, where each of the eight bleed taps lands)
+// is evaluated once into per-pixel tables of about 40 bytes a pixel. What is left per frame is
+// the tap gather plus a few multiplies, done four pixels at a time with SSE2. The image is shaded
+// in tiles on the thread pool, and only tiles within bleed reach of a changed pixel are redone.
+class WatercolorFilter {
+public:
+    // Tiles line up with CanvasDirtyTiles, so its lists can say what to shade
+    static constexpr int kTileSize = CanvasDirtyTiles::kTileSize;
+    static constexpr int kTapCount = 8;
+
+    // The pool, if any, must outlive the filter
+    WatercolorFilter(int width, int height, WatercolorSettings settings = {},
+                     ThreadPool* pool = nullptr);
+
+    // Shades source, which must be width x height, into getOutput(). Returns the number of tiles
+    // shaded: all of them the first time, then only those near pixels that changed.
+    std::size_t apply(const SoftwareImage& source);
+    // The same, trusting changed (CanvasDirtyTiles indices) instead of comparing pixels
+    std::size_t apply(const SoftwareImage& source, std::span<const std::uint32_t> changed);
+
+    [[nodiscard]] const SoftwareImage& getOutput() const { return output; }
+    [[nodiscard]] std::size_t getTileCount() const {
+        return static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY);
+    }
+    // Furthest a bleed tap reads from its pixel, in pixels
+    [[nodiscard]] int getReach() const { return reach; }
+
+    // The shader evaluated as written for one pixel, with no tables. Slow; for tests and tuning.
+    static Color shadeReference(const SoftwareImage& source, int x, int y,
+                                WatercolorSettings settings);
+
+private:
+    struct TapOffset {
+        std::int8_t dx;
+        std::int8_t dy;
+    };
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    int reach {0};
+    WatercolorSettings settings;
+    ThreadPool* pool;
+
+    // Per pixel, row-major
+    std::vector<float> paperScale;  // Paper texture blended in by intensity
+    std::vector<float> settleScale; // Darkening where pigment settles
+    std::vector<float> colorNoise;
+    std::vector<float> edgeFactor;
+    std::vector<float> wetBleed;
+    std::vector<TapOffset> taps;    // kTapCount per pixel
+    std::vector<std::uint8_t> tapMasks; // Bit per tap landing inside the image
+
+    std::array<float, kTapCount> tapWeights {};
+    std::array<float, 256> inverseWeightSums {}; // By tap mask
+    std::vector<float> powTable;                 // pow(x, 0.95) over [0, 1]
+
+    SoftwareImage previous; // Source as of the last apply that compared pixels
+    SoftwareImage output;
+    bool shadedOnce {false};
+    std::vector<std::uint8_t> changedTiles;
+    std::vector<std::size_t> dirtyTiles;
+
+    int buildRowTables(int y); // Returns the row's reach
+    bool copyIfChanged(const SoftwareImage& source, std::size_t tile);
+    std::size_t shadeChanged(const SoftwareImage& source);
+    void shadeTile(const SoftwareImage& source, std::size_t tile);
+};
+
+#endif // DIDDLEDOODLEDUEL_WATERCOLOR_FILTER_H
@@ -0,0 +1,251 @@
+#include "replay/canvas_stream.h"
+#include "canvas/byte_runs.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <string>
+#include <utility>
+
+// Layout, all integers little-endian:
+//   header: "DDDC", u16 version, u8 bits per cell, u8 palette entries, u32 width, u32 height,
+//           f32 cell size, then each palette entry's u8 r, g, b, a
+//   frames: u8 kind, u32 tick, then per stored row: varint rows on from the last stored row
+//           (from -1, so at least 1), varint packed size, the PackedCanvas row's byte_runs.
+//           A 0 in place of the row step ends the frame.
+//
+// Snapshots store every row and reset a reader; deltas store the changed rows and only make
+// sense after the frames before them.
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'D', 'D', 'D', 'C'};
+constexpr std::uint16_t kVersion = 1;
+constexpr std::uint8_t kSnapshot = 0;
+constexpr std::uint8_t kDelta = 1;
+
+template <typename T>
+void appendInteger(std::vector<std::uint8_t>& output, const T value) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+        output.push_back(static_cast<std::uint8_t>((bits >> (byte * 8)) & 0xFFU));
+    }
+}
+
+void appendVarint(std::vector<std::uint8_t>& output, std::uint32_t value) {
+    while (value >= 0x80U) {
+        output.push_back(static_cast<std::uint8_t>((value & 0x7FU) | 0x80U));
+        value >>= 7U;
+    }
+    output.push_back(static_cast<std::uint8_t>(value));
+}
+
+class Reader {
+public:
+    explicit Reader(std::istream& input) : input(input) {
+    }
+
+    bool bytes(void* data, const std::size_t size) {
+        return static_cast<bool>(
+            input.read(static_cast<char*>(data), static_cast<std::streamsize>(size)));
+    }
+
+    template <typename T>
+    bool integer(T& value) {
+        std::uint64_t bits = 0;
+        for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+            const int next = input.get();
+            if (next == std::istream::traits_type::eof()) {
+                return false;
+            }
+            bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(next)) << (byte * 8);
+        }
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    bool varint(std::uint32_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 32; shift += 7) {
+            const int next = input.get();
+            if (next == std::istream::traits_type::eof()) {
+                return false;
+            }
+            value |= static_cast<std::uint32_t>(next & 0x7F) << shift;
+            if ((next & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::istream& input;
+};
+
+std::size_t usedEntries(const std::span<const Color> palette) {
+    return std::clamp<std::size_t>(palette.size(), 1, CanvasOwnershipGrid::kMaxPaletteEntries);
+}
+
+} // namespace
+
+CanvasStreamWriter::CanvasStreamWriter(std::ostream& output, const CanvasOwnershipGrid& grid,
+                                       const std::span<const Color> palette)
+    : output(output), paletteEntries(usedEntries(palette)),
+      previous(grid.getWidth(), grid.getHeight(), PackedCanvas::bitsFor(paletteEntries)),
+      cells(static_cast<std::size_t>(grid.getWidth())), packedRow(previous.getRowBytes()) {
+    std::vector<std::uint8_t> header(kMagic.begin(), kMagic.end());
+    appendInteger(header, kVersion);
+    appendInteger(header, static_cast<std::uint8_t>(previous.getBitsPerCell()));
+    appendInteger(header, static_cast<std::uint8_t>(paletteEntries));
+    appendInteger(header, static_cast<std::uint32_t>(grid.getWidth()));
+    appendInteger(header, static_cast<std::uint32_t>(grid.getHeight()));
+    appendInteger(header, std::bit_cast<std::uint32_t>(grid.getCellSize()));
+    for (std::size_t entry = 0; entry < paletteEntries; ++entry) {
+        const Color color = entry < palette.size() ? palette[entry] : BLANK;
+        header.insert(header.end(), {color.r, color.g, color.b, color.a});
+    }
+    put(header);
+}
+
+bool CanvasStreamWriter::writeDelta(const CanvasOwnershipGrid& grid, const std::uint32_t tick) {
+    return writeFrame(grid, tick, frameCount == 0);
+}
+
+bool CanvasStreamWriter::writeSnapshot(const CanvasOwnershipGrid& grid, const std::uint32_t tick) {
+    return writeFrame(grid, tick, true);
+}
+
+bool CanvasStreamWriter::writeFrame(const CanvasOwnershipGrid& grid, const std::uint32_t tick,
+                                    const bool snapshot) {
+    if (grid.getWidth() != previous.getWidth() || grid.getHeight() != previous.getHeight()) {
+        return false;
+    }
+
+    prefix.clear();
+    appendInteger(prefix, snapshot ? kSnapshot : kDelta);
+    appendInteger(prefix, tick);
+    put(prefix);
+
+    // Each row goes out as soon as it is packed, so only one is ever held
+    const auto gridCells = grid.getCells();
+    int lastStored = -1;
+    for (int row = 0; row < grid.getHeight(); ++row) {
+        const auto source = gridCells.subspan(static_cast<std::size_t>(row) * cells.size(),
+                                              cells.size());
+        std::ranges::transform(source, cells.begin(), [this](const std::uint8_t cell) {
+            return cell < paletteEntries ? cell : CanvasOwnershipGrid::kUnpainted;
+        });
+        previous.packRow(cells, packedRow);
+
+        const auto stored = previous.getRow(row);
+        if (!snapshot && std::ranges::equal(packedRow, stored)) {
+            continue;
+        }
+        std::ranges::copy(packedRow, stored.begin());
+
+        runs.clear();
+        byte_runs::pack(packedRow, runs);
+        prefix.clear();
+        appendVarint(prefix, static_cast<std::uint32_t>(row - lastStored));
+        appendVarint(prefix, static_cast<std::uint32_t>(runs.size()));
+        put(prefix);
+        put(runs);
+        lastStored = row;
+    }
+
+    prefix.assign(1, 0);
+    put(prefix);
+    ++frameCount;
+    return static_cast<bool>(output);
+}
+
+void CanvasStreamWriter::put(const std::span<const std::uint8_t> bytes) {
+    output.write(reinterpret_cast<const char*>(bytes.data()),
+                 static_cast<std::streamsize>(bytes.size()));
+    bytesWritten += bytes.size();
+}
+
+std::expected<CanvasStreamReader, std::string> CanvasStreamReader::open(std::istream& input) {
+    Reader reader(input);
+    std::array<char, 4> magic {};
+    if (!reader.bytes(magic.data(), magic.size()) || magic != kMagic) {
+        return std::unexpected("not a canvas stream");
+    }
+    std::uint16_t version = 0;
+    std::uint8_t bitsPerCell = 0;
+    std::uint8_t entries = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t cellSizeBits = 0;
+    if (!reader.integer(version) || !reader.integer(bitsPerCell) || !reader.integer(entries) ||
+        !reader.integer(width) || !reader.integer(height) || !reader.integer(cellSizeBits)) {
+        return std::unexpected("truncated header");
+    }
+    if (version != kVersion) {
+        return std::unexpected("unsupported canvas stream version " + std::to_string(version));
+    }
+    if ((bitsPerCell != 2 && bitsPerCell != 4) || entries == 0 ||
+        entries > (1U << bitsPerCell) || width > (1U << 16U) || height > (1U << 16U)) {
+        return std::unexpected("bad canvas shape");
+    }
+
+    std::vector<Color> palette(entries);
+    for (Color& color : palette) {
+        if (!reader.integer(color.r) || !reader.integer(color.g) || !reader.integer(color.b) ||
+            !reader.integer(color.a)) {
+            return std::unexpected("truncated palette");
+        }
+    }
+    return CanvasStreamReader(input, std::bit_cast<float>(cellSizeBits), std::move(palette),
+                              PackedCanvas(static_cast<int>(width), static_cast<int>(height),
+                                           bitsPerCell));
+}
+
+CanvasStreamReader::CanvasStreamReader(std::istream& input, const float cellSize,
+                                       std::vector<Color> palette, PackedCanvas canvas)
+    : input(&input), cellSize(cellSize), palette(std::move(palette)), canvas(std::move(canvas)) {
+}
+
+bool CanvasStreamReader::next() {
+    Reader reader(*input);
+    std::uint8_t kind = 0;
+    std::uint32_t frameTick = 0;
+    if (!reader.integer(kind) || kind > kDelta || !reader.integer(frameTick)) {
+        return false;
+    }
+
+    int row = -1;
+    for (std::uint32_t step = 0;;) {
+        if (!reader.varint(step)) {
+            return false;
+        }
+        if (step == 0) {
+            break;
+        }
+        std::uint32_t packedSize = 0;
+        if (step > static_cast<std::uint32_t>(canvas.getHeight() - 1 - row) ||
+            !reader.varint(packedSize) || packedSize > (canvas.getRowBytes() * 2) + 2) {
+            return false;
+        }
+        row += static_cast<int>(step);
+        runs.resize(packedSize);
+        if (!reader.bytes(runs.data(), runs.size()) ||
+            !byte_runs::unpack(runs, canvas.getRow(row))) {
+            return false;
+        }
+    }
+    tick = frameTick;
+    snapshot = kind == kSnapshot;
+    return true;
+}
+
+std::vector<std::uint8_t> CanvasStreamReader::unpackCells() const {
+    const auto rowLength = static_cast<std::size_t>(canvas.getWidth());
+    std::vector<std::uint8_t> cells(rowLength * static_cast<std::size_t>(canvas.getHeight()));
+    for (int row = 0; row < canvas.getHeight(); ++row) {
+        canvas.unpackRow(canvas.getRow(row),
+                         std::span(cells).subspan(static_cast<std::size_t>(row) * rowLength,
+                                                  rowLength));
+    }
+    return cells;
+}
@@ -0,0 +1,79 @@
+#ifndef DIDDLEDOODLEDUEL_CANVAS_STREAM_H
+#define DIDDLEDOODLEDUEL_CANVAS_STREAM_H
+#include "canvas/ownership_grid.h"
+#include "canvas/packed_canvas.h"
+#include <cstdint>
+#include <expected>
+#include <istream>
+#include <ostream>
+#include <raylib.h>
+#include <span>
+#include <string>
+#include <vector>
+
+// Streams the paint ownership grid to disk as a PackedCanvas, e.g. a delta every second and a
+// snapshot at the end of a round. Snapshots hold every row and deltas only the rows that changed
+// since the last frame, each run-length packed and written as it is packed. The writer keeps one
+// packed canvas and one row whatever the match length. See canvas_stream.cpp for the layout.
+class CanvasStreamWriter {
+public:
+    // palette[i] is the colour of palette index i, with 0 the unpainted background. Indices the
+    // palette has no entry for are stored as 0.
+    CanvasStreamWriter(std::ostream& output, const CanvasOwnershipGrid& grid,
+                       std::span<const Color> palette);
+
+    // Appends the grid's rows that changed since the last frame; the first frame is a snapshot.
+    // False if the stream failed or the grid's size changed.
+    bool writeDelta(const CanvasOwnershipGrid& grid, std::uint32_t tick);
+    // Appends every row, so a reader can start over from it
+    bool writeSnapshot(const CanvasOwnershipGrid& grid, std::uint32_t tick);
+
+    [[nodiscard]] std::uint32_t getFrameCount() const { return frameCount; }
+    [[nodiscard]] std::uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    std::ostream& output;
+    std::size_t paletteEntries;
+    PackedCanvas previous; // As of the last frame
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> packedRow;
+    std::vector<std::uint8_t> runs;
+    std::vector<std::uint8_t> prefix; // Frame and row headers
+    std::uint32_t frameCount {0};
+    std::uint64_t bytesWritten {0};
+
+    bool writeFrame(const CanvasOwnershipGrid& grid, std::uint32_t tick, bool snapshot);
+    void put(std::span<const std::uint8_t> bytes);
+};
+
+// Reads a canvas stream frame by frame, keeping only the current canvas
+class CanvasStreamReader {
+public:
+    static std::expected<CanvasStreamReader, std::string> open(std::istream& input);
+
+    // Applies the next frame; false at the end of the stream or if it is corrupt
+    bool next();
+
+    [[nodiscard]] std::uint32_t getTick() const { return tick; }
+    [[nodiscard]] bool isSnapshot() const { return snapshot; }
+    [[nodiscard]] float getCellSize() const { return cellSize; }
+    [[nodiscard]] std::span<const Color> getPalette() const { return palette; }
+    [[nodiscard]] const PackedCanvas& getCanvas() const { return canvas; }
+
+    // Every cell's palette index, row after row as in CanvasOwnershipGrid::getCells()
+    [[nodiscard]] std::vector<std::uint8_t> unpackCells() const;
+
+private:
+    std::istream* input;
+    float cellSize;
+    std::vector<Color> palette;
+    PackedCanvas canvas;
+    std::vector<std::uint8_t> runs;
+    std::uint32_t tick {0};
+    bool snapshot {false};
+
+    CanvasStreamReader(std::istream& input, float cellSize, std::vector<Color> palette,
+                       PackedCanvas canvas);
+};
+
+#endif // DIDDLEDOODLEDUEL_CANVAS_STREAM_H
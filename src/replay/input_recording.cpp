@@ -0,0 +1,205 @@
+#include "replay/input_recording.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <type_traits>
+
+// Layout, all integers little-endian:
+//   "DDDI", u16 version, u16 player count
+//   u32 sizeof(GameConfig), GameConfig bytes
+//   per player: f32 x, f32 y, f32 rotation, i32 left key, i32 right key, u8 rgba[4], u8 palette
+//   u32 run count, per run: varint ticks, then player count * 2 bits of buttons padded to bytes
+//
+// GameConfig is stored as raw bytes, so a recording only replays on a build with the same
+// GameConfig layout; the size check rejects the obvious mismatches. Bump the version whenever
+// GameConfig's fields change, as reordered or resized fields can keep the same total size.
+//
+// Version 2: GameConfig gained arenaWidth, arenaHeight and canvasResidentTiles.
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'D', 'D', 'D', 'I'};
+constexpr std::uint16_t kVersion = 2;
+
+static_assert(std::is_trivially_copyable_v<GameConfig>, "GameConfig is recorded as raw bytes");
+
+class Writer {
+public:
+    explicit Writer(std::ostream& output) : output(output) {
+    }
+
+    void bytes(const void* data, const std::size_t size) {
+        output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+    template <typename T>
+    void integer(const T value, const std::size_t size = sizeof(T)) {
+        const auto bits = static_cast<std::uint64_t>(value);
+        for (std::size_t byte = 0; byte < size; ++byte) {
+            output.put(static_cast<char>((bits >> (byte * 8)) & 0xFFU));
+        }
+    }
+
+    void real(const float value) { integer(std::bit_cast<std::uint32_t>(value)); }
+
+    void varint(std::uint32_t value) {
+        while (value >= 0x80U) {
+            output.put(static_cast<char>((value & 0x7FU) | 0x80U));
+            value >>= 7U;
+        }
+        output.put(static_cast<char>(value));
+    }
+
+private:
+    std::ostream& output;
+};
+
+class Reader {
+public:
+    explicit Reader(std::istream& input) : input(input) {
+    }
+
+    bool bytes(void* data, const std::size_t size) {
+        return static_cast<bool>(input.read(static_cast<char*>(data), static_cast<std::streamsize>(size)));
+    }
+
+    template <typename T>
+    bool integer(T& value, const std::size_t size = sizeof(T)) {
+        std::uint64_t bits = 0;
+        for (std::size_t byte = 0; byte < size; ++byte) {
+            const int next = input.get();
+            if (next == std::istream::traits_type::eof()) {
+                return false;
+            }
+            bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(next)) << (byte * 8);
+        }
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    bool real(float& value) {
+        std::uint32_t bits = 0;
+        if (!integer(bits)) {
+            return false;
+        }
+        value = std::bit_cast<float>(bits);
+        return true;
+    }
+
+    bool varint(std::uint32_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 32; shift += 7) {
+            const int next = input.get();
+            if (next == std::istream::traits_type::eof()) {
+                return false;
+            }
+            value |= static_cast<std::uint32_t>(next & 0x7F) << shift;
+            if ((next & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::istream& input;
+};
+
+std::size_t inputBytes(const std::size_t players) {
+    return ((players * 2) + 7) / 8;
+}
+
+} // namespace
+
+bool writeInputRecording(std::ostream& output, const InputRecording& recording) {
+    if (recording.spawns.size() > InputRecording::kMaxPlayers) {
+        return false;
+    }
+
+    Writer writer(output);
+    writer.bytes(kMagic.data(), kMagic.size());
+    writer.integer(kVersion);
+    writer.integer(static_cast<std::uint16_t>(recording.spawns.size()));
+
+    writer.integer(static_cast<std::uint32_t>(sizeof(GameConfig)));
+    writer.bytes(&recording.config, sizeof(GameConfig));
+
+    for (const auto& [startPosition, initialRotation, rotateLeftKey, rotateRightKey, brushColor,
+                      paletteIndex] : recording.spawns) {
+        writer.real(startPosition.x);
+        writer.real(startPosition.y);
+        writer.real(initialRotation);
+        writer.integer(static_cast<std::int32_t>(rotateLeftKey));
+        writer.integer(static_cast<std::int32_t>(rotateRightKey));
+        writer.integer(brushColor.r);
+        writer.integer(brushColor.g);
+        writer.integer(brushColor.b);
+        writer.integer(brushColor.a);
+        writer.integer(paletteIndex);
+    }
+
+    const std::size_t bytesPerTick = inputBytes(recording.spawns.size());
+    writer.integer(static_cast<std::uint32_t>(recording.runs.size()));
+    for (const auto& [ticks, inputs] : recording.runs) {
+        writer.varint(ticks);
+        writer.integer(inputs, bytesPerTick);
+    }
+    return static_cast<bool>(output);
+}
+
+std::expected<InputRecording, std::string> readInputRecording(std::istream& input) {
+    Reader reader(input);
+
+    std::array<char, 4> magic {};
+    std::uint16_t version = 0;
+    std::uint16_t players = 0;
+    if (!reader.bytes(magic.data(), magic.size()) || magic != kMagic) {
+        return std::unexpected("not an input recording");
+    }
+    if (!reader.integer(version) || version != kVersion) {
+        return std::unexpected("unsupported recording version");
+    }
+    if (!reader.integer(players) || players > InputRecording::kMaxPlayers) {
+        return std::unexpected("invalid player count");
+    }
+
+    InputRecording recording;
+    std::uint32_t configSize = 0;
+    if (!reader.integer(configSize) || configSize != sizeof(GameConfig)) {
+        return std::unexpected("recorded by a build with a different GameConfig");
+    }
+    if (!reader.bytes(&recording.config, sizeof(GameConfig))) {
+        return std::unexpected("truncated config");
+    }
+
+    recording.spawns.resize(players);
+    for (auto& spawn : recording.spawns) {
+        std::int32_t leftKey = 0;
+        std::int32_t rightKey = 0;
+        if (!reader.real(spawn.startPosition.x) || !reader.real(spawn.startPosition.y) ||
+            !reader.real(spawn.initialRotation) || !reader.integer(leftKey) ||
+            !reader.integer(rightKey) || !reader.integer(spawn.brushColor.r) ||
+            !reader.integer(spawn.brushColor.g) || !reader.integer(spawn.brushColor.b) ||
+            !reader.integer(spawn.brushColor.a) || !reader.integer(spawn.paletteIndex)) {
+            return std::unexpected("truncated player spawns");
+        }
+        spawn.rotateLeftKey = static_cast<KeyboardKey>(leftKey);
+        spawn.rotateRightKey = static_cast<KeyboardKey>(rightKey);
+    }
+
+    const std::size_t bytesPerTick = inputBytes(players);
+    std::uint32_t runCount = 0;
+    if (!reader.integer(runCount)) {
+        return std::unexpected("truncated input");
+    }
+    // The count is untrusted, so only reserve what a sane recording would need
+    recording.runs.reserve(std::min<std::uint32_t>(runCount, 1U << 16U));
+    for (std::uint32_t run = 0; run < runCount; ++run) {
+        InputRun entry {};
+        if (!reader.varint(entry.ticks) || entry.ticks == 0 || !reader.integer(entry.inputs, bytesPerTick)) {
+            return std::unexpected("truncated input");
+        }
+        recording.runs.push_back(entry);
+    }
+    return recording;
+}
@@ -0,0 +1,84 @@
+#ifndef DIDDLEDOODLEDUEL_INPUT_RECORDING_H
+#define DIDDLEDOODLEDUEL_INPUT_RECORDING_H
+#include "components/input_action.h"
+#include "core/player_factory.h"
+#include "game_config.h"
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <expected>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Every player's buttons on one tick: player p holds left in bit 2p and right in bit 2p + 1
+using TickInputs = std::uint64_t;
+
+// Consecutive ticks with identical input
+struct InputRun {
+    std::uint32_t ticks;
+    TickInputs inputs;
+};
+
+// Everything needed to replay a match through the fixed simulation: its tuning, how players
+// spawned and what each of them held on every tick. Players hold buttons for long stretches,
+// so ticks are stored run-length encoded.
+struct InputRecording {
+    static constexpr std::size_t kMaxPlayers = sizeof(TickInputs) * 4;
+
+    GameConfig config;
+    std::vector<PlayerSpawn> spawns;
+    std::vector<InputRun> runs;
+
+    // Starts over for a new match; false if it has more players than fit in TickInputs
+    bool reset(const GameConfig& matchConfig, const std::span<const PlayerSpawn> matchSpawns) {
+        if (matchSpawns.size() > kMaxPlayers) {
+            return false;
+        }
+        config = matchConfig;
+        spawns.assign(matchSpawns.begin(), matchSpawns.end());
+        runs.clear();
+        return true;
+    }
+
+    void append(const TickInputs inputs) {
+        if (!runs.empty() && runs.back().inputs == inputs) {
+            ++runs.back().ticks;
+            return;
+        }
+        runs.push_back(InputRun{.ticks = 1, .inputs = inputs});
+    }
+
+    [[nodiscard]] std::uint32_t getTickCount() const {
+        std::uint32_t ticks = 0;
+        for (const auto& run : runs) {
+            ticks += run.ticks;
+        }
+        return ticks;
+    }
+
+    static TickInputs pack(const entt::registry& registry, const std::span<const entt::entity> players) {
+        TickInputs inputs = 0;
+        for (std::size_t player = 0; player < players.size() && player < kMaxPlayers; ++player) {
+            const auto& [rotateLeft, rotateRight] = registry.get<InputAction>(players[player]);
+            inputs |= (TickInputs {rotateLeft} | (TickInputs {rotateRight} << 1U)) << (player * 2);
+        }
+        return inputs;
+    }
+
+    static void unpack(entt::registry& registry, const std::span<const entt::entity> players,
+                       const TickInputs inputs) {
+        for (std::size_t player = 0; player < players.size() && player < kMaxPlayers; ++player) {
+            const TickInputs buttons = inputs >> (player * 2);
+            registry.get<InputAction>(players[player]) =
+                InputAction{.rotateLeft = (buttons & 1U) != 0, .rotateRight = (buttons & 2U) != 0};
+        }
+    }
+};
+
+// Compact little-endian binary log; see input_recording.cpp for the layout
+bool writeInputRecording(std::ostream& output, const InputRecording& recording);
+std::expected<InputRecording, std::string> readInputRecording(std::istream& input);
+
+#endif // DIDDLEDOODLEDUEL_INPUT_RECORDING_H
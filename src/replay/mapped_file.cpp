@@ -0,0 +1,61 @@
+#include "replay/mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER fileSize {};
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        if (const HANDLE mapping =
+                CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+            data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = data != nullptr ? static_cast<std::size_t>(fileSize.QuadPart) : 0;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return;
+    }
+    struct stat status {};
+    if (::fstat(file, &status) == 0 && status.st_size > 0) {
+        const auto fileSize = static_cast<std::size_t>(status.st_size);
+        if (void* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+            mapped != MAP_FAILED) {
+            data = static_cast<const std::byte*>(mapped);
+            size = fileSize;
+        }
+    }
+    ::close(file);
+#endif
+}
+
+void MappedFile::unmap() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    ::munmap(const_cast<std::byte*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef DIDDLEDOODLEDUEL_MAPPED_FILE_H
+#define DIDDLEDOODLEDUEL_MAPPED_FILE_H
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+// Read-only view of a whole file mapped into memory. Pages are read in by the OS as they are
+// touched, so opening a large recording costs nothing until parts of it are used. The platform
+// headers stay in mapped_file.cpp, as windows.h's macros clash with raylib's names.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] bool isOpen() const { return data != nullptr; }
+    [[nodiscard]] std::span<const std::byte> bytes() const { return {data, size}; }
+
+private:
+    const std::byte* data {nullptr};
+    std::size_t size {0};
+
+    void unmap();
+};
+
+#endif // DIDDLEDOODLEDUEL_MAPPED_FILE_H
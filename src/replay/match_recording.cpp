@@ -0,0 +1,545 @@
+#include "replay/match_recording.h"
+#include "canvas/ownership_grid.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <entt/entity/snapshot.hpp>
+#include <span>
+#include <type_traits>
+
+// Layout, integers little-endian unless noted:
+//   header: "DDDM", u16 version, u16 reserved, u32 keyframe interval,
+//           u32 grid width, u32 grid height, f32 cell size
+//   one record per tick: u8 kind, u32 payload size, payload
+//     keyframe: entt::snapshot of the entities and RecordedComponents, then the grid cells as
+//               (varint length, u8 palette index) runs
+//     delta:    changes to the tick's image, see encodeDelta
+//   index: per tick u64 record offset, u32 keyframe tick
+//   trailer: u64 index offset, u32 tick count, "DDDM"
+//
+// A tick's image is the raw bytes of every recorded component in RecordedLayout order followed by
+// the grid cells. Snapshots and images hold components as raw host-order bytes, so a recording
+// is only read back on a build with the same component layouts.
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'D', 'D', 'D', 'M'};
+constexpr std::uint16_t kVersion = 1;
+constexpr std::uint8_t kKeyframe = 0;
+constexpr std::uint8_t kDelta = 1;
+
+constexpr std::size_t kHeaderSize = 24;
+constexpr std::size_t kRecordHeaderSize = 5;
+constexpr std::size_t kIndexEntrySize = 12;
+constexpr std::size_t kTrailerSize = 16;
+
+// Unchanged stretches shorter than this stay inside a changed run; a new run costs about as much
+constexpr std::size_t kMinUnchangedRun = 3;
+
+template <typename... Components>
+consteval bool allTriviallyCopyable(TypeList<Components...> /*components*/) {
+    return (std::is_trivially_copyable_v<Components> && ...);
+}
+static_assert(allTriviallyCopyable(RecordedComponents {}), "Recorded components are stored as raw bytes");
+
+void appendBytes(std::vector<std::byte>& output, const void* data, const std::size_t size) {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    output.insert(output.end(), bytes, bytes + size);
+}
+
+template <typename T>
+void appendInteger(std::vector<std::byte>& output, const T value) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+        output.push_back(static_cast<std::byte>((bits >> (byte * 8)) & 0xFFU));
+    }
+}
+
+void appendVarint(std::vector<std::byte>& output, std::uint64_t value) {
+    while (value >= 0x80U) {
+        output.push_back(static_cast<std::byte>((value & 0x7FU) | 0x80U));
+        value >>= 7U;
+    }
+    output.push_back(static_cast<std::byte>(value));
+}
+
+class ByteReader {
+public:
+    explicit ByteReader(const std::span<const std::byte> data) : data(data) {
+    }
+
+    [[nodiscard]] std::size_t remaining() const { return data.size() - position; }
+
+    bool bytes(void* destination, const std::size_t size) {
+        if (size > remaining()) {
+            return false;
+        }
+        std::memcpy(destination, data.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    template <typename T>
+    bool integer(T& value) {
+        if (sizeof(T) > remaining()) {
+            return false;
+        }
+        std::uint64_t bits = 0;
+        for (std::size_t byte = 0; byte < sizeof(T); ++byte) {
+            bits |= std::to_integer<std::uint64_t>(data[position + byte]) << (byte * 8);
+        }
+        position += sizeof(T);
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    bool varint(std::uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64 && position < data.size(); shift += 7) {
+            const auto next = std::to_integer<std::uint64_t>(data[position++]);
+            value |= (next & 0x7FU) << shift;
+            if ((next & 0x80U) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::span<const std::byte> data;
+    std::size_t position {0};
+};
+
+// entt::snapshot archive appending raw values to a buffer
+class SnapshotOutput {
+public:
+    explicit SnapshotOutput(std::vector<std::byte>& output) : output(output) {
+    }
+
+    template <typename T>
+    void operator()(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        appendBytes(output, &value, sizeof(T));
+    }
+
+private:
+    std::vector<std::byte>& output;
+};
+
+// entt::snapshot_loader archive over a record's payload. Every read past the end fails the
+// archive and yields zeros, so a corrupt payload loads nonsense but never reads out of bounds.
+class SnapshotInput {
+public:
+    explicit SnapshotInput(ByteReader& reader) : reader(reader) {
+    }
+
+    [[nodiscard]] bool isValid() const { return valid; }
+
+    // EnTT reads element counts as the entity's integer type. A count larger than the bytes left
+    // can only come from a corrupt file, and would make the loader spin creating entities.
+    void operator()(std::underlying_type_t<entt::entity>& count) {
+        if (!reader.bytes(&count, sizeof(count)) || count > reader.remaining()) {
+            valid = false;
+            count = 0;
+        }
+    }
+
+    template <typename T>
+    void operator()(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (!reader.bytes(&value, sizeof(T))) {
+            valid = false;
+            value = T {};
+        }
+    }
+
+private:
+    ByteReader& reader;
+    bool valid {true};
+};
+
+template <typename... Components>
+void collectLayout(const entt::registry& registry, RecordedLayout& layout, TypeList<Components...> /*components*/) {
+    std::size_t slot = 0;
+    const auto collect = [&]<typename Component>() {
+        auto& entities = layout[slot++];
+        entities.clear();
+        for (const auto entity : registry.view<const Component>()) {
+            entities.push_back(entity);
+        }
+        std::ranges::sort(entities, {}, [](const entt::entity entity) { return entt::to_integral(entity); });
+    };
+    (collect.template operator()<Components>(), ...);
+}
+
+template <typename... Components>
+std::size_t componentBytes(const RecordedLayout& layout, TypeList<Components...> /*components*/) {
+    std::size_t slot = 0;
+    std::size_t bytes = 0;
+    ((bytes += layout[slot++].size() * sizeof(Components)), ...);
+    return bytes;
+}
+
+// Resizes image for layout plus cellCount grid cells and fills in the component bytes
+template <typename... Components>
+void packComponents(const entt::registry& registry, const RecordedLayout& layout, const std::size_t cellCount,
+                    std::vector<std::byte>& image, TypeList<Components...> components) {
+    image.resize(componentBytes(layout, components) + cellCount);
+    std::byte* cursor = image.data();
+    std::size_t slot = 0;
+    const auto pack = [&]<typename Component>() {
+        for (const auto entity : layout[slot]) {
+            std::memcpy(cursor, &registry.get<const Component>(entity), sizeof(Component));
+            cursor += sizeof(Component);
+        }
+        ++slot;
+    };
+    (pack.template operator()<Components>(), ...);
+}
+
+template <typename... Components>
+void unpackComponents(entt::registry& registry, const RecordedLayout& layout, const std::vector<std::byte>& image,
+                      TypeList<Components...> /*components*/) {
+    const std::byte* cursor = image.data();
+    std::size_t slot = 0;
+    const auto unpack = [&]<typename Component>() {
+        for (const auto entity : layout[slot]) {
+            std::memcpy(&registry.get<Component>(entity), cursor, sizeof(Component));
+            cursor += sizeof(Component);
+        }
+        ++slot;
+    };
+    (unpack.template operator()<Components>(), ...);
+}
+
+template <typename... Components>
+void writeSnapshot(const entt::registry& registry, SnapshotOutput& archive, TypeList<Components...> /*components*/) {
+    const entt::snapshot snapshot {registry};
+    snapshot.get<entt::entity>(archive);
+    (snapshot.get<Components>(archive), ...);
+}
+
+template <typename... Components>
+void loadSnapshot(entt::registry& registry, SnapshotInput& archive, TypeList<Components...> /*components*/) {
+    entt::snapshot_loader loader {registry};
+    loader.get<entt::entity>(archive);
+    (loader.get<Components>(archive), ...);
+}
+
+// Grid cells are mostly long stretches of one owner
+void encodeCells(const std::span<const std::byte> cells, std::vector<std::byte>& output) {
+    for (std::size_t start = 0; start < cells.size();) {
+        std::size_t end = start + 1;
+        while (end < cells.size() && cells[end] == cells[start]) {
+            ++end;
+        }
+        appendVarint(output, end - start);
+        output.push_back(cells[start]);
+        start = end;
+    }
+}
+
+bool decodeCells(ByteReader& reader, const std::span<std::byte> cells) {
+    for (std::size_t position = 0; position < cells.size();) {
+        std::uint64_t length = 0;
+        std::byte value {};
+        if (!reader.varint(length) || length == 0 || length > cells.size() - position ||
+            !reader.bytes(&value, 1)) {
+            return false;
+        }
+        std::fill_n(cells.begin() + static_cast<std::ptrdiff_t>(position), length, value);
+        position += length;
+    }
+    return reader.remaining() == 0;
+}
+
+// Alternating runs of (varint unchanged count, varint changed count, changed bytes) turning
+// previous into current. Trailing unchanged bytes are left implicit.
+void encodeDelta(const std::span<const std::byte> previous, const std::span<const std::byte> current,
+                 std::vector<std::byte>& output) {
+    std::size_t position = 0;
+    while (position < current.size()) {
+        const std::size_t unchangedStart = position;
+        while (position < current.size() && previous[position] == current[position]) {
+            ++position;
+        }
+        if (position == current.size()) {
+            break;
+        }
+
+        const std::size_t changedStart = position;
+        std::size_t changedEnd = position;
+        for (std::size_t unchanged = 0; position < current.size() && unchanged < kMinUnchangedRun; ++position) {
+            if (previous[position] == current[position]) {
+                ++unchanged;
+            } else {
+                unchanged = 0;
+                changedEnd = position + 1;
+            }
+        }
+        position = changedEnd;
+
+        appendVarint(output, changedStart - unchangedStart);
+        appendVarint(output, changedEnd - changedStart);
+        appendBytes(output, current.data() + changedStart, changedEnd - changedStart);
+    }
+}
+
+bool applyDeltaTo(ByteReader& reader, const std::span<std::byte> image) {
+    std::size_t position = 0;
+    while (reader.remaining() > 0) {
+        std::uint64_t unchanged = 0;
+        std::uint64_t changed = 0;
+        if (!reader.varint(unchanged) || !reader.varint(changed) || unchanged > image.size() - position ||
+            changed > image.size() - position - unchanged) {
+            return false;
+        }
+        position += unchanged;
+        if (!reader.bytes(image.data() + position, changed)) {
+            return false;
+        }
+        position += changed;
+    }
+    return true;
+}
+
+struct Record {
+    std::uint8_t kind;
+    std::span<const std::byte> payload;
+};
+
+std::optional<Record> recordAt(const std::span<const std::byte> bytes, const std::uint64_t offset,
+                               const std::uint64_t recordsEnd) {
+    if (offset < kHeaderSize || offset > recordsEnd || recordsEnd - offset < kRecordHeaderSize) {
+        return std::nullopt;
+    }
+    ByteReader header(bytes.subspan(offset, kRecordHeaderSize));
+    Record record {};
+    std::uint32_t size = 0;
+    header.integer(record.kind);
+    header.integer(size);
+    if (size > recordsEnd - offset - kRecordHeaderSize) {
+        return std::nullopt;
+    }
+    record.payload = bytes.subspan(offset + kRecordHeaderSize, size);
+    return record;
+}
+
+} // namespace
+
+MatchRecordingWriter::MatchRecordingWriter(std::ostream& output, const std::uint32_t keyframeInterval)
+    : output(output), keyframeInterval(std::max<std::uint32_t>(keyframeInterval, 1)) {
+}
+
+bool MatchRecordingWriter::record(const entt::registry& registry) {
+    const auto* grid = registry.ctx().find<CanvasOwnershipGrid>();
+    if (grid == nullptr) {
+        return false;
+    }
+
+    payload.clear();
+    if (index.empty()) {
+        gridWidth = grid->getWidth();
+        gridHeight = grid->getHeight();
+        appendBytes(payload, kMagic.data(), kMagic.size());
+        appendInteger(payload, kVersion);
+        appendInteger(payload, std::uint16_t {0});
+        appendInteger(payload, keyframeInterval);
+        appendInteger(payload, static_cast<std::uint32_t>(gridWidth));
+        appendInteger(payload, static_cast<std::uint32_t>(gridHeight));
+        appendInteger(payload, std::bit_cast<std::uint32_t>(grid->getCellSize()));
+        writeBytes(payload);
+        payload.clear();
+    } else if (grid->getWidth() != gridWidth || grid->getHeight() != gridHeight) {
+        return false;
+    }
+
+    const auto tick = static_cast<std::uint32_t>(index.size());
+    const auto cells = std::as_bytes(grid->getCells());
+    collectLayout(registry, nextLayout, RecordedComponents {});
+    packComponents(registry, nextLayout, cells.size(), image, RecordedComponents {});
+    std::ranges::copy(cells, image.end() - static_cast<std::ptrdiff_t>(cells.size()));
+
+    // Deltas only work between images of the same shape, so spawns and despawns start a keyframe
+    const bool keyframe = index.empty() || tick - index.back().keyframeTick >= keyframeInterval ||
+                          nextLayout != layout;
+    if (keyframe) {
+        SnapshotOutput archive(payload);
+        writeSnapshot(registry, archive, RecordedComponents {});
+        encodeCells(cells, payload);
+    } else {
+        encodeDelta(previousImage, image, payload);
+    }
+
+    index.push_back(MatchIndexEntry{.offset = offset, .keyframeTick = keyframe ? tick : index.back().keyframeTick});
+    std::vector<std::byte> recordHeader;
+    appendInteger(recordHeader, keyframe ? kKeyframe : kDelta);
+    appendInteger(recordHeader, static_cast<std::uint32_t>(payload.size()));
+    writeBytes(recordHeader);
+    writeBytes(payload);
+
+    std::swap(layout, nextLayout);
+    std::swap(image, previousImage);
+    return static_cast<bool>(output);
+}
+
+bool MatchRecordingWriter::finish() {
+    if (index.empty()) {
+        return false;
+    }
+
+    const std::uint64_t indexOffset = offset;
+    payload.clear();
+    for (const auto& [recordOffset, keyframeTick] : index) {
+        appendInteger(payload, recordOffset);
+        appendInteger(payload, keyframeTick);
+    }
+    appendInteger(payload, indexOffset);
+    appendInteger(payload, static_cast<std::uint32_t>(index.size()));
+    appendBytes(payload, kMagic.data(), kMagic.size());
+    writeBytes(payload);
+    output.flush();
+    return static_cast<bool>(output);
+}
+
+void MatchRecordingWriter::writeBytes(const std::vector<std::byte>& bytes) {
+    output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    offset += bytes.size();
+}
+
+std::expected<MatchRecordingReader, std::string> MatchRecordingReader::open(const std::filesystem::path& path) {
+    MatchRecordingReader reader;
+    reader.file = MappedFile(path);
+    if (!reader.file.isOpen()) {
+        return std::unexpected("could not map " + path.string());
+    }
+
+    const auto bytes = reader.file.bytes();
+    if (bytes.size() < kHeaderSize + kTrailerSize) {
+        return std::unexpected("not a match recording");
+    }
+
+    ByteReader header(bytes.first(kHeaderSize));
+    std::array<char, 4> magic {};
+    std::uint16_t version = 0;
+    std::uint16_t reserved = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t cellSizeBits = 0;
+    if (!header.bytes(magic.data(), magic.size()) || magic != kMagic) {
+        return std::unexpected("not a match recording");
+    }
+    if (!header.integer(version) || version != kVersion) {
+        return std::unexpected("unsupported match recording version");
+    }
+    header.integer(reserved);
+    header.integer(reader.keyframeInterval);
+    header.integer(width);
+    header.integer(height);
+    header.integer(cellSizeBits);
+    reader.cellSize = std::bit_cast<float>(cellSizeBits);
+    if (width == 0 || height == 0 || width > (1U << 16U) || height > (1U << 16U) || !(reader.cellSize > 0.0F)) {
+        return std::unexpected("invalid ownership grid");
+    }
+    reader.gridWidth = static_cast<int>(width);
+    reader.gridHeight = static_cast<int>(height);
+
+    ByteReader trailer(bytes.last(kTrailerSize));
+    trailer.integer(reader.indexOffset);
+    trailer.integer(reader.tickCount);
+    if (!trailer.bytes(magic.data(), magic.size()) || magic != kMagic) {
+        return std::unexpected("missing seek index, was the recording finished?");
+    }
+    const std::uint64_t indexEnd = bytes.size() - kTrailerSize;
+    if (reader.tickCount == 0 || reader.indexOffset < kHeaderSize || reader.indexOffset > indexEnd ||
+        (indexEnd - reader.indexOffset) != std::uint64_t {reader.tickCount} * kIndexEntrySize) {
+        return std::unexpected("corrupt seek index");
+    }
+    return reader;
+}
+
+MatchIndexEntry MatchRecordingReader::entryAt(const std::uint32_t tick) const {
+    ByteReader entry(file.bytes().subspan(indexOffset + (std::uint64_t {tick} * kIndexEntrySize), kIndexEntrySize));
+    MatchIndexEntry result {};
+    entry.integer(result.offset);
+    entry.integer(result.keyframeTick);
+    return result;
+}
+
+bool MatchRecordingReader::seek(entt::registry& registry, const std::uint32_t tick) {
+    if (tick >= tickCount) {
+        return false;
+    }
+    const std::uint32_t keyframeTick = entryAt(tick).keyframeTick;
+    if (keyframeTick > tick) {
+        return false;
+    }
+
+    // Continue from the previous seek when it is in the same span and not past the target
+    std::uint32_t firstDelta = keyframeTick + 1;
+    if (imageRegistry == &registry && imageTick.has_value() && *imageTick <= tick &&
+        *imageTick >= keyframeTick && entryAt(*imageTick).keyframeTick == keyframeTick) {
+        firstDelta = *imageTick + 1;
+    } else if (!restoreKeyframe(registry, keyframeTick)) {
+        imageTick.reset();
+        return false;
+    }
+
+    for (std::uint32_t delta = firstDelta; delta <= tick; ++delta) {
+        if (!applyDelta(delta)) {
+            imageTick.reset();
+            return false;
+        }
+    }
+
+    unpackComponents(registry, layout, image, RecordedComponents {});
+    const auto cellCount = static_cast<std::size_t>(gridWidth) * static_cast<std::size_t>(gridHeight);
+    const auto* cells = reinterpret_cast<const std::uint8_t*>(image.data() + (image.size() - cellCount));
+    if (!registry.ctx().get<CanvasOwnershipGrid>().assignCells({cells, cellCount})) {
+        imageTick.reset();
+        return false;
+    }
+    imageTick = tick;
+    imageRegistry = &registry;
+    return true;
+}
+
+bool MatchRecordingReader::restoreKeyframe(entt::registry& registry, const std::uint32_t tick) {
+    const auto record = recordAt(file.bytes(), entryAt(tick).offset, indexOffset);
+    if (!record.has_value() || record->kind != kKeyframe) {
+        return false;
+    }
+
+    registry.clear();
+    ByteReader reader(record->payload);
+    SnapshotInput archive(reader);
+    loadSnapshot(registry, archive, RecordedComponents {});
+    if (!archive.isValid()) {
+        return false;
+    }
+
+    // Reuse the registry's grid when it already has the recorded shape
+    const auto* grid = registry.ctx().find<CanvasOwnershipGrid>();
+    if (grid == nullptr || grid->getWidth() != gridWidth || grid->getHeight() != gridHeight) {
+        registry.ctx().insert_or_assign(CanvasOwnershipGrid(static_cast<float>(gridWidth) * cellSize,
+                                                            static_cast<float>(gridHeight) * cellSize, cellSize));
+        grid = &registry.ctx().get<CanvasOwnershipGrid>();
+        if (grid->getWidth() != gridWidth || grid->getHeight() != gridHeight) {
+            return false;
+        }
+    }
+
+    const auto cellCount = static_cast<std::size_t>(gridWidth) * static_cast<std::size_t>(gridHeight);
+    collectLayout(registry, layout, RecordedComponents {});
+    packComponents(registry, layout, cellCount, image, RecordedComponents {});
+    return decodeCells(reader, std::span(image).last(cellCount));
+}
+
+bool MatchRecordingReader::applyDelta(const std::uint32_t tick) {
+    const auto record = recordAt(file.bytes(), entryAt(tick).offset, indexOffset);
+    if (!record.has_value() || record->kind != kDelta) {
+        return false;
+    }
+    ByteReader reader(record->payload);
+    return applyDeltaTo(reader, image);
+}
@@ -0,0 +1,106 @@
+#ifndef DIDDLEDOODLEDUEL_MATCH_RECORDING_H
+#define DIDDLEDOODLEDUEL_MATCH_RECORDING_H
+#include "components/collision_state.h"
+#include "components/position.h"
+#include "components/renderable.h"
+#include "components/velocity.h"
+#include "core/type_list.h"
+#include "replay/mapped_file.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Components a match recording captures; the CanvasOwnershipGrid is stored alongside them
+using RecordedComponents = TypeList<Position, Velocity, CollisionState, Renderable>;
+
+// Per recorded component, the sorted entities holding it. Ticks with the same layout pack their
+// state into equally shaped images, so one can be stored as a delta against the other.
+using RecordedLayout = std::array<std::vector<entt::entity>, RecordedComponents::size>;
+
+// Where a tick's record starts, and the keyframe it is a delta from (itself for keyframes)
+struct MatchIndexEntry {
+    std::uint64_t offset;
+    std::uint32_t keyframeTick;
+};
+
+// Writes the simulated state of every tick. Every keyframeInterval ticks, and whenever the
+// recorded entities change, a full EnTT snapshot is stored; other ticks store only the bytes
+// that changed since the tick before. See match_recording.cpp for the layout.
+class MatchRecordingWriter {
+public:
+    static constexpr std::uint32_t kDefaultKeyframeInterval = 60;
+
+    explicit MatchRecordingWriter(std::ostream& output,
+                                  std::uint32_t keyframeInterval = kDefaultKeyframeInterval);
+
+    // Appends the registry's state as the next tick; call once per tick after the simulation.
+    // False if the registry has no ownership grid or its shape changed since the first tick.
+    bool record(const entt::registry& registry);
+
+    // Writes the seek index; without it the file cannot be read
+    bool finish();
+
+    [[nodiscard]] std::uint32_t getTickCount() const { return static_cast<std::uint32_t>(index.size()); }
+
+private:
+    std::ostream& output;
+    std::uint32_t keyframeInterval;
+    std::uint64_t offset {0};
+    int gridWidth {0};
+    int gridHeight {0};
+    std::vector<MatchIndexEntry> index;
+
+    RecordedLayout layout;
+    RecordedLayout nextLayout;
+    std::vector<std::byte> image;
+    std::vector<std::byte> previousImage;
+    std::vector<std::byte> payload;
+
+    void writeBytes(const std::vector<std::byte>& bytes);
+};
+
+// Seeks a memory-mapped match recording. The index footer gives every tick's keyframe, so a seek
+// restores one keyframe and applies at most keyframeInterval - 1 deltas after it.
+class MatchRecordingReader {
+public:
+    static std::expected<MatchRecordingReader, std::string> open(const std::filesystem::path& path);
+
+    [[nodiscard]] std::uint32_t getTickCount() const { return tickCount; }
+    [[nodiscard]] std::uint32_t getKeyframeInterval() const { return keyframeInterval; }
+
+    // Replaces every entity in registry with the recorded ones as of tick, and the ownership
+    // grid in its context. Moving forward within a keyframe's span continues from the previous
+    // seek instead of restoring the keyframe again. False if tick is out of range or the file
+    // is corrupt.
+    bool seek(entt::registry& registry, std::uint32_t tick);
+
+private:
+    MappedFile file;
+    std::uint32_t keyframeInterval {0};
+    int gridWidth {0};
+    int gridHeight {0};
+    float cellSize {0.0F};
+    std::uint32_t tickCount {0};
+    std::uint64_t indexOffset {0};
+
+    // State of the last seek, reused by later seeks into the same keyframe span
+    RecordedLayout layout;
+    std::vector<std::byte> image;
+    std::optional<std::uint32_t> imageTick;
+    const entt::registry* imageRegistry {nullptr};
+
+    MatchRecordingReader() = default;
+
+    [[nodiscard]] MatchIndexEntry entryAt(std::uint32_t tick) const;
+    bool restoreKeyframe(entt::registry& registry, std::uint32_t tick);
+    bool applyDelta(std::uint32_t tick);
+};
+
+#endif // DIDDLEDOODLEDUEL_MATCH_RECORDING_H
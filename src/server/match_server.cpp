@@ -0,0 +1,159 @@
+#include "server/match_server.h"
+#include "performance/profiler.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::size_t workerCount(const MatchServerOptions& options) {
+    const std::size_t requested =
+        options.threads > 0 ? options.threads : std::max(1U, std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(requested, 1, std::max<std::size_t>(options.matches, 1));
+}
+
+// Keeps the calling thread on one core, so the matches it owns stay in that core's caches
+void pinToCore(const std::size_t worker) {
+#ifdef __linux__
+    const unsigned cores = std::max(1U, std::thread::hardware_concurrency());
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(static_cast<int>(worker % cores), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    static_cast<void>(worker);
+#endif
+}
+
+} // namespace
+
+MatchServer::Match::Match(const engine::IRenderer& renderer, const HeadlessOptions& options,
+                          const std::uint32_t botClients, const std::size_t snapshotBudgetBytes)
+    : runner(renderer, options), encoder(snapshotBudgetBytes), clients(botClients) {
+}
+
+MatchServer::MatchServer(const engine::IRenderer& renderer, const MatchServerOptions& options)
+    : options(options), matches(options.matches), busySeconds(workerCount(options), 0.0),
+      tickStart(static_cast<std::ptrdiff_t>(workerCount(options) + 1)),
+      tickEnd(static_cast<std::ptrdiff_t>(workerCount(options) + 1)) {
+    const std::size_t count = workerCount(options);
+    workers.reserve(count);
+    for (std::size_t worker = 0; worker < count; ++worker) {
+        workers.emplace_back(
+            [this, &renderer, worker, count] { runWorker(renderer, worker, count); });
+    }
+    // Every match is built once the workers first reach the end of a tick
+    tickEnd.arrive_and_wait();
+}
+
+MatchServer::~MatchServer() {
+    stopping = true;
+    tickStart.arrive_and_wait();
+    workers.clear();
+}
+
+MatchServerReport MatchServer::run(const std::uint32_t ticks) {
+    const auto tickDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.tickRate));
+
+    MatchServerReport report;
+    report.ticks = ticks;
+    const auto start = Clock::now();
+    auto nextTick = start;
+    for (std::uint32_t tick = 0; tick < ticks; ++tick) {
+        tickStart.arrive_and_wait();
+        tickEnd.arrive_and_wait();
+
+        // Each server tick is a profiler frame; the matches' scopes land in it from every worker
+        ScopeProfiler::getInstance().endFrame();
+
+        if (options.paced) {
+            nextTick += tickDuration;
+            if (Clock::now() > nextTick) {
+                ++report.lateTicks;
+            } else {
+                std::this_thread::sleep_until(nextTick);
+            }
+        }
+    }
+    report.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Workers are parked at tickStart, so their results can be read
+    for (const auto& match : matches) {
+        report.matches.push_back(MatchCost{
+            .meanTickSeconds =
+                match->ticks > 0 ? match->totalSeconds / static_cast<double>(match->ticks) : 0.0,
+            .maxTickSeconds = match->maxSeconds,
+            .snapshotBytes = match->snapshotBytes});
+    }
+    report.threadBusySeconds = busySeconds;
+    return report;
+}
+
+void MatchServer::runWorker(const engine::IRenderer& renderer, const std::size_t worker,
+                            const std::size_t stride) {
+    if (options.pinThreads) {
+        pinToCore(worker);
+    }
+
+    for (std::size_t index = worker; index < matches.size(); index += stride) {
+        HeadlessOptions matchOptions;
+        matchOptions.players = options.playersPerMatch;
+        matchOptions.seed = options.seed + static_cast<std::uint32_t>(index);
+        matchOptions.tickRate = options.tickRate;
+        matchOptions.endProfilerFrames = false;
+        matches[index] =
+            std::make_unique<Match>(renderer, matchOptions, options.botClientsPerMatch,
+                                    options.snapshotBudgetBytes);
+    }
+    tickEnd.arrive_and_wait();
+
+    for (;;) {
+        tickStart.arrive_and_wait();
+        if (stopping) {
+            return;
+        }
+
+        const auto start = Clock::now();
+        for (std::size_t index = worker; index < matches.size(); index += stride) {
+            tickMatch(*matches[index]);
+        }
+        busySeconds[worker] += std::chrono::duration<double>(Clock::now() - start).count();
+        tickEnd.arrive_and_wait();
+    }
+}
+
+void MatchServer::tickMatch(Match& match) const {
+    const auto start = Clock::now();
+    match.runner.tick();
+
+    const bool sendsSnapshot =
+        options.snapshotInterval > 0 && match.runner.getTick() % options.snapshotInterval == 0;
+    if (sendsSnapshot) {
+        PROFILE_SCOPE("EncodeSnapshots");
+        match.encoder.capture(match.runner.getRegistry());
+        for (auto& client : match.clients) {
+            client.packet.clear();
+            match.encoder.encode(client.sent, client.acked, client.packet);
+            match.snapshotBytes += client.packet.size();
+        }
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ++match.ticks;
+    match.totalSeconds += seconds;
+    match.maxSeconds = std::max(match.maxSeconds, seconds);
+
+    // The bots are clients, not server work, so they run outside the measured cost
+    if (sendsSnapshot) {
+        for (auto& client : match.clients) {
+            client.decoder.decode(client.packet, client.registry);
+            client.acked = client.decoder.getLatestSequence();
+        }
+    }
+}
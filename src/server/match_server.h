@@ -0,0 +1,103 @@
+#ifndef DIDDLEDOODLEDUEL_MATCH_SERVER_H
+#define DIDDLEDOODLEDUEL_MATCH_SERVER_H
+#include "headless/headless_runner.h"
+#include "netcode/snapshot_codec.h"
+#include "rendering/irenderer.h"
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct MatchServerOptions {
+    std::uint32_t matches {100};
+    std::uint32_t playersPerMatch {4};
+    std::uint32_t botClientsPerMatch {1}; // Local clients that decode every snapshot
+    std::uint32_t snapshotInterval {3};   // Ticks between snapshots; 0 sends none
+    std::size_t snapshotBudgetBytes {kDefaultSnapshotBudgetBytes}; // Per client per snapshot
+    std::uint32_t threads {0};            // 0 uses every hardware thread
+    bool pinThreads {true};               // Pin each worker to one core, where supported
+    bool paced {true};                    // Tick on the wall clock; off runs ticks back to back
+    float tickRate {60.0F};
+    std::uint32_t seed {1}; // Match i plays with seed + i
+};
+
+// Server-side cost of one match: its simulation tick plus encoding its snapshots
+struct MatchCost {
+    double meanTickSeconds {0.0};
+    double maxTickSeconds {0.0};
+    std::uint64_t snapshotBytes {0}; // Sent to all of the match's clients
+};
+
+struct MatchServerReport {
+    std::uint32_t ticks {0};
+    double elapsedSeconds {0.0};
+    std::uint32_t lateTicks {0};           // Paced ticks that finished after the next was due
+    std::vector<MatchCost> matches;        // Indexed by match
+    std::vector<double> threadBusySeconds; // Time each worker spent ticking its matches
+};
+
+// Hosts many independent headless matches in one process. Matches are split across a fixed set
+// of worker threads, match i on worker i % threads, and never move: each worker builds its own
+// matches, so their memory is allocated near the core it stays pinned to. A shared clock
+// releases every worker once per tick and waits for all of them before the next.
+class MatchServer {
+public:
+    MatchServer(const engine::IRenderer& renderer, const MatchServerOptions& options);
+    ~MatchServer();
+
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+
+    // Runs ticks server ticks; costs accumulate over every call
+    MatchServerReport run(std::uint32_t ticks);
+
+    [[nodiscard]] std::size_t getThreadCount() const { return workers.size(); }
+    [[nodiscard]] entt::registry& getMatchRegistry(const std::size_t match) {
+        return matches[match]->runner.getRegistry();
+    }
+    // What the match's first bot client has decoded
+    [[nodiscard]] const entt::registry& getClientRegistry(const std::size_t match) const {
+        return matches[match]->clients.front().registry;
+    }
+
+private:
+    struct BotClient {
+        entt::registry registry;
+        SnapshotDecoder decoder;
+        std::optional<std::uint32_t> acked; // Newest snapshot the server knows it has
+        SnapshotClientState sent;           // What the server sent it
+        std::vector<std::uint8_t> packet;
+    };
+
+    struct Match {
+        HeadlessRunner runner;
+        SnapshotEncoder encoder;
+        std::vector<BotClient> clients;
+        std::uint64_t ticks {0};
+        double totalSeconds {0.0};
+        double maxSeconds {0.0};
+        std::uint64_t snapshotBytes {0};
+
+        Match(const engine::IRenderer& renderer, const HeadlessOptions& options,
+              std::uint32_t botClients, std::size_t snapshotBudgetBytes);
+    };
+
+    MatchServerOptions options;
+    std::vector<std::unique_ptr<Match>> matches;
+    std::vector<double> busySeconds; // Per worker
+    // Every worker and the clock thread meet here before and after each tick
+    std::barrier<> tickStart;
+    std::barrier<> tickEnd;
+    bool stopping {false};
+    std::vector<std::jthread> workers;
+
+    // Builds and ticks matches worker, worker + stride, ...
+    void runWorker(const engine::IRenderer& renderer, std::size_t worker, std::size_t stride);
+    void tickMatch(Match& match) const;
+};
+
+#endif // DIDDLEDOODLEDUEL_MATCH_SERVER_H
@@ -0,0 +1,188 @@
+#ifndef DIDDLEDOODLEDUEL_AI_STEERING_H
+#define DIDDLEDOODLEDUEL_AI_STEERING_H
+#include "canvas/ownership_grid.h"
+#include "canvas/unpainted_flow_field.h"
+#include "components/ai_controller.h"
+#include "components/input_action.h"
+#include "components/paint_owner.h"
+#include "components/position.h"
+#include "components/renderable.h"
+#include "components/velocity.h"
+#include "core/parallel_for.h"
+#include "core/thread_pool.h"
+#include "core/type_list.h"
+#include "game_config.h"
+#include "physics/spatial_hash.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <raylib.h>
+#include <vector>
+
+// Writes InputAction for brushes with an AiController, by the first rule that applies:
+// turn back towards the centre before leaving the arena, turn away from brushes just ahead,
+// turn towards the probe (left, ahead or right) that lands on the most valuable paint, head
+// for the nearest unclaimed space on the UnpaintedFlowField when there is one, and otherwise
+// wander. Bots only steer through InputAction, so they move and collide exactly like players.
+struct AiSteeringSystem {
+    using Reads = TypeList<Position, Velocity, Renderable, PaintOwner, CanvasOwnershipGrid,
+                           UnpaintedFlowField>;
+    using Writes = TypeList<InputAction, AiController>;
+
+    explicit AiSteeringSystem(entt::registry& registry, GameConfig& config,
+                              ThreadPool* pool = nullptr)
+        : registry(registry), config(config), pool(pool) {
+    }
+
+    void update() {
+        gatherBrushes();
+
+        const auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+        const auto* field = registry.ctx().find<UnpaintedFlowField>();
+        const auto view = registry.view<AiController, InputAction, const Position, const Velocity,
+                                        const PaintOwner>();
+        parallelForEach(pool, view, static_cast<std::size_t>(config.parallelEntityThreshold),
+                        static_cast<std::size_t>(config.parallelGrainSize),
+                        [&](const entt::entity entity) {
+                            const int turn = steer(grid, field, entity,
+                                                   view.get<const Position>(entity),
+                                                   view.get<const Velocity>(entity),
+                                                   view.get<const PaintOwner>(entity),
+                                                   view.get<AiController>(entity));
+                            view.get<InputAction>(entity) =
+                                InputAction{.rotateLeft = turn < 0, .rotateRight = turn > 0};
+                        });
+    }
+
+private:
+    // In brush radii: how far ahead walls and paint are probed, and how close another brush
+    // has to be before it is avoided
+    static constexpr float kLookaheadRadii = 4.0F;
+    static constexpr float kAvoidRadii = 3.0F;
+    static constexpr float kProbeAngle = 40.0F * DEG2RAD;
+    static constexpr std::uint32_t kMaxAvoided = 8;
+    // cos(10°): a flow field target within this of the heading counts as straight ahead
+    static constexpr float kOnCourseCosine = 0.985F;
+
+    entt::registry& registry;
+    const GameConfig& config;
+    ThreadPool* pool;
+
+    // Every brush, bots or not, bucketed for the avoidance queries. Kept between ticks so
+    // steady-state updates don't allocate.
+    SpatialHashGrid neighbours;
+    std::vector<entt::entity> bodies;
+    std::vector<float> xs;
+    std::vector<float> ys;
+
+    void gatherBrushes() {
+        bodies.clear();
+        xs.clear();
+        ys.clear();
+        for (const auto view = registry.view<const Position, const Renderable>();
+             const auto entity : view) {
+            const auto& [position] = view.get<const Position>(entity);
+            bodies.push_back(entity);
+            xs.push_back(position.x);
+            ys.push_back(position.y);
+        }
+        neighbours.build(xs, ys, config.brushSize * kAvoidRadii);
+    }
+
+    // -1 turns left, 1 turns right
+    static int sideOf(const Vector2 forward, const Vector2 offset) {
+        return (forward.x * offset.y) - (forward.y * offset.x) >= 0.0F ? 1 : -1;
+    }
+
+    static std::uint32_t nextRandom(AiController& controller) {
+        std::uint32_t state = controller.randomState;
+        state ^= state << 13U;
+        state ^= state >> 17U;
+        state ^= state << 5U;
+        controller.randomState = state;
+        return state;
+    }
+
+    int steer(const CanvasOwnershipGrid& grid, const UnpaintedFlowField* field,
+              const entt::entity self, const Position& position, const Velocity& velocity,
+              const PaintOwner& owner, AiController& controller) const {
+        const Vector2 pos = position.position;
+        const float heading = velocity.rotation * DEG2RAD;
+        const Vector2 forward = {std::cos(heading), std::sin(heading)};
+        const float lookahead = config.brushSize * kLookaheadRadii;
+
+        // Walls
+        const float arenaWidth = static_cast<float>(grid.getWidth()) * grid.getCellSize();
+        const float arenaHeight = static_cast<float>(grid.getHeight()) * grid.getCellSize();
+        const Vector2 ahead = {pos.x + (forward.x * lookahead), pos.y + (forward.y * lookahead)};
+        if (ahead.x < config.brushSize || ahead.x > arenaWidth - config.brushSize ||
+            ahead.y < config.brushSize || ahead.y > arenaHeight - config.brushSize) {
+            return sideOf(forward, {(arenaWidth * 0.5F) - pos.x, (arenaHeight * 0.5F) - pos.y});
+        }
+
+        // Other brushes, weighted by how close they are. In a crowd the first few decide.
+        const float avoidDistance = config.brushSize * kAvoidRadii;
+        float avoidance = 0.0F;
+        std::uint32_t avoided = 0;
+        neighbours.forEachNear(pos.x, pos.y, [&](const std::uint32_t item) {
+            const Vector2 offset = {xs[item] - pos.x, ys[item] - pos.y};
+            const float distanceSquared = (offset.x * offset.x) + (offset.y * offset.y);
+            const bool isAhead = (offset.x * forward.x) + (offset.y * forward.y) > 0.0F;
+            if (bodies[item] != self && isAhead &&
+                distanceSquared < avoidDistance * avoidDistance) {
+                avoidance -= static_cast<float>(sideOf(forward, offset)) *
+                             (1.0F - (std::sqrt(distanceSquared) / avoidDistance));
+                ++avoided;
+            }
+            return avoided < kMaxAvoided;
+        });
+        if (avoidance != 0.0F) {
+            return avoidance > 0.0F ? 1 : -1;
+        }
+
+        // Paint: unpainted cells are worth most, an opponent's less, our own nothing
+        const auto score = [&](const float angle) {
+            const Vector2 probe = {pos.x + (std::cos(angle) * lookahead),
+                                   pos.y + (std::sin(angle) * lookahead)};
+            const std::uint8_t cell = grid.ownerAt(probe.x, probe.y);
+            if (cell == CanvasOwnershipGrid::kUnpainted) {
+                return 2;
+            }
+            return cell == owner.paletteIndex ? 0 : 1;
+        };
+        const std::array<int, 3> scores = {score(heading - kProbeAngle), score(heading),
+                                           score(heading + kProbeAngle)};
+        if (scores[0] > scores[1] || scores[2] > scores[1]) {
+            return scores[2] >= scores[0] ? 1 : -1;
+        }
+        if (scores[1] > 0) {
+            return 0;
+        }
+
+        // Nothing unclaimed in reach, so head for the nearest block that still has some
+        if (field != nullptr) {
+            if (const auto offset = field->offsetToTarget(pos.x, pos.y); offset.has_value()) {
+                const float along = (offset->x * forward.x) + (offset->y * forward.y);
+                const float lengthSquared = (offset->x * offset->x) + (offset->y * offset->y);
+                if (along > 0.0F &&
+                    along * along >= kOnCourseCosine * kOnCourseCosine * lengthSquared) {
+                    return 0;
+                }
+                return sideOf(forward, *offset);
+            }
+        }
+
+        // Wander through our own paint, holding a random turn for a while
+        if (controller.wanderTicks == 0) {
+            controller.wanderTurn =
+                static_cast<std::int8_t>(static_cast<int>(nextRandom(controller) % 3U) - 1);
+            controller.wanderTicks =
+                static_cast<std::uint16_t>(10U + (nextRandom(controller) % 81U));
+        }
+        --controller.wanderTicks;
+        return controller.wanderTurn;
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_AI_STEERING_H
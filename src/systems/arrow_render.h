@@ -1,6 +1,6 @@
 #ifndef DIDDLEDOODLEDUEL_ARROW_RENDER_H
 #define DIDDLEDOODLEDUEL_ARROW_RENDER_H
-#include "components/position.h"
+#include "components/render_position.h"
 #include "components/renderable.h"
 #include "components/velocity.h"
 #include "rendering/irenderer.h"
@@ -16,12 +16,21 @@ struct ArrowRenderSystem {
     Texture2D arrowTexture{};
 
     explicit ArrowRenderSystem(entt::registry& registry, engine::IRenderer& renderer)
-        : registry(registry), renderer(renderer) {
-        
-        if (const auto result = engine::resources::loadTexture("resources/textures/arrowFacingUp.png");
-            result.has_value()) {
-            this->arrowTexture = result.value();
+        : ArrowRenderSystem(registry, renderer, loadArrowTexture()) {
+    }
+
+    // Takes an already loaded texture, e.g. a placeholder when nothing can be loaded
+    ArrowRenderSystem(entt::registry& registry, engine::IRenderer& renderer,
+                      const Texture2D arrowTexture)
+        : registry(registry), renderer(renderer), arrowTexture(arrowTexture) {
+    }
+
+    static Texture2D loadArrowTexture() {
+        if (!IsWindowReady()) {
+            return Texture2D{};
         }
+        const auto result = engine::resources::loadTexture("resources/textures/arrowFacingUp.png");
+        return result.has_value() ? result.value() : Texture2D{};
     }
 
     void render() const {
@@ -30,9 +39,9 @@ struct ArrowRenderSystem {
             return;
         }
         
-        for (const auto view = registry.view<const Position, const Velocity, const Renderable>();
+        for (const auto view = registry.view<const RenderPosition, const Velocity, const Renderable>();
              const auto entity : view) {
-            const auto& [position] = view.get<const Position>(entity);
+            const auto& [position] = view.get<const RenderPosition>(entity);
             const auto& vel = view.get<const Velocity>(entity);
             const auto& [radius, color] = view.get<const Renderable>(entity);
 
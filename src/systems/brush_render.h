@@ -0,0 +1,67 @@
+#ifndef DIDDLEDOODLEDUEL_BRUSH_RENDER_H
+#define DIDDLEDOODLEDUEL_BRUSH_RENDER_H
+#include "components/render_position.h"
+#include "components/renderable.h"
+#include "game_config.h"
+#include "rendering/irenderer.h"
+#include "resources/resource_manager.h"
+#include <entt/entity/registry.hpp>
+#include <raylib.h>
+
+// Draws every brush as its base texture with the brush colour's mask on top, two draws each
+struct BrushRenderSystem {
+    explicit BrushRenderSystem(entt::registry& registry, engine::IDrawHandler& drawHandler,
+                               const GameConfig& config)
+        : BrushRenderSystem(registry, drawHandler, config,
+                            loadTexture("resources/textures/brush_base.png"),
+                            loadTexture("resources/textures/brush_mask.png")) {
+    }
+
+    // Takes already loaded textures, e.g. placeholders when nothing can be loaded
+    BrushRenderSystem(entt::registry& registry, engine::IDrawHandler& drawHandler,
+                      const GameConfig& config, const Texture2D brushBase,
+                      const Texture2D brushMask)
+        : registry(registry), drawHandler(drawHandler), config(config), brushBase(brushBase),
+          brushMask(brushMask) {
+    }
+
+    void render() const {
+        const float brushSize = config.brushSize * 2.0F;
+        const Vector2 origin = {brushSize / 2.0F, brushSize / 2.0F};
+        constexpr float noRotation = 0.0F;
+
+        for (const auto view = registry.view<const RenderPosition, const Renderable>();
+             const auto entity : view) {
+            const auto& [pos] = view.get<const RenderPosition>(entity);
+            const auto& [radius, color] = view.get<const Renderable>(entity);
+            const Rectangle destinationRect = {pos.x, pos.y, brushSize, brushSize};
+
+            drawHandler.drawTexture(brushBase, sourceOf(brushBase), destinationRect, origin,
+                                    noRotation, WHITE);
+            drawHandler.drawTexture(brushMask, sourceOf(brushMask), destinationRect, origin,
+                                    noRotation, color);
+        }
+    }
+
+private:
+    entt::registry& registry;
+    engine::IDrawHandler& drawHandler;
+    const GameConfig& config;
+    Texture2D brushBase;
+    Texture2D brushMask;
+
+    // Nothing can be uploaded without a window, e.g. under a NullRenderer
+    static Texture2D loadTexture(const char* path) {
+        if (!IsWindowReady()) {
+            return Texture2D{};
+        }
+        const auto result = engine::resources::loadTexture(path);
+        return result.has_value() ? result.value() : Texture2D{};
+    }
+
+    static Rectangle sourceOf(const Texture2D& texture) {
+        return {0, 0, static_cast<float>(texture.width), static_cast<float>(texture.height)};
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_BRUSH_RENDER_H
@@ -0,0 +1,88 @@
+#ifndef DIDDLEDOODLEDUEL_CAMERA_H
+#define DIDDLEDOODLEDUEL_CAMERA_H
+#include "components/input_mapping.h"
+#include "components/render_position.h"
+#include "core/arena_camera.h"
+#include "core/type_list.h"
+#include "game_config.h"
+#include <algorithm>
+#include <entt/entity/registry.hpp>
+#include <raylib.h>
+
+// Points the ArenaCamera in the registry context at the local players. An arena that fits the
+// view is shown whole and centred. A larger one follows the box around the players, zoomed out
+// as far as it takes to keep them all in view but no further than the whole arena, and never
+// past its edges. With no local players, e.g. in the stress test, it shows as much as it can.
+struct CameraSystem {
+    using Reads = TypeList<RenderPosition, InputMapping>;
+    using Writes = TypeList<ArenaCamera>;
+
+    // Room kept around the players, in world units
+    static constexpr float kFollowMargin = 200.0F;
+
+    CameraSystem(entt::registry& registry, const GameConfig& config, const float viewWidth,
+                 const float viewHeight)
+        : registry(registry), config(config) {
+        registry.ctx().insert_or_assign(
+            ArenaCamera{.viewWidth = viewWidth, .viewHeight = viewHeight});
+        update();
+    }
+
+    // Call once per frame, after interpolation
+    void update() const {
+        auto& arenaCamera = registry.ctx().get<ArenaCamera>();
+        const float viewWidth = std::max(arenaCamera.viewWidth, 1.0F);
+        const float viewHeight = std::max(arenaCamera.viewHeight, 1.0F);
+        const float arenaWidth = std::max(config.arenaWidth, 1.0F);
+        const float arenaHeight = std::max(config.arenaHeight, 1.0F);
+
+        const Rectangle focus = focusRect(arenaWidth, arenaHeight);
+        const float fitZoom = std::min(viewWidth / arenaWidth, viewHeight / arenaHeight);
+        const float zoom = std::clamp(std::min(viewWidth / focus.width, viewHeight / focus.height),
+                                      std::min(fitZoom, 1.0F), 1.0F);
+
+        const auto centre = [zoom](const float focusCentre, const float view, const float arena) {
+            const float halfView = view * 0.5F / zoom;
+            return arena <= halfView * 2.0F ? arena * 0.5F
+                                            : std::clamp(focusCentre, halfView, arena - halfView);
+        };
+        arenaCamera.camera = Camera2D{
+            .offset = {viewWidth * 0.5F, viewHeight * 0.5F},
+            .target = {centre(focus.x + (focus.width * 0.5F), viewWidth, arenaWidth),
+                       centre(focus.y + (focus.height * 0.5F), viewHeight, arenaHeight)},
+            .rotation = 0.0F,
+            .zoom = zoom};
+    }
+
+    [[nodiscard]] const ArenaCamera& getCamera() const {
+        return registry.ctx().get<ArenaCamera>();
+    }
+
+private:
+    entt::registry& registry;
+    const GameConfig& config;
+
+    // The players with room around them, or the whole arena without any
+    [[nodiscard]] Rectangle focusRect(const float arenaWidth, const float arenaHeight) const {
+        const auto view = registry.view<const RenderPosition, const InputMapping>();
+        if (view.begin() == view.end()) {
+            return Rectangle{0.0F, 0.0F, arenaWidth, arenaHeight};
+        }
+        float minX = arenaWidth;
+        float maxX = 0.0F;
+        float minY = arenaHeight;
+        float maxY = 0.0F;
+        for (const auto entity : view) {
+            const auto& [position] = view.get<const RenderPosition>(entity);
+            minX = std::min(minX, position.x);
+            maxX = std::max(maxX, position.x);
+            minY = std::min(minY, position.y);
+            maxY = std::max(maxY, position.y);
+        }
+        return Rectangle{minX - kFollowMargin, minY - kFollowMargin,
+                         (maxX - minX) + (kFollowMargin * 2.0F),
+                         (maxY - minY) + (kFollowMargin * 2.0F)};
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_CAMERA_H
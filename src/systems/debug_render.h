@@ -2,7 +2,7 @@
 #define DIDDLEDOODLEDUEL_DEBUG_RENDER_H
 
 #include "game_config.h"
-#include "components/position.h"
+#include "components/render_position.h"
 #include <entt/entity/registry.hpp>
 #include <raylib.h>
 
@@ -11,9 +11,9 @@ struct DebugRenderSystem {
         : registry(registry), config(config) {}
 
     void render() const {
-        const auto view = registry.view<const Position>();
+        const auto view = registry.view<const RenderPosition>();
         for (const auto entity : view) {
-            const auto& pos = view.get<const Position>(entity);
+            const auto& pos = view.get<const RenderPosition>(entity);
             DrawCircleLines(static_cast<int>(pos.position.x), static_cast<int>(pos.position.y), config.debugCollisionRadius, RED);
         }
     }
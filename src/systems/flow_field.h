@@ -0,0 +1,55 @@
+#ifndef DIDDLEDOODLEDUEL_FLOW_FIELD_H
+#define DIDDLEDOODLEDUEL_FLOW_FIELD_H
+#include "canvas/ownership_grid.h"
+#include "canvas/unpainted_flow_field.h"
+#include "core/type_list.h"
+#include "game_config.h"
+#include <chrono>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <optional>
+
+// Keeps the UnpaintedFlowField in step with the ownership grid, one field block per grid
+// block. Blocks at least a quarter unpainted are targets; each tick re-checks the blocks the
+// grid reports changed, so its cost follows what was painted rather than the arena size, and
+// then repairs a bounded part of the field.
+struct FlowFieldSystem {
+    using Reads = TypeList<>;
+    // Taking the grid's changed blocks empties its list
+    using Writes = TypeList<UnpaintedFlowField, CanvasOwnershipGrid>;
+
+    // The ownership grid has to exist, i.e. PaintGridSystem is constructed first
+    explicit FlowFieldSystem(entt::registry& registry, GameConfig& config)
+        : registry(registry), config(config) {
+        const auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+        registry.ctx().emplace<UnpaintedFlowField>(
+            grid.getBlockColumns(), grid.getBlockRows(),
+            grid.getCellSize() * static_cast<float>(CanvasOwnershipGrid::kBlockCells));
+    }
+
+    void update() const {
+        auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+        auto& field = registry.ctx().get<UnpaintedFlowField>();
+        grid.takeChangedBlocks([&](const int column, const int row) {
+            field.setTarget(column, row,
+                            grid.unpaintedBlockFraction(column, row) >= kTargetFraction);
+        });
+
+        std::optional<UnpaintedFlowField::Clock::time_point> deadline;
+        if (config.flowFieldBudgetMicros > 0.0F) {
+            deadline = UnpaintedFlowField::Clock::now() +
+                       std::chrono::duration_cast<UnpaintedFlowField::Clock::duration>(
+                           std::chrono::duration<float, std::micro>(
+                               config.flowFieldBudgetMicros));
+        }
+        field.repair(static_cast<std::uint32_t>(config.flowFieldUpdatesPerTick), deadline);
+    }
+
+private:
+    static constexpr float kTargetFraction = 0.25F;
+
+    entt::registry& registry;
+    const GameConfig& config;
+};
+
+#endif // DIDDLEDOODLEDUEL_FLOW_FIELD_H
@@ -1,7 +1,10 @@
 #include "imgui_system.h"
+#include "canvas/dirty_tiles.h"
+#include "canvas/ownership_grid.h"
 #include "components/collision_state.h"
 #include "components/input_action.h"
 #include "components/input_mapping.h"
+#include "components/paint_owner.h"
 #include "components/position.h"
 #include "components/renderable.h"
 #include "components/velocity.h"
@@ -9,7 +12,9 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include <GLFW/glfw3.h>
+#include <array>
 #include <entt/entity/registry.hpp>
+#include <utility>
 
 ImGuiSystem::ImGuiSystem(entt::registry& registry, GameConfig& gameConfig) : gameConfig(gameConfig), registry(registry) {
 }
@@ -85,12 +90,55 @@ void ImGuiSystem::renderGameUI(const std::string& title, int fps) {
     ImGui::Text("FPS: %d", fps);
     ImGui::Separator();
 
+    if (const auto* grid = registry.ctx().find<CanvasOwnershipGrid>(); grid != nullptr) {
+        ImGui::Text("Canvas Coverage");
+        // Once per palette entry, however many brushes share it
+        std::array<bool, CanvasOwnershipGrid::kMaxPaletteEntries> listed {};
+        for (const auto view = registry.view<const PaintOwner, const Renderable>();
+             const auto entity : view) {
+            const auto& [paletteIndex] = view.get<const PaintOwner>(entity);
+            if (std::exchange(listed[paletteIndex], true)) {
+                continue;
+            }
+            const auto& [radius, color] = view.get<const Renderable>(entity);
+            ImGui::TextColored(ImVec4(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f),
+                               "Player %d: %.1f%%", paletteIndex,
+                               grid->coverage(paletteIndex) * 100.0f);
+        }
+    }
+    if (const auto* dirtyTiles = registry.ctx().find<CanvasDirtyTiles>(); dirtyTiles != nullptr) {
+        ImGui::Text("Canvas tiles painted: %zu / %u", dirtyTiles->getDirtyTiles().size(),
+                    dirtyTiles->getTileCount());
+    }
+
     ImGui::Separator();
     ImGui::Text("Collision Physics");
     ImGui::SliderFloat("Restitution", &gameConfig.restitution, 0.0f, 1.0f);
     ImGui::SliderFloat("Collision Damping", &gameConfig.collisionDamping, 0.1f, 1.0f);
     ImGui::SliderFloat("Separation Force", &gameConfig.separationForce, 50.0f, 300.0f);
     ImGui::SliderFloat("Brush Size", &gameConfig.brushSize, 10.0f, 50.0f);
+    ImGui::Checkbox("Spatial Hash Broadphase", &gameConfig.useSpatialHash);
+    if (bool simdNarrowphase = gameConfig.narrowphaseBackend == NarrowphaseBackend::Simd;
+        ImGui::Checkbox("SIMD Narrowphase", &simdNarrowphase)) {
+        gameConfig.narrowphaseBackend =
+            simdNarrowphase ? NarrowphaseBackend::Simd : NarrowphaseBackend::Scalar;
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Frame Pacing");
+    ImGui::SliderFloat("Simulation Tick Rate", &gameConfig.simulationTickRate, 20.0f, 240.0f);
+    ImGui::SliderInt("Max Ticks Per Frame", &gameConfig.maxSimulationStepsPerFrame, 1, 10);
+    ImGui::SliderInt("Target FPS (0 = uncapped)", &gameConfig.targetFps, 0, 240);
+    ImGui::Checkbox("Parallel Systems", &gameConfig.parallelSystems);
+    ImGui::SliderInt("Parallel Entity Threshold", &gameConfig.parallelEntityThreshold, 64, 8192);
+    ImGui::SliderInt("Parallel Grain Size", &gameConfig.parallelGrainSize, 16, 1024);
+
+    ImGui::Separator();
+    ImGui::Text("Bots (from the next match)");
+    ImGui::SliderInt("Human Players", &gameConfig.localHumanPlayers, 0, 4);
+    ImGui::SliderInt("Stress Test Bots", &gameConfig.stressBotCount, 1000, 50000);
+    ImGui::SliderInt("Flow Field Blocks/Tick", &gameConfig.flowFieldUpdatesPerTick, 64, 8192);
+    ImGui::SliderFloat("Flow Field Budget (us)", &gameConfig.flowFieldBudgetMicros, 0.0f, 2000.0f);
     
     ImGui::Separator();
     ImGui::Text("Debug Options");
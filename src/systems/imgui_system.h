@@ -20,6 +20,8 @@ public:
     void renderEcsDebug();
 
     [[nodiscard]] bool isDebugWindowVisible() const { return showDebugWindow; }
+    // False until initialize() finds a window to draw into
+    [[nodiscard]] bool isInitialized() const { return initialized; }
     
 private:
     bool initialized = false;
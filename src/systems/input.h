@@ -3,9 +3,15 @@
 #include "components/input_action.h"
 #include "components/input_mapping.h"
 #include "components/collision_state.h"
+#include "core/type_list.h"
 #include <entt/entity/registry.hpp>
 
 struct InputSystem {
+    using Reads = TypeList<InputMapping>;
+    using Writes = TypeList<InputAction>;
+    // Polls raylib's keyboard state
+    static constexpr bool kMainThreadOnly = true;
+
     explicit InputSystem(entt::registry& registry) : registry(registry) {
     }
 
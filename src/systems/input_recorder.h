@@ -0,0 +1,38 @@
+#ifndef DIDDLEDOODLEDUEL_INPUT_RECORDER_H
+#define DIDDLEDOODLEDUEL_INPUT_RECORDER_H
+#include "components/input_action.h"
+#include "core/type_list.h"
+#include "replay/input_recording.h"
+#include <entt/entity/registry.hpp>
+#include <span>
+
+// Appends what every player holds to an InputRecording once per simulation tick. Runs after
+// whatever produced the input and before the simulation reads it.
+struct InputRecorderSystem {
+    using Reads = TypeList<InputAction>;
+    using Writes = TypeList<>;
+
+    explicit InputRecorderSystem(const entt::registry& registry) : registry(registry) {
+    }
+
+    // Drops the previous match; false (and nothing recorded) past InputRecording::kMaxPlayers
+    bool start(const GameConfig& config, const std::span<const PlayerSpawn> spawns) {
+        active = recording.reset(config, spawns);
+        return active;
+    }
+
+    void update(const std::span<const entt::entity> players) {
+        if (active) {
+            recording.append(InputRecording::pack(registry, players));
+        }
+    }
+
+    [[nodiscard]] const InputRecording& getRecording() const { return recording; }
+
+private:
+    const entt::registry& registry;
+    InputRecording recording;
+    bool active {false};
+};
+
+#endif // DIDDLEDOODLEDUEL_INPUT_RECORDER_H
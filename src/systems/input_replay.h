@@ -0,0 +1,47 @@
+#ifndef DIDDLEDOODLEDUEL_INPUT_REPLAY_H
+#define DIDDLEDOODLEDUEL_INPUT_REPLAY_H
+#include "components/input_action.h"
+#include "core/type_list.h"
+#include "replay/input_recording.h"
+#include <entt/entity/registry.hpp>
+#include <span>
+
+// Drives InputAction from a recording, one recorded tick per simulation tick, in place of the
+// keyboard or scripted input. Players must be spawned from the recording's spawns, in order.
+struct InputReplaySystem {
+    using Reads = TypeList<>;
+    using Writes = TypeList<InputAction>;
+
+    explicit InputReplaySystem(entt::registry& registry, InputRecording recording)
+        : registry(registry), recording(std::move(recording)) {
+    }
+
+    void restart() {
+        run = 0;
+        tickInRun = 0;
+    }
+
+    // Past the end of the recording every player lets go
+    void update(const std::span<const entt::entity> players) {
+        TickInputs inputs = 0;
+        if (run < recording.runs.size()) {
+            inputs = recording.runs[run].inputs;
+            if (++tickInRun == recording.runs[run].ticks) {
+                ++run;
+                tickInRun = 0;
+            }
+        }
+        InputRecording::unpack(registry, players, inputs);
+    }
+
+    [[nodiscard]] bool isFinished() const { return run >= recording.runs.size(); }
+    [[nodiscard]] const InputRecording& getRecording() const { return recording; }
+
+private:
+    entt::registry& registry;
+    InputRecording recording;
+    std::size_t run {0};
+    std::uint32_t tickInRun {0};
+};
+
+#endif // DIDDLEDOODLEDUEL_INPUT_REPLAY_H
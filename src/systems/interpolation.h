@@ -0,0 +1,39 @@
+#ifndef DIDDLEDOODLEDUEL_INTERPOLATION_H
+#define DIDDLEDOODLEDUEL_INTERPOLATION_H
+#include "components/position.h"
+#include "components/previous_position.h"
+#include "components/render_position.h"
+#include "core/type_list.h"
+#include <entt/entity/registry.hpp>
+#include <raymath.h>
+
+struct InterpolationSystem {
+    using Reads = TypeList<Position, PreviousPosition>;
+    using Writes = TypeList<PreviousPosition, RenderPosition>;
+
+    explicit InterpolationSystem(entt::registry& registry) : registry(registry) {
+    }
+
+    // Call before each simulation tick
+    void storePreviousPositions() const {
+        for (const auto view = registry.view<const Position, PreviousPosition>();
+             const auto entity : view) {
+            view.get<PreviousPosition>(entity).position = view.get<const Position>(entity).position;
+        }
+    }
+
+    // Call once per frame after the ticks, with FixedTimestep::getAlpha()
+    void interpolate(const float alpha) const {
+        for (const auto view = registry.view<const Position, const PreviousPosition, RenderPosition>();
+             const auto entity : view) {
+            const auto& [previous] = view.get<const PreviousPosition>(entity);
+            const auto& [current] = view.get<const Position>(entity);
+            view.get<RenderPosition>(entity).position = Vector2Lerp(previous, current, alpha);
+        }
+    }
+
+private:
+    entt::registry& registry;
+};
+
+#endif // DIDDLEDOODLEDUEL_INTERPOLATION_H
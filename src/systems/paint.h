@@ -1,134 +1,81 @@
 #ifndef DIDDLEDOODLEDUEL_PAINT_H
 #define DIDDLEDOODLEDUEL_PAINT_H
-#include "components/renderable.h"
-#include "rendering/irenderer.h"
-#include "resources/resource_manager.h"
+#include "canvas/dirty_tiles.h"
+#include "canvas/paint_stamp_queue.h"
+#include "core/arena_camera.h"
+#include "core/type_list.h"
 #include "game_config.h"
+#include "rendering/gpu_canvas_tile_store.h"
+#include "rendering/gpu_paint_canvas.h"
+#include "rendering/irenderer.h"
+#include "rendering/null_paint_canvas.h"
+#include "rendering/paint_canvas.h"
+#include "rendering/tiled_paint_canvas.h"
+#include <algorithm>
+#include <cmath>
 #include <entt/entity/registry.hpp>
-#include <raylib.h>
-#include <raymath.h>
-#include <unordered_map>
+#include <memory>
 
 struct PaintSystem {
+    using Reads = TypeList<>;
+    using Writes = TypeList<PaintStampQueue, CanvasDirtyTiles>;
+    // The game's canvas is a GPU render texture
+    static constexpr bool kMainThreadOnly = true;
+
+    // Paints into an arena-sized GPU canvas, or into GPU tiles of one when the arena is larger
+    // than the window. Without a window there is no GPU, and the stamps are dropped.
+    PaintSystem(const engine::IRenderer& renderer, entt::registry& registry,
+                const GameConfig& config)
+        : PaintSystem(registry, makeGpuCanvas(renderer, config)) {
+    }
 
-    explicit PaintSystem(engine::IRenderer& renderer, GameConfig& config, entt::registry& registry)
-    : config(config), registry(registry), renderer(renderer)
-    {
-        if (const auto result = engine::resources::loadTexture("resources/textures/brush_base.png");
-            result.has_value()) {
-            this->brushBase = result.value();
-        }
-
-        if (const auto result = engine::resources::loadTexture("resources/textures/brush_mask.png");
-            result.has_value()) {
-            this->brushMask = result.value();
-        }
-
-        const auto width = renderer.getWindowWidth();
-        const auto height = renderer.getWindowHeight();
-
-        renderTexture = std::make_unique<RenderTexture2D>(LoadRenderTexture(width, height));
-        shader = std::make_unique<Shader>(LoadShader(nullptr, "resources/shaders/watercolor.fs"));
-
-        initialiseTexture();
+    PaintSystem(entt::registry& registry, std::unique_ptr<PaintCanvas> canvas)
+        : registry(registry), canvas(std::move(canvas)) {
+        registry.ctx().insert_or_assign(
+            CanvasDirtyTiles(this->canvas->getWidth(), this->canvas->getHeight()));
     }
 
+    // Draws the stamps PaintGridSystem queued since the last update into the canvas. The
+    // CanvasDirtyTiles in the context then hold the tiles they touched until the next update.
     void update() const {
-        const auto view = registry.view<Position, Renderable>();
-        bool needsPainting = false;
-
-        for (auto entity : view) {
-            const auto& [pos] = view.get<Position>(entity);
-            const auto& [radius, color] = view.get<Renderable>(entity);
-            
-            // Use config.brushSize instead of radius for consistent sizing
-            drawBrush(pos, config.brushSize, color);
-            
-            // Store last positions to only paint when actually moving
-            static std::unordered_map<entt::entity, Vector2> lastPositions;
-            
-            auto it = lastPositions.find(entity);
-            if (it == lastPositions.end() || 
-                Vector2Distance(it->second, pos) > radius * 0.1f) {
-                lastPositions[entity] = pos;
-                needsPainting = true;
-
-                BeginTextureMode(*renderTexture);
-                DrawCircle(static_cast<int>(pos.x), static_cast<int>(pos.y), radius, color);
-                EndTextureMode();
-            }
+        auto& queue = registry.ctx().get<PaintStampQueue>();
+        auto& dirtyTiles = registry.ctx().get<CanvasDirtyTiles>();
+        dirtyTiles.clear();
+        for (const auto& stamp : queue.stamps) {
+            dirtyTiles.markStamp(stamp);
         }
+        canvas->drawStamps(queue.stamps, dirtyTiles);
+        queue.stamps.clear();
     }
 
+    // Through the ArenaCamera in the context, if there is one. Brushes on top are
+    // BrushRenderSystem's.
     void render() const {
-        drawTexture();
-        drawBrush(registry, renderer, config);
+        if (const auto* camera = registry.ctx().find<ArenaCamera>(); camera != nullptr) {
+            canvas->draw(*camera);
+            return;
+        }
+        canvas->draw(ArenaCamera{.viewWidth = static_cast<float>(canvas->getWidth()),
+                                 .viewHeight = static_cast<float>(canvas->getHeight())});
     }
 
 private:
-    std::unique_ptr<RenderTexture2D> renderTexture;
-    std::unique_ptr<Shader> shader;
-    Texture2D brushBase{};
-    Texture2D brushMask{};
-    const GameConfig& config;
     entt::registry& registry;
-    engine::IRenderer& renderer;
-
-    void initialiseTexture() const {
-        BeginTextureMode(*renderTexture);
-        ClearBackground(WHITE);
-        EndTextureMode();
-    }
-
-    void drawTexture() const{
-        BeginShaderMode(*shader);
-        DrawTextureRec(renderTexture->texture,
-            Rectangle{0,0, static_cast<float>(renderTexture->texture.width), static_cast<float>(-renderTexture->texture.height)},
-            Vector2{0.0F, 0.0F},
-            WHITE);
-        EndShaderMode();
-    }
-
-    void drawBrush(const entt::registry& registry, engine::IDrawHandler& drawHandler, const GameConfig& config) const {
-        for (const auto view = registry.view<const Position, const Renderable>();
-             const auto& entity : view) {
-            const auto& [pos] = view.get<const Position>(entity);
-            const auto& [radius, color] = view.get<const Renderable>(entity);
-
-            const float brushSize = config.brushSize * 2.0F;
-
-            const Rectangle destinationRect = {
-                pos.x,
-                pos.y,
-                brushSize,
-                brushSize
-            };
-
-            Vector2 origin = {brushSize / 2.0F, brushSize / 2.0F};
-            constexpr float noRotation = 0.0F;
-
-            drawHandler.drawTexture(
-                brushBase, {0,0, static_cast<float>(brushBase.width), static_cast<float>(brushBase.height)},
-                destinationRect,
-                origin,
-                noRotation,
-                WHITE);
-
-            drawHandler.drawTexture(
-                brushMask, {0, 0, static_cast<float>(brushMask.width), static_cast<float>(brushMask.height)},
-                destinationRect,
-                origin,
-                noRotation,
-                color);
+    std::unique_ptr<PaintCanvas> canvas;
+
+    static std::unique_ptr<PaintCanvas> makeGpuCanvas(const engine::IRenderer& renderer,
+                                                      const GameConfig& config) {
+        const auto width = static_cast<int>(std::ceil(config.arenaWidth));
+        const auto height = static_cast<int>(std::ceil(config.arenaHeight));
+        if (!IsWindowReady()) {
+            return std::make_unique<NullPaintCanvas>(width, height);
         }
-    }
-
-    void drawBrush(const Vector2& pos, float size, const Color& color) const {
-        // This method can be used for immediate drawing effects
-        // For now, it just draws to the render texture
-        BeginTextureMode(*renderTexture);
-        DrawCircle(static_cast<int>(pos.x), static_cast<int>(pos.y), size, color);
-        EndTextureMode();
+        if (width <= renderer.getWindowWidth() && height <= renderer.getWindowHeight()) {
+            return std::make_unique<GpuPaintCanvas>(width, height);
+        }
+        return std::make_unique<TiledPaintCanvas>(
+            std::make_unique<GpuCanvasTileStore>(), width, height,
+            static_cast<std::size_t>(std::max(config.canvasResidentTiles, 1)));
     }
 };
 
@@ -0,0 +1,80 @@
+#ifndef DIDDLEDOODLEDUEL_PAINT_GRID_H
+#define DIDDLEDOODLEDUEL_PAINT_GRID_H
+#include "canvas/ownership_grid.h"
+#include "canvas/paint_stamp_queue.h"
+#include "components/paint_owner.h"
+#include "components/paint_trail.h"
+#include "components/position.h"
+#include "components/renderable.h"
+#include "core/type_list.h"
+#include "game_config.h"
+#include <entt/entity/registry.hpp>
+#include <raylib.h>
+#include <raymath.h>
+
+// CPU half of painting: turns brush movement into stamps and claims canvas ownership. Needs no
+// renderer, so it runs the same in the windowed game and in headless simulations.
+struct PaintGridSystem {
+    using Reads = TypeList<Position, Renderable, PaintOwner>;
+    using Writes = TypeList<PaintTrail, PaintStampQueue, CanvasOwnershipGrid>;
+
+    explicit PaintGridSystem(entt::registry& registry, GameConfig& config, const float worldWidth,
+                             const float worldHeight)
+        : registry(registry), config(config) {
+        registry.ctx().emplace<CanvasOwnershipGrid>(worldWidth, worldHeight, config.ownershipCellSize);
+        registry.ctx().emplace<PaintStampQueue>();
+    }
+
+    void update() const {
+        auto& queue = registry.ctx().get<PaintStampQueue>();
+        const auto firstNewStamp = queue.stamps.size();
+
+        queueStrokes(queue);
+        claimCells(queue, firstNewStamp);
+    }
+
+private:
+    entt::registry& registry;
+    const GameConfig& config;
+
+    // Turns each brush's movement since its last stamp into one swept stamp, so fast brushes
+    // leave continuous strokes however far they travel in a frame
+    void queueStrokes(PaintStampQueue& queue) const {
+        for (const auto view = registry.view<const Position, const Renderable>();
+             const auto entity : view) {
+            const auto& [pos] = view.get<const Position>(entity);
+            const auto& [radius, color] = view.get<const Renderable>(entity);
+            auto& trail = registry.get_or_emplace<PaintTrail>(entity);
+
+            // Only paint when actually moving
+            if (trail.hasLastPosition && Vector2Distance(trail.lastPosition, pos) <= radius * 0.1f) {
+                continue;
+            }
+
+            const PaintOwner* owner = registry.try_get<PaintOwner>(entity);
+            // Use config.brushSize instead of radius for consistent sizing
+            queue.stamps.push_back(PaintStamp{
+                .from = trail.hasLastPosition ? trail.lastPosition : pos,
+                .to = pos,
+                .radius = config.brushSize,
+                .color = color,
+                .paletteIndex = owner != nullptr ? owner->paletteIndex : CanvasOwnershipGrid::kUnpainted});
+
+            trail.lastPosition = pos;
+            trail.hasLastPosition = true;
+        }
+    }
+
+    // Mirrors new stamps into the CPU ownership grid so coverage stays current without readbacks
+    void claimCells(const PaintStampQueue& queue, const std::size_t firstNewStamp) const {
+        auto& grid = registry.ctx().get<CanvasOwnershipGrid>();
+        for (auto stamp = queue.stamps.begin() + static_cast<std::ptrdiff_t>(firstNewStamp);
+             stamp != queue.stamps.end(); ++stamp) {
+            if (stamp->paletteIndex != CanvasOwnershipGrid::kUnpainted) {
+                grid.rasterizeCapsule(stamp->from, stamp->to, stamp->radius, stamp->paletteIndex);
+            }
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_PAINT_GRID_H
@@ -4,50 +4,32 @@
 #include "components/position.h"
 #include "components/renderable.h"
 #include "components/velocity.h"
+#include "core/parallel_for.h"
+#include "core/thread_pool.h"
+#include "core/type_list.h"
+#include "game_config.h"
+#include "physics/circle_narrowphase.h"
+#include "physics/spatial_hash.h"
+#include <algorithm>
 #include <cmath>
 #include <entt/entity/registry.hpp>
 #include <raymath.h>
+#include <vector>
 
 struct PhysicsCollisionSystem {
-    explicit PhysicsCollisionSystem(entt::registry& registry, GameConfig& gameConfig) 
-        : registry(registry), gameConfig(gameConfig) {
-    }
+    using Reads = TypeList<Renderable>;
+    using Writes = TypeList<Position, Velocity, CollisionState>;
 
-    void update(const float& deltaTime) const {
-        // Check all entity pairs for collisions
-        for (const auto view = registry.view<Position, CollisionState, Renderable, Velocity>();
-             const auto entityA : view) {
-            for (const auto entityB : view) {
-                if (entityA == entityB) { continue; }
+    explicit PhysicsCollisionSystem(entt::registry& registry, GameConfig& gameConfig,
+                                    ThreadPool* pool = nullptr)
+        : registry(registry), gameConfig(gameConfig), pool(pool) {
+    }
 
-                auto& positionA = registry.get<Position>(entityA);
-                auto& positionB = registry.get<Position>(entityB);
-
-                const auto& renderableA = registry.get<Renderable>(entityA);
-                const auto& renderableB = registry.get<Renderable>(entityB);
-
-                auto& velocityA = registry.get<Velocity>(entityA);
-                auto& velocityB = registry.get<Velocity>(entityB);
-
-                auto& stateA = registry.get<CollisionState>(entityA);
-                auto& stateB = registry.get<CollisionState>(entityB);
-
-                // Don't process collision if either object is already in collision cooldown
-                if ((stateA.isInCollision && stateA.bounceTimer > 0.0f) || 
-                    (stateB.isInCollision && stateB.bounceTimer > 0.0f)) {
-                    continue;
-                }
-
-                if (auto [collision, collisionData] = checkCollision(positionA.position, positionB.position, renderableA, renderableB); 
-                    collision) {
-                    
-                    // Separate overlapping objects
-                    separateObjects(positionA, positionB, collisionData, renderableA, renderableB);
-                    
-                    // Apply realistic collision response
-                    applyPhysicsCollision(velocityA, velocityB, collisionData, stateA, stateB);
-                }
-            }
+    void update(const float& deltaTime) {
+        if (gameConfig.useSpatialHash) {
+            resolveBroadphaseCollisions();
+        } else {
+            resolveBruteForceCollisions();
         }
 
         // Update collision timers
@@ -57,6 +39,14 @@ struct PhysicsCollisionSystem {
 private:
     entt::registry& registry;
     const GameConfig& gameConfig;
+    ThreadPool* pool;
+
+    // Broadphase scratch, kept between frames so steady-state updates don't allocate
+    SpatialHashGrid broadphase;
+    std::vector<entt::entity> bodies;
+    CircleBodies circles;
+    std::vector<CandidatePair> candidatePairs;
+    std::vector<CircleContact> contacts;
 
     struct CollisionData {
         Vector2 normal;      // Collision normal (from A to B)
@@ -64,6 +54,110 @@ private:
         Vector2 contactPoint; // Point of contact
     };
 
+    void resolveBroadphaseCollisions() {
+        const auto view = registry.view<Position, CollisionState, Renderable, Velocity>();
+
+        bodies.clear();
+        circles.clear();
+        float maxRadius = 0.0F;
+        for (const auto entity : view) {
+            const float radius = view.get<Renderable>(entity).radius;
+            bodies.push_back(entity);
+            circles.push(view.get<Position>(entity).position, radius);
+            maxRadius = std::max(maxRadius, radius);
+        }
+
+        if (bodies.size() < 2 || maxRadius <= 0.0F) {
+            return;
+        }
+
+        // Cells as wide as the largest diameter keep every overlapping pair in adjacent cells
+        broadphase.build(circles.x, circles.y, maxRadius * 2.0F);
+        broadphase.collectPairs(candidatePairs);
+
+        // Batched contacts are computed from positions at the start of the pass. That matches
+        // the per-pair path because separation only moves brushes that then sit out the rest
+        // of the pass in bounce cooldown, which needs a positive bounce duration.
+        if (gameConfig.narrowphaseBackend == NarrowphaseBackend::Simd &&
+            gameConfig.bounceDuration > 0.0F) {
+            findCircleContacts(circles, candidatePairs, contacts, NarrowphaseBackend::Simd);
+            for (const auto& contact : contacts) {
+                resolveContact(view, contact);
+            }
+            return;
+        }
+
+        for (const auto& [a, b] : candidatePairs) {
+            resolvePair(view, bodies[a], bodies[b]);
+        }
+    }
+
+    void resolveBruteForceCollisions() const {
+        // Check all entity pairs for collisions
+        for (const auto view = registry.view<Position, CollisionState, Renderable, Velocity>();
+             const auto entityA : view) {
+            for (const auto entityB : view) {
+                if (entityA == entityB) { continue; }
+                resolvePair(view, entityA, entityB);
+            }
+        }
+    }
+
+    template <typename View>
+    void resolvePair(const View& view, const entt::entity entityA, const entt::entity entityB) const {
+        auto& stateA = view.template get<CollisionState>(entityA);
+        auto& stateB = view.template get<CollisionState>(entityB);
+
+        // Don't process collision if either object is already in collision cooldown
+        if ((stateA.isInCollision && stateA.bounceTimer > 0.0f) ||
+            (stateB.isInCollision && stateB.bounceTimer > 0.0f)) {
+            return;
+        }
+
+        auto& positionA = view.template get<Position>(entityA);
+        auto& positionB = view.template get<Position>(entityB);
+
+        const auto& renderableA = view.template get<Renderable>(entityA);
+        const auto& renderableB = view.template get<Renderable>(entityB);
+
+        if (auto [collision, collisionData] = checkCollision(positionA.position, positionB.position, renderableA, renderableB);
+            collision) {
+
+            // Separate overlapping objects
+            separateObjects(positionA, positionB, collisionData, renderableA, renderableB);
+
+            // Apply realistic collision response
+            applyPhysicsCollision(view.template get<Velocity>(entityA), view.template get<Velocity>(entityB),
+                                  collisionData, stateA, stateB);
+        }
+    }
+
+    template <typename View>
+    void resolveContact(const View& view, const CircleContact& contact) const {
+        const auto entityA = bodies[contact.a];
+        const auto entityB = bodies[contact.b];
+
+        auto& stateA = view.template get<CollisionState>(entityA);
+        auto& stateB = view.template get<CollisionState>(entityB);
+        if ((stateA.isInCollision && stateA.bounceTimer > 0.0f) ||
+            (stateB.isInCollision && stateB.bounceTimer > 0.0f)) {
+            return;
+        }
+
+        const auto& renderableA = view.template get<Renderable>(entityA);
+        const auto& renderableB = view.template get<Renderable>(entityB);
+        auto& positionB = view.template get<Position>(entityB);
+
+        const CollisionData data{
+            .normal = contact.normal,
+            .penetration = contact.penetration,
+            .contactPoint = Vector2Add(positionB.position, Vector2Scale(contact.normal, renderableB.radius))};
+
+        separateObjects(view.template get<Position>(entityA), positionB, data, renderableA, renderableB);
+        applyPhysicsCollision(view.template get<Velocity>(entityA), view.template get<Velocity>(entityB),
+                              data, stateA, stateB);
+    }
+
     std::tuple<bool, CollisionData> checkCollision(const Vector2& posA, const Vector2& posB,
                                                    const Renderable& renderableA, const Renderable& renderableB) const {
         Vector2 delta = {posA.x - posB.x, posA.y - posB.y};
@@ -125,17 +219,21 @@ private:
     }
 
     void updateCollisionStates(const float deltaTime) const {
-        for (const auto view = registry.view<CollisionState>(); const auto& entity : view) {
-            if (auto& [isInCollision, bounceTimer, bounceVelocity] =
-                    registry.get<CollisionState>(entity);
-                bounceTimer > 0) {
-                bounceTimer -= deltaTime;
-                if (bounceTimer <= 0) {
-                    isInCollision = false;
-                    bounceVelocity = {.x=0.0F, .y=0.0F};
-                }
-            }
-        }
+        // Timers are independent per entity, so large counts are swept in parallel chunks
+        const auto view = registry.view<CollisionState>();
+        parallelForEach(pool, view, static_cast<std::size_t>(gameConfig.parallelEntityThreshold),
+                        static_cast<std::size_t>(gameConfig.parallelGrainSize),
+                        [&](const entt::entity entity) {
+                            if (auto& [isInCollision, bounceTimer, bounceVelocity] =
+                                    view.get<CollisionState>(entity);
+                                bounceTimer > 0) {
+                                bounceTimer -= deltaTime;
+                                if (bounceTimer <= 0) {
+                                    isInCollision = false;
+                                    bounceVelocity = {.x=0.0F, .y=0.0F};
+                                }
+                            }
+                        });
     }
 };
 
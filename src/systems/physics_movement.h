@@ -1,15 +1,24 @@
 #ifndef DIDDLEDOODLEDUEL_PHYSICS_MOVEMENT_H
 #define DIDDLEDOODLEDUEL_PHYSICS_MOVEMENT_H
 #include "components/collision_state.h"
-
+#include "components/input_action.h"
+#include "components/position.h"
+#include "components/velocity.h"
+#include "core/parallel_for.h"
+#include "core/thread_pool.h"
+#include "core/type_list.h"
 #include "game_config.h"
 #include <algorithm>
 #include <cmath>
 #include <entt/entity/registry.hpp>
 
 struct PhysicsMovementSystem {
-    explicit PhysicsMovementSystem(entt::registry& registry, GameConfig& config)
-    : registry(registry), config(config)
+    using Reads = TypeList<InputAction, CollisionState>;
+    using Writes = TypeList<Position, Velocity>;
+
+    // Per-entity loops spread over pool once enough brushes exist; without one they stay inline
+    explicit PhysicsMovementSystem(entt::registry& registry, GameConfig& config, ThreadPool* pool = nullptr)
+    : registry(registry), config(config), pool(pool)
     {
     }
 
@@ -22,11 +31,18 @@ struct PhysicsMovementSystem {
 private:
     entt::registry& registry;
     const GameConfig& config;
+    ThreadPool* pool;
+
+    // Every loop below only touches the entity it is given, so chunks can run in any order
+    template <typename View, typename Func>
+    void forEachEntity(const View& view, const Func& func) const {
+        parallelForEach(pool, view, static_cast<std::size_t>(config.parallelEntityThreshold),
+                        static_cast<std::size_t>(config.parallelGrainSize), func);
+    }
 
     void handleInput(const float deltaTime) const {
-        for (const auto view = registry.view<Velocity, InputAction>();
-            const auto entity : view) {
-            
+        const auto view = registry.view<Velocity, InputAction>();
+        forEachEntity(view, [&](const entt::entity entity) {
             const auto& [rotateLeft, rotateRight] = view.get<InputAction>(entity);
             auto& velocity = view.get<Velocity>(entity);
 
@@ -42,46 +58,48 @@ private:
             const float thrustAngle = velocity.rotation * DEG2RAD;
             velocity.velocity.x = cosf(thrustAngle) * config.brushMovementSpeed;
             velocity.velocity.y = sinf(thrustAngle) * config.brushMovementSpeed;
-        }
+        });
     }
 
-    void integratePhysics(const float deltaTime) {
-        for (const auto view = registry.view<Position, Velocity>();
-            const auto entity : view) {
-            
+    void integratePhysics(const float deltaTime) const {
+        const auto view = registry.view<Position, Velocity>();
+        const auto collisionStates = registry.view<const CollisionState>();
+        forEachEntity(view, [&](const entt::entity entity) {
             auto& position = view.get<Position>(entity);
             auto& velocity = view.get<Velocity>(entity);
 
             // Check collision state - during collision, apply strong bounce forces
-            const CollisionState* col = registry.try_get<CollisionState>(entity);
-            if (col && col->isInCollision && col->bounceTimer > 0.0f) {
-                // Override normal movement with bounce velocity for more impact
-                position.position.x += col->bounceVelocity.x * deltaTime;
-                position.position.y += col->bounceVelocity.y * deltaTime;
-            } else {
-                // Normal movement - continuous forward motion
-                position.position.x += velocity.velocity.x * deltaTime;
-                position.position.y += velocity.velocity.y * deltaTime;
+            if (collisionStates.contains(entity)) {
+                if (const auto& col = collisionStates.get<const CollisionState>(entity);
+                    col.isInCollision && col.bounceTimer > 0.0f) {
+                    // Override normal movement with bounce velocity for more impact
+                    position.position.x += col.bounceVelocity.x * deltaTime;
+                    position.position.y += col.bounceVelocity.y * deltaTime;
+                    return;
+                }
             }
-        }
+
+            // Normal movement - continuous forward motion
+            position.position.x += velocity.velocity.x * deltaTime;
+            position.position.y += velocity.velocity.y * deltaTime;
+        });
     }
 
-    void constrainToBounds() {
-        for (const auto view = registry.view<Position, Velocity>();
-            const auto entity : view) {
-            
+    void constrainToBounds() const {
+        const auto view = registry.view<Position, Velocity>();
+        forEachEntity(view, [&](const entt::entity entity) {
             auto& position = view.get<Position>(entity);
 
             const float margin = config.brushSize;
             const float minX = margin;
-            const float maxX = 1280.0f - margin;  // Screen width bounds
+            const float maxX = std::max(minX, config.arenaWidth - margin);
             const float minY = margin;
-            const float maxY = 720.0f - margin;   // Screen height bounds
+            const float maxY = std::max(minY, config.arenaHeight - margin);
 
-            // Clamp to screen bounds (no bouncing, just constraint)
+            // Clamp to arena bounds (no bouncing, just constraint)
             position.position.x = std::clamp(position.position.x, minX, maxX);
             position.position.y = std::clamp(position.position.y, minY, maxY);
-        }
+        });
     }
 };
 
@@ -0,0 +1,107 @@
+#ifndef DIDDLEDOODLEDUEL_SCRIPTED_INPUT_H
+#define DIDDLEDOODLEDUEL_SCRIPTED_INPUT_H
+#include "components/input_action.h"
+#include "core/type_list.h"
+#include <algorithm>
+#include <cstdint>
+#include <entt/entity/registry.hpp>
+#include <istream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// One input change: from `tick` on, `player` holds the given buttons
+struct ScriptedInput {
+    std::uint32_t tick;
+    std::uint32_t player;
+    InputAction action;
+};
+
+// Drives InputAction without a keyboard. Follows a script when one is loaded, otherwise every
+// player holds a random turn for a random number of ticks. Random input is fully determined by
+// the seed, so runs are repeatable.
+struct ScriptedInputSystem {
+    using Reads = TypeList<>;
+    using Writes = TypeList<InputAction>;
+
+    explicit ScriptedInputSystem(entt::registry& registry, const std::uint32_t seed)
+        : registry(registry), random(seed) {
+    }
+
+    // Script lines are "<tick> <player> <L|R|LR|->"; blank lines and lines starting with #
+    // are skipped. Returns false on the first malformed line.
+    bool loadScript(std::istream& input) {
+        script.clear();
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+
+            std::istringstream fields(line);
+            ScriptedInput entry{};
+            std::string buttons;
+            if (!(fields >> entry.tick >> entry.player >> buttons)) {
+                return false;
+            }
+            if (buttons != "-" && buttons.find_first_not_of("LR") != std::string::npos) {
+                return false;
+            }
+            entry.action = InputAction{.rotateLeft = buttons.find('L') != std::string::npos,
+                                       .rotateRight = buttons.find('R') != std::string::npos};
+            script.push_back(entry);
+        }
+
+        std::ranges::stable_sort(script, {}, &ScriptedInput::tick);
+        nextEntry = 0;
+        return true;
+    }
+
+    [[nodiscard]] bool hasScript() const { return !script.empty(); }
+
+    // Script player numbers index into players
+    void update(const std::uint32_t tick, const std::span<const entt::entity> players) {
+        if (hasScript()) {
+            applyScript(tick, players);
+        } else {
+            applyRandom(players);
+        }
+    }
+
+private:
+    entt::registry& registry;
+    std::mt19937 random;
+    std::vector<ScriptedInput> script;
+    std::size_t nextEntry {0};
+    std::vector<std::uint32_t> ticksUntilChange;
+
+    void applyScript(const std::uint32_t tick, const std::span<const entt::entity> players) {
+        for (; nextEntry < script.size() && script[nextEntry].tick <= tick; ++nextEntry) {
+            if (const auto& [entryTick, player, action] = script[nextEntry]; player < players.size()) {
+                registry.get<InputAction>(players[player]) = action;
+            }
+        }
+    }
+
+    void applyRandom(const std::span<const entt::entity> players) {
+        ticksUntilChange.resize(players.size(), 0);
+        std::uniform_int_distribution<std::uint32_t> holdTicks(10, 90);
+        std::uniform_int_distribution<int> turn(0, 2);
+
+        for (std::size_t player = 0; player < players.size(); ++player) {
+            if (ticksUntilChange[player] > 0) {
+                --ticksUntilChange[player];
+                continue;
+            }
+
+            const int direction = turn(random);
+            registry.get<InputAction>(players[player]) =
+                InputAction{.rotateLeft = direction == 1, .rotateRight = direction == 2};
+            ticksUntilChange[player] = holdTicks(random);
+        }
+    }
+};
+
+#endif // DIDDLEDOODLEDUEL_SCRIPTED_INPUT_H
@@ -1,17 +1,27 @@
 #ifndef DIDDLEDOODLEDUEL_SYSTEM_ACTIVATION_H
 #define DIDDLEDOODLEDUEL_SYSTEM_ACTIVATION_H
 #include <entt/entity/registry.hpp>
-#include <string>
 #include "core/scene_state.h"
+#include "core/system_registry.h"
 
 struct SystemsActivationSystem {
     static void processActivations(entt::registry& registry) {
         registry.ctx().get<SceneState>().updateActiveSystems();
     }
 
-    static bool shouldSystemRun(const entt::registry& registry, const std::string& systemName) {
-        const auto& state = registry.ctx().get<SceneState>();
-        return state.activeSystems.contains(systemName);
+    [[nodiscard]] static SystemMask activeSystems(const entt::registry& registry) {
+        return registry.ctx().get<SceneState>().activeSystems;
+    }
+
+    // Fetch the mask once with activeSystems() and test each system against it
+    template <typename System>
+    [[nodiscard]] static constexpr bool isActive(const SystemMask active) {
+        return (active & systemBit<System>) != 0;
+    }
+
+    template <typename System>
+    [[nodiscard]] static bool shouldSystemRun(const entt::registry& registry) {
+        return isActive<System>(activeSystems(registry));
     }
 };
 
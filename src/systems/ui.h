@@ -1,12 +1,18 @@
 #ifndef DIDDLEDOODLEDUEL_UI_H
 #define DIDDLEDOODLEDUEL_UI_H
+#include "rendering/irenderer.h"
+#include <raylib.h>
+#include <string>
 
 struct UISystem {
     explicit UISystem(engine::IDrawHandler& drawHandler) : drawHandler(drawHandler) {
     }
 
-    void render(const std::string& title) {
-        DrawFPS(20, 100);
+    // fps is passed in rather than read from raylib, so this runs without a window
+    void render(const std::string& title, const int fps) {
+        // Same text and colours as raylib's DrawFPS, but through the draw handler
+        const Color fpsColor = fps < 15 ? RED : (fps < 30 ? ORANGE : LIME);
+        drawHandler.drawText(TextFormat("%2i FPS", fps), Vector2 {20.0F, 100.0F}, 20, fpsColor);
         drawHandler.drawText(title, Vector2 {20.0F, 20.0F }, 24, BLACK);
         drawHandler.drawText("Use A or D to update the rotation", Vector2 { 20.0F , 50.0F}, 18, BLACK);
     }
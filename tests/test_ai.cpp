@@ -0,0 +1,69 @@
+#include "canvas/ownership_grid.h"
+#include "core/player_factory.h"
+#include "headless/headless_runner.h"
+#include "rendering/null_renderer.h"
+#include "systems/ai_steering.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+PlayerSpawn spawnAt(const Vector2 position, const std::uint8_t paletteIndex) {
+    return PlayerSpawn{.startPosition = position,
+                       .initialRotation = 0.0F,
+                       .rotateLeftKey = KEY_NULL,
+                       .rotateRightKey = KEY_NULL,
+                       .brushColor = RED,
+                       .paletteIndex = paletteIndex};
+}
+
+} // namespace
+
+TEST_CASE("Bots turn back from walls, away from brushes and towards unpainted cells", "[ai]") {
+    entt::registry registry;
+    GameConfig config = GameConfig::localMatch();
+    auto& grid = registry.ctx().emplace<CanvasOwnershipGrid>(1280.0F, 720.0F, 4.0F);
+
+    // Ahead is our own paint, ahead-right an opponent's, ahead-left is still unpainted
+    const auto painter = PlayerFactory::createBot(registry, config, spawnAt({640, 360}, 1), 1);
+    grid.rasterizeCircle({740, 360}, 60.0F, 1);
+    grid.rasterizeCircle({717, 424}, 15.0F, 2);
+
+    const auto nearWall = PlayerFactory::createBot(registry, config, spawnAt({1200, 300}, 2), 2);
+
+    // A player just ahead and slightly to the right
+    const auto dodger = PlayerFactory::createBot(registry, config, spawnAt({300, 360}, 3), 3);
+    PlayerFactory::createPlayer(registry, config, spawnAt({340, 370}, 4));
+
+    AiSteeringSystem steering(registry, config);
+    steering.update();
+
+    REQUIRE(registry.get<InputAction>(painter).rotateLeft);
+    REQUIRE_FALSE(registry.get<InputAction>(painter).rotateRight);
+    REQUIRE(registry.get<InputAction>(nearWall).rotateRight);
+    REQUIRE(registry.get<InputAction>(dodger).rotateLeft);
+}
+
+TEST_CASE("Bot-filled headless matches are repeatable on any number of threads", "[ai]") {
+    const NullRenderer renderer {};
+    HeadlessOptions options;
+    options.ticks = 300;
+    options.players = 2;
+    options.bots = 600;
+    options.seed = 5;
+
+    HeadlessRunner sequential(renderer, options);
+    const auto sequentialReport = sequential.run();
+    options.workerThreads = 3;
+    HeadlessRunner parallel(renderer, options);
+    const auto parallelReport = parallel.run();
+
+    // Only the scripted players are reported
+    REQUIRE(sequentialReport.coverage.size() == 2);
+    const auto& sequentialGrid = sequential.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    const auto& parallelGrid = parallel.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    REQUIRE(std::ranges::equal(sequentialGrid.getCells(), parallelGrid.getCells()));
+
+    // With that many bots the arena is mostly painted
+    REQUIRE(sequentialGrid.coverage(CanvasOwnershipGrid::kUnpainted) < 0.2F);
+}
@@ -1,13 +1,15 @@
-#include "../src/components/movement_structs.h"
 #include "../src/diddle_doodle_duel.h"
+#include "components/position.h"
+#include "components/renderable.h"
+#include "components/velocity.h"
 #include "core/engine_core.h"
 #include "logging/logger.h"
-#include "rendering/renderer.h"
+#include "rendering/null_renderer.h"
+#include "rendering/recording_renderer.h"
 #include <catch2/catch_test_macros.hpp>
 #include <entt/entt.hpp>
 #include <iterator>
 
-struct Renderable;
 TEST_CASE("EngineCore initializes/shuts down", "[engine][core]") {
     auto& core = engine::EngineCore::getInstance();
     REQUIRE(core.initialize() == true);
@@ -53,7 +55,7 @@ TEST_CASE("ECS registry basic operations", "[ecs][entt]") {
         REQUIRE(registry.all_of<Position, Velocity>(entity));
         
         auto& [position] = registry.get<Position>(entity);
-        auto& [velocity, rotationSpeed] = registry.get<Velocity>(entity);
+        const auto& velocity = registry.get<Velocity>(entity).velocity;
         
         REQUIRE(position.x == 5.0F);
         REQUIRE(velocity.x == 1.0F);
@@ -90,9 +92,8 @@ TEST_CASE("ECS registry basic operations", "[ecs][entt]") {
 }
 
 TEST_CASE("DiddleDoodleDuel game initialization", "[game][ddd]") {
-    engine::Renderer renderer;
-    
-    // Initialize renderer for headless testing
+    // No window, so this runs without a display or a GPU
+    NullRenderer renderer;
     auto init = renderer.initialize(800, 600, "Test Window");
     REQUIRE(init.has_value());
     
@@ -128,21 +129,19 @@ TEST_CASE("Game component systems", "[game][ecs][components]") {
         registry.emplace<Position>(player, Vector2{400.0f, 300.0f});
         registry.emplace<Velocity>(player, Vector2{0.0f, 0.0f});
         registry.emplace<Renderable>(player, 20.0f, Color{0, 255, 255, 255}); // CYAN
-        registry.emplace<Player>(player, 200.0F);
 
-        REQUIRE(registry.all_of<Position, Velocity, Renderable, Player>(player));
+        REQUIRE(registry.all_of<Position, Velocity, Renderable>(player));
         
         auto& pos = registry.get<Position>(player);
         auto& vel = registry.get<Velocity>(player);
         auto& render = registry.get<Renderable>(player);
-        auto& playerComp = registry.get<Player>(player);
         
-        REQUIRE(pos.pos.x == 400.0f);
-        REQUIRE(pos.pos.y == 300.0f);
-        REQUIRE(vel.vel.x == 0.0f);
-        REQUIRE(vel.vel.y == 0.0f);
+        REQUIRE(pos.position.x == 400.0f);
+        REQUIRE(pos.position.y == 300.0f);
+        REQUIRE(vel.velocity.x == 0.0f);
+        REQUIRE(vel.velocity.y == 0.0f);
         REQUIRE(render.radius == 20.0f);
-        REQUIRE(playerComp.speed == 30000.0f);
+        REQUIRE(vel.speed == 5000.0f);
     }
     
     SECTION("Movement system simulation") {
@@ -157,13 +156,13 @@ TEST_CASE("Game component systems", "[game][ecs][components]") {
             auto& pos = registry.get<Position>(ent);
             auto& vel = registry.get<Velocity>(ent);
             
-            pos.pos.x += vel.vel.x * deltaTime;
-            pos.pos.y += vel.vel.y * deltaTime;
+            pos.position.x += vel.velocity.x * deltaTime;
+            pos.position.y += vel.velocity.y * deltaTime;
         }
         
         auto& finalPos = registry.get<Position>(entity);
-        REQUIRE(finalPos.pos.x == 105.0f); // 100 + 50*0.1
-        REQUIRE(finalPos.pos.y == 97.5f);  // 100 + (-25)*0.1
+        REQUIRE(finalPos.position.x == 105.0f); // 100 + 50*0.1
+        REQUIRE(finalPos.position.y == 97.5f);  // 100 + (-25)*0.1
     }
     
     SECTION("Boundary checking") {
@@ -177,18 +176,18 @@ TEST_CASE("Game component systems", "[game][ecs][components]") {
         auto& vel = registry.get<Velocity>(entity);
         
         // Simulate boundary check (left edge)
-        if (pos.pos.x - radius < 0) {
-            pos.pos.x = radius;
-            vel.vel.x = -vel.vel.x;
+        if (pos.position.x - radius < 0) {
+            pos.position.x = radius;
+            vel.velocity.x = -vel.velocity.x;
         }
         
-        REQUIRE(pos.pos.x == radius);
-        REQUIRE(vel.vel.x == 100.0f); // Velocity should be reversed
+        REQUIRE(pos.position.x == radius);
+        REQUIRE(vel.velocity.x == 100.0f); // Velocity should be reversed
     }
 }
 
 TEST_CASE("Renderer integration", "[renderer][integration]") {
-    engine::Renderer renderer;
+    RecordingRenderer renderer;
     
     auto init = renderer.initialize(640, 480, "Test Renderer");
     REQUIRE(init.has_value());
@@ -198,6 +197,10 @@ TEST_CASE("Renderer integration", "[renderer][integration]") {
         REQUIRE_NOTHROW(renderer.drawCircle(Vector2{100, 100}, 25.0f, Color{255, 0, 0, 255})); // RED
         REQUIRE_NOTHROW(renderer.drawText("Test", Vector2{10, 10}, 20, Color{255, 255, 255, 255})); // WHITE
         REQUIRE_NOTHROW(renderer.endFrame());
+
+        REQUIRE(renderer.count(DrawCommand::Kind::Circle) == 1);
+        REQUIRE(renderer.getCommands()[0].radius == 25.0f);
+        REQUIRE(renderer.textOf(renderer.getCommands()[1]) == "Test");
     }
     
     SECTION("Renderer properties") {
@@ -0,0 +1,296 @@
+#include "canvas/byte_runs.h"
+#include "canvas/dirty_tiles.h"
+#include "canvas/ownership_grid.h"
+#include "canvas/packed_canvas.h"
+#include "canvas/unpainted_flow_field.h"
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+float distanceToSegment(const Vector2 point, const Vector2 from, const Vector2 to) {
+    const float segmentX = to.x - from.x;
+    const float segmentY = to.y - from.y;
+    const float lengthSquared = (segmentX * segmentX) + (segmentY * segmentY);
+    float t = 0.0F;
+    if (lengthSquared > 0.0F) {
+        t = std::clamp(((point.x - from.x) * segmentX + (point.y - from.y) * segmentY) / lengthSquared,
+                       0.0F, 1.0F);
+    }
+    const float dx = point.x - (from.x + segmentX * t);
+    const float dy = point.y - (from.y + segmentY * t);
+    return std::sqrt((dx * dx) + (dy * dy));
+}
+
+// Cells whose centre is strictly inside, and those sitting on the boundary where rounding may
+// go either way
+struct CellBounds {
+    std::uint32_t inside {0};
+    std::uint32_t boundary {0};
+
+    [[nodiscard]] bool admits(const std::uint32_t count) const {
+        return count >= inside && count <= inside + boundary;
+    }
+};
+
+CellBounds countCellsWithin(const CanvasOwnershipGrid& grid, const Vector2 from, const Vector2 to,
+                            const float radius) {
+    CellBounds bounds;
+    for (int row = 0; row < grid.getHeight(); ++row) {
+        for (int column = 0; column < grid.getWidth(); ++column) {
+            const Vector2 center = {(static_cast<float>(column) + 0.5F) * grid.getCellSize(),
+                                    (static_cast<float>(row) + 0.5F) * grid.getCellSize()};
+            const float distance = distanceToSegment(center, from, to);
+            if (std::abs(distance - radius) < 1.0e-3F) {
+                ++bounds.boundary;
+            } else if (distance < radius) {
+                ++bounds.inside;
+            }
+        }
+    }
+    return bounds;
+}
+} // namespace
+
+TEST_CASE("Ownership grid rasterizes circles and capsules by cell centre", "[canvas][ownership]") {
+    CanvasOwnershipGrid grid(320.0F, 180.0F, 4.0F);
+    REQUIRE(grid.cellCount(CanvasOwnershipGrid::kUnpainted) == 80 * 45);
+
+    SECTION("Circle") {
+        grid.rasterizeCircle({101.0F, 67.0F}, 25.0F, 1);
+        REQUIRE(countCellsWithin(grid, {101.0F, 67.0F}, {101.0F, 67.0F}, 25.0F).admits(grid.cellCount(1)));
+        REQUIRE(grid.ownerAt(101.0F, 67.0F) == 1);
+        REQUIRE(grid.ownerAt(10.0F, 10.0F) == CanvasOwnershipGrid::kUnpainted);
+    }
+
+    SECTION("Capsule") {
+        const Vector2 from = {40.0F, 30.0F};
+        const Vector2 to = {260.0F, 140.0F};
+        grid.rasterizeCapsule(from, to, 12.0F, 2);
+        REQUIRE(countCellsWithin(grid, from, to, 12.0F).admits(grid.cellCount(2)));
+        REQUIRE(grid.ownerAt(150.0F, 85.0F) == 2);
+    }
+
+    SECTION("Axis-aligned capsule") {
+        grid.rasterizeCapsule({20.0F, 90.0F}, {300.0F, 90.0F}, 10.0F, 3);
+        REQUIRE(countCellsWithin(grid, {20.0F, 90.0F}, {300.0F, 90.0F}, 10.0F).admits(grid.cellCount(3)));
+    }
+}
+
+TEST_CASE("Ownership grid counts stay consistent across overwrites", "[canvas][ownership]") {
+    CanvasOwnershipGrid grid(200.0F, 200.0F, 2.0F);
+    grid.rasterizeCircle({80.0F, 100.0F}, 40.0F, 1);
+    const std::uint32_t firstOnly = grid.cellCount(1);
+
+    grid.rasterizeCircle({120.0F, 100.0F}, 40.0F, 2);
+    REQUIRE(grid.cellCount(1) < firstOnly);
+    REQUIRE(grid.ownerAt(100.0F, 100.0F) == 2);
+    REQUIRE(grid.ownerAt(50.0F, 100.0F) == 1);
+
+    std::uint32_t total = 0;
+    for (std::uint8_t index = 0; index < CanvasOwnershipGrid::kMaxPaletteEntries; ++index) {
+        total += grid.cellCount(index);
+    }
+    REQUIRE(total == 100 * 100);
+
+    // Indices past the palette are dropped rather than counted out of bounds
+    grid.rasterizeCircle({100.0F, 100.0F}, 30.0F, CanvasOwnershipGrid::kMaxPaletteEntries);
+    grid.rasterizeCapsule({20.0F, 20.0F}, {180.0F, 20.0F}, 10.0F, 255);
+    REQUIRE(grid.ownerAt(100.0F, 100.0F) == 2);
+    REQUIRE(grid.ownerAt(100.0F, 20.0F) == CanvasOwnershipGrid::kUnpainted);
+
+    // Block counts follow the cells, including the partial blocks along the far edges
+    REQUIRE(grid.getBlockColumns() == 13);
+    for (int blockRow = 0; blockRow < grid.getBlockRows(); ++blockRow) {
+        for (int blockColumn = 0; blockColumn < grid.getBlockColumns(); ++blockColumn) {
+            int cells = 0;
+            int unpainted = 0;
+            for (int row = blockRow * 8; row < std::min(100, (blockRow + 1) * 8); ++row) {
+                for (int column = blockColumn * 8; column < std::min(100, (blockColumn + 1) * 8);
+                     ++column) {
+                    ++cells;
+                    unpainted += grid.ownerAt((static_cast<float>(column) * 2.0F) + 1.0F,
+                                              (static_cast<float>(row) * 2.0F) + 1.0F) ==
+                                 CanvasOwnershipGrid::kUnpainted;
+                }
+            }
+            REQUIRE(grid.unpaintedBlockFraction(blockColumn, blockRow) ==
+                    static_cast<float>(unpainted) / static_cast<float>(cells));
+        }
+    }
+
+    grid.clear();
+    REQUIRE(grid.cellCount(1) == 0);
+    REQUIRE(grid.cellCount(CanvasOwnershipGrid::kUnpainted) == 100 * 100);
+}
+
+TEST_CASE("Ownership grid lists the blocks whose unpainted count changed", "[canvas][ownership]") {
+    CanvasOwnershipGrid grid(200.0F, 200.0F, 2.0F);
+    using Blocks = std::vector<std::pair<int, int>>;
+    const auto takeChanged = [&grid] {
+        Blocks blocks;
+        grid.takeChangedBlocks(
+            [&blocks](const int column, const int row) { blocks.emplace_back(column, row); });
+        std::ranges::sort(blocks);
+        return blocks;
+    };
+
+    // A new grid has every block to report, once
+    REQUIRE(takeChanged().size() == 13 * 13);
+    REQUIRE(takeChanged().empty());
+
+    // Cells 0-7 of row 0 are block (0, 0), cells 8-9 block (1, 0)
+    grid.rasterizeCapsule({1.0F, 1.0F}, {19.0F, 1.0F}, 0.5F, 1);
+    const Blocks painted = {{0, 0}, {1, 0}};
+    REQUIRE(takeChanged() == painted);
+
+    // Painting over paint leaves the unpainted counts alone
+    grid.rasterizeCapsule({1.0F, 1.0F}, {19.0F, 1.0F}, 0.5F, 2);
+    REQUIRE(takeChanged().empty());
+
+    // Restoring an earlier grid reports the blocks it differs in, not the list it was saved with
+    const CanvasOwnershipGrid saved = grid;
+    grid.rasterizeCircle({150.0F, 150.0F}, 3.0F, 1);
+    takeChanged();
+    grid = saved;
+    const Blocks restored = {{9, 9}};
+    REQUIRE(takeChanged() == restored);
+}
+
+TEST_CASE("Flow field repairs match a full recompute as targets come and go", "[canvas][flow]") {
+    constexpr int kColumns = 40;
+    constexpr int kRows = 23;
+    UnpaintedFlowField field(kColumns, kRows, 32.0F);
+    std::uint32_t state = 7;
+    const auto nextRandom = [&state] {
+        state ^= state << 13U;
+        state ^= state >> 17U;
+        state ^= state << 5U;
+        return state;
+    };
+
+    for (int round = 0; round < 50; ++round) {
+        for (int change = 0; change < 12; ++change) {
+            field.setTarget(static_cast<int>(nextRandom() % kColumns),
+                            static_cast<int>(nextRandom() % kRows), nextRandom() % 3 != 0);
+        }
+        // A small budget leaves work queued across calls, like a busy tick would
+        while (!field.repair(64)) {
+        }
+
+        for (int row = 0; row < kRows; ++row) {
+            for (int column = 0; column < kColumns; ++column) {
+                std::int32_t expected = UnpaintedFlowField::kUnreachable;
+                for (int targetRow = 0; targetRow < kRows; ++targetRow) {
+                    for (int targetColumn = 0; targetColumn < kColumns; ++targetColumn) {
+                        if (field.isTarget(targetColumn, targetRow)) {
+                            const int dx = targetColumn - column;
+                            const int dy = targetRow - row;
+                            expected = std::min(expected, (dx * dx) + (dy * dy));
+                        }
+                    }
+                }
+                REQUIRE(field.distanceSquaredAt(column, row) == expected);
+            }
+        }
+    }
+
+    const auto offset = field.offsetToTarget(100.0F, 100.0F);
+    REQUIRE(offset.has_value());
+    REQUIRE(field.isTarget(static_cast<int>((100.0F + offset->x) / 32.0F),
+                           static_cast<int>((100.0F + offset->y) / 32.0F)));
+}
+
+TEST_CASE("Dirty tiles cover every stamp and clear back to nothing", "[canvas][dirty]") {
+    // 4 x 3 tiles, the last column and row partial
+    CanvasDirtyTiles tiles(200, 150);
+    REQUIRE(tiles.getTileCount() == 12);
+    REQUIRE_FALSE(tiles.any());
+
+    // A stroke along the top row, crossing from the first tile into the second
+    tiles.markStamp(PaintStamp{{20, 20}, {90, 30}, 10.0F, {230, 41, 55, 255}, 1});
+    REQUIRE(tiles.getDirtyTiles().size() == 2);
+    REQUIRE((tiles.isDirty(0, 0) && tiles.isDirty(1, 0)));
+
+    // Marking again lists nothing twice; off-canvas parts are dropped
+    tiles.markStamp(PaintStamp{{60, 20}, {60, 20}, 2.0F, {0, 121, 241, 255}, 2});
+    tiles.markStamp(PaintStamp{{198, 140}, {400, 400}, 5.0F, {0, 121, 241, 255}, 2});
+    tiles.markRect(-50.0F, -50.0F, -1.0F, -1.0F);
+    REQUIRE(tiles.getDirtyTiles().size() == 3);
+    REQUIRE(tiles.isDirty(3, 2));
+    const Rectangle corner = tiles.getTileBounds(tiles.getDirtyTiles().back());
+    REQUIRE((corner.x == 192.0F && corner.y == 128.0F));
+    REQUIRE((corner.width == 8.0F && corner.height == 22.0F));
+
+    CanvasDirtyTiles merged(200, 150);
+    merged.markRect(0.0F, 64.0F, 10.0F, 70.0F);
+    merged.merge(tiles);
+    REQUIRE(merged.getDirtyTiles().size() == 4);
+
+    tiles.clear();
+    REQUIRE_FALSE(tiles.any());
+    for (int row = 0; row < tiles.getRows(); ++row) {
+        for (int column = 0; column < tiles.getColumns(); ++column) {
+            REQUIRE_FALSE(tiles.isDirty(column, row));
+        }
+    }
+    tiles.markAll();
+    REQUIRE(tiles.getDirtyTiles().size() == tiles.getTileCount());
+}
+
+TEST_CASE("Packed canvas stores palette indices in 2 or 4 bits and packs flat rows to runs",
+          "[canvas][packed]") {
+    REQUIRE(PackedCanvas::bitsFor(4) == 2);
+    REQUIRE(PackedCanvas::bitsFor(5) == 4);
+    REQUIRE(PackedCanvas::bitsFor(CanvasOwnershipGrid::kMaxPaletteEntries) == 4);
+
+    // A 4K canvas of five entries in 4 MB, an eighth of its RGBA size
+    const PackedCanvas uhd(3840, 2160, PackedCanvas::bitsFor(5));
+    REQUIRE(uhd.getBytes().size() == std::size_t {3840} * 2160 / 2);
+
+    CanvasOwnershipGrid grid(103.0F, 20.0F, 1.0F);
+    grid.rasterizeCapsule({10.0F, 10.0F}, {90.0F, 12.0F}, 6.0F, 3);
+    grid.rasterizeCircle({50.0F, 8.0F}, 5.0F, 1);
+    for (const int bits : {2, 4}) {
+        PackedCanvas packed(grid.getWidth(), grid.getHeight(), bits);
+        REQUIRE(packed.getRowBytes() == (103 * static_cast<std::size_t>(bits) + 7) / 8);
+        packed.assign(grid.getCells());
+
+        std::vector<std::uint8_t> row(static_cast<std::size_t>(grid.getWidth()));
+        for (int y = 0; y < grid.getHeight(); ++y) {
+            packed.unpackRow(packed.getRow(y), row);
+            for (int x = 0; x < grid.getWidth(); ++x) {
+                const auto cell = grid.ownerAt(static_cast<float>(x) + 0.5F,
+                                               static_cast<float>(y) + 0.5F);
+                REQUIRE(row[static_cast<std::size_t>(x)] == cell);
+                REQUIRE(packed.at(x, y) == cell);
+            }
+
+            // Runs restore the row exactly, and an unpainted row packs to a couple of runs
+            std::vector<std::uint8_t> runs;
+            byte_runs::pack(packed.getRow(y), runs);
+            std::vector<std::uint8_t> restored(packed.getRowBytes());
+            REQUIRE(byte_runs::unpack(runs, restored));
+            REQUIRE(std::ranges::equal(restored, packed.getRow(y)));
+            if (y == 0) {
+                REQUIRE(runs.size() <= 4);
+            }
+        }
+    }
+
+    // Literals, repeats longer than one run, and a truncated input
+    std::vector<std::uint8_t> bytes = {1, 2, 3, 3, 4, 4, 4, 4};
+    bytes.insert(bytes.end(), 300, 9);
+    bytes.push_back(5);
+    std::vector<std::uint8_t> runs;
+    byte_runs::pack(bytes, runs);
+    REQUIRE(runs.size() < 20);
+    std::vector<std::uint8_t> restored(bytes.size());
+    REQUIRE(byte_runs::unpack(runs, restored));
+    REQUIRE(restored == bytes);
+    runs.pop_back();
+    REQUIRE_FALSE(byte_runs::unpack(runs, restored));
+}
@@ -0,0 +1,245 @@
+#include "components/collision_state.h"
+#include "components/input_action.h"
+#include "components/position.h"
+#include "components/renderable.h"
+#include "components/velocity.h"
+#include "core/fixed_timestep.h"
+#include "core/thread_pool.h"
+#include "game_config.h"
+#include "physics/circle_narrowphase.h"
+#include "physics/spatial_hash.h"
+#include "systems/physics_collision.h"
+#include "systems/physics_movement.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <entt/entity/registry.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<Vector2> randomPositions(const std::size_t count, const float extent,
+                                     const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coordinate(-extent, extent);
+    std::vector<Vector2> positions(count);
+    for (auto& position : positions) {
+        position = Vector2{coordinate(rng), coordinate(rng)};
+    }
+    return positions;
+}
+
+void spawnBrushes(entt::registry& registry, const std::vector<Vector2>& positions,
+                  const float radius) {
+    for (const auto& position : positions) {
+        const auto entity = registry.create();
+        registry.emplace<Position>(entity, Position{.position = position});
+        registry.emplace<Velocity>(entity, Velocity{});
+        registry.emplace<Renderable>(entity, Renderable{.radius = radius, .color = WHITE});
+        registry.emplace<CollisionState>(entity, CollisionState{});
+    }
+}
+} // namespace
+
+TEST_CASE("Spatial hash emits every overlapping pair exactly once", "[physics][broadphase]") {
+    constexpr float radius = 25.0F;
+    const auto positions = randomPositions(600, 800.0F, 7);
+
+    CircleBodies bodies;
+    for (const auto& position : positions) {
+        bodies.push(position, radius);
+    }
+
+    SpatialHashGrid grid;
+    grid.build(bodies.x, bodies.y, radius * 2.0F);
+    std::vector<CandidatePair> pairs;
+    grid.collectPairs(pairs);
+
+    for (std::size_t i = 1; i < pairs.size(); ++i) {
+        const bool ordered = pairs[i - 1].a < pairs[i].a ||
+                             (pairs[i - 1].a == pairs[i].a && pairs[i - 1].b < pairs[i].b);
+        REQUIRE(ordered);
+    }
+
+    std::size_t overlapping = 0;
+    for (std::uint32_t a = 0; a < positions.size(); ++a) {
+        for (std::uint32_t b = a + 1; b < positions.size(); ++b) {
+            const float dx = positions[a].x - positions[b].x;
+            const float dy = positions[a].y - positions[b].y;
+            if (dx * dx + dy * dy >= (radius * 2.0F) * (radius * 2.0F)) {
+                continue;
+            }
+            ++overlapping;
+            const bool found = std::ranges::any_of(
+                pairs, [&](const CandidatePair& pair) { return pair.a == a && pair.b == b; });
+            REQUIRE(found);
+        }
+    }
+    REQUIRE(overlapping > 0);
+}
+
+TEST_CASE("SIMD narrowphase finds the same contacts as the scalar kernel", "[physics][narrowphase]") {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> radius(5.0F, 40.0F);
+
+    CircleBodies bodies;
+    for (const auto& position : randomPositions(512, 300.0F, 5)) {
+        bodies.push(position, radius(rng));
+    }
+    // Coincident circles are never reported as touching
+    bodies.push(Vector2{bodies.x[0], bodies.y[0]}, 10.0F);
+
+    std::vector<CandidatePair> pairs;
+    for (std::uint32_t a = 0; a < bodies.size(); ++a) {
+        for (std::uint32_t b = a + 1; b < bodies.size(); ++b) {
+            pairs.push_back(CandidatePair{.a = a, .b = b});
+        }
+    }
+
+    std::vector<CircleContact> scalarContacts;
+    std::vector<CircleContact> simdContacts;
+    findCircleContacts(bodies, pairs, scalarContacts, NarrowphaseBackend::Scalar);
+    findCircleContacts(bodies, pairs, simdContacts, NarrowphaseBackend::Simd);
+
+    REQUIRE(!scalarContacts.empty());
+    REQUIRE(scalarContacts.size() == simdContacts.size());
+    for (std::size_t i = 0; i < scalarContacts.size(); ++i) {
+        REQUIRE(scalarContacts[i].a == simdContacts[i].a);
+        REQUIRE(scalarContacts[i].b == simdContacts[i].b);
+        REQUIRE(scalarContacts[i].penetration == simdContacts[i].penetration);
+        REQUIRE(scalarContacts[i].normal.x == simdContacts[i].normal.x);
+        REQUIRE(scalarContacts[i].normal.y == simdContacts[i].normal.y);
+    }
+}
+
+TEST_CASE("Broadphase and brute-force collision paths agree", "[physics][broadphase]") {
+    const auto positions = randomPositions(300, 400.0F, 11);
+    const auto backend = GENERATE(NarrowphaseBackend::Scalar, NarrowphaseBackend::Simd);
+
+    GameConfig bruteForceConfig;
+    bruteForceConfig.useSpatialHash = false;
+    GameConfig broadphaseConfig;
+    broadphaseConfig.useSpatialHash = true;
+    broadphaseConfig.narrowphaseBackend = backend;
+
+    entt::registry bruteForceRegistry;
+    entt::registry broadphaseRegistry;
+    spawnBrushes(bruteForceRegistry, positions, 25.0F);
+    spawnBrushes(broadphaseRegistry, positions, 25.0F);
+
+    PhysicsCollisionSystem bruteForce(bruteForceRegistry, bruteForceConfig);
+    PhysicsCollisionSystem withBroadphase(broadphaseRegistry, broadphaseConfig);
+    bruteForce.update(0.016F);
+    withBroadphase.update(0.016F);
+
+    const auto expected = bruteForceRegistry.view<const Position, const CollisionState>();
+    for (const auto entity : expected) {
+        const auto& expectedPosition = expected.get<const Position>(entity);
+        const auto& actualPosition = broadphaseRegistry.get<Position>(entity);
+        REQUIRE(expectedPosition.position.x == actualPosition.position.x);
+        REQUIRE(expectedPosition.position.y == actualPosition.position.y);
+        REQUIRE(expected.get<const CollisionState>(entity).isInCollision ==
+                broadphaseRegistry.get<CollisionState>(entity).isInCollision);
+    }
+}
+
+TEST_CASE("Parallel per-entity loops match the sequential systems", "[physics][parallel]") {
+    const auto positions = randomPositions(5000, 600.0F, 23);
+    GameConfig config;
+    config.parallelEntityThreshold = 256;
+    config.parallelGrainSize = 64;
+    ThreadPool pool(4);
+
+    entt::registry sequentialRegistry;
+    entt::registry parallelRegistry;
+    for (auto* registry : {&sequentialRegistry, &parallelRegistry}) {
+        spawnBrushes(*registry, positions, 10.0F);
+        for (const auto entity : registry->view<Position>()) {
+            registry->emplace<InputAction>(
+                entity, InputAction{.rotateLeft = (static_cast<std::uint32_t>(entity) % 3) == 0,
+                                    .rotateRight = (static_cast<std::uint32_t>(entity) % 3) == 1});
+        }
+    }
+
+    PhysicsMovementSystem sequentialMovement(sequentialRegistry, config);
+    PhysicsCollisionSystem sequentialCollision(sequentialRegistry, config);
+    PhysicsMovementSystem parallelMovement(parallelRegistry, config, &pool);
+    PhysicsCollisionSystem parallelCollision(parallelRegistry, config, &pool);
+    for (int tick = 0; tick < 30; ++tick) {
+        sequentialMovement.update(1.0F / 60.0F);
+        sequentialCollision.update(1.0F / 60.0F);
+        parallelMovement.update(1.0F / 60.0F);
+        parallelCollision.update(1.0F / 60.0F);
+    }
+
+    const auto expected = sequentialRegistry.view<const Position, const CollisionState>();
+    for (const auto entity : expected) {
+        const auto& expectedPosition = expected.get<const Position>(entity);
+        const auto& actualPosition = parallelRegistry.get<Position>(entity);
+        REQUIRE(expectedPosition.position.x == actualPosition.position.x);
+        REQUIRE(expectedPosition.position.y == actualPosition.position.y);
+        REQUIRE(expected.get<const CollisionState>(entity).bounceTimer ==
+                parallelRegistry.get<CollisionState>(entity).bounceTimer);
+    }
+}
+
+TEST_CASE("Fixed timestep runs whole ticks and carries the remainder", "[physics][timestep]") {
+    FixedTimestep timestep(60.0F, 5);
+
+    SECTION("Frame time accumulates across frames") {
+        REQUIRE(timestep.advance(0.010F) == 0);
+        REQUIRE(timestep.advance(0.010F) == 1);
+        REQUIRE(timestep.getAlpha() > 0.0F);
+        REQUIRE(timestep.getAlpha() < 1.0F);
+    }
+
+    SECTION("The same total time gives the same tick count at any frame rate") {
+        FixedTimestep slowFrames(60.0F, 5);
+        int fastTicks = 0;
+        int slowTicks = 0;
+        for (int frame = 0; frame < 240; ++frame) {
+            fastTicks += timestep.advance(1.0F / 240.0F);
+        }
+        for (int frame = 0; frame < 30; ++frame) {
+            slowTicks += slowFrames.advance(1.0F / 30.0F);
+        }
+        REQUIRE(fastTicks >= 59);
+        REQUIRE(fastTicks <= 60);
+        REQUIRE(slowTicks >= 59);
+        REQUIRE(slowTicks <= 60);
+    }
+
+    SECTION("A long stall is capped and the backlog dropped") {
+        REQUIRE(timestep.advance(2.0F) == 5);
+        REQUIRE(timestep.advance(0.0F) <= 1);
+    }
+}
+
+TEST_CASE("Brushes are kept inside the configured arena", "[physics][arena]") {
+    GameConfig config;
+    config.arenaWidth = 3000.0F;
+    config.arenaHeight = 2000.0F;
+    entt::registry registry;
+    spawnBrushes(registry, randomPositions(200, 600.0F, 5), 10.0F);
+    for (const auto entity : registry.view<Position>()) {
+        registry.emplace<InputAction>(entity, InputAction{});
+        registry.get<Velocity>(entity).rotation = static_cast<float>(entity) * 37.0F;
+    }
+
+    PhysicsMovementSystem movement(registry, config);
+    for (int tick = 0; tick < 60; ++tick) {
+        movement.update(1.0F / 60.0F);
+    }
+
+    // Past where a window-sized arena would have stopped them, but no further than this one
+    float furthestX = 0.0F;
+    for (const auto entity : registry.view<Position>()) {
+        const Vector2 position = registry.get<Position>(entity).position;
+        REQUIRE(position.x >= config.brushSize);
+        REQUIRE(position.y >= config.brushSize);
+        REQUIRE(position.x <= config.arenaWidth - config.brushSize);
+        REQUIRE(position.y <= config.arenaHeight - config.brushSize);
+        furthestX = std::max(furthestX, position.x);
+    }
+    REQUIRE(furthestX > 1280.0F);
+}
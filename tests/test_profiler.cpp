@@ -0,0 +1,154 @@
+#include "performance/profiler.h"
+#include <array>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Scope ids are interned by name", "[profiler]") {
+    auto& profiler = ScopeProfiler::getInstance();
+    const ProfileScopeId first = profiler.intern("TestInterned");
+    REQUIRE(profiler.intern("TestInterned") == first);
+    REQUIRE(profiler.intern("TestInternedOther") != first);
+}
+
+TEST_CASE("Scopes record one sample per frame with nesting", "[profiler]") {
+    auto& profiler = ScopeProfiler::getInstance();
+    const ProfileScopeId outer = profiler.intern("TestOuter");
+    const ProfileScopeId inner = profiler.intern("TestInner");
+    const std::uint32_t thread = profiler.threadProfile().getThreadIndex();
+    profiler.endFrame();
+    profiler.reset();
+
+    constexpr int frames = 50;
+    for (int frame = 0; frame < frames; ++frame) {
+        {
+            const ProfileScope outerScope(outer);
+            for (int call = 0; call < 3; ++call) {
+                const ProfileScope innerScope(inner);
+            }
+        }
+        profiler.endFrame();
+    }
+
+    const auto outerStats = profiler.getStats(outer, thread);
+    const auto innerStats = profiler.getStats(inner, thread);
+    REQUIRE(outerStats.frames == frames);
+    REQUIRE(innerStats.frames == frames);
+    REQUIRE(outerStats.callsPerFrame == 1.0);
+    REQUIRE(innerStats.callsPerFrame == 3.0);
+    REQUIRE(outerStats.minMicros <= outerStats.p50Micros);
+    REQUIRE(outerStats.p50Micros <= outerStats.p95Micros);
+    REQUIRE(outerStats.p95Micros <= outerStats.p99Micros);
+    REQUIRE(outerStats.p99Micros <= outerStats.maxMicros);
+    REQUIRE(profiler.threadProfile().getParent(inner) == outer);
+
+    std::ostringstream report;
+    profiler.printResults(report);
+    const std::string text = report.str();
+    REQUIRE(text.find("TestOuter") < text.find("TestInner"));
+}
+
+TEST_CASE("Reports can be printed while other threads are profiling", "[profiler]") {
+    auto& profiler = ScopeProfiler::getInstance();
+    const ProfileScopeId outer = profiler.intern("TestWorkerOuter");
+    const ProfileScopeId inner = profiler.intern("TestWorkerInner");
+
+    std::atomic<bool> stop {false};
+    std::atomic<bool> nest {false};
+    std::array<std::atomic<std::uint64_t>, 2> iterations {};
+    std::array<std::atomic<std::uint64_t>, 2> nestedIterations {};
+    std::vector<std::thread> workers;
+    for (std::size_t worker = 0; worker < iterations.size(); ++worker) {
+        workers.emplace_back([&, worker] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                {
+                    const ProfileScope outerScope(outer);
+                    if (nest.load(std::memory_order_relaxed)) {
+                        const ProfileScope innerScope(inner);
+                        nestedIterations[worker].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                iterations[worker].fetch_add(1, std::memory_order_release);
+            }
+        });
+    }
+    // Workers commit a frame the first time they profile in the next one
+    const auto waitForWorkers = [&] {
+        for (const auto& count : iterations) {
+            const std::uint64_t seen = count.load(std::memory_order_acquire);
+            while (count.load(std::memory_order_acquire) < seen + 2) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    waitForWorkers();
+    profiler.endFrame();
+    waitForWorkers();
+
+    // The workers now link the inner scope's parent mid-frame, with nothing ordering that
+    // against the report reading it
+    nest.store(true, std::memory_order_relaxed);
+    for (const auto& count : nestedIterations) {
+        while (count.load(std::memory_order_relaxed) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    std::ostringstream midFrame;
+    profiler.printResults(midFrame);
+
+    profiler.endFrame();
+    waitForWorkers();
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::ostringstream report;
+    profiler.printResults(report);
+    const std::string text = report.str();
+    REQUIRE(text.find("TestWorkerOuter") < text.find("TestWorkerInner"));
+}
+
+TEST_CASE("Trace capture records scopes for the requested frames only", "[profiler][trace]") {
+    auto& profiler = ScopeProfiler::getInstance();
+    const ProfileScopeId traced = profiler.intern("TestTraced");
+    const auto runFrame = [&] {
+        { const ProfileScope scope(traced); }
+        profiler.endFrame();
+    };
+
+    const auto tracePath = std::filesystem::temp_directory_path() / "ddd_test_trace.json";
+    std::filesystem::remove(tracePath);
+    profiler.requestCapture(2, tracePath.string());
+    const std::uint32_t generation = profiler.getCaptureGeneration();
+    runFrame(); // Capture starts at the next frame boundary
+    runFrame();
+    runFrame();
+    runFrame();
+
+    const auto events = profiler.threadProfile().getTraceEvents(generation);
+    std::size_t tracedCount = 0;
+    for (const auto& event : events) {
+        tracedCount += event.id == traced ? 1 : 0;
+    }
+    REQUIRE(tracedCount == 2);
+
+    std::ostringstream trace;
+    profiler.writeChromeTrace(trace);
+    REQUIRE(trace.str().find(R"("name":"TestTraced","cat":"scope","ph":"X")") != std::string::npos);
+    REQUIRE(trace.str().find(R"("name":"FullFrame")") != std::string::npos);
+
+    // The file is written off the frame thread once the capture ends
+    profiler.waitForCapture();
+    std::ifstream file(tracePath);
+    const std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    REQUIRE(written == trace.str());
+}
@@ -0,0 +1,101 @@
+#include "core/player_factory.h"
+#include "rendering/recording_renderer.h"
+#include "systems/arrow_render.h"
+#include "systems/brush_render.h"
+#include "systems/ui.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+// Stand-ins for loaded textures; the recording renderer only looks at their ids
+constexpr Texture2D kBrushBase {.id = 1, .width = 64, .height = 64, .mipmaps = 1, .format = 7};
+constexpr Texture2D kBrushMask {.id = 2, .width = 64, .height = 64, .mipmaps = 1, .format = 7};
+constexpr Texture2D kArrow {.id = 3, .width = 32, .height = 32, .mipmaps = 1, .format = 7};
+
+} // namespace
+
+TEST_CASE("Render systems submit a known number of draws per brush", "[rendering]") {
+    entt::registry registry;
+    const GameConfig config = GameConfig::localMatch();
+    RecordingRenderer renderer;
+
+    const auto spawns = PlayerFactory::localGameSpawns();
+    std::vector<entt::entity> players;
+    for (const auto& spawn : spawns) {
+        players.push_back(PlayerFactory::createPlayer(registry, config, spawn));
+    }
+    // Only brushes moving fast enough get an arrow
+    registry.get<Velocity>(players[0]).velocity = {120.0F, 0.0F};
+    registry.get<Velocity>(players[2]).velocity = {0.0F, -80.0F};
+
+    const BrushRenderSystem brushes(registry, renderer, config, kBrushBase, kBrushMask);
+    const ArrowRenderSystem arrows(registry, renderer, kArrow);
+    UISystem ui(renderer);
+
+    renderer.beginFrame();
+    brushes.render();
+    REQUIRE(renderer.count(DrawCommand::Kind::Texture) == 2 * spawns.size());
+    REQUIRE(renderer.getCommands()[0].textureId == kBrushBase.id);
+    REQUIRE(renderer.getCommands()[1].textureId == kBrushMask.id);
+
+    renderer.beginFrame();
+    arrows.render();
+    REQUIRE(renderer.count(DrawCommand::Kind::Texture) == 2);
+
+    renderer.beginFrame();
+    ui.render("Title", 60);
+    REQUIRE(renderer.count(DrawCommand::Kind::Text) == 3);
+    REQUIRE(renderer.textOf(renderer.getCommands()[0]) == "60 FPS");
+    REQUIRE(renderer.textOf(renderer.getCommands()[1]) == "Title");
+    REQUIRE(renderer.getFrameCount() == 3);
+}
+
+TEST_CASE("Recording renderer reuses its buffers between frames", "[rendering]") {
+    RecordingRenderer renderer(1280, 720, 16, 64);
+    const auto recordFrame = [&renderer] {
+        renderer.beginFrame();
+        for (int index = 0; index < 15; ++index) {
+            renderer.drawCircle({static_cast<float>(index), 0.0F}, 4.0F, RED);
+        }
+        renderer.drawText("score", {0.0F, 0.0F}, 20, BLACK);
+        renderer.endFrame();
+    };
+
+    recordFrame();
+    // Everything fit the reserved sizes, so nothing moved
+    const DrawCommand* storage = renderer.getCommands().data();
+    recordFrame();
+    REQUIRE(renderer.getCommands().data() == storage);
+    REQUIRE(renderer.count(DrawCommand::Kind::Circle) == 15);
+    REQUIRE(renderer.getCommands()[3].position.x == 3.0F);
+    REQUIRE(renderer.textOf(renderer.getCommands().back()) == "score");
+}
+
+TEST_CASE("Submitting 500 brushes to a recording renderer", "[rendering][benchmark]") {
+    entt::registry registry;
+    const GameConfig config = GameConfig::localMatch();
+    RecordingRenderer renderer;
+    for (int index = 0; index < 500; ++index) {
+        const auto brush = registry.create();
+        registry.emplace<RenderPosition>(
+            brush, RenderPosition{.position = {static_cast<float>(index % 25) * 40.0F,
+                                               static_cast<float>(index / 25) * 30.0F}});
+        registry.emplace<Renderable>(brush, Renderable{.radius = 20.0F, .color = RED});
+    }
+    const BrushRenderSystem brushes(registry, renderer, config, kBrushBase, kBrushMask);
+
+    // Two draws per brush fit the default buffer, so every frame reuses it
+    const auto submitFrame = [&] {
+        renderer.beginFrame();
+        brushes.render();
+        renderer.endFrame();
+        return renderer.getCommands().size();
+    };
+    REQUIRE(submitFrame() == 1000);
+
+    BENCHMARK("Brush render submission") {
+        return submitFrame();
+    };
+}
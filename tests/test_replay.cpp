@@ -0,0 +1,181 @@
+#include "canvas/ownership_grid.h"
+#include "components/position.h"
+#include "headless/headless_runner.h"
+#include "rendering/null_renderer.h"
+#include "replay/canvas_stream.h"
+#include "replay/input_recording.h"
+#include "replay/match_recording.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+TEST_CASE("Input recordings round-trip through the binary log", "[replay]") {
+    GameConfig config = GameConfig::localMatch();
+    config.brushSize = 31.0F;
+    constexpr auto spawns = PlayerFactory::localGameSpawns();
+
+    InputRecording recording;
+    REQUIRE(recording.reset(config, spawns));
+    for (int tick = 0; tick < 500; ++tick) {
+        recording.append(static_cast<TickInputs>((tick / 40) % 3) << ((tick / 125) * 2));
+    }
+    REQUIRE(recording.getTickCount() == 500);
+    REQUIRE(recording.runs.size() < 30);
+
+    std::stringstream stream;
+    REQUIRE(writeInputRecording(stream, recording));
+    const auto loaded = readInputRecording(stream);
+    REQUIRE(loaded.has_value());
+    REQUIRE(loaded->config.brushSize == config.brushSize);
+    REQUIRE(loaded->spawns.size() == spawns.size());
+    REQUIRE(loaded->spawns[1].startPosition.x == spawns[1].startPosition.x);
+    REQUIRE(loaded->spawns[2].paletteIndex == spawns[2].paletteIndex);
+    REQUIRE(loaded->runs.size() == recording.runs.size());
+    for (std::size_t run = 0; run < recording.runs.size(); ++run) {
+        REQUIRE(loaded->runs[run].ticks == recording.runs[run].ticks);
+        REQUIRE(loaded->runs[run].inputs == recording.runs[run].inputs);
+    }
+
+    // Anything cut short is rejected rather than replayed partially
+    std::string truncated = stream.str();
+    truncated.resize(truncated.size() - 1);
+    std::istringstream shortStream(truncated);
+    REQUIRE_FALSE(readInputRecording(shortStream).has_value());
+}
+
+TEST_CASE("Replaying a recorded headless match reproduces it exactly", "[replay]") {
+    const NullRenderer renderer {};
+    HeadlessOptions options;
+    options.ticks = 900;
+    options.players = 8;
+    options.seed = 3;
+
+    HeadlessRunner original(renderer, options);
+    REQUIRE(original.startRecording());
+    original.run();
+    REQUIRE(original.getRecording().getTickCount() == options.ticks);
+
+    std::stringstream stream;
+    REQUIRE(writeInputRecording(stream, original.getRecording()));
+    auto recording = readInputRecording(stream);
+    REQUIRE(recording.has_value());
+
+    // Different seed and player count: everything must come from the recording
+    options.seed = 99;
+    options.players = 2;
+    HeadlessRunner replayed(renderer, options, std::move(*recording));
+    replayed.run();
+
+    const auto& originalGrid = original.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    const auto& replayedGrid = replayed.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    REQUIRE(std::ranges::equal(originalGrid.getCells(), replayedGrid.getCells()));
+
+    const auto originalView = original.getRegistry().view<const Position>();
+    for (const auto entity : originalView) {
+        const auto& [expected] = originalView.get<const Position>(entity);
+        const auto& [actual] = replayed.getRegistry().get<const Position>(entity);
+        REQUIRE(expected.x == actual.x);
+        REQUIRE(expected.y == actual.y);
+    }
+}
+
+TEST_CASE("Seeking a match recording restores the recorded tick", "[replay]") {
+    const NullRenderer renderer {};
+    HeadlessOptions options;
+    options.players = 6;
+    options.seed = 5;
+    HeadlessRunner runner(renderer, options);
+
+    const auto path = std::filesystem::temp_directory_path() / "ddd_test_match.ddm";
+    std::ofstream file(path, std::ios::binary);
+    MatchRecordingWriter writer(file, 50);
+    runner.recordMatch(writer);
+
+    // Grid cells and positions as simulated, for a few ticks to seek back to
+    struct Expected {
+        std::vector<std::uint8_t> cells;
+        std::vector<std::pair<entt::entity, Vector2>> positions;
+    };
+    constexpr std::array<std::uint32_t, 5> seekTicks = {299, 0, 137, 150, 149};
+    std::map<std::uint32_t, Expected> expected;
+    for (std::uint32_t tick = 0; tick < 300; ++tick) {
+        runner.tick();
+        if (std::ranges::find(seekTicks, tick) == seekTicks.end()) {
+            continue;
+        }
+        auto& [cells, positions] = expected[tick];
+        const auto grid = runner.getRegistry().ctx().get<CanvasOwnershipGrid>().getCells();
+        cells.assign(grid.begin(), grid.end());
+        for (const auto entity : runner.getRegistry().view<const Position>()) {
+            positions.emplace_back(entity, runner.getRegistry().get<const Position>(entity).position);
+        }
+    }
+    REQUIRE(writer.finish());
+    file.close();
+
+    auto reader = MatchRecordingReader::open(path);
+    REQUIRE(reader.has_value());
+    REQUIRE(reader->getTickCount() == 300);
+
+    // Backwards, forwards within a keyframe span and across one
+    entt::registry registry;
+    for (const auto tick : seekTicks) {
+        REQUIRE(reader->seek(registry, tick));
+        const auto& [cells, positions] = expected.at(tick);
+        REQUIRE(std::ranges::equal(registry.ctx().get<CanvasOwnershipGrid>().getCells(), cells));
+        for (const auto& [entity, position] : positions) {
+            REQUIRE(registry.get<const Position>(entity).position.x == position.x);
+            REQUIRE(registry.get<const Position>(entity).position.y == position.y);
+        }
+    }
+    REQUIRE_FALSE(reader->seek(registry, 300));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Canvas streams replay every delta and snapshot as simulated", "[replay][canvas]") {
+    const NullRenderer renderer {};
+    HeadlessOptions options;
+    options.players = 6;
+    options.seed = 9;
+    HeadlessRunner runner(renderer, options);
+    const auto& grid = runner.getRegistry().ctx().get<CanvasOwnershipGrid>();
+
+    std::stringstream stream;
+    const auto palette = runner.getPalette();
+    REQUIRE(palette.size() == 7);
+    CanvasStreamWriter writer(stream, grid, palette);
+    runner.streamCanvas(writer, 30);
+
+    std::vector<std::vector<std::uint8_t>> expected;
+    for (std::uint32_t tick = 0; tick < 300; ++tick) {
+        runner.tick();
+        if (tick % 30 == 0) {
+            expected.emplace_back(grid.getCells().begin(), grid.getCells().end());
+        }
+    }
+    REQUIRE(writer.writeSnapshot(grid, runner.getTick()));
+    expected.emplace_back(grid.getCells().begin(), grid.getCells().end());
+    REQUIRE(writer.getFrameCount() == 11);
+    // Mostly unpainted rows and small deltas: far below one byte per cell per frame
+    REQUIRE(writer.getBytesWritten() < grid.getCells().size());
+
+    auto reader = CanvasStreamReader::open(stream);
+    REQUIRE(reader.has_value());
+    REQUIRE(reader->getCanvas().getBitsPerCell() == 4);
+    REQUIRE(reader->getCellSize() == grid.getCellSize());
+    REQUIRE(reader->getPalette()[1].r == palette[1].r);
+    for (std::size_t frame = 0; frame < expected.size(); ++frame) {
+        REQUIRE(reader->next());
+        REQUIRE(reader->isSnapshot() == (frame == 0 || frame == expected.size() - 1));
+        REQUIRE(reader->getTick() == (frame < 10 ? frame * 30 : 300));
+        REQUIRE(reader->unpackCells() == expected[frame]);
+    }
+    REQUIRE_FALSE(reader->next());
+
+    std::stringstream garbage("DDDM not a canvas");
+    REQUIRE_FALSE(CanvasStreamReader::open(garbage).has_value());
+}
@@ -0,0 +1,293 @@
+#include "canvas/ownership_grid.h"
+#include "canvas/paint_stamp_queue.h"
+#include "components/position.h"
+#include "components/velocity.h"
+#include "core/player_factory.h"
+#include "game_config.h"
+#include "netcode/bit_stream.h"
+#include "netcode/input_transport.h"
+#include "netcode/rollback_session.h"
+#include "netcode/rollback_state.h"
+#include "netcode/udp_transport.h"
+#include "systems/interpolation.h"
+#include "systems/paint_grid.h"
+#include "systems/physics_collision.h"
+#include "systems/physics_movement.h"
+#include <algorithm>
+#include <array>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// The simulated half of a local match, as each peer runs it
+struct MatchInstance {
+    entt::registry registry;
+    GameConfig config = GameConfig::localMatch();
+    std::vector<entt::entity> players;
+    InterpolationSystem interpolation {registry};
+    PhysicsMovementSystem movement {registry, config};
+    PhysicsCollisionSystem collision {registry, config};
+    PaintGridSystem paintGrid {registry, config, 1280.0F, 720.0F};
+    std::vector<PaintStamp> drawn; // Stamps taken off the queue, in the order they came
+
+    MatchInstance() {
+        for (const auto& spawn : PlayerFactory::localGameSpawns()) {
+            players.push_back(PlayerFactory::createPlayer(registry, config, spawn));
+        }
+    }
+
+    void simulate() {
+        const float tickDuration = 1.0F / config.simulationTickRate;
+        interpolation.storePreviousPositions();
+        movement.update(tickDuration);
+        collision.update(tickDuration);
+        paintGrid.update();
+    }
+
+    // What PaintSystem does with the queue each frame, with a list standing in for the canvas
+    void drawStamps() {
+        auto& stamps = registry.ctx().get<PaintStampQueue>().stamps;
+        drawn.insert(drawn.end(), stamps.begin(), stamps.end());
+        stamps.clear();
+    }
+};
+
+// Every player changes what they hold every few ticks, so predictions keep failing
+InputAction scriptedInput(const std::uint32_t tick, const std::size_t player) {
+    const auto hold = (tick / static_cast<std::uint32_t>(5 + (player * 3)) + player) % 3;
+    return InputAction{.rotateLeft = hold == 1, .rotateRight = hold == 2};
+}
+
+// The match every peer should end up with
+void playScripted(MatchInstance& match, const std::uint32_t ticks) {
+    for (std::uint32_t tick = 0; tick < ticks; ++tick) {
+        for (std::size_t player = 0; player < match.players.size(); ++player) {
+            match.registry.get<InputAction>(match.players[player]) = scriptedInput(tick, player);
+        }
+        match.simulate();
+        match.drawStamps();
+    }
+}
+
+void requireSameState(const MatchInstance& lhs, const MatchInstance& rhs) {
+    REQUIRE(std::ranges::equal(lhs.registry.ctx().get<CanvasOwnershipGrid>().getCells(),
+                               rhs.registry.ctx().get<CanvasOwnershipGrid>().getCells()));
+    for (std::size_t player = 0; player < lhs.players.size(); ++player) {
+        const auto& [expected] = lhs.registry.get<const Position>(lhs.players[player]);
+        const auto& [actual] = rhs.registry.get<const Position>(rhs.players[player]);
+        REQUIRE(expected.x == actual.x);
+        REQUIRE(expected.y == actual.y);
+        REQUIRE(lhs.registry.get<const Velocity>(lhs.players[player]).rotation ==
+                rhs.registry.get<const Velocity>(rhs.players[player]).rotation);
+    }
+}
+
+// The canvas can't be rolled back, so a peer must only ever draw the strokes the match settles on
+void requireSameStrokes(const MatchInstance& lhs, const MatchInstance& rhs) {
+    REQUIRE(lhs.drawn.size() == rhs.drawn.size());
+    for (std::size_t index = 0; index < lhs.drawn.size(); ++index) {
+        const PaintStamp& expected = lhs.drawn[index];
+        const PaintStamp& actual = rhs.drawn[index];
+        REQUIRE(expected.from.x == actual.from.x);
+        REQUIRE(expected.from.y == actual.from.y);
+        REQUIRE(expected.to.x == actual.to.x);
+        REQUIRE(expected.to.y == actual.to.y);
+        REQUIRE(expected.radius == actual.radius);
+        REQUIRE(expected.paletteIndex == actual.paletteIndex);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Rollback peers end up with the match a single simulation produces", "[rollback]") {
+    constexpr std::uint32_t ticks = 600;
+    MatchInstance reference;
+    playScripted(reference, ticks);
+
+    struct Connection {
+        std::uint32_t latency;
+        std::uint32_t jitter;
+    };
+    // Jitter reorders packets; the slow link is further away than the rollback window
+    for (const auto [latency, jitter] : {Connection{3, 2}, Connection{12, 0}}) {
+        LoopbackLink link(latency, jitter, 7);
+        MatchInstance peers[2];
+        constexpr std::array<std::array<std::size_t, 2>, 2> localPlayers = {{{0, 1}, {2, 3}}};
+        RollbackSession sessions[2] = {
+            RollbackSession(peers[0].registry, peers[0].players, localPlayers[0], link.endpoint(0),
+                            [&] { peers[0].simulate(); }),
+            RollbackSession(peers[1].registry, peers[1].players, localPlayers[1], link.endpoint(1),
+                            [&] { peers[1].simulate(); }),
+        };
+
+        for (std::uint32_t frame = 0; frame < ticks * 10; ++frame) {
+            if (sessions[0].getConfirmedTick() == ticks && sessions[1].getConfirmedTick() == ticks) {
+                break;
+            }
+            for (std::size_t peer = 0; peer < 2; ++peer) {
+                const std::uint32_t tick = sessions[peer].getTick();
+                if (tick == ticks) {
+                    sessions[peer].poll();
+                    peers[peer].drawStamps();
+                    continue;
+                }
+                const std::array<InputAction, 2> inputs = {scriptedInput(tick, localPlayers[peer][0]),
+                                                           scriptedInput(tick, localPlayers[peer][1])};
+                sessions[peer].advance(inputs);
+                peers[peer].drawStamps();
+            }
+            link.tick();
+        }
+
+        for (std::size_t peer = 0; peer < 2; ++peer) {
+            REQUIRE(sessions[peer].getTick() == ticks);
+            REQUIRE(sessions[peer].getConfirmedTick() == ticks);
+            REQUIRE(sessions[peer].getStats().rollbacks > 0);
+            requireSameState(reference, peers[peer]);
+            requireSameStrokes(reference, peers[peer]);
+        }
+        if (latency > RollbackSession::kDefaultMaxRollbackTicks) {
+            REQUIRE(sessions[0].getStats().stalls > 0);
+        }
+    }
+}
+
+TEST_CASE("Bit streams read back what was packed", "[rollback]") {
+    std::vector<std::uint8_t> bytes;
+    BitWriter writer(bytes);
+    writer.write(5, 3);
+    writer.writeBool(true);
+    writer.write(0xDEADBEEF, 32);
+    writer.writeSigned(-3, 5);
+    REQUIRE(writer.getBitCount() == 41);
+    REQUIRE(bytes.size() == 6);
+
+    BitReader reader(bytes);
+    REQUIRE(reader.read(3) == 5);
+    REQUIRE(reader.readBool());
+    REQUIRE(reader.read(32) == 0xDEADBEEF);
+    REQUIRE(reader.readSigned(5) == -3);
+    REQUIRE_FALSE(reader.hasOverflowed());
+
+    // Only padding is left
+    REQUIRE(reader.read(8) == 0);
+    REQUIRE(reader.hasOverflowed());
+}
+
+TEST_CASE("Rollback peers converge over a lossy UDP connection", "[rollback]") {
+    constexpr std::uint32_t ticks = 600;
+    MatchInstance reference;
+    playScripted(reference, ticks);
+
+    UdpTransportOptions options;
+    options.conditions = NetworkConditions{
+        .lossRate = 0.1F, .latencySeconds = 0.03, .jitterSeconds = 0.02, .seed = 11};
+    auto first = UdpTransport::open(options);
+    options.conditions.seed = 12;
+    auto second = UdpTransport::open(options);
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    const std::array<std::unique_ptr<UdpTransport>, 2> transports = {std::move(*first),
+                                                                     std::move(*second)};
+    transports[0]->addPeer(transports[1]->getPort());
+    transports[1]->addPeer(transports[0]->getPort());
+
+    MatchInstance peers[2];
+    constexpr std::array<std::array<std::size_t, 2>, 2> localPlayers = {{{0, 1}, {2, 3}}};
+    RollbackSession sessions[2] = {
+        RollbackSession(peers[0].registry, peers[0].players, localPlayers[0], *transports[0],
+                        [&] { peers[0].simulate(); }),
+        RollbackSession(peers[1].registry, peers[1].players, localPlayers[1], *transports[1],
+                        [&] { peers[1].simulate(); }),
+    };
+
+    // Simulated time at 60 frames per second, so the test runs as fast as the sockets allow
+    using Clock = UdpTransport::Clock;
+    const auto frameDuration =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+    auto now = Clock::now();
+    std::uint32_t frames = 0;
+    for (; frames < ticks * 10; ++frames) {
+        if (sessions[0].getConfirmedTick() == ticks && sessions[1].getConfirmedTick() == ticks) {
+            break;
+        }
+        for (std::size_t peer = 0; peer < 2; ++peer) {
+            const std::uint32_t tick = sessions[peer].getTick();
+            if (tick == ticks) {
+                sessions[peer].poll();
+            } else {
+                const std::array<InputAction, 2> inputs = {
+                    scriptedInput(tick, localPlayers[peer][0]),
+                    scriptedInput(tick, localPlayers[peer][1])};
+                sessions[peer].advance(inputs);
+            }
+            peers[peer].drawStamps();
+            transports[peer]->update(now);
+        }
+        now += frameDuration;
+    }
+
+    const double seconds = frames / 60.0;
+    for (std::size_t peer = 0; peer < 2; ++peer) {
+        REQUIRE(sessions[peer].getConfirmedTick() == ticks);
+        requireSameState(reference, peers[peer]);
+        requireSameStrokes(reference, peers[peer]);
+
+        // 60 to 100 ms of simulated round trip, plus up to a send interval before the ack leaves
+        const auto& stats = transports[peer]->getPeerStats(0);
+        REQUIRE(stats.rttSeconds > 0.05);
+        REQUIRE(stats.rttSeconds < 0.2);
+        REQUIRE(stats.datagramsLost > 0);
+        // About 350 B/s: a datagram every 50 ms, repeating the input not yet acknowledged
+        REQUIRE(static_cast<double>(stats.bytesSent) / seconds < 400.0);
+    }
+}
+
+TEST_CASE("Restoring and re-simulating 8 ticks of 4 players", "[rollback][benchmark]") {
+    MatchInstance match;
+    for (std::uint32_t tick = 0; tick < 60; ++tick) {
+        match.simulate();
+    }
+
+    constexpr std::uint32_t rollbackTicks = 8;
+    const auto applyInput = [](MatchInstance& instance, const std::uint32_t tick) {
+        for (std::size_t player = 0; player < instance.players.size(); ++player) {
+            instance.registry.get<InputAction>(instance.players[player]) = scriptedInput(tick, player);
+        }
+    };
+
+    // The same match played straight through
+    MatchInstance expected;
+    for (std::uint32_t tick = 0; tick < 60 + rollbackTicks; ++tick) {
+        if (tick >= 60) {
+            applyInput(expected, tick - 60);
+        }
+        expected.simulate();
+    }
+
+    RollbackStateRing states(match.registry, match.players, rollbackTicks + 1);
+    states.save(match.registry, 0);
+    const auto resimulate = [&] {
+        states.load(match.registry, 0);
+        for (std::uint32_t tick = 0; tick < rollbackTicks; ++tick) {
+            states.save(match.registry, tick);
+            applyInput(match, tick);
+            match.simulate();
+            // Nothing draws here
+            match.registry.ctx().get<PaintStampQueue>().stamps.clear();
+        }
+    };
+
+    resimulate();
+    requireSameState(expected, match);
+
+    BENCHMARK("Rollback 8 ticks") {
+        resimulate();
+        return match.registry.get<const Position>(match.players[0]).position.x;
+    };
+    requireSameState(expected, match);
+}
@@ -0,0 +1,110 @@
+#include "components/position.h"
+#include "core/parallel_for.h"
+#include "core/system_scheduler.h"
+#include "core/thread_pool.h"
+#include "core/type_list.h"
+#include "headless/headless_runner.h"
+#include "rendering/null_renderer.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+
+struct Log {
+    std::vector<int> order;
+};
+
+struct First {
+    using Reads = TypeList<>;
+    using Writes = TypeList<Log>;
+};
+
+struct Second {
+    using Reads = TypeList<Position>;
+    using Writes = TypeList<Log>;
+};
+
+struct Independent {
+    using Reads = TypeList<Position>;
+    using Writes = TypeList<>;
+};
+
+} // namespace
+
+TEST_CASE("Thread pool runs every submitted task", "[scheduler]") {
+    ThreadPool pool(3);
+    std::atomic<int> completed {0};
+    constexpr int tasks = 1000;
+    for (int task = 0; task < tasks; ++task) {
+        pool.submit([&] { completed.fetch_add(1, std::memory_order_relaxed); });
+    }
+    while (completed.load() < tasks) {
+        pool.tryRunPendingTask();
+    }
+    REQUIRE(completed.load() == tasks);
+}
+
+TEST_CASE("parallelFor visits every index exactly once", "[scheduler]") {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> visits(10007);
+    parallelFor(&pool, visits.size(), 100, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            visits[index].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    REQUIRE(std::ranges::all_of(visits,
+                                [](const std::atomic<int>& count) { return count.load() == 1; }));
+}
+
+TEST_CASE("Conflicting systems keep their order on the pool", "[scheduler]") {
+    entt::registry registry;
+    ThreadPool pool(4);
+    Log log;
+    std::atomic<int> independentRuns {0};
+
+    SystemScheduler scheduler;
+    scheduler.add<First>("TestFirst", [&] { log.order.push_back(1); });
+    scheduler.add<Independent>("TestIndependent", [&] { independentRuns.fetch_add(1); });
+    scheduler.add<Second>("TestSecond", [&] { log.order.push_back(2); });
+
+    for (int run = 0; run < 100; ++run) {
+        scheduler.run(registry, ~SystemMask{0}, &pool);
+    }
+
+    REQUIRE(independentRuns.load() == 100);
+    REQUIRE(log.order.size() == 200);
+    for (std::size_t entry = 0; entry < log.order.size(); entry += 2) {
+        REQUIRE(log.order[entry] == 1);
+        REQUIRE(log.order[entry + 1] == 2);
+    }
+}
+
+TEST_CASE("Parallel headless runs match the sequential run", "[scheduler]") {
+    const NullRenderer renderer {};
+    HeadlessOptions options;
+    options.ticks = 600;
+    options.players = 12;
+    options.seed = 7;
+
+    HeadlessRunner sequential(renderer, options);
+    options.workerThreads = 4;
+    HeadlessRunner parallel(renderer, options);
+
+    const auto sequentialReport = sequential.run();
+    const auto parallelReport = parallel.run();
+    REQUIRE(sequentialReport.coverage == parallelReport.coverage);
+
+    const auto& sequentialGrid = sequential.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    const auto& parallelGrid = parallel.getRegistry().ctx().get<CanvasOwnershipGrid>();
+    REQUIRE(std::ranges::equal(sequentialGrid.getCells(), parallelGrid.getCells()));
+
+    const auto sequentialView = sequential.getRegistry().view<const Position>();
+    for (const auto entity : sequentialView) {
+        const auto& [expected] = sequentialView.get<const Position>(entity);
+        const auto& [actual] = parallel.getRegistry().get<const Position>(entity);
+        REQUIRE(expected.x == actual.x);
+        REQUIRE(expected.y == actual.y);
+    }
+}
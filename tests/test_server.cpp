@@ -0,0 +1,52 @@
+#include "canvas/ownership_grid.h"
+#include "components/position.h"
+#include "headless/headless_runner.h"
+#include "rendering/null_renderer.h"
+#include "server/match_server.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+TEST_CASE("Server matches play exactly like standalone headless runs", "[server]") {
+    const NullRenderer renderer {};
+    MatchServerOptions options;
+    options.matches = 7;
+    options.playersPerMatch = 4;
+    options.threads = 3;
+    options.paced = false;
+    options.seed = 11;
+
+    MatchServer server(renderer, options);
+    REQUIRE(server.getThreadCount() == 3);
+    const auto report = server.run(60);
+    REQUIRE(server.run(60).matches.size() == options.matches);
+    REQUIRE(report.threadBusySeconds.size() == 3);
+
+    for (std::uint32_t match = 0; match < options.matches; ++match) {
+        HeadlessOptions standaloneOptions;
+        standaloneOptions.players = options.playersPerMatch;
+        standaloneOptions.seed = options.seed + match;
+        HeadlessRunner standalone(renderer, standaloneOptions);
+        for (std::uint32_t tick = 0; tick < 120; ++tick) {
+            standalone.tick();
+        }
+
+        auto& registry = server.getMatchRegistry(match);
+        const auto& expected = standalone.getRegistry().ctx().get<CanvasOwnershipGrid>();
+        const auto& actual = registry.ctx().get<CanvasOwnershipGrid>();
+        REQUIRE(std::ranges::equal(expected.getCells(), actual.getCells()));
+
+        // Tick 120 sent a snapshot, so the bot client is up to date within quantization
+        const auto& client = server.getClientRegistry(match);
+        const auto view = registry.view<const Position>();
+        std::uint32_t players = 0;
+        for (const auto entity : view) {
+            ++players;
+            const auto& [position] = view.get<const Position>(entity);
+            const auto& [mirrored] = client.get<const Position>(entity);
+            REQUIRE(std::abs(position.x - mirrored.x) <= 1.0F / 32.0F);
+            REQUIRE(std::abs(position.y - mirrored.y) <= 1.0F / 32.0F);
+        }
+        REQUIRE(players == options.playersPerMatch);
+    }
+}
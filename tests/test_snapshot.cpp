@@ -0,0 +1,241 @@
+#include "components/collision_state.h"
+#include "components/position.h"
+#include "components/velocity.h"
+#include "netcode/snapshot_codec.h"
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace {
+
+// Brushes steering around the arena, every one of them moving, and a few bouncing off each
+// other now and then
+struct BrushWorld {
+    entt::registry registry;
+
+    explicit BrushWorld(const std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            spawn(index);
+        }
+    }
+
+    void spawn(const std::size_t index) {
+        const auto brush = registry.create();
+        registry.emplace<Position>(
+            brush, Position{.position = {40.0F + static_cast<float>(index % 40) * 30.0F,
+                                         40.0F + static_cast<float>(index / 40) * 30.0F}});
+        registry.emplace<Velocity>(brush, Velocity{.rotation = static_cast<float>(index * 37)});
+        registry.emplace<CollisionState>(brush);
+    }
+
+    void step(const std::uint32_t tick) {
+        constexpr float tickDuration = 1.0F / 60.0F;
+        for (const auto brush : registry.view<Position, Velocity, CollisionState>()) {
+            const auto index = static_cast<std::uint32_t>(entt::to_integral(brush));
+            auto& [position] = registry.get<Position>(brush);
+            auto& velocity = registry.get<Velocity>(brush);
+            auto& collision = registry.get<CollisionState>(brush);
+            velocity.rotation += (static_cast<float>(index % 3) - 1.0F) * 90.0F * tickDuration;
+            const float angle = velocity.rotation * DEG2RAD;
+            position.x += std::cos(angle) * 200.0F * tickDuration;
+            position.y += std::sin(angle) * 200.0F * tickDuration;
+
+            if ((tick + index) % 150 == 0) {
+                collision = CollisionState{.isInCollision = true,
+                                           .bounceTimer = 0.6F,
+                                           .bounceVelocity = {std::cos(angle) * -300.0F, 120.0F}};
+            } else if (collision.isInCollision) {
+                collision.bounceTimer -= tickDuration;
+                if (collision.bounceTimer <= 0.0F) {
+                    collision = CollisionState {};
+                }
+            }
+        }
+    }
+};
+
+void requireMirrors(const entt::registry& server, const entt::registry& client) {
+    std::size_t mirrored = 0;
+    for (const auto entity : client.view<const Position>()) {
+        REQUIRE(server.valid(entity));
+        ++mirrored;
+    }
+    for (const auto entity : server.view<const Position, const Velocity, const CollisionState>()) {
+        const auto& [expected] = server.get<const Position>(entity);
+        const auto& [actual] = client.get<const Position>(entity);
+        REQUIRE(std::abs(expected.x - actual.x) <= 1.0F / 32.0F);
+        REQUIRE(std::abs(expected.y - actual.y) <= 1.0F / 32.0F);
+
+        const float rotationError = std::remainder(server.get<const Velocity>(entity).rotation -
+                                                       client.get<const Velocity>(entity).rotation,
+                                                   360.0F);
+        REQUIRE(std::abs(rotationError) <= 360.0F / 4096.0F);
+
+        const auto& expectedCollision = server.get<const CollisionState>(entity);
+        const auto& actualCollision = client.get<const CollisionState>(entity);
+        REQUIRE(expectedCollision.isInCollision == actualCollision.isInCollision);
+        REQUIRE(std::abs(expectedCollision.bounceTimer - actualCollision.bounceTimer) <= 0.001F);
+        REQUIRE(std::abs(expectedCollision.bounceVelocity.x - actualCollision.bounceVelocity.x) <=
+                1.0F / 32.0F);
+        --mirrored;
+    }
+    REQUIRE(mirrored == 0);
+}
+
+} // namespace
+
+TEST_CASE("Snapshots decoded against acknowledged baselines mirror the server", "[snapshot]") {
+    BrushWorld world(300);
+    SnapshotEncoder encoder;
+    SnapshotClientState sent;
+    SnapshotDecoder decoder;
+    entt::registry client;
+
+    // Snapshots and acks each take two sends to arrive, and every fourth snapshot is lost
+    std::deque<std::vector<std::uint8_t>> inFlight;
+    std::deque<std::optional<std::uint32_t>> acks;
+    std::optional<std::uint32_t> acked;
+    std::size_t largest = 0;
+    for (std::uint32_t tick = 0; tick < 600; ++tick) {
+        if (tick == 200) {
+            for (std::uint32_t index = 5; index < 60; index += 7) {
+                world.registry.destroy(static_cast<entt::entity>(index));
+            }
+            world.spawn(1000);
+            world.spawn(1001);
+        }
+        // The last second is at rest, to let everything settle
+        if (tick < 540) {
+            world.step(tick);
+        }
+        if (tick % 3 != 0) {
+            continue;
+        }
+
+        const std::uint32_t sequence = encoder.capture(world.registry);
+        auto& packet = inFlight.emplace_back();
+        encoder.encode(sent, acked, packet);
+        largest = std::max(largest, packet.size());
+        if (sequence % 4 == 3) {
+            inFlight.back().clear();
+        }
+
+        if (inFlight.size() > 2) {
+            if (!inFlight.front().empty()) {
+                REQUIRE(decoder.decode(inFlight.front(), client));
+            }
+            inFlight.pop_front();
+        }
+        acks.push_back(decoder.getLatestSequence());
+        if (acks.size() > 2) {
+            acked = acks.front();
+            acks.pop_front();
+        }
+    }
+    requireMirrors(world.registry, client);
+
+    // Every brush moves, more than one snapshot holds, yet none went over the budget
+    REQUIRE(largest <= kDefaultSnapshotBudgetBytes);
+
+    // With nothing changing, a snapshot is little more than its header
+    std::vector<std::uint8_t> idle;
+    encoder.capture(world.registry);
+    encoder.encode(sent, acked, idle);
+    REQUIRE(idle.size() <= 8);
+
+    // Truncated data is rejected rather than applied partially
+    SnapshotClientState fresh;
+    std::vector<std::uint8_t> full;
+    encoder.capture(world.registry);
+    encoder.encode(fresh, std::nullopt, full);
+    full.resize(full.size() / 2);
+    REQUIRE_FALSE(decoder.decode(full, client));
+}
+
+TEST_CASE("Snapshot bandwidth stays flat as brushes are added", "[snapshot]") {
+    std::vector<std::size_t> averages;
+    for (const std::size_t brushes : {100, 400, 1600}) {
+        BrushWorld world(brushes);
+        SnapshotEncoder encoder;
+        SnapshotClientState sent;
+        SnapshotDecoder decoder;
+        entt::registry client;
+
+        // Acknowledged at once, as the server's bot clients do. Two seconds of movement, then one
+        // at rest for the brushes that were left out to catch up.
+        std::size_t total = 0;
+        std::size_t snapshots = 0;
+        for (std::uint32_t tick = 0; tick < 180; ++tick) {
+            if (tick < 120) {
+                world.step(tick);
+            }
+            if (tick % 3 != 0) {
+                continue;
+            }
+            std::vector<std::uint8_t> packet;
+            encoder.capture(world.registry);
+            encoder.encode(sent, decoder.getLatestSequence(), packet);
+            REQUIRE(packet.size() <= kDefaultSnapshotBudgetBytes);
+            REQUIRE(decoder.decode(packet, client));
+            if (tick < 120) {
+                total += packet.size();
+                ++snapshots;
+            }
+        }
+        // Skipped brushes rotate in, so every one of them reached the client
+        requireMirrors(world.registry, client);
+
+        averages.push_back(total / snapshots);
+    }
+
+    // Past the budget, more brushes mean less frequent updates rather than more bytes
+    REQUIRE(averages[0] < averages[1]);
+    REQUIRE(averages[1] <= kDefaultSnapshotBudgetBytes);
+    REQUIRE(averages[2] <= averages[1] + averages[1] / 20);
+}
+
+TEST_CASE("Encoding and decoding snapshots of 500 brushes", "[snapshot][benchmark]") {
+    BrushWorld world(500);
+    // Room for the whole world, so the client mirrors it after one full snapshot and one delta
+    SnapshotEncoder encoder(64 * 1024);
+    SnapshotClientState sent;
+    std::vector<std::uint8_t> full;
+    encoder.capture(world.registry);
+    encoder.encode(sent, std::nullopt, full);
+
+    // Three ticks later, with the first snapshot acknowledged
+    for (std::uint32_t tick = 0; tick < 3; ++tick) {
+        world.step(tick);
+    }
+    std::vector<std::uint8_t> delta;
+    const std::uint32_t baseline = 0;
+    encoder.capture(world.registry);
+    encoder.encode(sent, baseline, delta);
+
+    const auto decodeBoth = [&](entt::registry& client) {
+        SnapshotDecoder decoder;
+        REQUIRE(decoder.decode(full, client));
+        REQUIRE(decoder.decode(delta, client));
+    };
+    entt::registry mirror;
+    decodeBoth(mirror);
+    requireMirrors(world.registry, mirror);
+
+    BENCHMARK("Encode a delta") {
+        delta.clear();
+        encoder.encode(sent, baseline, delta);
+        return delta.size();
+    };
+    BENCHMARK("Capture") {
+        return encoder.capture(world.registry);
+    };
+    BENCHMARK("Decode a full snapshot and a delta") {
+        entt::registry client;
+        decodeBoth(client);
+        return client.view<const Position>().size_hint();
+    };
+}
@@ -0,0 +1,312 @@
+#include "canvas/paint_stamp_queue.h"
+#include "core/player_factory.h"
+#include "rendering/pixel_blend.h"
+#include "rendering/software_canvas_tile_store.h"
+#include "rendering/software_paint_canvas.h"
+#include "rendering/software_renderer.h"
+#include "rendering/tiled_paint_canvas.h"
+#include "rendering/watercolor_filter.h"
+#include "systems/arrow_render.h"
+#include "systems/paint.h"
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int kFrameWidth = 96;
+constexpr int kFrameHeight = 64;
+
+// Compares the framebuffer with tests/golden/<name>.ppm. Exact maths may still round a few
+// edge pixels differently on other compilers, so a handful may differ. Set DDD_UPDATE_GOLDENS
+// to rewrite the golden instead; on a mismatch the actual image is written to the temp directory.
+void requireMatchesGolden(const SoftwareImage& image, const std::string& name) {
+    const std::filesystem::path golden = std::filesystem::path(DDD_GOLDEN_DIR) / (name + ".ppm");
+    if (std::getenv("DDD_UPDATE_GOLDENS") != nullptr) {
+        std::ofstream file(golden, std::ios::binary);
+        REQUIRE(image.writePpm(file));
+        return;
+    }
+
+    std::ifstream file(golden, std::ios::binary);
+    const auto expected = SoftwareImage::readPpm(file);
+    REQUIRE(expected.has_value());
+    REQUIRE(expected->getWidth() == image.getWidth());
+    REQUIRE(expected->getHeight() == image.getHeight());
+
+    std::size_t differing = 0;
+    for (int y = 0; y < image.getHeight(); ++y) {
+        for (int x = 0; x < image.getWidth(); ++x) {
+            const Color actual = image.at(x, y);
+            const Color wanted = expected->at(x, y);
+            differing += actual.r != wanted.r || actual.g != wanted.g || actual.b != wanted.b;
+        }
+    }
+    const std::filesystem::path actualPath =
+        std::filesystem::temp_directory_path() / ("ddd_" + name + ".actual.ppm");
+    if (differing > image.getPixels().size() / 200) {
+        std::ofstream actual(actualPath, std::ios::binary);
+        image.writePpm(actual);
+    }
+    INFO(differing << " pixels differ from " << golden.string() << ", see "
+                   << actualPath.string());
+    REQUIRE(differing <= image.getPixels().size() / 200);
+}
+
+// 8x8, opaque at the top fading out towards the bottom, with a dark left column
+SoftwareImage patternTexture() {
+    SoftwareImage image(8, 8);
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            image.getPixels()[static_cast<std::size_t>((y * 8) + x)] =
+                x == 0 ? Color{40, 40, 40, 255}
+                       : Color{255, 255, 255, static_cast<unsigned char>(255 - (y * 30))};
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TEST_CASE("SIMD pixel kernels match the scalar ones exactly", "[rendering][software]") {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const auto randomColor = [&] {
+        const auto channel = [&] { return static_cast<unsigned char>(byte(random)); };
+        return Color{channel(), channel(), channel(), channel()};
+    };
+
+    // Odd length, so the scalar tail runs too
+    std::vector<Color> src(1027);
+    std::vector<Color> dst(src.size());
+    for (std::size_t index = 0; index < src.size(); ++index) {
+        src[index] = randomColor();
+        dst[index] = randomColor();
+    }
+    const Color tint = randomColor();
+    const Color fill = Color{200, 30, 90, 100};
+
+    std::vector<Color> expected = dst;
+    for (std::size_t index = 0; index < src.size(); ++index) {
+        pixel_blend::blendPixelScalar(expected[index],
+                                      pixel_blend::tintPixelScalar(src[index], tint));
+        pixel_blend::blendPixelScalar(expected[index], fill);
+    }
+
+    pixel_blend::tintSpan(src.data(), tint, src.size());
+    pixel_blend::blendSpan(dst.data(), src.data(), dst.size());
+    pixel_blend::fillSpan(dst.data(), fill, dst.size());
+    for (std::size_t index = 0; index < dst.size(); ++index) {
+        REQUIRE(dst[index].r == expected[index].r);
+        REQUIRE(dst[index].g == expected[index].g);
+        REQUIRE(dst[index].b == expected[index].b);
+        REQUIRE(dst[index].a == expected[index].a);
+    }
+
+    // Opaque sources replace, transparent ones leave the destination alone
+    Color pixel = {10, 20, 30, 255};
+    pixel_blend::blendPixelScalar(pixel, Color{1, 2, 3, 255});
+    REQUIRE((pixel.r == 1 && pixel.g == 2 && pixel.b == 3 && pixel.a == 255));
+    pixel_blend::blendPixelScalar(pixel, Color{200, 200, 200, 0});
+    REQUIRE((pixel.r == 1 && pixel.g == 2 && pixel.b == 3 && pixel.a == 255));
+}
+
+TEST_CASE("PaintSystem output matches its golden image", "[rendering][software][golden]") {
+    entt::registry registry;
+    auto& queue = registry.ctx().emplace<PaintStampQueue>();
+    SoftwareRenderer renderer(kFrameWidth, kFrameHeight, Color{245, 245, 245, 255});
+    const PaintSystem paint(registry, std::make_unique<SoftwarePaintCanvas>(renderer));
+
+    // A stroke, a translucent stroke over it and a translucent dot
+    queue.stamps = {
+        PaintStamp{{10, 12}, {80, 20}, 6.0F, {230, 41, 55, 255}, 1},
+        PaintStamp{{20, 50}, {60, 8}, 9.5F, {0, 121, 241, 160}, 2},
+        PaintStamp{{70, 45}, {70, 45}, 14.0F, {0, 228, 48, 200}, 3},
+    };
+    paint.update();
+    REQUIRE(queue.stamps.empty());
+    // Later stamps land on the same canvas
+    queue.stamps = {PaintStamp{{5, 60}, {90, 58}, 3.0F, {253, 249, 0, 255}, 4}};
+    paint.update();
+
+    renderer.beginFrame();
+    paint.render();
+    renderer.drawText("P1 42%", {2.0F, 30.0F}, 10, Color{0, 0, 0, 255});
+    renderer.endFrame();
+
+    requireMatchesGolden(renderer.getFramebuffer(), "paint_canvas");
+}
+
+TEST_CASE("ArrowRenderSystem output matches its golden image", "[rendering][software][golden]") {
+    entt::registry registry;
+    SoftwareRenderer renderer(kFrameWidth, kFrameHeight, Color{245, 245, 245, 255});
+    const ArrowRenderSystem arrows(registry, renderer, renderer.addTexture(patternTexture()));
+
+    // Headings of 0, 90, 210 and 315 degrees; the last one too slow to get an arrow
+    const std::array<std::pair<Vector2, Vector2>, 4> brushes = {{
+        {{20.0F, 16.0F}, {100.0F, 0.0F}},
+        {{70.0F, 16.0F}, {0.0F, 100.0F}},
+        {{24.0F, 46.0F}, {-86.6F, -50.0F}},
+        {{72.0F, 46.0F}, {3.0F, -3.0F}},
+    }};
+    renderer.beginFrame();
+    for (const auto& [position, velocity] : brushes) {
+        const auto entity = registry.create();
+        registry.emplace<RenderPosition>(entity, position);
+        registry.emplace<Velocity>(entity, Velocity{.velocity = velocity});
+        registry.emplace<Renderable>(entity,
+                                     Renderable{.radius = 9.0F, .color = {230, 41, 55, 255}});
+        renderer.drawCircle(position, 9.0F, Color{0, 121, 241, 255});
+    }
+    arrows.render();
+    renderer.endFrame();
+
+    requireMatchesGolden(renderer.getFramebuffer(), "arrows");
+}
+
+TEST_CASE("Watercolor filter follows the shader and reshades only changed tiles",
+          "[rendering][software][watercolor]") {
+    // Not a multiple of the tile size, so edge tiles are partial
+    SoftwareImage canvas(150, 100, WHITE);
+    canvas.fillCapsule({10, 12}, {140, 30}, 8.0F, Color{230, 41, 55, 255});
+    canvas.fillCapsule({30, 90}, {90, 20}, 12.0F, Color{0, 121, 241, 160});
+    canvas.fillCircle({120, 75}, 15.0F, Color{0, 228, 48, 255});
+    canvas.fillCircle({60, 60}, 6.0F, Color{0, 0, 0, 0});
+
+    const WatercolorSettings settings {.intensity = 1.5F, .time = 3.0F};
+    WatercolorFilter filter(canvas.getWidth(), canvas.getHeight(), settings);
+    REQUIRE(filter.apply(canvas) == filter.getTileCount());
+
+    // Tables and the contrast curve lookup may round a channel differently by a step or two
+    const SoftwareImage& shaded = filter.getOutput();
+    for (int y = 0; y < canvas.getHeight(); ++y) {
+        for (int x = 0; x < canvas.getWidth(); ++x) {
+            const Color expected = WatercolorFilter::shadeReference(canvas, x, y, settings);
+            const Color actual = shaded.at(x, y);
+            INFO("pixel " << x << ", " << y);
+            REQUIRE(std::abs(actual.r - expected.r) <= 2);
+            REQUIRE(std::abs(actual.g - expected.g) <= 2);
+            REQUIRE(std::abs(actual.b - expected.b) <= 2);
+            REQUIRE(std::abs(actual.a - expected.a) <= 2);
+        }
+    }
+
+    REQUIRE(filter.apply(canvas) == 0);
+
+    // A dab in the top-left tile only reaches that tile's neighbours
+    canvas.fillCircle({20, 20}, 4.0F, Color{253, 249, 0, 255});
+    const std::size_t reshaded = filter.apply(canvas);
+    REQUIRE(reshaded > 0);
+    REQUIRE(reshaded < filter.getTileCount());
+
+    // Told which tiles changed instead, a filter skips comparing pixels and shades the same
+    WatercolorFilter told(canvas.getWidth(), canvas.getHeight(), settings);
+    told.apply(canvas);
+    const PaintStamp stamp {{15, 75}, {25, 80}, 5.0F, {0, 0, 0, 255}, 1};
+    canvas.fillCapsule(stamp.from, stamp.to, stamp.radius, stamp.color);
+    filter.apply(canvas);
+    CanvasDirtyTiles dirtyTiles(canvas.getWidth(), canvas.getHeight());
+    dirtyTiles.markStamp(stamp);
+    REQUIRE(told.apply(canvas, dirtyTiles.getDirtyTiles()) < told.getTileCount());
+
+    // The result is the same as shading everything again, on any number of threads
+    ThreadPool pool(3);
+    WatercolorFilter fresh(canvas.getWidth(), canvas.getHeight(), settings, &pool);
+    fresh.apply(canvas);
+    for (std::size_t index = 0; index < canvas.getPixels().size(); ++index) {
+        const Color expected = fresh.getOutput().getPixels()[index];
+        for (const WatercolorFilter* incremental : {&filter, &told}) {
+            const Color actual = incremental->getOutput().getPixels()[index];
+            REQUIRE((actual.r == expected.r && actual.g == expected.g && actual.b == expected.b &&
+                     actual.a == expected.a));
+        }
+    }
+}
+
+TEST_CASE("Tiled canvas paints like a whole one, packing old tiles and drawing only the view",
+          "[rendering][software][tiled]") {
+    constexpr int kArenaWidth = 600;
+    constexpr int kArenaHeight = 400;
+    SoftwareRenderer wholeRenderer(kArenaWidth, kArenaHeight, BLACK);
+    SoftwareRenderer tiledRenderer(kArenaWidth, kArenaHeight, BLACK);
+    SoftwarePaintCanvas whole(wholeRenderer);
+    // Room for one live tile, so nearly every pass packs and unpacks
+    TiledPaintCanvas tiled(std::make_unique<SoftwareCanvasTileStore>(tiledRenderer), kArenaWidth,
+                           kArenaHeight, 1);
+    const CanvasDirtyTiles dirtyTiles(kArenaWidth, kArenaHeight);
+    REQUIRE(tiled.getTileCount() == 0);
+
+    // Only tiles under stamps exist: here the top left and bottom right ones
+    const std::vector<PaintStamp> first = {PaintStamp{{40, 40}, {90, 60}, 12.0F, RED, 1},
+                                           PaintStamp{{560, 370}, {580, 380}, 8.0F, BLUE, 3}};
+    whole.drawStamps(first, dirtyTiles);
+    tiled.drawStamps(first, dirtyTiles);
+    REQUIRE(tiled.getTileCount() == 2);
+    REQUIRE(tiled.getPackedBytes() == 0);
+
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> x(-20.0F, kArenaWidth + 20.0F);
+    std::uniform_real_distribution<float> y(-20.0F, kArenaHeight + 20.0F);
+    std::uniform_int_distribution<int> channel(0, 255);
+    for (int pass = 0; pass < 20; ++pass) {
+        std::vector<PaintStamp> stamps;
+        for (int index = 0; index < 4; ++index) {
+            const auto alpha = static_cast<unsigned char>(channel(random) | 0x80);
+            stamps.push_back(PaintStamp{{x(random), y(random)}, {x(random), y(random)}, 9.0F,
+                                        Color{static_cast<unsigned char>(channel(random)), 80,
+                                              200, alpha},
+                                        2});
+        }
+        whole.drawStamps(stamps, dirtyTiles);
+        tiled.drawStamps(stamps, dirtyTiles);
+    }
+    // Six tiles at most, each packed far below its 256 KB
+    REQUIRE(tiled.getTileCount() <= 6);
+    REQUIRE(tiled.getPackedBytes() > 0);
+    REQUIRE(tiled.getPackedBytes() < tiled.getTileCount() * 64 * 1024);
+
+    // Drawn whole, the tiles match the single image, pixel for pixel
+    const ArenaCamera full {.viewWidth = kArenaWidth, .viewHeight = kArenaHeight};
+    for (auto [canvas, renderer] : {std::pair<PaintCanvas*, SoftwareRenderer*>{&whole,
+                                                                              &wholeRenderer},
+                                    {&tiled, &tiledRenderer}}) {
+        renderer->beginFrame();
+        canvas->draw(full);
+        renderer->endFrame();
+    }
+    const auto wholePixels = wholeRenderer.getFramebuffer().getPixels();
+    const auto tiledPixels = tiledRenderer.getFramebuffer().getPixels();
+    for (std::size_t index = 0; index < wholePixels.size(); ++index) {
+        REQUIRE((wholePixels[index].r == tiledPixels[index].r &&
+                 wholePixels[index].g == tiledPixels[index].g &&
+                 wholePixels[index].b == tiledPixels[index].b));
+    }
+    REQUIRE(tiled.readPixel(40, 40).r == wholeRenderer.getFramebuffer().at(40, 40).r);
+
+    // Zoomed in on the bottom right corner, past the arena's edge only the clear colour shows
+    const ArenaCamera corner {.camera = {.offset = {0.0F, 0.0F},
+                                         .target = {530.0F, 350.0F},
+                                         .rotation = 0.0F,
+                                         .zoom = 2.0F},
+                              .viewWidth = kArenaWidth,
+                              .viewHeight = kArenaHeight};
+    REQUIRE(corner.getVisibleRect().x == 530.0F);
+    REQUIRE(corner.getVisibleRect().width == 300.0F);
+    tiledRenderer.beginFrame();
+    tiled.draw(corner);
+    tiledRenderer.endFrame();
+    const Color inside = tiledRenderer.getFramebuffer().at(20, 20);
+    const Color expected = wholeRenderer.getFramebuffer().at(540, 360);
+    REQUIRE((inside.r == expected.r && inside.g == expected.g && inside.b == expected.b));
+    const Color outside = tiledRenderer.getFramebuffer().at(kArenaWidth - 10, kArenaHeight - 10);
+    REQUIRE((outside.r == 0 && outside.g == 0 && outside.b == 0));
+    // The one tile in view is live; the rest stayed packed
+    REQUIRE(tiled.getResidentTileCount() == 1);
+}